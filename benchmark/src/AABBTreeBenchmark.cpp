@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "AABBTree.h"
+#include "BenchmarkUtils.h"
+#include "Parallel.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    using AABB = AABBTree<double, 3, size_t>;
+
+    static constexpr size_t NumBoxes = 100'000;
+    static constexpr size_t NumRays = 10'000;
+
+    static std::vector<vm::bbox3d> makeBoxes() {
+        std::mt19937 random(0);
+        std::uniform_real_distribution<double> position(-4096.0, 4096.0);
+        std::uniform_real_distribution<double> size(8.0, 256.0);
+
+        std::vector<vm::bbox3d> result;
+        result.reserve(NumBoxes);
+        for (size_t i = 0; i < NumBoxes; ++i) {
+            const vm::vec3d min(position(random), position(random), position(random));
+            result.push_back(vm::bbox3d(min, min + vm::vec3d(size(random), size(random), size(random))));
+        }
+        return result;
+    }
+
+    static std::vector<vm::ray3d> makeRays() {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<double> coord(-1.0, 1.0);
+
+        std::vector<vm::ray3d> result;
+        result.reserve(NumRays);
+        for (size_t i = 0; i < NumRays; ++i) {
+            const vm::vec3d origin = vm::vec3d(coord(random), coord(random), coord(random)) * 4096.0;
+            result.push_back(vm::ray3d(origin, normalize(vm::vec3d(coord(random), coord(random), coord(random)))));
+        }
+        return result;
+    }
+
+    static void queryTree(const AABB& tree, const std::vector<vm::ray3d>& rays, const std::string& name) {
+        size_t hits = 0;
+        timeLambda([&]() {
+            std::vector<size_t> result;
+            for (const auto& ray : rays) {
+                result.clear();
+                tree.findIntersectors(ray, std::back_inserter(result));
+                hits += result.size();
+            }
+        }, "query " + std::to_string(rays.size()) + " rays in " + name + " tree (height " + std::to_string(tree.height()) + ")");
+        ASSERT_LE(0u, hits);
+    }
+
+    TEST(AABBTreeBenchmark, buildAndQuery) {
+        const std::vector<vm::bbox3d> boxes = makeBoxes();
+        const std::vector<vm::ray3d> rays = makeRays();
+
+        std::vector<size_t> items(NumBoxes);
+        std::iota(std::begin(items), std::end(items), 0u);
+        const auto getBounds = [&](const size_t i) { return boxes[i]; };
+
+        AABB incrementalTree;
+        timeLambda([&]() {
+            for (const size_t i : items)
+                incrementalTree.insert(boxes[i], i);
+        }, "insert " + std::to_string(NumBoxes) + " boxes one by one");
+
+        // map files tend to list nearby brushes one after another, which is the worst case for incremental insertion
+        std::vector<size_t> sortedItems = items;
+        std::sort(std::begin(sortedItems), std::end(sortedItems), [&](const size_t lhs, const size_t rhs) { return boxes[lhs].min.x() < boxes[rhs].min.x(); });
+
+        AABB sortedIncrementalTree;
+        timeLambda([&]() {
+            for (const size_t i : sortedItems)
+                sortedIncrementalTree.insert(boxes[i], i);
+        }, "insert " + std::to_string(NumBoxes) + " boxes one by one, sorted by position");
+
+        AABB bulkTree;
+        timeLambda([&]() { bulkTree.clearAndBuild(items, getBounds); },
+                   "build tree from " + std::to_string(NumBoxes) + " boxes with 1 thread(s)");
+
+        AABB parallelTree;
+        parallelTree.setThreadCount(defaultThreadCount());
+        timeLambda([&]() { parallelTree.clearAndBuild(items, getBounds); },
+                   "build tree from " + std::to_string(NumBoxes) + " boxes with " + std::to_string(defaultThreadCount()) + " thread(s)");
+
+        // the first query flattens the tree, so it is timed separately
+        queryTree(incrementalTree, std::vector<vm::ray3d>(1, rays.front()), "incremental");
+        queryTree(sortedIncrementalTree, std::vector<vm::ray3d>(1, rays.front()), "sorted incremental");
+        queryTree(bulkTree, std::vector<vm::ray3d>(1, rays.front()), "bulk built");
+
+        queryTree(incrementalTree, rays, "incremental");
+        queryTree(sortedIncrementalTree, rays, "sorted incremental");
+        queryTree(bulkTree, rays, "bulk built");
+    }
+
+    TEST(AABBTreeBenchmark, updateAndQuery) {
+        static constexpr size_t NumUpdates = 1000;
+
+        const std::vector<vm::bbox3d> boxes = makeBoxes();
+        const std::vector<vm::ray3d> rays = makeRays();
+
+        std::vector<size_t> items(NumBoxes);
+        std::iota(std::begin(items), std::end(items), 0u);
+
+        AABB tree;
+        tree.clearAndBuild(items, [&](const size_t i) { return boxes[i]; });
+
+        // moving an object and picking afterwards, like dragging a brush in the 3D view
+        size_t hits = 0;
+        timeLambda([&]() {
+            const vm::vec3d offset(1.0, 0.0, 0.0);
+            for (size_t i = 0; i < NumUpdates; ++i) {
+                tree.update(boxes[i], boxes[i].translate(offset), i);
+
+                std::vector<size_t> result;
+                tree.findIntersectors(rays[i], std::back_inserter(result));
+                hits += result.size();
+            }
+        }, "update " + std::to_string(NumUpdates) + " boxes and query a ray after each update");
+        ASSERT_LT(0u, hits);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "Parallel.h"
+#include "Polyhedron.h"
+#include "Polyhedron_DefaultPayload.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    typedef Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload> Polyhedron3d;
+
+    static constexpr size_t NumPolyhedra = 100'000;
+
+    static void buildCubes(const size_t threadCount) {
+        timeLambda([&]() {
+            parallelFor(NumPolyhedra, threadCount, [](const size_t i) {
+                const double offset = static_cast<double>(i % 1024);
+                const Polyhedron3d cube(vm::bbox3d(vm::vec3d(offset, offset, offset), vm::vec3d(offset + 64.0, offset + 64.0, offset + 64.0)));
+                ASSERT_EQ(8u, cube.vertexCount());
+            });
+        }, "build and destroy " + std::to_string(NumPolyhedra) + " cubes with " + std::to_string(threadCount) + " thread(s)");
+    }
+
+    class SmallObject : public Allocator<SmallObject> {
+    private:
+        double m_values[6];
+    };
+
+    TEST(AllocatorBenchmark, allocateAndFreeInRandomOrder) {
+        static constexpr size_t NumObjects = 4'000'000;
+
+        std::vector<SmallObject*> objects(NumObjects);
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumObjects; ++i)
+                objects[i] = new SmallObject();
+        }, "allocate " + std::to_string(NumObjects) + " objects");
+
+        std::mt19937 random(0);
+        std::shuffle(std::begin(objects), std::end(objects), random);
+
+        timeLambda([&]() {
+            for (SmallObject* object : objects)
+                delete object;
+        }, "free " + std::to_string(NumObjects) + " objects in random order");
+    }
+
+    TEST(AllocatorBenchmark, buildAndDestroyCubes) {
+        buildCubes(1);
+        buildCubes(defaultThreadCount());
+    }
+
+    TEST(AllocatorBenchmark, buildCubesAndDestroyLater) {
+        // keeps all polyhedra alive until the end so that the allocator has to grow
+        std::vector<Polyhedron3d> cubes(NumPolyhedra);
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumPolyhedra; ++i) {
+                const double offset = static_cast<double>(i % 1024);
+                cubes[i] = Polyhedron3d(vm::bbox3d(vm::vec3d(offset, offset, offset), vm::vec3d(offset + 64.0, offset + 64.0, offset + 64.0)));
+            }
+        }, "build " + std::to_string(NumPolyhedra) + " cubes");
+
+        timeLambda([&]() { cubes.clear(); }, "destroy " + std::to_string(NumPolyhedra) + " cubes");
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "ByteBuffer.h"
+#include "Color.h"
+#include "Assets/Palette.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        static constexpr size_t NumMips = 2000;
+        static constexpr size_t MipSize = 256 * 256;
+
+        static void convertMips(const Palette& palette, const std::vector<std::vector<unsigned char>>& mips, const PaletteKernel kernel, const std::string& name) {
+            Buffer<unsigned char> image(MipSize * 4);
+            Color averageColor;
+            float checksum = 0.0f;
+
+            timeLambda([&]() {
+                for (size_t i = 0; i < NumMips; ++i) {
+                    const auto& mip = mips[i % mips.size()];
+                    palette.indexedToRgba(mip.data(), MipSize, image, averageColor, PaletteTransparency::Index255Transparent, kernel);
+                    checksum += averageColor[0];
+                }
+            }, "convert " + std::to_string(NumMips) + " 256x256 mips with the " + name + " kernel");
+
+            ASSERT_LT(0.0f, checksum);
+        }
+
+        TEST(PaletteBenchmark, convertMips) {
+            std::mt19937 rng(12345);
+            std::uniform_int_distribution<int> dist(0, 255);
+
+            unsigned char* data = new unsigned char[768];
+            for (size_t i = 0; i < 768; ++i)
+                data[i] = static_cast<unsigned char>(dist(rng));
+            const Palette palette(768, data);
+
+            // a few distinct mips that are converted over and over
+            std::vector<std::vector<unsigned char>> mips(16, std::vector<unsigned char>(MipSize));
+            for (auto& mip : mips) {
+                for (auto& index : mip)
+                    index = static_cast<unsigned char>(dist(rng));
+            }
+
+            convertMips(palette, mips, PaletteKernel::Scalar, "scalar");
+            convertMips(palette, mips, PaletteKernel::Table, "table");
+            if (Palette::supportsKernel(PaletteKernel::Avx2))
+                convertMips(palette, mips, PaletteKernel::Avx2, "AVX2");
+        }
+    }
+}
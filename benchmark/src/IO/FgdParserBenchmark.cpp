@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "CollectionUtils.h"
+#include "StringUtils.h"
+#include "Assets/EntityDefinition.h"
+#include "IO/DiskIO.h"
+#include "IO/FgdFileCache.h"
+#include "IO/FgdParser.h"
+#include "IO/Path.h"
+#include "IO/SimpleParserStatus.h"
+
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumBaseClasses = 50;
+        static constexpr size_t NumPointClasses = 1'100;
+
+        /**
+         * Creates an FGD file with about 8000 lines whose point classes inherit from a few base classes.
+         */
+        static String createFgd() {
+            StringStream str;
+            for (size_t i = 0; i < NumBaseClasses; ++i) {
+                str << "@BaseClass = Base" << i << "\n"
+                    << "[\n"
+                    << "    spawnflags(Flags) = [ " << (1 << (i % 8)) << " : \"Flag " << i << "\" : 0 ]\n"
+                    << "    base" << i << "(integer) : \"Base property\" : 0\n"
+                    << "]\n\n";
+            }
+
+            for (size_t i = 0; i < NumPointClasses; ++i) {
+                str << "@PointClass base(Base" << (i % NumBaseClasses) << ") size(-16 -16 -16, 16 16 16) = entity_" << i << " : \"Entity " << i << "\"\n"
+                    << "[\n"
+                    << "    message(string) : \"Message\"\n"
+                    << "    delay(float) : \"Delay\" : \"0.5\"\n"
+                    << "    count(integer) : \"Count\" : 1\n"
+                    << "]\n\n";
+            }
+            return str.str();
+        }
+
+        static void parseFgd(const String& fgd, const Path& path, FgdFileCache* cache) {
+            const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+            FgdParser parser(fgd, defaultColor, path, cache);
+
+            SimpleParserStatus status(nullptr);
+            auto definitions = parser.parseDefinitions(status);
+            ASSERT_EQ(NumPointClasses, definitions.size());
+            VectorUtils::clearAndDelete(definitions);
+        }
+
+        TEST(FgdParserBenchmark, reloadFgd) {
+            const String fgd = createFgd();
+            const Path path = Disk::getCurrentWorkingDir() + Path("benchmark.fgd");
+            const size_t numReloads = 10;
+
+            timeLambda([&]() {
+                for (size_t i = 0; i < numReloads; ++i) {
+                    parseFgd(fgd, path, nullptr);
+                }
+            }, "parse FGD with " + std::to_string(StringUtils::split(fgd, '\n').size()) + " lines " + std::to_string(numReloads) + " times");
+
+            FgdFileCache cache;
+            parseFgd(fgd, path, &cache);
+            timeLambda([&]() {
+                for (size_t i = 0; i < numReloads; ++i) {
+                    parseFgd(fgd, path, &cache);
+                }
+            }, "reload cached FGD " + std::to_string(numReloads) + " times");
+        }
+    }
+}
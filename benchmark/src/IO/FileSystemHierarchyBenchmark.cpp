@@ -0,0 +1,150 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "StringUtils.h"
+#include "IO/FileSystem.h"
+#include "IO/FileSystemHierarchy.h"
+#include "IO/Path.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumFileSystems = 40;
+        static constexpr size_t NumDirectories = 20;
+        static constexpr size_t FilesPerDirectory = 125;
+        static constexpr size_t NumLookups = 100'000;
+
+        /**
+         * A file system without contents that only knows the names of its files, like a mounted archive.
+         */
+        class NameOnlyFileSystem : public FileSystem {
+        private:
+            std::map<String, Path::List> m_directories;
+            std::set<String> m_files;
+        public:
+            NameOnlyFileSystem() {
+                m_directories[""] = Path::List();
+            }
+
+            void addFile(const Path& path) {
+                m_files.insert(key(path));
+
+                Path current = path;
+                while (!current.isEmpty()) {
+                    const Path parent = current.deleteLastComponent();
+                    auto& contents = m_directories[key(parent)];
+                    if (std::find(std::begin(contents), std::end(contents), current.lastComponent()) == std::end(contents))
+                        contents.push_back(current.lastComponent());
+                    current = parent;
+                }
+            }
+        private:
+            static String key(const Path& path) {
+                return StringUtils::toLower(path.asString('/'));
+            }
+
+            Path doMakeAbsolute(const Path& relPath) const override {
+                return Path("/") + relPath;
+            }
+
+            bool doDirectoryExists(const Path& path) const override {
+                return m_directories.count(key(path)) > 0;
+            }
+
+            bool doFileExists(const Path& path) const override {
+                return m_files.count(key(path)) > 0;
+            }
+
+            Path::List doGetDirectoryContents(const Path& path) const override {
+                return m_directories.at(key(path));
+            }
+
+            const MappedFile::Ptr doOpenFile(const Path& path) const override {
+                return MappedFile::Ptr();
+            }
+        };
+
+        static Path assetPath(const size_t fileSystem, const size_t directory, const size_t file) {
+            return Path("textures/set" + std::to_string(directory) + "/tex" + std::to_string(fileSystem) + "_" + std::to_string(file) + ".wal");
+        }
+
+        TEST(FileSystemHierarchyBenchmark, resolveAssetPaths) {
+            std::vector<NameOnlyFileSystem*> fileSystems;
+            FileSystemHierarchy hierarchy;
+            for (size_t i = 0; i < NumFileSystems; ++i) {
+                auto* fileSystem = new NameOnlyFileSystem();
+                for (size_t j = 0; j < NumDirectories; ++j) {
+                    for (size_t k = 0; k < FilesPerDirectory; ++k)
+                        fileSystem->addFile(assetPath(i, j, k));
+                }
+                fileSystems.push_back(fileSystem);
+                hierarchy.pushFileSystem(fileSystem);
+            }
+
+            // every lookup is spelled differently so that case insensitivity is exercised
+            std::vector<Path> paths;
+            paths.reserve(NumLookups);
+            for (size_t i = 0; i < NumLookups; ++i) {
+                const Path path = assetPath(i % NumFileSystems, (i / NumFileSystems) % NumDirectories, i % FilesPerDirectory);
+                paths.push_back(i % 2 == 0 ? path : Path(StringUtils::capitalize(path.asString())));
+            }
+
+            size_t linearFound = 0;
+            timeLambda([&]() {
+                for (const Path& path : paths) {
+                    for (auto it = fileSystems.rbegin(), end = fileSystems.rend(); it != end; ++it) {
+                        if ((*it)->fileExists(path)) {
+                            ++linearFound;
+                            break;
+                        }
+                    }
+                }
+            }, "resolve " + std::to_string(NumLookups) + " paths by asking " + std::to_string(NumFileSystems) + " file systems");
+
+            size_t indexedFound = 0;
+            timeLambda([&]() {
+                for (const Path& path : paths) {
+                    if (hierarchy.fileExists(path))
+                        ++indexedFound;
+                }
+            }, "resolve " + std::to_string(NumLookups) + " paths through the file system hierarchy");
+
+            size_t cachedFound = 0;
+            timeLambda([&]() {
+                for (const Path& path : paths) {
+                    if (hierarchy.fileExists(path))
+                        ++cachedFound;
+                }
+            }, "resolve " + std::to_string(NumLookups) + " paths through the file system hierarchy again");
+
+            ASSERT_EQ(NumLookups, linearFound);
+            ASSERT_EQ(NumLookups, indexedFound);
+            ASSERT_EQ(NumLookups, cachedFound);
+        }
+    }
+}
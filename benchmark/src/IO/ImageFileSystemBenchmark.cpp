@@ -0,0 +1,99 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/MappedFile.h"
+#include "IO/Path.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumPaks = 50;
+        static constexpr size_t EntriesPerPak = 4'000;
+        static constexpr size_t EntryDataSize = 16;
+
+        static void writeInt(char* cursor, const size_t value) {
+            const auto i = static_cast<int32_t>(value);
+            std::memcpy(cursor, &i, sizeof(i));
+        }
+
+        /**
+         * Creates a PAK file in memory whose entries are spread over a few directories like a mod's textures.
+         */
+        static MappedFile::Ptr createPak(const Path& path, const size_t entryCount) {
+            const size_t headerSize = 12;
+            const size_t entrySize = 64;
+            const size_t directoryAddress = headerSize + entryCount * EntryDataSize;
+            const size_t fileSize = directoryAddress + entryCount * entrySize;
+
+            char* data = new char[fileSize];
+            std::memset(data, 0, fileSize);
+            std::memcpy(data, "PACK", 4);
+            writeInt(data + 4, directoryAddress);
+            writeInt(data + 8, entryCount * entrySize);
+
+            for (size_t i = 0; i < entryCount; ++i) {
+                char* entry = data + directoryAddress + i * entrySize;
+                const std::string name = "textures/set" + std::to_string(i % 32) + "/Texture" + std::to_string(i) + ".wal";
+                std::strncpy(entry, name.c_str(), 55);
+                writeInt(entry + 56, headerSize + i * EntryDataSize);
+                writeInt(entry + 60, EntryDataSize);
+            }
+
+            return std::make_shared<MappedFileBuffer>(path, data, fileSize);
+        }
+
+        TEST(ImageFileSystemBenchmark, mountPaks) {
+            std::vector<MappedFile::Ptr> files;
+            for (size_t i = 0; i < NumPaks; ++i) {
+                files.push_back(createPak(Path("pak" + std::to_string(i) + ".pak"), EntriesPerPak));
+            }
+
+            std::vector<std::unique_ptr<IdPakFileSystem>> fileSystems;
+            timeLambda([&]() {
+                for (const auto& file : files) {
+                    fileSystems.push_back(std::make_unique<IdPakFileSystem>(file->path(), file));
+                }
+            }, "mount " + std::to_string(NumPaks) + " paks with " + std::to_string(EntriesPerPak) + " entries each");
+
+            size_t found = 0;
+            timeLambda([&]() {
+                for (const auto& fileSystem : fileSystems) {
+                    for (size_t i = 0; i < EntriesPerPak; i += 7) {
+                        const Path path("textures/set" + std::to_string(i % 32) + "/texture" + std::to_string(i) + ".WAL");
+                        if (fileSystem->openFile(path)->size() == EntryDataSize) {
+                            ++found;
+                        }
+                    }
+                }
+            }, "open every seventh entry of each pak");
+
+            ASSERT_EQ(NumPaks * ((EntriesPerPak + 6) / 7), found);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "IO/MapSnapshot.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/World.h"
+
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumSnapshotBrushes = 100'000;
+        static constexpr size_t NumSnapshotEntities = 5'000;
+
+        TEST(MapSnapshotBenchmark, takeSnapshot) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World world(Model::MapFormat::Valve, nullptr, worldBounds);
+            world.addOrUpdateAttribute("classname", "worldspawn");
+
+            Model::BrushBuilder builder(&world, worldBounds);
+            for (size_t i = 0; i < NumSnapshotBrushes; ++i) {
+                Model::Brush* brush = builder.createCube(64.0, "some_texture_name");
+                brush->transform(vm::translationMatrix(vm::vec3(static_cast<double>(i % 100) * 64.0, static_cast<double>(i / 100) * 8.0, 0.0)), false, worldBounds);
+                world.defaultLayer()->addChild(brush);
+            }
+
+            for (size_t i = 0; i < NumSnapshotEntities; ++i) {
+                Model::Entity* entity = new Model::Entity();
+                entity->addOrUpdateAttribute("classname", "light");
+                entity->addOrUpdateAttribute("origin", std::to_string(i) + " 0 0");
+                entity->addOrUpdateAttribute("light", "300");
+                entity->addOrUpdateAttribute("targetname", "light_" + std::to_string(i));
+                world.defaultLayer()->addChild(entity);
+            }
+
+            const String counts = std::to_string(NumSnapshotBrushes) + " brushes and " + std::to_string(NumSnapshotEntities) + " entities";
+            timeLambda([&]() { MapSnapshot::take(&world, "Test"); }, "take first snapshot of " + counts);
+            timeLambda([&]() { MapSnapshot::take(&world, "Test"); }, "take snapshot of unchanged " + counts);
+
+            // change a few brushes like an edit would
+            auto& children = world.defaultLayer()->children();
+            for (size_t i = 0; i < 100; ++i) {
+                auto* brush = static_cast<Model::Brush*>(children[i * 997]);
+                brush->faces().front()->setXOffset(static_cast<float>(i));
+            }
+            timeLambda([&]() { MapSnapshot::take(&world, "Test"); }, "take snapshot after changing 100 brushes of " + counts);
+        }
+    }
+}
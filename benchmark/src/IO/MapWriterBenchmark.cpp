@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "Parallel.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Layer.h"
+#include "Model/World.h"
+
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumBrushes = 100'000;
+
+        static void writeMap(Model::World& world, const size_t threadCount) {
+            FILE* file = std::tmpfile();
+            ASSERT_NE(nullptr, file);
+
+            timeLambda([&]() {
+                NodeWriter writer(&world, file, threadCount);
+                writer.writeMap();
+                std::fflush(file);
+            }, "write " + std::to_string(NumBrushes) + " brushes with " + std::to_string(threadCount) + " thread(s)");
+
+            std::fclose(file);
+        }
+
+        TEST(MapWriterBenchmark, benchWriteMap) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            world.addOrUpdateAttribute("classname", "worldspawn");
+
+            // half of the brushes have integer coordinates, the other half are rotated
+            std::mt19937 random(0);
+            std::uniform_real_distribution<double> angles(0.0, 3.14);
+            std::uniform_real_distribution<double> coords(-4096.0, 4096.0);
+
+            Model::BrushBuilder builder(&world, worldBounds);
+            for (size_t i = 0; i < NumBrushes; ++i) {
+                Model::Brush* brush = builder.createCube(64.0, "tex");
+                if (i % 2 == 0) {
+                    brush->transform(vm::translationMatrix(vm::vec3(coords(random), coords(random), coords(random))) *
+                                     vm::rotationMatrix(angles(random), angles(random), angles(random)), false, worldBounds);
+                }
+                world.defaultLayer()->addChild(brush);
+            }
+
+            writeMap(world, 1);
+            writeMap(world, defaultThreadCount());
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "StringUtils.h"
+#include "IO/DiskIO.h"
+#include "IO/MappedFile.h"
+#include "IO/Path.h"
+#include "IO/StandardMapParser.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t MapFileSize = 256 * 1024 * 1024;
+
+        /**
+         * Writes brushes with integer and decimal plane points until the file reaches the given size.
+         */
+        static void writeMapFile(const Path& path, const size_t size) {
+            std::ofstream stream(path.asString().c_str(), std::ios::out | std::ios::binary);
+            std::mt19937 random(0);
+            std::uniform_int_distribution<int> coords(-4096, 4096);
+            std::uniform_real_distribution<double> decimals(-4096.0, 4096.0);
+
+            size_t written = 0;
+            StringStream chunk;
+            chunk << "{\n\"classname\" \"worldspawn\"\n\"wad\" \"quake.wad\"\n";
+            while (written < size) {
+                chunk << "// brush\n{\n";
+                for (size_t i = 0; i < 6; ++i) {
+                    for (size_t j = 0; j < 3; ++j) {
+                        if (i % 2 == 0)
+                            chunk << "( " << coords(random) << " " << coords(random) << " " << coords(random) << " ) ";
+                        else
+                            chunk << "( " << decimals(random) << " " << decimals(random) << " " << decimals(random) << " ) ";
+                    }
+                    chunk << "base_wall" << i << " 0 0 0 1 1\n";
+                }
+                chunk << "}\n";
+
+                const String str = chunk.str();
+                stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+                written += str.size();
+                chunk.str("");
+            }
+            stream << "}\n";
+        }
+
+        TEST(QuakeMapTokenizerBenchmark, benchTokenizeMapFile) {
+            const Path path = Disk::getCurrentWorkingDir() + Path("tokenizer_benchmark.map");
+            writeMapFile(path, MapFileSize);
+
+            {
+                const MappedFile::Ptr file = Disk::openFile(path);
+                const double sizeInMB = static_cast<double>(file->size()) / (1024.0 * 1024.0);
+
+                // peek at every token like the parser does, and convert every number
+                size_t tokenCount = 0;
+                double sum = 0.0;
+                const double elapsedMs = timeLambda([&]() {
+                    QuakeMapTokenizer tokenizer(file->begin(), file->end());
+                    auto token = tokenizer.peekToken();
+                    while (!token.hasType(QuakeMapToken::Eof)) {
+                        token = tokenizer.nextToken();
+                        if (token.hasType(QuakeMapToken::Integer | QuakeMapToken::Decimal))
+                            sum += token.toFloat<double>();
+                        ++tokenCount;
+                        token = tokenizer.peekToken();
+                    }
+                }, "tokenize " + std::to_string(file->size()) + " bytes");
+
+                printf("Tokenized %zu tokens (checksum %f) at %f MB/s\n", tokenCount, sum, sizeInMB / (elapsedMs / 1000.0));
+                ASSERT_LT(0u, tokenCount);
+            }
+
+            std::remove(path.asString().c_str());
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "Parallel.h"
+#include "StringUtils.h"
+#include "IO/SimpleParserStatus.h"
+#include "IO/WorldReader.h"
+#include "Model/World.h"
+
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static constexpr size_t NumBrushes = 100'000;
+        static constexpr size_t BrushesPerEntity = 8;
+
+        static void writeBrush(StringStream& str, const int x, const int y, const int z) {
+            const int s = 64;
+            // a cube with one corner cut off so that the geometry isn't entirely trivial
+            str << "{\n";
+            str << "( " << x     << " " << y     << " " << z     << " ) ( " << x     << " " << y + 1 << " " << z     << " ) ( " << x     << " " << y     << " " << z + 1 << " ) tex1 0 0 0 1 1\n";
+            str << "( " << x     << " " << y     << " " << z     << " ) ( " << x     << " " << y     << " " << z + 1 << " ) ( " << x + 1 << " " << y     << " " << z     << " ) tex2 0 0 0 1 1\n";
+            str << "( " << x     << " " << y     << " " << z     << " ) ( " << x + 1 << " " << y     << " " << z     << " ) ( " << x     << " " << y + 1 << " " << z     << " ) tex3 0 0 0 1 1\n";
+            str << "( " << x + s << " " << y + s << " " << z + s << " ) ( " << x + s << " " << y + s << " " << z + s + 1 << " ) ( " << x + s << " " << y + s + 1 << " " << z + s << " ) tex4 0 0 0 1 1\n";
+            str << "( " << x + s << " " << y + s << " " << z + s << " ) ( " << x + s + 1 << " " << y + s << " " << z + s << " ) ( " << x + s << " " << y + s << " " << z + s + 1 << " ) tex5 0 0 0 1 1\n";
+            str << "( " << x + s << " " << y + s << " " << z + s << " ) ( " << x + s << " " << y + s + 1 << " " << z + s << " ) ( " << x + s + 1 << " " << y + s << " " << z + s << " ) tex6 0 0 0 1 1\n";
+            str << "( " << x + s << " " << y + s / 2 << " " << z + s << " ) ( " << x + s / 2 << " " << y + s << " " << z + s << " ) ( " << x + s << " " << y + s << " " << z + s / 2 << " ) tex7 0 0 0 1 1\n";
+            str << "}\n";
+        }
+
+        /**
+         * Generates a map where the first half of the brushes belong to the worldspawn entity and the remaining
+         * brushes are distributed among brush entities.
+         */
+        static String makeMap() {
+            const int gridSize = 96;
+            const int cellsPerAxis = 64;
+
+            StringStream str;
+            str << "{\n\"classname\" \"worldspawn\"\n";
+            size_t i = 0;
+            for (; i < NumBrushes / 2; ++i) {
+                const int x = static_cast<int>(i % cellsPerAxis) * gridSize - 4096;
+                const int y = static_cast<int>((i / cellsPerAxis) % cellsPerAxis) * gridSize - 4096;
+                const int z = static_cast<int>(i / (cellsPerAxis * cellsPerAxis)) * gridSize - 4096;
+                writeBrush(str, x, y, z);
+            }
+            str << "}\n";
+
+            while (i < NumBrushes) {
+                str << "{\n\"classname\" \"func_wall\"\n";
+                for (size_t j = 0; j < BrushesPerEntity && i < NumBrushes; ++j, ++i) {
+                    const int x = static_cast<int>(i % cellsPerAxis) * gridSize - 4096;
+                    const int y = static_cast<int>((i / cellsPerAxis) % cellsPerAxis) * gridSize - 4096;
+                    const int z = static_cast<int>(i / (cellsPerAxis * cellsPerAxis)) * gridSize - 4096;
+                    writeBrush(str, x, y, z);
+                }
+                str << "}\n";
+            }
+
+            return str.str();
+        }
+
+        static void readMap(const String& data, const size_t threadCount) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            SimpleParserStatus status(nullptr);
+            WorldReader reader(data, nullptr);
+            reader.setThreadCount(threadCount);
+
+            Model::World* world = nullptr;
+            timeLambda([&]() { world = reader.read(Model::MapFormat::Standard, worldBounds, status); },
+                       "read " + std::to_string(NumBrushes) + " brushes with " + std::to_string(threadCount) + " thread(s)");
+
+            ASSERT_EQ(1u, world->childCount());
+            delete world;
+        }
+
+        TEST(WorldReaderBenchmark, benchReadMap) {
+            const String data = makeMap();
+
+            readMap(data, 1);
+            readMap(data, defaultThreadCount());
+        }
+    }
+}
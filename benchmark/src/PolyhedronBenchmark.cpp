@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "Polyhedron.h"
+#include "Polyhedron_DefaultPayload.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/vec.h>
+
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    typedef Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload> Polyhedron3d;
+
+    static constexpr size_t NumPolyhedra = 20'000;
+
+    /**
+     * Returns a cube with its corners cut off so that the polyhedron has a realistic number of elements.
+     */
+    static Polyhedron3d makeBevelledCube(const double offset) {
+        const vm::vec3d min(offset, offset, offset);
+        const vm::vec3d max(offset + 64.0, offset + 64.0, offset + 64.0);
+        Polyhedron3d result(vm::bbox3d(min, max));
+        for (size_t i = 0; i < 8; ++i) {
+            const vm::vec3d corner((i & 1) ? max.x() : min.x(), (i & 2) ? max.y() : min.y(), (i & 4) ? max.z() : min.z());
+            const vm::vec3d normal = normalize(corner - (min + max) / 2.0);
+            result.clip(vm::plane3d(corner - normal * 8.0, normal));
+        }
+        return result;
+    }
+
+    static std::vector<Polyhedron3d> makeBevelledCubes() {
+        std::vector<Polyhedron3d> result;
+        result.reserve(NumPolyhedra);
+        for (size_t i = 0; i < NumPolyhedra; ++i)
+            result.push_back(makeBevelledCube(static_cast<double>(i % 1024)));
+        return result;
+    }
+
+    TEST(PolyhedronBenchmark, clone) {
+        const std::vector<Polyhedron3d> originals = makeBevelledCubes();
+        std::vector<Polyhedron3d> copies;
+        copies.reserve(NumPolyhedra);
+
+        timeLambda([&]() {
+            for (const Polyhedron3d& original : originals)
+                copies.push_back(original);
+        }, "clone " + std::to_string(NumPolyhedra) + " polyhedra");
+        ASSERT_EQ(originals.front(), copies.front());
+
+        timeLambda([&]() { copies.clear(); }, "destroy " + std::to_string(NumPolyhedra) + " clones");
+    }
+
+    TEST(PolyhedronBenchmark, clip) {
+        const std::vector<Polyhedron3d> originals = makeBevelledCubes();
+
+        size_t vertexCount = 0;
+        timeLambda([&]() {
+            for (const Polyhedron3d& original : originals) {
+                Polyhedron3d copy(original);
+                const vm::vec3d center = copy.bounds().center();
+                copy.clip(vm::plane3d(center, normalize(vm::vec3d(1.0, 2.0, 3.0))));
+                vertexCount += copy.vertexCount();
+            }
+        }, "clone and clip " + std::to_string(NumPolyhedra) + " polyhedra");
+        ASSERT_LT(0u, vertexCount);
+    }
+
+    TEST(PolyhedronBenchmark, subtract) {
+        const std::vector<Polyhedron3d> originals = makeBevelledCubes();
+        const Polyhedron3d subtrahend(vm::bbox3d(vm::vec3d(-4096.0, -4096.0, -4096.0), vm::vec3d(4096.0, 4096.0, 32.0)));
+
+        size_t fragmentCount = 0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumPolyhedra / 10; ++i) {
+                const auto fragments = originals[i].subtract(subtrahend);
+                fragmentCount += fragments.size();
+            }
+        }, "subtract from " + std::to_string(NumPolyhedra / 10) + " polyhedra");
+        ASSERT_LT(0u, fragmentCount);
+    }
+
+    TEST(PolyhedronBenchmark, moveVertices) {
+        const std::vector<Polyhedron3d> originals = makeBevelledCubes();
+
+        // moving vertices rebuilds the geometry from the moved positions, like Brush::doMoveVertices does
+        size_t vertexCount = 0;
+        timeLambda([&]() {
+            for (const Polyhedron3d& original : originals) {
+                std::vector<vm::vec3d> positions = original.vertexPositions();
+                positions.front() = positions.front() + vm::vec3d(4.0, 4.0, 4.0);
+                const Polyhedron3d moved(positions);
+                vertexCount += moved.vertexCount();
+            }
+        }, "move a vertex of " + std::to_string(NumPolyhedra) + " polyhedra");
+        ASSERT_LT(0u, vertexCount);
+    }
+}
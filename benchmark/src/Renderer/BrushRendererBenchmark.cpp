@@ -19,7 +19,9 @@
 
 #include <gtest/gtest.h>
 
+#include "BenchmarkUtils.h"
 #include "CollectionUtils.h"
+#include "Parallel.h"
 #include "Assets/Texture.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
@@ -28,11 +30,11 @@
 #include "Renderer/BrushRenderer.h"
 
 #include <vector>
-#include <chrono>
 #include <string>
 #include <iostream>
 #include <tuple>
 #include <algorithm>
+#include <cstdio>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -79,23 +81,6 @@ namespace TrenchBroom {
             return {result, textures};
         }
 
-#ifdef __GNUC__
-#define TB_NOINLINE __attribute__((noinline))
-#else
-#define TB_NOINLINE
-#endif
-
-        // the noinline is so you can see the timeLambda when profiling
-        template<class L>
-        TB_NOINLINE static void timeLambda(L&& lambda, const std::string& message) {
-            const auto start = std::chrono::high_resolution_clock::now();
-            lambda();
-            const auto end = std::chrono::high_resolution_clock::now();
-
-            printf("Time elapsed for '%s': %fms\n", message.c_str(),
-                   std::chrono::duration<double>(end - start).count() * 1000.0);
-        }
-
         TEST(BrushRendererBenchmark, benchBrushRenderer) {
             auto brushesTextures = makeBrushes();
             std::vector<Model::Brush*> brushes = brushesTextures.first;
@@ -142,6 +127,95 @@ namespace TrenchBroom {
             VectorUtils::clearAndDelete(brushes);
             VectorUtils::clearAndDelete(textures);
         }
+
+        TEST(BrushRendererBenchmark, benchValidateInParallel) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            std::vector<size_t> threadCounts{ 1u };
+            if (defaultThreadCount() > 1u) {
+                threadCounts.push_back(defaultThreadCount());
+            }
+
+            for (const auto threadCount : threadCounts) {
+                BrushRenderer r(false);
+                r.setThreadCount(threadCount);
+                r.addBrushes(brushes);
+                r.validate();
+
+                // a filter change only requires the filter to be evaluated again
+                r.invalidate();
+                timeLambda([&](){ r.validate(); },
+                           "validate " + std::to_string(brushes.size()) + " brushes with cached vertices on " +
+                           std::to_string(threadCount) + " thread(s)");
+
+                // a texture change also requires the vertices to be rebuilt
+                for (auto* brush : brushes) {
+                    brush->invalidateVertexCache();
+                }
+                r.invalidate();
+                timeLambda([&](){ r.validate(); },
+                           "validate " + std::to_string(brushes.size()) + " brushes without cached vertices on " +
+                           std::to_string(threadCount) + " thread(s)");
+            }
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
+        }
+
+        TEST(BrushRendererBenchmark, benchMemoryUsage) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            BrushRenderer r(false);
+            r.addBrushes(brushes);
+            r.validate();
+
+            const auto usage = r.memoryUsage();
+            ASSERT_EQ(brushes.size(), usage.brushCount);
+
+            const auto perBrush = [&](const size_t bytes) { return static_cast<double>(bytes) / static_cast<double>(usage.brushCount); };
+            printf("Memory used per brush: %.1f bytes of vertex cache, %.1f bytes of vertices, %.1f bytes of indices\n",
+                   perBrush(usage.brushCacheBytes), perBrush(usage.vertexBytes), perBrush(usage.indexBytes));
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
+        }
+
+        TEST(BrushRendererBenchmark, benchToggleSelection) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            // stand-ins for the default and selection renderers of MapRenderer
+            BrushRenderer unselected(false);
+            BrushRenderer selected(false);
+            unselected.setBrushes(brushes);
+            unselected.validate();
+
+            const auto toggle = [&](BrushRenderer& from, BrushRenderer& to) {
+                from.setBrushes(Model::BrushList());
+                to.setBrushes(brushes);
+                if (!from.valid()) {
+                    from.validate();
+                }
+                if (!to.valid()) {
+                    to.validate();
+                }
+            };
+
+            // the first selection must upload all brushes to the selection renderer
+            timeLambda([&](){ toggle(unselected, selected); }, "select all " + std::to_string(brushes.size()) + " brushes");
+            for (size_t i = 0; i < 2; ++i) {
+                timeLambda([&](){ toggle(selected, unselected); }, "deselect all " + std::to_string(brushes.size()) + " brushes");
+                timeLambda([&](){ toggle(unselected, selected); }, "select all " + std::to_string(brushes.size()) + " brushes");
+            }
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
+        }
     }
 }
 
@@ -22,17 +22,27 @@
 
 #include "NodeTree.h"
 #include "Exceptions.h"
+#include "Macros.h"
+#include "Parallel.h"
 #include <vecmath/scalar.h>
 #include <vecmath/bbox.h>
+#include <vecmath/bbox_packet.h>
 #include <vecmath/ray.h>
 #include <vecmath/intersection.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 template <typename T, size_t S, typename U, typename Cmp = std::less<U>>
 class AABBTree : public NodeTree<T,S,U,Cmp> {
@@ -41,34 +51,12 @@ public:
     using Box = typename NodeTree<T,S,U,Cmp>::Box;
     using DataType = typename NodeTree<T,S,U,Cmp>::DataType;
     using FloatType = typename NodeTree<T,S,U,Cmp>::FloatType;
+    using Array = typename NodeTree<T,S,U,Cmp>::Array;
+    using GetBounds = typename NodeTree<T,S,U,Cmp>::GetBounds;
 private:
     class InnerNode;
     class LeafNode;
 
-    class Visitor {
-    public:
-        virtual ~Visitor() = default;
-
-        virtual bool visit(const InnerNode* innerNode) = 0;
-        virtual void visit(const LeafNode* leaf) = 0;
-    };
-
-    class LambdaVisitor : public Visitor {
-    public:
-        using InnerNodeVisitor = std::function<bool(const InnerNode*)>;
-        using LeafVisitor = std::function<void(const LeafNode*)>;
-    private:
-        const InnerNodeVisitor m_innerNodeVisitor;
-        const LeafVisitor m_leafVisitor;
-    public:
-        LambdaVisitor(const InnerNodeVisitor& innerNodeVisitor, const LeafVisitor& leafVisitor) :
-                m_innerNodeVisitor(innerNodeVisitor),
-                m_leafVisitor(leafVisitor) {}
-
-        bool visit(const InnerNode* innerNode) override { return m_innerNodeVisitor(innerNode); }
-        void visit(const LeafNode* leaf)           override { m_leafVisitor(leaf); }
-    };
-
     class Node {
     private:
         Box m_bounds;
@@ -142,11 +130,15 @@ private:
         virtual std::pair<Node*, bool> remove(const Box& bounds, const U& data) = 0;
 
         /**
-         * Accepts the given visitor.
+         * Replaces the bounds of the node with the given old bounds and data in the subtree of which this node is the
+         * root without changing the structure of the subtree. The bounds of the ancestors of that node are updated.
          *
-         * @param visitor the visitor to accept
+         * @param oldBounds the current bounds of the node to update
+         * @param newBounds the new bounds of the node to update
+         * @param data the data associated with the node to update
+         * @return true if the node was found and false otherwise
          */
-        virtual void accept(Visitor& visitor) const = 0;
+        virtual bool refit(const Box& oldBounds, const Box& newBounds, const U& data) = 0;
     public:
         /**
          * Appends a textual representation of this node to the given output stream.
@@ -215,6 +207,14 @@ private:
             return false;
         }
 
+        const Node* left() const {
+            return m_left;
+        }
+
+        const Node* right() const {
+            return m_right;
+        }
+
         size_t height() const override {
             return m_height;
         }
@@ -251,6 +251,15 @@ private:
                 return doRemove(bounds, data, m_right, m_left);
             }
         }
+
+        bool refit(const Box& oldBounds, const Box& newBounds, const U& data) override {
+            if (this->bounds().contains(oldBounds) &&
+                (m_left->refit(oldBounds, newBounds, data) || m_right->refit(oldBounds, newBounds, data))) {
+                updateBounds();
+                return true;
+            }
+            return false;
+        }
     private:
         /**
          * Attempt to remove the node with the given bounds and data from the given child.
@@ -340,13 +349,6 @@ private:
             m_height = std::max(m_left->height(), m_right->height()) + 1;
             assert(m_height > 0);
         }
-
-        void accept(Visitor& visitor) const override {
-            if (visitor.visit(this)) {
-                m_left->accept(visitor);
-                m_right->accept(visitor);
-            }
-        }
     public:
         void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
             for (size_t i = 0; i < level; ++i)
@@ -432,6 +434,14 @@ private:
             }
         }
 
+        bool refit(const Box& oldBounds, const Box& newBounds, const U& data) override {
+            if (this->hasBounds(oldBounds) && hasData(data)) {
+                this->setBounds(newBounds);
+                return true;
+            }
+            return false;
+        }
+
         /**
          * Checks whether the given data equals the data of this leaf. The given data is considered
          * equal to this node's data if and only if !(data < m_data) && !(m_data < data) where < is
@@ -445,10 +455,6 @@ private:
             return !cmp(data, m_data) && !cmp(m_data, data);
         }
 
-        void accept(Visitor& visitor) const override {
-            visitor.visit(this);
-        }
-
         void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
             for (size_t i = 0; i < level; ++i)
                 str << indent;
@@ -458,15 +464,250 @@ private:
             str << ": " << m_data << std::endl;
         }
     };
+
+    /**
+     * Builds a tree top down from a set of items that are known in advance. Every range of items is split into two
+     * using the surface area heuristic (SAH): the item centers are sorted into bins along the axis where the centers
+     * are spread out the most, and the range is split at the bin boundary that minimizes the sum of the surface areas
+     * of the two halves weighted by their item counts. This yields much tighter trees than inserting the items one by
+     * one, and large ranges are split on multiple threads.
+     */
+    class Builder {
+    private:
+        struct Item {
+            Box bounds;
+            vm::vec<T,S> center;
+            U data;
+        };
+        using ItemList = std::vector<Item>;
+        using ItemIter = typename ItemList::iterator;
+
+        static const size_t BinCount = 16;
+        // ranges with fewer items are not worth handing off to another thread
+        static const size_t MinParallelItems = 4096;
+
+        struct Bin {
+            Box bounds;
+            size_t count = 0;
+
+            void add(const Box& itemBounds) {
+                bounds = count == 0 ? itemBounds : merge(bounds, itemBounds);
+                ++count;
+            }
+        };
+
+        ItemList m_items;
+    public:
+        Builder(const std::vector<U>& objects, const GetBounds& getBounds) {
+            m_items.reserve(objects.size());
+            for (const auto& object : objects) {
+                const auto bounds = getBounds(object);
+                m_items.push_back(Item{ bounds, bounds.center(), object });
+            }
+        }
+
+        Node* build(const size_t threadCount) {
+            if (m_items.empty()) {
+                return nullptr;
+            } else {
+                return build(std::begin(m_items), std::end(m_items), threadCount);
+            }
+        }
+    private:
+        static Node* build(const ItemIter begin, const ItemIter end, const size_t threadCount) {
+            const auto count = static_cast<size_t>(std::distance(begin, end));
+            assert(count > 0);
+
+            if (count == 1) {
+                return new LeafNode(begin->bounds, begin->data);
+            }
+
+            const auto mid = split(begin, end);
+
+            Node* left = nullptr;
+            Node* right = nullptr;
+            if (threadCount > 1 && count >= MinParallelItems) {
+                TrenchBroom::parallelFor(2, 2, [&](const size_t i) {
+                    if (i == 0) {
+                        left = build(begin, mid, (threadCount + 1) / 2);
+                    } else {
+                        right = build(mid, end, threadCount / 2);
+                    }
+                });
+            } else {
+                left = build(begin, mid, 1);
+                right = build(mid, end, 1);
+            }
+            return new InnerNode(left, right);
+        }
+
+        /**
+         * Partitions the given range of items and returns the first item of the second partition. Both partitions are
+         * guaranteed to be non empty.
+         */
+        static ItemIter split(const ItemIter begin, const ItemIter end) {
+            auto centerBounds = Box(begin->center, begin->center);
+            for (auto it = std::next(begin); it != end; ++it) {
+                centerBounds = merge(centerBounds, it->center);
+            }
+
+            const auto axis = findMaxAxis(centerBounds.size());
+            const auto min = centerBounds.min[axis];
+            const auto extent = centerBounds.max[axis] - min;
+            if (extent <= static_cast<T>(0.0)) {
+                // all centers coincide, so any split is as good as any other
+                return begin + std::distance(begin, end) / 2;
+            }
+
+            const auto binOf = [&](const Item& item) {
+                const auto bin = static_cast<size_t>((item.center[axis] - min) / extent * static_cast<T>(BinCount));
+                return std::min(bin, BinCount - 1);
+            };
+
+            Bin bins[BinCount];
+            for (auto it = begin; it != end; ++it) {
+                bins[binOf(*it)].add(it->bounds);
+            }
+
+            // the cost of splitting after bin i is computed from the bins to the right in one sweep and from the bins
+            // to the left in another
+            T rightCosts[BinCount];
+            Bin right;
+            for (size_t i = BinCount - 1; i > 0; --i) {
+                if (bins[i].count > 0) {
+                    right.bounds = right.count == 0 ? bins[i].bounds : merge(right.bounds, bins[i].bounds);
+                    right.count += bins[i].count;
+                }
+                rightCosts[i - 1] = right.count == 0 ? static_cast<T>(0.0) : halfArea(right.bounds) * static_cast<T>(right.count);
+            }
+
+            auto bestBin = BinCount;
+            auto bestCost = std::numeric_limits<T>::max();
+            Bin left;
+            for (size_t i = 0; i < BinCount - 1; ++i) {
+                if (bins[i].count > 0) {
+                    left.bounds = left.count == 0 ? bins[i].bounds : merge(left.bounds, bins[i].bounds);
+                    left.count += bins[i].count;
+                }
+
+                const auto rightCount = static_cast<size_t>(std::distance(begin, end)) - left.count;
+                if (left.count > 0 && rightCount > 0) {
+                    const auto cost = halfArea(left.bounds) * static_cast<T>(left.count) + rightCosts[i];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestBin = i;
+                    }
+                }
+            }
+
+            // since the centers are spread out along the axis, the first and the last bin are never empty
+            assert(bestBin < BinCount);
+            return std::partition(begin, end, [&](const Item& item) { return binOf(item) <= bestBin; });
+        }
+
+        static size_t findMaxAxis(const vm::vec<T,S>& size) {
+            size_t result = 0;
+            for (size_t i = 1; i < S; ++i) {
+                if (size[i] > size[result]) {
+                    result = i;
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Returns half the surface area of the given box, which is all the heuristic needs.
+         */
+        static T halfArea(const Box& box) {
+            const auto size = box.size();
+            if (S == 1) {
+                return size[0];
+            }
+
+            auto result = static_cast<T>(0.0);
+            for (size_t i = 0; i < S; ++i) {
+                for (size_t j = i + 1; j < S; ++j) {
+                    result += size[i] * size[j];
+                }
+            }
+            return result;
+        }
+    };
+
+    static const size_t FlatWidth = 4;
+    using FlatBounds = vm::bbox_packet<float,S,FlatWidth>;
+
+    /**
+     * The tree in a linearized, read-only form that is used to answer queries. Every flat node stands for an inner node
+     * of the tree and its grandchildren, so it has up to four children whose bounds are tested against a query at once,
+     * see vm::bbox_packet. The bounds of the children are rounded outwards to single precision; the exact bounds are
+     * only needed for the leaves and are stored separately along with their data.
+     */
+    struct FlatNode {
+        FlatBounds bounds;
+        // for each child, the index of its flat node, or the index of its item if the child is a leaf
+        uint32_t children[FlatWidth];
+        uint32_t count;
+        uint32_t leafMask;
+    };
+
+    struct FlatItem {
+        Box bounds;
+        U data;
+    };
 private:
     Node* m_root;
+    size_t m_threadCount;
+
+    // the flattened tree is rebuilt on the first query after the tree has changed
+    mutable std::vector<FlatNode> m_flatNodes;
+    mutable std::vector<FlatItem> m_flatItems;
+    mutable size_t m_flatHeight;
+    mutable std::atomic<bool> m_flatValid;
+    mutable std::mutex m_flatMutex;
 public:
-    AABBTree() : m_root(nullptr) {}
+    AABBTree() :
+    m_root(nullptr),
+    m_threadCount(1),
+    m_flatHeight(0),
+    m_flatValid(false) {}
 
     ~AABBTree() override {
         clear();
     }
 
+    /**
+     * Sets the number of threads used to build the tree in clearAndBuild.
+     *
+     * @param threadCount the number of threads, a value of 0 or 1 builds the tree on the calling thread
+     */
+    void setThreadCount(const size_t threadCount) {
+        m_threadCount = threadCount;
+    }
+
+    /**
+     * Clears this tree and rebuilds it from the given objects in one go, see Builder.
+     *
+     * @param objects the objects to insert
+     * @param getBounds a function to compute the bounds from each object
+     */
+    void clearAndBuild(const List& objects, const GetBounds& getBounds) override {
+        clearAndBuild(Array(std::begin(objects), std::end(objects)), getBounds);
+    }
+
+    /**
+     * Clears this tree and rebuilds it from the given objects in one go, see Builder.
+     *
+     * @param objects the objects to insert
+     * @param getBounds a function to compute the bounds from each object
+     */
+    void clearAndBuild(const Array& objects, const GetBounds& getBounds) override {
+        clear();
+        Builder builder(objects, getBounds);
+        m_root = builder.build(m_threadCount);
+        invalidateFlatTree();
+    }
+
     bool contains(const Box& bounds, const U& data) const override {
         return (!empty() && m_root->find(bounds, data) != nullptr);
     }
@@ -477,6 +718,7 @@ public:
         } else {
             m_root = m_root->insert(bounds, data);
         }
+        invalidateFlatTree();
     }
 
     bool remove(const Box& bounds, const U& data) override {
@@ -487,13 +729,27 @@ public:
                     delete m_root;
                     m_root = newRoot;
                 }
+                invalidateFlatTree();
                 return true;
             }
         }
         return false;
     }
 
+    /**
+     * Updates the bounds of the node with the given data. If the old and the new bounds overlap, as they do when an
+     * object is dragged around or edited, the node is updated in place and the bounds of its ancestors are refit. This
+     * keeps the flattened tree valid so that the next query doesn't have to rebuild it. Otherwise, the node is removed
+     * and inserted again.
+     */
     void update(const Box& oldBounds, const Box& newBounds, const U& data) override {
+        if (!empty() && oldBounds.intersects(newBounds) && m_root->refit(oldBounds, newBounds, data)) {
+            if (m_flatValid.load(std::memory_order_relaxed)) {
+                assertResult(refitFlatTree(0, oldBounds, newBounds, data));
+            }
+            return;
+        }
+
         if (!remove(oldBounds, data)) {
             NodeTreeException ex;
             ex << "AABB node not found with oldBounds [ ( " << oldBounds.min << " ) ( " << oldBounds.max << " ) ]: " << data;
@@ -506,6 +762,7 @@ public:
         if (!empty()) {
             delete m_root;
             m_root = nullptr;
+            invalidateFlatTree();
         }
     }
     
@@ -545,19 +802,22 @@ public:
     template <typename O>
     void findIntersectors(const vm::ray<T,S>& ray, O out) const {
         if (!empty()) {
-            LambdaVisitor visitor(
-                    [&](const InnerNode* innerNode) {
-                        return innerNode->bounds().contains(ray.origin) || !vm::isnan(
-                            intersect(ray, innerNode->bounds()));
-                    },
-                    [&](const LeafNode* leaf) {
-                        if (leaf->bounds().contains(ray.origin) || !vm::isnan(intersect(ray, leaf->bounds()))) {
-                            out = leaf->data();
-                            ++out;
-                        }
+            vm::vec<T,S> inverseDirection;
+            for (size_t i = 0; i < S; ++i) {
+                inverseDirection[i] = static_cast<T>(1.0) / ray.direction[i];
+            }
+
+            visitFlatTree(
+                [&](const FlatBounds& bounds) {
+                    return vm::intersects(ray, inverseDirection, bounds);
+                },
+                [&](const FlatItem& item) {
+                    if (item.bounds.contains(ray.origin) || !vm::isnan(intersect(ray, item.bounds))) {
+                        out = item.data;
+                        ++out;
                     }
+                }
             );
-            m_root->accept(visitor);
         }
     }
 
@@ -578,21 +838,178 @@ public:
     template <typename O>
     void findContainers(const vm::vec<T,S>& point, O out) const {
         if (!empty()) {
-            LambdaVisitor visitor(
-                    [&](const InnerNode* innerNode) {
-                        return innerNode->bounds().contains(point);
-                    },
-                    [&](const LeafNode* leaf) {
-                        if (leaf->bounds().contains(point)) {
-                            out = leaf->data();
-                            ++out;
-                        }
+            visitFlatTree(
+                [&](const FlatBounds& bounds) {
+                    return bounds.contains(point);
+                },
+                [&](const FlatItem& item) {
+                    if (item.bounds.contains(point)) {
+                        out = item.data;
+                        ++out;
                     }
+                }
             );
-            m_root->accept(visitor);
         }
     }
+private:
+    void invalidateFlatTree() {
+        m_flatValid.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Visits the flattened tree in depth first order. The given node visitor returns a bit mask of the children of a
+     * flat node that are visited. Children that are leaves have their item passed to the item visitor.
+     */
+    template <typename NodeVisitor, typename ItemVisitor>
+    void visitFlatTree(const NodeVisitor& visitNode, const ItemVisitor& visitItem) const {
+        validateFlatTree();
+
+        // every flat node pushes at most three more nodes than it pops, and the flattened tree is at most as high as
+        // the tree
+        static const size_t LocalStackSize = 128;
+        const auto maxStackSize = (FlatWidth - 1) * m_flatHeight + 1;
+        uint32_t localStack[LocalStackSize];
+        std::vector<uint32_t> heapStack;
+        uint32_t* stack = localStack;
+        if (maxStackSize > LocalStackSize) {
+            heapStack.resize(maxStackSize);
+            stack = heapStack.data();
+        }
+
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const auto& node = m_flatNodes[stack[--stackSize]];
+            const auto mask = visitNode(node.bounds);
+
+            // push the children in reverse order so that they are visited from left to right
+            for (size_t i = node.count; i > 0; --i) {
+                const auto bit = 1u << (i - 1);
+                if (mask & bit) {
+                    if (node.leafMask & bit) {
+                        visitItem(m_flatItems[node.children[i - 1]]);
+                    } else {
+                        stack[stackSize++] = node.children[i - 1];
+                    }
+                }
+            }
+        }
+    }
+
+    void validateFlatTree() const {
+        if (!m_flatValid.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_flatMutex);
+            if (!m_flatValid.load(std::memory_order_relaxed)) {
+                m_flatNodes.clear();
+                m_flatItems.clear();
+                m_flatHeight = 0;
+                if (!empty()) {
+                    m_flatHeight = m_root->height();
+                    flatten(m_root);
+                }
+                m_flatValid.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * Appends a flat node for the given node to the flattened tree and returns its index. The children of the flat node
+     * are the grandchildren of the given node, or its children if they are leaves. A leaf root becomes the only child
+     * of the root flat node.
+     */
+    uint32_t flatten(const Node* node) const {
+        const Node* children[FlatWidth];
+        size_t count = 0;
+        if (node->leaf()) {
+            children[count++] = node;
+        } else {
+            const auto* inner = static_cast<const InnerNode*>(node);
+            for (const auto* child : { inner->left(), inner->right() }) {
+                if (child->leaf()) {
+                    children[count++] = child;
+                } else {
+                    const auto* innerChild = static_cast<const InnerNode*>(child);
+                    children[count++] = innerChild->left();
+                    children[count++] = innerChild->right();
+                }
+            }
+        }
+
+        const auto index = static_cast<uint32_t>(m_flatNodes.size());
+        m_flatNodes.emplace_back();
+        m_flatNodes[index].count = static_cast<uint32_t>(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto* child = children[i];
+            m_flatNodes[index].bounds.set(i, roundOut(child->bounds()));
+            if (child->leaf()) {
+                const auto* leaf = static_cast<const LeafNode*>(child);
+                m_flatNodes[index].children[i] = static_cast<uint32_t>(m_flatItems.size());
+                m_flatNodes[index].leafMask |= 1u << i;
+                m_flatItems.push_back(FlatItem{ leaf->bounds(), leaf->data() });
+            } else {
+                // flatten may reallocate the node array, so the node must be looked up again
+                const auto childIndex = flatten(child);
+                m_flatNodes[index].children[i] = childIndex;
+            }
+        }
 
+        return index;
+    }
+
+    /**
+     * Refits the flattened tree like Node::refit refits the tree. Since every flat node corresponds to a node of the
+     * tree, this finds the corresponding leaf.
+     */
+    bool refitFlatTree(const uint32_t index, const Box& oldBounds, const Box& newBounds, const U& data) {
+        static const Cmp cmp;
+
+        auto& node = m_flatNodes[index];
+        const auto candidates = node.bounds.contains(oldBounds);
+        for (size_t i = 0; i < node.count; ++i) {
+            const auto bit = 1u << i;
+            if (node.leafMask & bit) {
+                auto& item = m_flatItems[node.children[i]];
+                if (item.bounds == oldBounds && !cmp(data, item.data) && !cmp(item.data, data)) {
+                    item.bounds = newBounds;
+                    node.bounds.set(i, roundOut(newBounds));
+                    return true;
+                }
+            } else if ((candidates & bit) && refitFlatTree(node.children[i], oldBounds, newBounds, data)) {
+                node.bounds.set(i, mergeBounds(m_flatNodes[node.children[i]]));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static vm::bbox<float,S> mergeBounds(const FlatNode& node) {
+        auto result = node.bounds.get(0);
+        for (size_t i = 1; i < node.count; ++i) {
+            result = vm::merge(result, node.bounds.get(i));
+        }
+        return result;
+    }
+
+    static vm::bbox<float,S> roundOut(const Box& bounds) {
+        vm::bbox<float,S> result;
+        for (size_t i = 0; i < S; ++i) {
+            result.min[i] = roundDown(bounds.min[i]);
+            result.max[i] = roundUp(bounds.max[i]);
+        }
+        return result;
+    }
+
+    static float roundDown(const T value) {
+        const auto result = static_cast<float>(value);
+        return static_cast<T>(result) > value ? std::nextafter(result, -std::numeric_limits<float>::infinity()) : result;
+    }
+
+    static float roundUp(const T value) {
+        const auto result = static_cast<float>(value);
+        return static_cast<T>(result) < value ? std::nextafter(result, std::numeric_limits<float>::infinity()) : result;
+    }
+public:
     /**
      * Prints a textual representation of this tree to the given output stream.
      *
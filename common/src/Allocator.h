@@ -21,180 +21,307 @@
 #define TrenchBroom_Allocator_h
 
 #include <cassert>
-#include <iostream>
-#include <limits>
-#include <stack>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
 
 // Undefine this to prevent false positives when looking for memory leaks.
 #define TB_ENABLE_ALLOCATOR 1
 
-template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+/**
+ * A pooled allocator for small objects of type T, used by deriving T from Allocator<T>.
+ *
+ * The blocks are carved out of chunks of ChunkSize bytes which are aligned to their size, so the chunk that owns a
+ * block, and with it the chunk's free list, is found by masking the block's address. The chunks are managed by a pool
+ * that is shared by all threads and guarded by a mutex. In addition, every thread caches up to CacheSize free blocks
+ * and exchanges them with the shared pool in batches, so that objects can be created and destroyed concurrently
+ * without contending for the mutex. A block may be freed by a different thread than the one that allocated it.
+ */
+template <class T, size_t CacheSize = 256, size_t ChunkSize = 64 * 1024>
 class Allocator {
 private:
-    class Chunk {
+    struct Block {
+        Block* next;
+    };
+
+    struct Chunk {
+        // the neighbours in the list of chunks that have free blocks
+        Chunk* previous;
+        Chunk* next;
+
+        Block* freeBlocks;
+        // the number of blocks that were handed out and not returned to this chunk
+        size_t usedBlocks;
+        // the blocks with an index below this have been handed out at least once
+        size_t initializedBlocks;
+    };
+
+    static constexpr size_t roundUp(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // T is incomplete when this class is instantiated, so its size and alignment can only be used in functions
+    static constexpr size_t blockAlignment() {
+        return alignof(T) > alignof(Block) ? alignof(T) : alignof(Block);
+    }
+
+    static constexpr size_t blockSize() {
+        return roundUp(sizeof(T) > sizeof(Block) ? sizeof(T) : sizeof(Block), blockAlignment());
+    }
+
+    static constexpr size_t firstBlockOffset() {
+        return roundUp(sizeof(Chunk), blockAlignment());
+    }
+
+    static constexpr size_t blocksPerChunk() {
+        return (ChunkSize - firstBlockOffset()) / blockSize();
+    }
+
+    static constexpr size_t BatchSize = CacheSize / 2 > 0 ? CacheSize / 2 : 1;
+
+    class Pool {
     private:
-        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
-        unsigned char m_firstFreeBlock;
-        unsigned char m_numFreeBlocks;
+        std::mutex m_mutex;
+        Chunk* m_available;
+        // one empty chunk is kept so that allocating and freeing a single object does not allocate a chunk every time
+        Chunk* m_spare;
     public:
-        Chunk() :
-        m_firstFreeBlock(0),
-        m_numFreeBlocks(BlocksPerChunk - 1) {
-            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
-                m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
+        Pool() :
+        m_available(nullptr),
+        m_spare(nullptr) {}
+
+        /**
+         * Prepends up to count blocks to the given list and returns the number of blocks added.
+         */
+        size_t allocate(Block*& list, const size_t count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (m_available == nullptr)
+                    link(newChunk());
+
+                Chunk* chunk = m_available;
+                Block* block = allocate(chunk);
+                block->next = list;
+                list = block;
+
+                if (full(chunk))
+                    unlink(chunk);
+            }
+            return count;
+        }
+
+        /**
+         * Returns all blocks in the given list to their chunks.
+         */
+        void deallocate(Block* list) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            while (list != nullptr) {
+                Block* block = list;
+                list = list->next;
+                release(block);
+            }
+        }
+    private:
+        void release(Block* block) {
+            Chunk* chunk = chunkOf(block);
+            assert(chunk->usedBlocks > 0);
+
+            if (full(chunk))
+                link(chunk);
+
+            block->next = chunk->freeBlocks;
+            chunk->freeBlocks = block;
+            --chunk->usedBlocks;
+
+            if (chunk->usedBlocks == 0) {
+                unlink(chunk);
+                if (m_spare == nullptr) {
+                    m_spare = chunk;
+                } else {
+                    deleteChunk(chunk);
+                }
+            }
+        }
+
+        Chunk* newChunk() {
+            Chunk* chunk = m_spare;
+            if (chunk != nullptr) {
+                m_spare = nullptr;
+            } else {
+                chunk = static_cast<Chunk*>(allocateAligned(ChunkSize));
+            }
+
+            chunk->previous = nullptr;
+            chunk->next = nullptr;
+            chunk->freeBlocks = nullptr;
+            chunk->usedBlocks = 0;
+            chunk->initializedBlocks = 0;
+            return chunk;
+        }
+
+        static void deleteChunk(Chunk* chunk) {
+            freeAligned(chunk);
+        }
+
+        // the aligned variants of operator new require macOS 10.14, so the platform functions are used instead
+        static void* allocateAligned(const size_t size) {
+#ifdef _MSC_VER
+            void* memory = _aligned_malloc(size, size);
+            if (memory == nullptr)
+                throw std::bad_alloc();
+            return memory;
+#else
+            void* memory = nullptr;
+            if (posix_memalign(&memory, size, size) != 0)
+                throw std::bad_alloc();
+            return memory;
+#endif
+        }
+
+        static void freeAligned(void* memory) {
+#ifdef _MSC_VER
+            _aligned_free(memory);
+#else
+            free(memory);
+#endif
         }
-        
-        bool contains(const T* t) const {
-            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
-            if (block < m_blocks)
-                return false;
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            return offset < (BlocksPerChunk - 1) * sizeof(T);
+
+        static Block* allocate(Chunk* chunk) {
+            Block* block = chunk->freeBlocks;
+            if (block != nullptr) {
+                chunk->freeBlocks = block->next;
+            } else {
+                assert(chunk->initializedBlocks < blocksPerChunk());
+                unsigned char* memory = reinterpret_cast<unsigned char*>(chunk) + firstBlockOffset();
+                block = reinterpret_cast<Block*>(memory + chunk->initializedBlocks * blockSize());
+                ++chunk->initializedBlocks;
+            }
+            ++chunk->usedBlocks;
+            return block;
+        }
+
+        static bool full(const Chunk* chunk) {
+            return chunk->freeBlocks == nullptr && chunk->initializedBlocks == blocksPerChunk();
+        }
+
+        void link(Chunk* chunk) {
+            chunk->previous = nullptr;
+            chunk->next = m_available;
+            if (m_available != nullptr)
+                m_available->previous = chunk;
+            m_available = chunk;
         }
-        
-        T* allocate() {
-            if (m_numFreeBlocks == 0)
-                return nullptr;
-            
-            unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
-            m_firstFreeBlock = *block;
-            m_numFreeBlocks--;
-            return reinterpret_cast<T*>(block);
+
+        void unlink(Chunk* chunk) {
+            if (chunk->previous != nullptr)
+                chunk->previous->next = chunk->next;
+            else
+                m_available = chunk->next;
+            if (chunk->next != nullptr)
+                chunk->next->previous = chunk->previous;
+            chunk->previous = nullptr;
+            chunk->next = nullptr;
         }
-        
-        void deallocate(T* t) {
-            assert(m_numFreeBlocks < BlocksPerChunk - 1);
-            assert(contains(t));
-            
-            unsigned char* block = reinterpret_cast<unsigned char*>(t);
-            assert(block >= m_blocks);
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            assert(offset % sizeof(T) == 0);
-            
-            size_t index = offset / sizeof(T);
-            assert(index < BlocksPerChunk);
-            
-            *block = m_firstFreeBlock;
-            m_firstFreeBlock = static_cast<unsigned char>(index);
-            m_numFreeBlocks++;
+    };
+
+    class Cache {
+    private:
+        Block* m_blocks;
+        size_t m_count;
+    public:
+        Cache() :
+        m_blocks(nullptr),
+        m_count(0) {}
+
+        ~Cache() {
+            pool().deallocate(m_blocks);
+            cacheDestroyed() = true;
         }
-        
-        bool empty() const {
-            return m_numFreeBlocks == BlocksPerChunk - 1;
+
+        Block* allocate() {
+            if (m_count == 0)
+                m_count = pool().allocate(m_blocks, BatchSize);
+
+            Block* block = m_blocks;
+            m_blocks = block->next;
+            --m_count;
+            return block;
         }
-        
-        bool full() const {
-            return m_numFreeBlocks == 0;
+
+        void deallocate(Block* block) {
+            block->next = m_blocks;
+            m_blocks = block;
+            ++m_count;
+
+            if (m_count > CacheSize) {
+                // return a batch of blocks to the shared pool
+                Block* last = m_blocks;
+                for (size_t i = 1; i < BatchSize; ++i)
+                    last = last->next;
+
+                Block* batch = m_blocks;
+                m_blocks = last->next;
+                last->next = nullptr;
+                m_count -= BatchSize;
+                pool().deallocate(batch);
+            }
         }
     };
-    
-    typedef std::vector<Chunk*> ChunkList;
-    typedef std::stack<T*> Pool;
-    
-    static Pool& pool() {
-        static Pool p;
-        return p;
+
+    static Chunk* chunkOf(Block* block) {
+        return reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(ChunkSize - 1));
     }
-    
-    static ChunkList& fullChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static Pool& pool() {
+        // never destroyed because objects may be freed during static destruction
+        static Pool* p = new Pool();
+        return *p;
     }
-    
-    static ChunkList& mixedChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static Cache& cache() {
+        static thread_local Cache c;
+        return c;
     }
-    
-    static ChunkList emptyChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    // set when the calling thread's cache has been destroyed, after which the shared pool is used directly
+    static bool& cacheDestroyed() {
+        static thread_local bool destroyed = false;
+        return destroyed;
     }
 public:
 #ifdef TB_ENABLE_ALLOCATOR
-    void* operator new(size_t size) {
+    void* operator new(const size_t size) {
+        static_assert((ChunkSize & (ChunkSize - 1)) == 0, "chunk size must be a power of two");
+        static_assert(blockAlignment() <= ChunkSize, "chunk size must be at least the alignment of T");
+        static_assert(blocksPerChunk() > 0, "chunk size is too small for T");
         assert(size == sizeof(T));
-        
-        if (!pool().empty()) {
-            T* t = pool().top();
-            pool().pop();
-            return t;
-        }
-        
-        Chunk* chunk = nullptr;
-        if (mixedChunks().empty()) {
-            if (!emptyChunks().empty()) {
-                chunk = emptyChunks().back();
-                emptyChunks().pop_back();
-            } else {
-                chunk = new Chunk();
-            }
-        } else {
-            chunk = mixedChunks().back();
-            mixedChunks().pop_back();
-        }
-        
-        assert(!chunk->full());
-        T* block = chunk->allocate();
-        
-        if (chunk->full()) {
-            fullChunks().push_back(chunk);
-        } else {
-            mixedChunks().push_back(chunk);
-        }
+
+        if (!cacheDestroyed())
+            return cache().allocate();
+
+        Block* block = nullptr;
+        pool().allocate(block, 1);
         return block;
     }
     
-    void operator delete(void* block) {
-        T* t = reinterpret_cast<T*>(block);
-        
-        if (PoolSize > 0 && pool().size() < PoolSize) {
-            pool().push(t);
+    void operator delete(void* t) {
+        if (t == nullptr)
             return;
-        }
-        
-        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
-        fullIt = fullChunks().rbegin();
-        fullEnd = fullChunks().rend();
-        mixedIt = mixedChunks().rbegin();
-        mixedEnd = mixedChunks().rend();
-        
-        Chunk* chunk = nullptr;
-        while (fullIt < fullEnd || mixedIt < mixedEnd) {
-            if (fullIt < fullEnd) {
-                Chunk* fullChunk = *fullIt;
-                if (fullChunk->contains(t)) {
-                    chunk = fullChunk;
-                    break;
-                }
-                ++fullIt;
-            }
-            if (mixedIt < mixedEnd) {
-                Chunk* mixedChunk = *mixedIt;
-                if (mixedChunk->contains(t)) {
-                    chunk = mixedChunk;
-                    break;
-                }
-                ++mixedIt;
-            }
-        }
-        
-        assert(chunk != nullptr);
-        
-        if (chunk->full()) {
-            fullChunks().erase((fullIt + 1).base());
-            mixedChunks().push_back(chunk);
-        }
-        
-        chunk->deallocate(t);
-        
-        if (chunk->empty()) {
-            mixedChunks().erase((mixedIt + 1).base());
-            if (emptyChunks().size() < 2)
-                emptyChunks().push_back(chunk);
-                else
-                    delete chunk;
+
+        Block* block = static_cast<Block*>(t);
+        if (!cacheDestroyed()) {
+            cache().deallocate(block);
+        } else {
+            block->next = nullptr;
+            pool().deallocate(block);
         }
     }
 #endif
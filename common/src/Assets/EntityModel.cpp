@@ -19,11 +19,15 @@
 
 #include "EntityModel.h"
 
+#include "Exceptions.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
 
+#include <algorithm>
+#include <cassert>
+
 namespace TrenchBroom {
     namespace Assets {
         EntityModel::Frame::Frame(const String& name, const vm::bbox3f& bounds, const EntityModel::VertexList& vertices) :
@@ -37,6 +41,10 @@ namespace TrenchBroom {
             return m_bounds;
         }
 
+        size_t EntityModel::Frame::memoryUsage() const {
+            return m_vertices.capacity() * sizeof(Vertex);
+        }
+
         Renderer::TexturedIndexRangeRenderer* EntityModel::Frame::buildRenderer(Assets::Texture* skin) {
             const auto vertexArray = Renderer::VertexArray::ref(m_vertices);
             return doBuildRenderer(skin, vertexArray);
@@ -64,21 +72,27 @@ namespace TrenchBroom {
         m_skins(std::make_unique<Assets::TextureCollection>()),
         m_prepared(false) {}
 
-        Renderer::TexturedIndexRangeRenderer* EntityModel::buildRenderer(const size_t skinIndex, const size_t frameIndex) const {
+        Renderer::TexturedIndexRangeRenderer* EntityModel::buildRenderer(const size_t skinIndex, const size_t frameIndex) {
             if (skinIndex >= skinCount() || frameIndex >= frameCount()) {
                 return nullptr;
             } else {
+                auto* frame = this->frame(frameIndex);
+                if (frame == nullptr) {
+                    return nullptr;
+                }
+
                 const auto& textures = m_skins->textures();
                 auto* skin = textures[skinIndex];
-                return m_frames[frameIndex]->buildRenderer(skin);
+                return frame->buildRenderer(skin);
             }
         }
 
-        vm::bbox3f EntityModel::bounds(const size_t /* skinIndex */, const size_t frameIndex) const {
-            if (frameIndex >= frameCount()) {
+        vm::bbox3f EntityModel::bounds(const size_t /* skinIndex */, const size_t frameIndex) {
+            auto* frame = frameIndex < frameCount() ? this->frame(frameIndex) : nullptr;
+            if (frame == nullptr) {
                 return vm::bbox3f(8.0f);
             } else {
-                return m_frames[frameIndex]->bounds();
+                return frame->bounds();
             }
         }
 
@@ -86,6 +100,20 @@ namespace TrenchBroom {
             return m_frames.size();
         }
 
+        size_t EntityModel::loadedFrameCount() const {
+            return static_cast<size_t>(std::count_if(std::begin(m_frames), std::end(m_frames), [](const FramePtr& frame) { return frame != nullptr; }));
+        }
+
+        size_t EntityModel::memoryUsage() const {
+            size_t result = 0;
+            for (const auto& frame : m_frames) {
+                if (frame != nullptr) {
+                    result += frame->memoryUsage();
+                }
+            }
+            return result;
+        }
+
         size_t EntityModel::skinCount() const {
             return m_skins->textureCount();
         }
@@ -126,5 +154,35 @@ namespace TrenchBroom {
             const auto bounds = vm::bbox3f::mergeAll(std::begin(vertices), std::end(vertices), Renderer::GetVertexComponent1());
             m_frames.push_back(std::make_unique<TexturedFrame>(name, bounds, vertices, indices));
         }
+
+        void EntityModel::addLazyFrames(const size_t count, const FrameDecoder& decoder) {
+            assert(!m_frameDecoder);
+            m_frames.resize(m_frames.size() + count);
+            m_frameDecoder = decoder;
+        }
+
+        void EntityModel::setFrame(const size_t frameIndex, const String& name, const EntityModel::VertexList& vertices, const EntityModel::Indices& indices) {
+            assert(frameIndex < frameCount());
+            const auto bounds = vm::bbox3f::mergeAll(std::begin(vertices), std::end(vertices), Renderer::GetVertexComponent1());
+            m_frames[frameIndex] = std::make_unique<IndexedFrame>(name, bounds, vertices, indices);
+        }
+
+        void EntityModel::setFrame(const size_t frameIndex, const String& name, const EntityModel::VertexList& vertices, const EntityModel::TexturedIndices& indices) {
+            assert(frameIndex < frameCount());
+            const auto bounds = vm::bbox3f::mergeAll(std::begin(vertices), std::end(vertices), Renderer::GetVertexComponent1());
+            m_frames[frameIndex] = std::make_unique<TexturedFrame>(name, bounds, vertices, indices);
+        }
+
+        EntityModel::Frame* EntityModel::frame(const size_t frameIndex) {
+            assert(frameIndex < frameCount());
+            if (m_frames[frameIndex] == nullptr && m_frameDecoder) {
+                try {
+                    m_frameDecoder(*this, frameIndex);
+                } catch (const Exception&) {
+                    // leave the frame empty, callers treat this like an invalid frame index
+                }
+            }
+            return m_frames[frameIndex].get();
+        }
     }
 }
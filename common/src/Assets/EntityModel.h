@@ -27,6 +27,8 @@
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
 
+#include <functional>
+
 namespace TrenchBroom {
     namespace Renderer {
         class TexturedIndexRangeRenderer;
@@ -51,6 +53,7 @@ namespace TrenchBroom {
                 virtual ~Frame();
 
                 const vm::bbox3f& bounds() const;
+                size_t memoryUsage() const;
                 Renderer::TexturedIndexRangeRenderer* buildRenderer(Assets::Texture* skin);
             private:
                 virtual Renderer::TexturedIndexRangeRenderer* doBuildRenderer(Assets::Texture* skin, const Renderer::VertexArray& vertices) = 0;
@@ -73,24 +76,47 @@ namespace TrenchBroom {
             private:
                 Renderer::TexturedIndexRangeRenderer* doBuildRenderer(Assets::Texture* skin, const Renderer::VertexArray& vertices) override;
             };
+        public:
+            /**
+             * Decodes the frame with the given index and passes it to the given model by calling setFrame.
+             */
+            using FrameDecoder = std::function<void(EntityModel& model, size_t frameIndex)>;
         private:
             using FramePtr = std::unique_ptr<Frame>;
             using FrameList = std::vector<FramePtr>;
             using TextureCollectionPtr = std::unique_ptr<TextureCollection>;
 
             String m_name;
+            // contains null for every frame that has not been decoded yet
             FrameList m_frames;
+            FrameDecoder m_frameDecoder;
             TextureCollectionPtr m_skins;
             bool m_prepared;
         public:
             EntityModel(const String& name);
 
-            Renderer::TexturedIndexRangeRenderer* buildRenderer(size_t skinIndex, size_t frameIndex) const;
-            vm::bbox3f bounds(size_t skinIndex, size_t frameIndex) const;
+            /**
+             * Returns a renderer for the given skin and frame, or null if either index is out of bounds. Decodes
+             * the frame if necessary.
+             */
+            Renderer::TexturedIndexRangeRenderer* buildRenderer(size_t skinIndex, size_t frameIndex);
+            /**
+             * Returns the bounds of the given frame. Decodes the frame if necessary.
+             */
+            vm::bbox3f bounds(size_t skinIndex, size_t frameIndex);
 
             size_t frameCount() const;
             size_t skinCount() const;
 
+            /**
+             * Returns the number of frames that have been decoded.
+             */
+            size_t loadedFrameCount() const;
+            /**
+             * Returns the number of bytes used by the vertices of the decoded frames.
+             */
+            size_t memoryUsage() const;
+
             Assets::Texture* skin(size_t index) const;
 
             bool prepared() const;
@@ -100,6 +126,16 @@ namespace TrenchBroom {
             void addSkin(Assets::Texture* skin);
             void addFrame(const String& name, const VertexList& vertices, const Indices& indices);
             void addFrame(const String& name, const VertexList& vertices, const TexturedIndices& indices);
+
+            /**
+             * Adds the given number of frames that are decoded by the given decoder when they are first used. The
+             * decoder must call setFrame with the index that it was passed.
+             */
+            void addLazyFrames(size_t count, const FrameDecoder& decoder);
+            void setFrame(size_t frameIndex, const String& name, const VertexList& vertices, const Indices& indices);
+            void setFrame(size_t frameIndex, const String& name, const VertexList& vertices, const TexturedIndices& indices);
+        private:
+            Frame* frame(size_t frameIndex);
         };
     }
 }
@@ -29,18 +29,24 @@
 
 namespace TrenchBroom {
     namespace Assets {
-        EntityModelManager::EntityModelManager(Logger* logger, int minFilter, int magFilter) :
+        EntityModelManager::EntityModelManager(Logger* logger, int minFilter, int magFilter, const size_t threadCount) :
         m_logger(logger),
         m_loader(nullptr),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_threadCount(threadCount),
+        m_activeLoads(0),
+        m_stopWorkers(false) {}
         
         EntityModelManager::~EntityModelManager() {
             clear();
+            stopWorkers();
         }
         
         void EntityModelManager::clear() {
+            cancelLoads();
+
             MapUtils::clearAndDelete(m_renderers);
             MapUtils::clearAndDelete(m_models);
             m_rendererMismatches.clear();
@@ -63,21 +69,27 @@ namespace TrenchBroom {
             m_loader = loader;
         }
 
+        void EntityModelManager::setLoadCallback(const LoadCallback& loadCallback) {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_loadCallback = loadCallback;
+        }
+
         EntityModel* EntityModelManager::model(const IO::Path& path) const {
             if (path.isEmpty())
                 return nullptr;
             
-            ModelCache::const_iterator it = m_models.find(path);
+            const IO::InternedPath internedPath(path);
+            ModelCache::const_iterator it = m_models.find(internedPath);
             if (it != std::end(m_models))
                 return it->second;
             
-            if (m_modelMismatches.count(path) > 0)
+            if (m_modelMismatches.count(internedPath) > 0)
                 return nullptr;
             
             try {
                 EntityModel* model = loadModel(path);
                 ensure(model != nullptr, "model is null");
-                m_models[path] = model;
+                m_models[internedPath] = model;
                 m_unpreparedModels.push_back(model);
                 
                 if (m_logger != nullptr)
@@ -85,7 +97,7 @@ namespace TrenchBroom {
 
                 return model;
             } catch (const GameException&) {
-                m_modelMismatches.insert(path);
+                m_modelMismatches.insert(internedPath);
                 throw;
             }
         }
@@ -99,7 +111,7 @@ namespace TrenchBroom {
         }
         
         Renderer::TexturedIndexRangeRenderer* EntityModelManager::renderer(const Assets::ModelSpecification& spec) const {
-            EntityModel* entityModel = safeGetModel(spec.path);
+            EntityModel* entityModel = spec.path.isEmpty() ? nullptr : requestModel(IO::InternedPath(spec.path));
 
             if (entityModel == nullptr)
                 return nullptr;
@@ -123,7 +135,11 @@ namespace TrenchBroom {
                 m_unpreparedRenderers.push_back(renderer);
                 
                 if (m_logger != nullptr) {
-                    m_logger->debug("Constructed entity model renderer for %s", spec.asString().c_str());
+                    m_logger->debug("Constructed entity model renderer for %s (%u of %u frames decoded, %u KiB)",
+                                    spec.asString().c_str(),
+                                    static_cast<unsigned int>(entityModel->loadedFrameCount()),
+                                    static_cast<unsigned int>(entityModel->frameCount()),
+                                    static_cast<unsigned int>(entityModel->memoryUsage() / 1024));
                 }
             }
             return renderer;
@@ -137,11 +153,125 @@ namespace TrenchBroom {
             return renderer(spec) != nullptr;
         }
 
+        bool EntityModelManager::hasLoadedModels() const {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            return !m_loadResults.empty();
+        }
+
+        bool EntityModelManager::commitLoadedModels() {
+            LoadResultList results;
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                using std::swap;
+                swap(results, m_loadResults);
+            }
+
+            bool added = false;
+            for (const LoadResult& result : results) {
+                m_pendingModels.erase(result.path);
+
+                if (m_models.count(result.path) > 0 || m_modelMismatches.count(result.path) > 0) {
+                    // the model was requested with model() while it was being loaded
+                    delete result.model;
+                } else if (result.model == nullptr) {
+                    m_modelMismatches.insert(result.path);
+                    if (m_logger != nullptr)
+                        m_logger->error(result.error);
+                } else {
+                    m_models[result.path] = result.model;
+                    m_unpreparedModels.push_back(result.model);
+                    added = true;
+
+                    if (m_logger != nullptr)
+                        m_logger->debug("Loaded entity model %s", result.path.path().asString().c_str());
+                }
+            }
+            return added;
+        }
+
         EntityModel* EntityModelManager::loadModel(const IO::Path& path) const {
             ensure(m_loader != nullptr, "loader is null");
             return m_loader->loadEntityModel(path);
         }
 
+        EntityModel* EntityModelManager::requestModel(const IO::InternedPath& path) const {
+            if (m_threadCount == 0)
+                return safeGetModel(path.path());
+
+            ModelCache::const_iterator it = m_models.find(path);
+            if (it != std::end(m_models))
+                return it->second;
+
+            if (m_modelMismatches.count(path) > 0 || m_pendingModels.count(path) > 0)
+                return nullptr;
+
+            m_pendingModels.insert(path);
+
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_loadQueue.push_back(path);
+            if (m_workers.size() < m_threadCount)
+                m_workers.emplace_back(&EntityModelManager::loadModelsInBackground, this);
+            m_loadCondition.notify_one();
+            return nullptr;
+        }
+
+        void EntityModelManager::loadModelsInBackground() const {
+            std::unique_lock<std::mutex> lock(m_loadMutex);
+            while (true) {
+                m_loadCondition.wait(lock, [this]() { return m_stopWorkers || !m_loadQueue.empty(); });
+                if (m_stopWorkers)
+                    return;
+
+                LoadResult result = { m_loadQueue.front(), nullptr, "" };
+                m_loadQueue.pop_front();
+                ++m_activeLoads;
+                lock.unlock();
+
+                try {
+                    result.model = loadModel(result.path.path());
+                    ensure(result.model != nullptr, "model is null");
+                } catch (const std::exception& e) {
+                    result.error = e.what();
+                }
+
+                lock.lock();
+                --m_activeLoads;
+                m_loadResults.push_back(result);
+                if (m_loadCallback)
+                    m_loadCallback();
+                m_idleCondition.notify_all();
+            }
+        }
+
+        void EntityModelManager::cancelLoads() {
+            LoadResultList results;
+            {
+                // the loader must not be used anymore once this returns, so wait for the running loads to finish
+                std::unique_lock<std::mutex> lock(m_loadMutex);
+                m_loadQueue.clear();
+                m_idleCondition.wait(lock, [this]() { return m_activeLoads == 0; });
+
+                using std::swap;
+                swap(results, m_loadResults);
+            }
+
+            for (const LoadResult& result : results)
+                delete result.model;
+            m_pendingModels.clear();
+        }
+
+        void EntityModelManager::stopWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                m_stopWorkers = true;
+            }
+            m_loadCondition.notify_all();
+
+            for (std::thread& worker : m_workers)
+                worker.join();
+            m_workers.clear();
+        }
+
         void EntityModelManager::prepare(Renderer::Vbo& vbo) {
             resetTextureMode();
             prepareModels();
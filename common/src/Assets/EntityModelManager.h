@@ -21,11 +21,21 @@
 #define TrenchBroom_EntityModelManager
 
 #include "Assets/ModelDefinition.h"
+#include "IO/InternedPath.h"
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
+#include "Parallel.h"
+#include "StringUtils.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom {
@@ -45,14 +55,23 @@ namespace TrenchBroom {
         
         class EntityModelManager {
         private:
-            typedef std::map<IO::Path, EntityModel*> ModelCache;
-            typedef std::set<IO::Path> ModelMismatches;
+            typedef std::unordered_map<IO::InternedPath, EntityModel*, IO::InternedPath::Hash> ModelCache;
+            typedef std::unordered_set<IO::InternedPath, IO::InternedPath::Hash> ModelMismatches;
             typedef std::vector<EntityModel*> ModelList;
             
             typedef std::map<Assets::ModelSpecification, Renderer::TexturedIndexRangeRenderer*> RendererCache;
             typedef std::set<Assets::ModelSpecification> RendererMismatches;
             typedef std::vector<Renderer::TexturedIndexRangeRenderer*> RendererList;
-            
+
+            struct LoadResult {
+                IO::InternedPath path;
+                EntityModel* model;
+                String error;
+            };
+            typedef std::vector<LoadResult> LoadResultList;
+        public:
+            typedef std::function<void()> LoadCallback;
+        private:
             Logger* m_logger;
             const IO::EntityModelLoader* m_loader;
 
@@ -67,23 +86,80 @@ namespace TrenchBroom {
 
             mutable ModelList m_unpreparedModels;
             mutable RendererList m_unpreparedRenderers;
+
+            /*
+             * Models requested by the renderers are loaded on up to m_threadCount worker threads. The queue, the
+             * results and the worker state are shared with the workers and guarded by m_loadMutex, the set of
+             * pending models is only accessed on the main thread.
+             */
+            size_t m_threadCount;
+            LoadCallback m_loadCallback;
+            mutable ModelMismatches m_pendingModels;
+            mutable std::vector<std::thread> m_workers;
+            mutable std::mutex m_loadMutex;
+            mutable std::condition_variable m_loadCondition;
+            mutable std::condition_variable m_idleCondition;
+            mutable std::deque<IO::InternedPath> m_loadQueue;
+            mutable LoadResultList m_loadResults;
+            mutable size_t m_activeLoads;
+            mutable bool m_stopWorkers;
         public:
-            EntityModelManager(Logger* logger, int minFilter, int magFilter);
+            /**
+             * Creates a new entity model manager.
+             *
+             * @param logger the logger to use, may be null
+             * @param minFilter the texture minification filter to use for the model skins
+             * @param magFilter the texture magnification filter to use for the model skins
+             * @param threadCount the maximum number of threads to load models on in the background, a value of 0
+             * loads all models on the calling thread
+             */
+            EntityModelManager(Logger* logger, int minFilter, int magFilter, size_t threadCount = defaultThreadCount());
             ~EntityModelManager();
             
             void clear();
 
             void setTextureMode(int minFilter, int magFilter);
             void setLoader(const IO::EntityModelLoader* loader);
-            
+
+            /**
+             * Sets a function to call whenever a model that was loaded in the background becomes available. The
+             * function is called on a worker thread.
+             */
+            void setLoadCallback(const LoadCallback& loadCallback);
+
+            /**
+             * Returns the model with the given path, loading it on the calling thread if necessary.
+             */
             EntityModel* model(const IO::Path& path) const;
             EntityModel* safeGetModel(const IO::Path& path) const;
+
+            /**
+             * Returns the renderer for the given model specification. If the model has not been loaded yet, it is
+             * loaded in the background and null is returned until it has been committed by commitLoadedModels.
+             */
             Renderer::TexturedIndexRangeRenderer* renderer(const Assets::ModelSpecification& spec) const;
             
             bool hasModel(const Model::Entity* entity) const;
             bool hasModel(const Assets::ModelSpecification& spec) const;
+
+            /**
+             * Indicates whether any models that were loaded in the background are waiting to be committed.
+             */
+            bool hasLoadedModels() const;
+
+            /**
+             * Adds the models that were loaded in the background to this manager and records the models that could
+             * not be loaded. Must be called on the main thread.
+             *
+             * @return true if any model was added
+             */
+            bool commitLoadedModels();
         private:
             EntityModel* loadModel(const IO::Path& path) const;
+            EntityModel* requestModel(const IO::InternedPath& path) const;
+            void loadModelsInBackground() const;
+            void cancelLoads();
+            void stopWorkers();
         public:
             void prepare(Renderer::Vbo& vbo);
         private:
@@ -29,6 +29,11 @@
 #include <cstring>
 #include <fstream>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRENCHBROOM_PALETTE_AVX2
+#include <immintrin.h>
+#endif
+
 namespace TrenchBroom {
     namespace Assets {
         Palette::Data::Data(const size_t size, RawDataPtr&& data) :
@@ -36,6 +41,7 @@ namespace TrenchBroom {
         m_data(std::move(data)) {
             ensure(m_size > 0, "size is 0");
             ensure(m_data.get() != nullptr, "data is null");
+            initializeTables();
         }
 
         Palette::Data::Data(const size_t size, unsigned char* data) :
@@ -43,6 +49,134 @@ namespace TrenchBroom {
         m_data(data) {
             ensure(m_size > 0, "size is 0");
             ensure(m_data.get() != nullptr, "data is null");
+            initializeTables();
+        }
+
+        void Palette::Data::initializeTables() {
+            for (size_t i = 0; i < 256; ++i) {
+                unsigned char rgba[4] = { 0x00, 0x00, 0x00, 0xFF };
+                for (size_t j = 0; j < 3 && i * 3 + j < m_size; ++j) {
+                    rgba[j] = m_data[i * 3 + j];
+                }
+                std::memcpy(&m_opaqueTable[i], rgba, 4);
+
+                if (i == 255) {
+                    rgba[3] = 0x00;
+                }
+                std::memcpy(&m_maskedTable[i], rgba, 4);
+            }
+        }
+
+        static void setAverageColor(const uint64_t sums[3], const size_t pixelCount, Color& averageColor) {
+            // the sums are exact in double precision, so this matches the scalar kernel bit for bit
+            for (size_t i = 0; i < 3; ++i)
+                averageColor[i] = static_cast<float>(static_cast<double>(sums[i]) / pixelCount / 0xFF);
+            averageColor[3] = 1.0f;
+        }
+
+        static void indexedToRgbaTable(const uint32_t* table, const unsigned char* indexedImage, const size_t pixelCount, unsigned char* rgbaImage, uint64_t sums[3]) {
+            size_t counts[256] = {};
+            for (size_t i = 0; i < pixelCount; ++i) {
+                const auto index = indexedImage[i];
+                std::memcpy(rgbaImage + i * 4, &table[index], 4);
+                ++counts[index];
+            }
+
+            const auto* channels = reinterpret_cast<const unsigned char*>(table);
+            for (size_t i = 0; i < 256; ++i) {
+                for (size_t j = 0; j < 3; ++j)
+                    sums[j] += counts[i] * channels[i * 4 + j];
+            }
+        }
+
+#ifdef TRENCHBROOM_PALETTE_AVX2
+        __attribute__((target("avx2")))
+        static void indexedToRgbaAvx2(const uint32_t* table, const unsigned char* indexedImage, const size_t pixelCount, unsigned char* rgbaImage, uint64_t sums[3]) {
+            // x86 is little endian, so the red channel is the lowest byte of every table entry
+            const __m256i mask = _mm256_set1_epi32(0xFF);
+            const auto* tableInts = reinterpret_cast<const int*>(table);
+
+            size_t i = 0;
+            while (pixelCount - i >= 8) {
+                // the 32 bit lane sums overflow after 2^24 pixels, so they are flushed well before that
+                const size_t blockEnd = i + std::min((pixelCount - i) / 8, size_t(1) << 16) * 8;
+                __m256i r = _mm256_setzero_si256();
+                __m256i g = _mm256_setzero_si256();
+                __m256i b = _mm256_setzero_si256();
+
+                for (; i < blockEnd; i += 8) {
+                    const __m128i indices = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indexedImage + i));
+                    const __m256i pixels = _mm256_i32gather_epi32(tableInts, _mm256_cvtepu8_epi32(indices), 4);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgbaImage + i * 4), pixels);
+
+                    r = _mm256_add_epi32(r, _mm256_and_si256(pixels, mask));
+                    g = _mm256_add_epi32(g, _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask));
+                    b = _mm256_add_epi32(b, _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask));
+                }
+
+                alignas(32) uint32_t lanes[3][8];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), r);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), g);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[2]), b);
+                for (size_t j = 0; j < 3; ++j) {
+                    for (size_t k = 0; k < 8; ++k)
+                        sums[j] += lanes[j][k];
+                }
+            }
+
+            indexedToRgbaTable(table, indexedImage + i, pixelCount - i, rgbaImage + i * 4, sums);
+        }
+#endif
+
+        void Palette::Data::indexedToRgba(const unsigned char* indexedImage, const size_t pixelCount, unsigned char* rgbaImage, Color& averageColor, const PaletteTransparency transparency, const PaletteKernel kernel) const {
+            const auto& table = transparency == PaletteTransparency::Index255Transparent ? m_maskedTable : m_opaqueTable;
+            uint64_t sums[3] = { 0, 0, 0 };
+
+            switch (kernel) {
+                case PaletteKernel::Scalar:
+                    indexedToRgbaScalar(indexedImage, pixelCount, rgbaImage, averageColor, transparency);
+                    return;
+                case PaletteKernel::Table:
+                    indexedToRgbaTable(table.data(), indexedImage, pixelCount, rgbaImage, sums);
+                    break;
+                case PaletteKernel::Avx2:
+                    assert(supportsKernel(kernel));
+#ifdef TRENCHBROOM_PALETTE_AVX2
+                    indexedToRgbaAvx2(table.data(), indexedImage, pixelCount, rgbaImage, sums);
+#else
+                    indexedToRgbaTable(table.data(), indexedImage, pixelCount, rgbaImage, sums);
+#endif
+                    break;
+                switchDefault()
+            }
+
+            setAverageColor(sums, pixelCount, averageColor);
+        }
+
+        void Palette::Data::indexedToRgbaScalar(const unsigned char* indexedImage, const size_t pixelCount, unsigned char* rgbaImage, Color& averageColor, const PaletteTransparency transparency) const {
+            double avg[3];
+            avg[0] = avg[1] = avg[2] = 0.0;
+            for (size_t i = 0; i < pixelCount; ++i) {
+                const size_t index = static_cast<size_t>(indexedImage[i]);
+                assert(index < m_size);
+                for (size_t j = 0; j < 3; ++j) {
+                    const unsigned char c = m_data[index * 3 + j];
+                    rgbaImage[i * 4 + j] = c;
+                    avg[j] += static_cast<double>(c);
+                }
+                switch (transparency) {
+                    case PaletteTransparency::Opaque:
+                        rgbaImage[i * 4 + 3] = 0xFF;
+                        break;
+                    case PaletteTransparency::Index255Transparent:
+                        rgbaImage[i * 4 + 3] = (index == 255) ? 0x00 : 0xFF;
+                        break;
+                }
+            }
+            
+            for (size_t i = 0; i < 3; ++i)
+                averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
+            averageColor[3] = 1.0f;
         }
 
         Palette::Palette() {}
@@ -112,5 +246,25 @@ namespace TrenchBroom {
         bool Palette::initialized() const {
             return m_data.get() != nullptr;
         }
+
+        bool Palette::supportsKernel(const PaletteKernel kernel) {
+            switch (kernel) {
+                case PaletteKernel::Scalar:
+                case PaletteKernel::Table:
+                    return true;
+                case PaletteKernel::Avx2:
+#ifdef TRENCHBROOM_PALETTE_AVX2
+                    return __builtin_cpu_supports("avx2");
+#else
+                    return false;
+#endif
+                switchDefault()
+            }
+        }
+
+        PaletteKernel Palette::defaultKernel() {
+            static const PaletteKernel kernel = supportsKernel(PaletteKernel::Avx2) ? PaletteKernel::Avx2 : PaletteKernel::Table;
+            return kernel;
+        }
     }
 }
@@ -24,7 +24,9 @@
 #include "ByteBuffer.h"
 #include "IO/MappedFile.h"
 
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <memory>
 
 namespace TrenchBroom {
@@ -38,49 +40,46 @@ namespace TrenchBroom {
             Opaque, Index255Transparent
         };
 
+        /**
+         * The implementations of the conversion from indexed to RGBA images. All of them produce identical images
+         * and average colors, but the vectorized ones are only available on some CPUs.
+         */
+        enum class PaletteKernel {
+            /**
+             * Looks up every channel of every pixel in the raw palette data.
+             */
+            Scalar,
+            /**
+             * Copies whole RGBA pixels from a lookup table and computes the average color from a histogram of the
+             * indices.
+             */
+            Table,
+            /**
+             * Gathers eight RGBA pixels at once from the lookup table using AVX2 instructions.
+             */
+            Avx2
+        };
+
         class Palette {
         private:
             using RawDataPtr = std::unique_ptr<unsigned char[]>;
+            using Table = std::array<uint32_t, 256>;
 
             class Data {
             private:
                 size_t m_size;
                 RawDataPtr m_data;
+                // the RGBA pixel for each index, with the alpha channel of index 255 set to 0 in the masked table
+                Table m_opaqueTable;
+                Table m_maskedTable;
             public:
                 Data(size_t size, RawDataPtr&& data);
                 Data(size_t size, unsigned char* data);
 
-                template <typename IndexT, typename ColorT>
-                void indexedToRgba(const Buffer<IndexT>& indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency) const {
-                    indexedToRgba(&indexedImage[0], pixelCount, rgbaImage, averageColor, transparency);
-                }
-                
-                template <typename IndexT, typename ColorT>
-                void indexedToRgba(const IndexT* indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency) const {
-                    double avg[3];
-                    avg[0] = avg[1] = avg[2] = 0.0;
-                    for (size_t i = 0; i < pixelCount; ++i) {
-                        const size_t index = static_cast<size_t>(static_cast<unsigned char>(indexedImage[i]));
-                        assert(index < m_size);
-                        for (size_t j = 0; j < 3; ++j) {
-                            const unsigned char c = m_data[index * 3 + j];
-                            rgbaImage[i * 4 + j] = c;
-                            avg[j] += static_cast<double>(c);
-                        }
-                        switch (transparency) {
-                            case PaletteTransparency::Opaque:
-                                rgbaImage[i * 4 + 3] = 0xFF;
-                                break;
-                            case PaletteTransparency::Index255Transparent:
-                                rgbaImage[i * 4 + 3] = (index == 255) ? 0x00 : 0xFF;
-                                break;
-                        }
-                    }
-                    
-                    for (size_t i = 0; i < 3; ++i)
-                        averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
-                    averageColor[3] = 1.0f;
-                }
+                void indexedToRgba(const unsigned char* indexedImage, size_t pixelCount, unsigned char* rgbaImage, Color& averageColor, PaletteTransparency transparency, PaletteKernel kernel) const;
+            private:
+                void initializeTables();
+                void indexedToRgbaScalar(const unsigned char* indexedImage, size_t pixelCount, unsigned char* rgbaImage, Color& averageColor, PaletteTransparency transparency) const;
             };
             
             typedef std::shared_ptr<Data> DataPtr;
@@ -98,14 +97,33 @@ namespace TrenchBroom {
 
             bool initialized() const;
 
+            /**
+             * Returns whether the given kernel can be used on this CPU.
+             */
+            static bool supportsKernel(PaletteKernel kernel);
+
+            /**
+             * Returns the fastest kernel that can be used on this CPU.
+             */
+            static PaletteKernel defaultKernel();
+
             template <typename IndexT, typename ColorT>
             void indexedToRgba(const Buffer<IndexT>& indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency = PaletteTransparency::Opaque) const {
-                m_data->indexedToRgba(indexedImage, pixelCount, rgbaImage, averageColor, transparency);
+                indexedToRgba(&indexedImage[0], pixelCount, rgbaImage, averageColor, transparency, defaultKernel());
             }
             
             template <typename IndexT, typename ColorT>
             void indexedToRgba(const IndexT* indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency = PaletteTransparency::Opaque) const {
-                m_data->indexedToRgba(indexedImage, pixelCount, rgbaImage, averageColor, transparency);
+                indexedToRgba(indexedImage, pixelCount, rgbaImage, averageColor, transparency, defaultKernel());
+            }
+
+            template <typename IndexT, typename ColorT>
+            void indexedToRgba(const IndexT* indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, Color& averageColor, const PaletteTransparency transparency, const PaletteKernel kernel) const {
+                static_assert(sizeof(IndexT) == 1 && sizeof(ColorT) == 1, "indices and color channels must be bytes");
+                assert(rgbaImage.size() >= pixelCount * 4);
+                
+                unsigned char* rgbaPtr = pixelCount > 0 ? reinterpret_cast<unsigned char*>(rgbaImage.ptr()) : nullptr;
+                m_data->indexedToRgba(reinterpret_cast<const unsigned char*>(indexedImage), pixelCount, rgbaPtr, averageColor, transparency, kernel);
             }
         };
     }
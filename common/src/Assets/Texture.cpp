@@ -18,11 +18,14 @@
  */
 
 #include "Texture.h"
+#include "Exceptions.h"
 #include "Assets/ImageUtils.h"
+#include "Assets/TextureCache.h"
 #include "Assets/TextureCollection.h"
 
 #include <cassert>
 #include <algorithm>
+#include <memory>
 
 namespace TrenchBroom {
     namespace Assets {
@@ -68,7 +71,9 @@ namespace TrenchBroom {
         m_overridden(false),
         m_format(format),
         m_type(type),
-        m_textureId(0) {
+        m_textureId(0),
+        m_cache(nullptr),
+        m_decodingFailed(false) {
             assert(m_width > 0);
             assert(m_height > 0);
             assert(buffer.size() >= m_width * m_height * bytesPerPixelForFormat(format));
@@ -86,7 +91,9 @@ namespace TrenchBroom {
         m_format(format),
         m_type(type),
         m_textureId(0),
-        m_buffers(buffers) {
+        m_buffers(buffers),
+        m_cache(nullptr),
+        m_decodingFailed(false) {
             assert(m_width > 0);
             assert(m_height > 0);
 
@@ -109,10 +116,33 @@ namespace TrenchBroom {
         m_overridden(false),
         m_format(format),
         m_type(type),
-        m_textureId(0) {}
+        m_textureId(0),
+        m_cache(nullptr),
+        m_decodingFailed(false) {}
+
+        Texture::Texture(const String& name, const size_t width, const size_t height, const Decoder& decoder) :
+        m_collection(nullptr),
+        m_name(name),
+        m_width(width),
+        m_height(height),
+        m_averageColor(Color(0.0f, 0.0f, 0.0f, 1.0f)),
+        m_usageCount(0),
+        m_overridden(false),
+        m_format(GL_RGBA),
+        m_type(TextureType::Opaque),
+        m_textureId(0),
+        m_decoder(decoder),
+        m_cache(nullptr),
+        m_decodingFailed(false) {
+            assert(m_decoder);
+        }
 
         Texture::~Texture() {
-            if (m_collection == nullptr && m_textureId != 0) {
+            if (m_cache != nullptr) {
+                m_cache->remove(this);
+            }
+            // lazy textures own their texture id, all others get it from their collection
+            if ((m_collection == nullptr || lazy()) && m_textureId != 0) {
                 glAssert(glDeleteTextures(1, &m_textureId));
             }
             m_textureId = 0;
@@ -134,6 +164,18 @@ namespace TrenchBroom {
             return m_averageColor;
         }
         
+        GLenum Texture::format() const {
+            return m_format;
+        }
+        
+        TextureType Texture::type() const {
+            return m_type;
+        }
+        
+        const TextureBuffer::List& Texture::buffers() const {
+            return m_buffers;
+        }
+        
         size_t Texture::usageCount() const {
             return m_usageCount;
         }
@@ -168,7 +210,12 @@ namespace TrenchBroom {
         void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter) {
             assert(textureId > 0);
             assert(m_textureId == 0);
+            assert(!lazy());
 
+            upload(textureId, minFilter, magFilter);
+        }
+
+        void Texture::upload(const GLuint textureId, const int minFilter, const int magFilter) const {
             if (!m_buffers.empty()) {
                 glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
                 glAssert(glPixelStorei(GL_UNPACK_LSB_FIRST, false));
@@ -218,7 +265,24 @@ namespace TrenchBroom {
             }
         }
 
+        bool Texture::lazy() const {
+            return static_cast<bool>(m_decoder);
+        }
+
+        void Texture::setCache(TextureCache* cache) {
+            assert(lazy());
+            if (cache != m_cache) {
+                if (m_cache != nullptr) {
+                    m_cache->remove(this);
+                }
+                m_cache = cache;
+            }
+        }
+
         void Texture::activate() const {
+            if (m_cache != nullptr) {
+                m_cache->use(this);
+            }
             if (isPrepared()) {
                 glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
             }
@@ -230,6 +294,52 @@ namespace TrenchBroom {
             }
         }
 
+        size_t Texture::load(const int minFilter, const int magFilter) const {
+            assert(lazy());
+            assert(!isPrepared());
+
+            if (m_decodingFailed) {
+                return 0;
+            }
+
+            std::unique_ptr<Texture> decoded;
+            try {
+                decoded.reset(m_decoder());
+            } catch (const Exception&) {}
+
+            if (decoded == nullptr || decoded->m_buffers.empty() || decoded->m_width != m_width || decoded->m_height != m_height) {
+                // don't try again every time the texture is activated
+                m_decodingFailed = true;
+                return 0;
+            }
+
+            // activating a texture is logically const, decoding only replaces the placeholder properties
+            auto& self = const_cast<Texture&>(*this);
+            self.m_averageColor = decoded->m_averageColor;
+            self.m_format = decoded->m_format;
+            self.m_type = decoded->m_type;
+            m_buffers = decoded->m_buffers;
+
+            size_t bytes = 0;
+            for (const auto& buffer : m_buffers) {
+                bytes += buffer.size();
+            }
+
+            GLuint textureId;
+            glAssert(glGenTextures(1, &textureId));
+            upload(textureId, minFilter, magFilter);
+
+            return bytes;
+        }
+
+        void Texture::unload() const {
+            assert(lazy());
+            if (m_textureId != 0) {
+                glAssert(glDeleteTextures(1, &m_textureId));
+                m_textureId = 0;
+            }
+        }
+
         void Texture::setCollection(TextureCollection* collection) {
             m_collection = collection;
         }
@@ -27,12 +27,14 @@
 
 #include <vecmath/forward.h>
 
+#include <functional>
 #include <utility>
 #include <cassert>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Assets {
+        class TextureCache;
         class TextureCollection;
         
         typedef Buffer<unsigned char> TextureBuffer;
@@ -46,6 +48,12 @@ namespace TrenchBroom {
         void setMipBufferSize(TextureBuffer::List& buffers, size_t mipLevels, size_t width, size_t height, GLenum format);
         
         class Texture {
+        public:
+            /**
+             * Decodes the image data of a lazily loaded texture and returns it as a new texture, or null if the
+             * image data cannot be decoded.
+             */
+            using Decoder = std::function<Texture*()>;
         private:
             TextureCollection* m_collection;
             String m_name;
@@ -62,10 +70,19 @@ namespace TrenchBroom {
 
             mutable GLuint m_textureId;
             mutable TextureBuffer::List m_buffers;
+
+            Decoder m_decoder;
+            TextureCache* m_cache;
+            mutable bool m_decodingFailed;
         public:
             Texture(const String& name, size_t width, size_t height, const Color& averageColor, const TextureBuffer& buffer, GLenum format, TextureType type);
             Texture(const String& name, size_t width, size_t height, const Color& averageColor, const TextureBuffer::List& buffers, GLenum format, TextureType type);
             Texture(const String& name, size_t width, size_t height, GLenum format = GL_RGB, TextureType type = TextureType::Opaque);
+            /**
+             * Creates a texture whose image data is decoded by the given decoder when the texture is first
+             * activated. Until then, the average color is black.
+             */
+            Texture(const String& name, size_t width, size_t height, const Decoder& decoder);
             ~Texture();
 
             const String& name() const;
@@ -73,6 +90,12 @@ namespace TrenchBroom {
             size_t width() const;
             size_t height() const;
             const Color& averageColor() const;
+            GLenum format() const;
+            TextureType type() const;
+            /**
+             * Returns the image data of this texture. It is only available until the texture is uploaded.
+             */
+            const TextureBuffer::List& buffers() const;
 
             size_t usageCount() const;
             void incUsageCount();
@@ -84,9 +107,28 @@ namespace TrenchBroom {
             void prepare(GLuint textureId, int minFilter, int magFilter);
             void setMode(int minFilter, int magFilter);
 
+            /**
+             * Indicates whether this texture decodes its image data when it is first activated.
+             */
+            bool lazy() const;
+            /**
+             * Sets the cache that decodes, uploads and unloads this texture if it is lazy.
+             */
+            void setCache(TextureCache* cache);
+
+            /**
+             * Binds this texture. If it is lazy and not loaded, its image data is decoded and uploaded first, which
+             * happens synchronously on the calling thread. See TextureCache for when a loaded texture is unloaded.
+             */
             void activate() const;
             void deactivate() const;
         private:
+            void upload(GLuint textureId, int minFilter, int magFilter) const;
+
+            size_t load(int minFilter, int magFilter) const;
+            void unload() const;
+            friend class TextureCache;
+
             void setCollection(TextureCollection* collection);
             friend class TextureCollection;
         };
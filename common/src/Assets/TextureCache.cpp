@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TextureCache.h"
+
+#include "Assets/Texture.h"
+
+#include <cassert>
+#include <iterator>
+
+namespace TrenchBroom {
+    namespace Assets {
+        const size_t TextureCache::DefaultMemoryBudget = 512u * 1024u * 1024u;
+
+        TextureCache::TextureCache(const size_t memoryBudget, const int minFilter, const int magFilter) :
+        m_memoryBudget(memoryBudget),
+        m_memoryUsage(0),
+        m_minFilter(minFilter),
+        m_magFilter(magFilter),
+        m_frame(0) {}
+
+        TextureCache::~TextureCache() {
+            clear();
+        }
+
+        size_t TextureCache::memoryBudget() const {
+            return m_memoryBudget;
+        }
+
+        void TextureCache::setMemoryBudget(const size_t memoryBudget) {
+            m_memoryBudget = memoryBudget;
+            evict();
+        }
+
+        void TextureCache::setTextureMode(const int minFilter, const int magFilter) {
+            m_minFilter = minFilter;
+            m_magFilter = magFilter;
+        }
+
+        void TextureCache::beginFrame() {
+            ++m_frame;
+            evict();
+        }
+
+        void TextureCache::use(const Texture* texture) {
+            const auto it = m_entries.find(texture);
+            if (it != std::end(m_entries)) {
+                m_textures.splice(std::begin(m_textures), m_textures, it->second.position);
+                it->second.frame = m_frame;
+                return;
+            }
+
+            const auto bytes = texture->load(m_minFilter, m_magFilter);
+            if (bytes == 0) {
+                return;
+            }
+
+            m_textures.push_front(texture);
+            m_entries.insert(std::make_pair(texture, Entry{ std::begin(m_textures), bytes, m_frame }));
+            m_memoryUsage += bytes;
+
+            evict();
+        }
+
+        void TextureCache::remove(const Texture* texture) {
+            const auto it = m_entries.find(texture);
+            if (it != std::end(m_entries)) {
+                texture->unload();
+                m_memoryUsage -= it->second.bytes;
+                m_textures.erase(it->second.position);
+                m_entries.erase(it);
+            }
+        }
+
+        void TextureCache::clear() {
+            for (const auto* texture : m_textures) {
+                texture->unload();
+            }
+            m_textures.clear();
+            m_entries.clear();
+            m_memoryUsage = 0;
+        }
+
+        size_t TextureCache::memoryUsage() const {
+            return m_memoryUsage;
+        }
+
+        size_t TextureCache::loadedTextureCount() const {
+            return m_textures.size();
+        }
+
+        void TextureCache::evict() {
+            // the textures are ordered by the frame in which they were used, so no texture after a pinned one can be
+            // unloaded either
+            while (m_memoryUsage > m_memoryBudget && m_textures.size() > 1 && !pinned(m_entries.at(m_textures.back()))) {
+                remove(m_textures.back());
+            }
+        }
+
+        bool TextureCache::pinned(const Entry& entry) const {
+            return m_frame > 0 && entry.frame + 1 >= m_frame;
+        }
+    }
+}
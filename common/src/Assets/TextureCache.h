@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_TextureCache
+#define TrenchBroom_TextureCache
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class Texture;
+
+        /**
+         * Decodes and uploads lazily loaded textures when they are first activated, and unloads the least recently
+         * activated ones when the decoded image data of all loaded textures exceeds the memory budget. An unloaded
+         * texture is decoded again when it is activated the next time.
+         *
+         * The most recently activated texture is never unloaded, even if it alone exceeds the budget. Once frames are
+         * used, see beginFrame(), the textures activated in the current or the previous frame are not unloaded either.
+         * If they don't fit into the budget, the memory usage grows beyond it until they are no longer used, instead
+         * of decoding the same textures again in every frame.
+         */
+        class TextureCache {
+        public:
+            static const size_t DefaultMemoryBudget;
+        private:
+            struct Entry {
+                std::list<const Texture*>::iterator position;
+                size_t bytes;
+                // the frame in which the texture was last used
+                size_t frame;
+            };
+
+            size_t m_memoryBudget;
+            size_t m_memoryUsage;
+            int m_minFilter;
+            int m_magFilter;
+            // the current frame, or 0 if beginFrame has not been called yet
+            size_t m_frame;
+
+            // the loaded textures, the most recently used one first
+            std::list<const Texture*> m_textures;
+            std::unordered_map<const Texture*, Entry> m_entries;
+        public:
+            TextureCache(size_t memoryBudget, int minFilter, int magFilter);
+            ~TextureCache();
+
+            size_t memoryBudget() const;
+            void setMemoryBudget(size_t memoryBudget);
+            void setTextureMode(int minFilter, int magFilter);
+
+            /**
+             * Starts a new frame and unloads the textures that exceed the budget and were not used in the frame that
+             * just ended. This should be called before rendering.
+             */
+            void beginFrame();
+
+            /**
+             * Loads the given texture if necessary and marks it as the most recently used one.
+             */
+            void use(const Texture* texture);
+
+            /**
+             * Unloads the given texture if it is loaded and forgets about it.
+             */
+            void remove(const Texture* texture);
+
+            /**
+             * Unloads all textures.
+             */
+            void clear();
+
+            size_t memoryUsage() const;
+            size_t loadedTextureCount() const;
+        private:
+            void evict();
+            bool pinned(const Entry& entry) const;
+
+            deleteCopyAndAssignment(TextureCache)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureCache) */
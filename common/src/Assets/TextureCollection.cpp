@@ -26,23 +26,27 @@ namespace TrenchBroom {
     namespace Assets {
         TextureCollection::TextureCollection() :
         m_loaded(false),
-        m_usageCount(0) {}
+        m_usageCount(0),
+        m_prepared(false) {}
         
         TextureCollection::TextureCollection(const TextureList& textures) :
         m_loaded(false),
-        m_usageCount(0) {
+        m_usageCount(0),
+        m_prepared(false) {
             addTextures(textures);
         }
 
         TextureCollection::TextureCollection(const IO::Path& path) :
         m_loaded(false),
         m_path(path),
-        m_usageCount(0) {}
+        m_usageCount(0),
+        m_prepared(false) {}
 
         TextureCollection::TextureCollection(const IO::Path& path, const TextureList& textures) :
         m_loaded(true),
         m_path(path),
-        m_usageCount(0) {
+        m_usageCount(0),
+        m_prepared(false) {
             addTextures(textures);
         }
 
@@ -102,20 +106,30 @@ namespace TrenchBroom {
         }
 
         bool TextureCollection::prepared() const {
-            return !m_textureIds.empty();
+            return m_prepared;
         }
 
         void TextureCollection::prepare(const int minFilter, const int magFilter) {
             assert(!prepared());
             
-            m_textureIds.resize(textureCount());
-            glAssert(glGenTextures(static_cast<GLsizei>(textureCount()),
-                                   static_cast<GLuint*>(&m_textureIds.front())));
+            // lazy textures are uploaded by the texture cache when they are first used
+            TextureList texturesToPrepare;
+            for (Texture* texture : m_textures) {
+                if (!texture->lazy())
+                    texturesToPrepare.push_back(texture);
+            }
+
+            if (!texturesToPrepare.empty()) {
+                m_textureIds.resize(texturesToPrepare.size());
+                glAssert(glGenTextures(static_cast<GLsizei>(texturesToPrepare.size()),
+                                       static_cast<GLuint*>(&m_textureIds.front())));
 
-            for (size_t i = 0; i < textureCount(); ++i) {
-                Texture* texture = m_textures[i];
-                texture->prepare(m_textureIds[i], minFilter, magFilter);
+                for (size_t i = 0; i < texturesToPrepare.size(); ++i) {
+                    texturesToPrepare[i]->prepare(m_textureIds[i], minFilter, magFilter);
+                }
             }
+            
+            m_prepared = true;
         }
 
         void TextureCollection::setTextureMode(const int minFilter, const int magFilter) {
@@ -41,6 +41,7 @@ namespace TrenchBroom {
             size_t m_usageCount;
             
             TextureIdList m_textureIds;
+            bool m_prepared;
             
             friend class Texture;
         public:
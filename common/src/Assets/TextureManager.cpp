@@ -52,7 +52,9 @@ namespace TrenchBroom {
         m_logger(logger),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_lazyLoading(false),
+        m_cache(TextureCache::DefaultMemoryBudget, minFilter, magFilter) {}
         
         TextureManager::~TextureManager() {
             clear();
@@ -63,30 +65,60 @@ namespace TrenchBroom {
             m_collections.clear();
             clear();
             
+            // the collections that can be reused, or null if the collection at that position must be loaded
+            TextureCollectionList reused;
+            std::vector<bool> known;
+            IO::Path::List pathsToLoad;
+            
             for (const IO::Path& path : paths) {
                 const auto it = collections.find(path);
                 if (it == std::end(collections) || !it->second->loaded()) {
-                    try {
-                        Assets::TextureCollection* collection = loader.loadTextureCollection(path);
+                    reused.push_back(nullptr);
+                    pathsToLoad.push_back(path);
+                } else {
+                    reused.push_back(it->second);
+                }
+                known.push_back(it != std::end(collections));
+                if (it != std::end(collections))
+                    collections.erase(it);
+            }
+            
+            // all missing collections are loaded at once so that their textures can be decoded in parallel
+            auto results = loader.loadTextureCollections(pathsToLoad, m_lazyLoading);
+            auto result = std::begin(results);
+            
+            for (size_t i = 0; i < paths.size(); ++i) {
+                const IO::Path& path = paths[i];
+                if (reused[i] == nullptr) {
+                    if (result->collection != nullptr) {
+                        Assets::TextureCollection* collection = result->collection.release();
                         m_logger->info("Loaded texture collection '" + path.asString() + "'");
                         addTextureCollection(collection);
                         collection->usageCountDidChange.addObserver(usageCountDidChange);
-                    } catch (const Exception& e) {
+                    } else {
                         addTextureCollection(new Assets::TextureCollection(path));
-                        if (it == std::end(collections))
-                            m_logger->error("Could not load texture collection '" + path.asString() + "': " + e.what());
+                        if (!known[i])
+                            m_logger->error("Could not load texture collection '" + path.asString() + "': " + result->error);
                     }
+                    ++result;
                 } else {
-                    addTextureCollection(it->second);
+                    addTextureCollection(reused[i]);
                 }
-                if (it != std::end(collections))
-                    collections.erase(it);
             }
             
             updateTextures();
             VectorUtils::append(m_toRemove, collections);
         }
 
+        void TextureManager::setLazyLoading(const bool lazyLoading, const size_t memoryBudget) {
+            m_lazyLoading = lazyLoading;
+            m_cache.setMemoryBudget(memoryBudget);
+        }
+        
+        const TextureCache& TextureManager::cache() const {
+            return m_cache;
+        }
+
         TextureManager::TextureCollectionMap TextureManager::collectionMap() const {
             TextureCollectionMap result;
             for (Assets::TextureCollection* collection : m_collections)
@@ -96,6 +128,10 @@ namespace TrenchBroom {
 
         void TextureManager::addTextureCollection(Assets::TextureCollection* collection) {
             m_collections.push_back(collection);
+            for (Texture* texture : collection->textures()) {
+                if (texture->lazy())
+                    texture->setCache(&m_cache);
+            }
             if (collection->loaded() && !collection->prepared())
                 m_toPrepare.push_back(collection);
             
@@ -117,6 +153,7 @@ namespace TrenchBroom {
         void TextureManager::setTextureMode(const int minFilter, const int magFilter) {
             m_minFilter = minFilter;
             m_magFilter = magFilter;
+            m_cache.setTextureMode(minFilter, magFilter);
             m_resetTextureMode = true;
         }
 
@@ -124,6 +161,8 @@ namespace TrenchBroom {
             resetTextureMode();
             prepare();
             VectorUtils::clearAndDelete(m_toRemove);
+            // this is called before every frame is rendered
+            m_cache.beginFrame();
         }
         
         Texture* TextureManager::texture(const String& name) const {
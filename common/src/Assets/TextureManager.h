@@ -22,6 +22,7 @@
 
 #include "Notifier.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/TextureCache.h"
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
 
@@ -55,6 +56,9 @@ namespace TrenchBroom {
             int m_minFilter;
             int m_magFilter;
             bool m_resetTextureMode;
+            
+            bool m_lazyLoading;
+            TextureCache m_cache;
         public:
             Notifier0 usageCountDidChange;
         public:
@@ -62,6 +66,18 @@ namespace TrenchBroom {
             ~TextureManager();
 
             void setTextureCollections(const IO::Path::List& paths, IO::TextureLoader& loader);
+            
+            /**
+             * Sets whether texture collections are loaded lazily. In this mode, only the names and sizes of the
+             * textures are read when a collection is loaded. Their image data is decoded and uploaded when they are
+             * first used, and the least recently used textures are unloaded when their decoded image data exceeds
+             * the given memory budget in bytes. Textures used in the current or the previous frame are kept even if
+             * they exceed the budget, see TextureCache.
+             *
+             * Only affects collections that are loaded afterwards.
+             */
+            void setLazyLoading(bool lazyLoading, size_t memoryBudget);
+            const TextureCache& cache() const;
         private:
             TextureCollectionMap collectionMap() const;
             void addTextureCollection(Assets::TextureCollection* collection);
@@ -69,6 +85,10 @@ namespace TrenchBroom {
             void clear();
             
             void setTextureMode(int minFilter, int magFilter);
+            /**
+             * Prepares the pending texture collections and starts a new frame of the texture cache. This must be
+             * called before rendering.
+             */
             void commitChanges();
             
             Texture* texture(const String& name) const;
@@ -28,6 +28,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include "SharedPointer.h"
 #include "Macros.h"
@@ -1240,6 +1241,13 @@ namespace MapUtils {
         map.clear();
     }
 
+    template <typename K, typename V, typename H, typename E>
+    void clearAndDelete(std::unordered_map<K, V*, H, E>& map) {
+        Deleter<K,V> deleter; // need separate instance because for_each only allows modification of the items if the function is not const
+        std::for_each(std::begin(map), std::end(map), deleter);
+        map.clear();
+    }
+
     template <typename K, typename V, typename C>
     void clearAndDelete(std::map<K, std::vector<V*>, C>& map) {
         VectorDeleter<K,V> deleter; // need separate instance because for_each only allows modification of the items if the function is not const
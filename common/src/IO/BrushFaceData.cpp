@@ -0,0 +1,39 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "BrushFaceData.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        BrushFaceData::BrushFaceData(const Model::BrushFace* face) :
+        points{ face->points()[0], face->points()[1], face->points()[2] },
+        attributes(face->attribs().takeSnapshot()),
+        textureXAxis(face->textureXAxis()),
+        textureYAxis(face->textureYAxis()) {}
+
+        bool BrushFaceData::hasSurfaceAttributes() const {
+            return attributes.surfaceContents() != 0 || attributes.surfaceFlags() != 0 || attributes.surfaceValue() != 0.0f;
+        }
+
+        bool BrushFaceData::hasColor() const {
+            return attributes.color().a() > 0.0f;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_BrushFaceData
+#define TrenchBroom_BrushFaceData
+
+#include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
+
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * The data of a brush face that is needed to write it to a map file. It does not refer to the face, so it can
+         * be written after the face has changed or on another thread.
+         */
+        struct BrushFaceData {
+            Model::BrushFace::Points points;
+            Model::BrushFaceAttributes attributes;
+            vm::vec3 textureXAxis;
+            vm::vec3 textureYAxis;
+
+            explicit BrushFaceData(const Model::BrushFace* face);
+
+            bool hasSurfaceAttributes() const;
+            bool hasColor() const;
+        };
+
+        typedef std::vector<BrushFaceData> BrushFaceDataList;
+
+        /**
+         * The face data of a brush is immutable once it has been created. Brushes keep it until they change, so it
+         * can be shared between everything that was serialized since the last change instead of being copied.
+         */
+        typedef std::shared_ptr<const BrushFaceDataList> BrushFaceDataListPtr;
+    }
+}
+
+#endif /* defined(TrenchBroom_BrushFaceData) */
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace IO {
+        static const uint64_t HashMultiplier = 0x9E3779B97F4A7C15ull;
+
+        static uint64_t mix(uint64_t h) {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        ContentHash contentHash(const char* begin, const char* end, const ContentHash seed) {
+            const auto size = static_cast<uint64_t>(end - begin);
+
+            // four independent lanes so that the multiplications can overlap
+            uint64_t lanes[4] = { seed, seed + 1, seed + 2, seed + 3 };
+            const char* cur = begin;
+            while (end - cur >= 32) {
+                for (size_t i = 0; i < 4; ++i) {
+                    uint64_t word;
+                    std::memcpy(&word, cur + i * 8, 8);
+                    lanes[i] = (lanes[i] ^ mix(word)) * HashMultiplier;
+                }
+                cur += 32;
+            }
+
+            uint64_t result = mix(size ^ seed);
+            for (size_t i = 0; i < 4; ++i)
+                result = (result ^ mix(lanes[i])) * HashMultiplier;
+            
+            while (cur < end) {
+                uint64_t word = 0;
+                const auto count = std::min(static_cast<size_t>(end - cur), size_t(8));
+                std::memcpy(&word, cur, count);
+                result = (result ^ mix(word)) * HashMultiplier;
+                cur += count;
+            }
+
+            return mix(result);
+        }
+
+        ContentHash contentHash(const String& str, const ContentHash seed) {
+            return contentHash(str.data(), str.data() + str.size(), seed);
+        }
+    }
+}
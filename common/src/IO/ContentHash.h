@@ -0,0 +1,42 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_ContentHash
+#define TrenchBroom_ContentHash
+
+#include "StringUtils.h"
+
+#include <cstdint>
+
+namespace TrenchBroom {
+    namespace IO {
+        typedef uint64_t ContentHash;
+
+        /**
+         * Returns a 64 bit hash of the given bytes, e.g. to check whether the contents of a file have changed. The hash
+         * is not cryptographic, but it is stable across runs and platforms with the same byte order, so it can be
+         * stored on disk.
+         */
+        ContentHash contentHash(const char* begin, const char* end, ContentHash seed = 0);
+        ContentHash contentHash(const String& str, ContentHash seed = 0);
+    }
+}
+
+#endif /* defined(TrenchBroom_ContentHash) */
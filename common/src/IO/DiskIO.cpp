@@ -106,6 +106,22 @@ namespace TrenchBroom {
                 const Path fixedPath = fixPath(path);
                 return ::wxFileExists(fixedPath.asString());
             }
+
+            size_t fileSize(const Path& path) {
+                const Path fixedPath = fixPath(path);
+                const wxULongLong size = wxFileName::GetSize(fixedPath.asString());
+                if (size == wxInvalidSize)
+                    throw FileSystemException("Could not get size of file '" + fixedPath.asString() + "'");
+                return static_cast<size_t>(size.GetValue());
+            }
+
+            std::time_t fileModificationTime(const Path& path) {
+                const Path fixedPath = fixPath(path);
+                const time_t time = ::wxFileModificationTime(fixedPath.asString());
+                if (time == -1)
+                    throw FileSystemException("Could not get modification time of file '" + fixedPath.asString() + "'");
+                return time;
+            }
             
             String replaceForbiddenChars(const String& name) {
                 static const String forbidden = wxFileName::GetForbiddenChars().ToStdString();
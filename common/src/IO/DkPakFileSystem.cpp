@@ -36,19 +36,10 @@ namespace TrenchBroom {
             static const String HeaderMagic       = "PACK";
         }
         
-        DkPakFileSystem::CompressedFile::CompressedFile(MappedFile::Ptr file, const size_t uncompressedSize) :
-        m_file(file),
-        m_uncompressedSize(uncompressedSize) {}
-
-        MappedFile::Ptr DkPakFileSystem::CompressedFile::doOpen() {
-            const char* data = decompress();
-            return MappedFile::Ptr(new MappedFileBuffer(m_file->path(), data, m_uncompressedSize));
-        }
-
-        char* DkPakFileSystem::CompressedFile::decompress() const {
-            CharArrayReader reader(m_file->begin(), m_file->end());
+        static char* decompress(const char* begin, const char* end, const size_t uncompressedSize) {
+            CharArrayReader reader(begin, end);
             
-            char* result = new char[m_uncompressedSize];
+            char* result = new char[uncompressedSize];
             char* curTarget = result;
             
             unsigned char x = reader.readUnsignedChar<unsigned char>();
@@ -114,16 +105,18 @@ namespace TrenchBroom {
                 const bool compressed = reader.readBool<int32_t>();
                 const size_t entrySize = compressed ? compressedSize : uncompressedSize;
 
-                const char* entryBegin = m_file->begin() + entryAddress;
-                const char* entryEnd = entryBegin + entrySize;
-                const Path filePath(StringUtils::toLower(entryName));
-                MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
-                
-                if (compressed)
-                    m_root.addFile(filePath, new CompressedFile(entryFile, uncompressedSize));
-                else
-                    m_root.addFile(filePath, new SimpleFile(entryFile));
+                addEntry(StringUtils::toLower(entryName), entryAddress, entrySize, uncompressedSize, compressed);
             }
         }
+
+        MappedFile::Ptr DkPakFileSystem::doOpenEntry(const Path& path, const Entry& entry) const {
+            if (!entry.compressed) {
+                return ImageFileSystem::doOpenEntry(path, entry);
+            }
+
+            const char* begin = m_file->begin() + entry.offset;
+            const char* data = decompress(begin, begin + entry.size, entry.uncompressedSize);
+            return MappedFile::Ptr(new MappedFileBuffer(path, data, entry.uncompressedSize));
+        }
     }
 }
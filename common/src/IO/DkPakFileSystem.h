@@ -20,31 +20,17 @@
 #ifndef DkPakFileSystem_h
 #define DkPakFileSystem_h
 
-#include "StringUtils.h"
 #include "IO/ImageFileSystem.h"
 #include "IO/Path.h"
 
-#include <map>
-
 namespace TrenchBroom {
     namespace IO {
         class DkPakFileSystem : public ImageFileSystem {
-        private:
-            class CompressedFile : public File {
-            private:
-                MappedFile::Ptr m_file;
-                const size_t m_uncompressedSize;
-            public:
-                CompressedFile(MappedFile::Ptr file, size_t uncompressedSize);
-            private:
-                MappedFile::Ptr doOpen() override;
-                char* decompress() const;
-            };
         public:
             DkPakFileSystem(const Path& path, MappedFile::Ptr file);
         private:
             void doReadDirectory() override;
-            
+            MappedFile::Ptr doOpenEntry(const Path& path, const Entry& entry) const override;
         };
     }
 }
@@ -231,6 +231,12 @@ namespace TrenchBroom {
         m_begin(begin),
         /* m_end(end), */
         m_fs(fs) {}
+
+        DkmParser::DkmParser(const String& name, MappedFile::Ptr file, const FileSystem& fs) :
+        m_name(name),
+        m_begin(file->begin()),
+        m_file(std::move(file)),
+        m_fs(fs) {}
         
         // http://tfc.duke.free.fr/old/models/md2.htm
         Assets::EntityModel* DkmParser::doParseModel() {
@@ -263,10 +269,13 @@ namespace TrenchBroom {
             /* const size_t surfaceOffset =*/ readSize<int32_t>(cursor);
 
             const DkmSkinList skins = parseSkins(m_begin + skinOffset, skinCount);
-            const DkmFrameList frames = parseFrames(m_begin + frameOffset, frameCount, frameVertexCount, version);
             const DkmMeshList meshes = parseMeshes(m_begin + commandOffset, commandCount);
-            
-            return buildModel(skins, frames, meshes);
+
+            auto model = std::make_unique<Assets::EntityModel>(m_name);
+            loadSkins(model.get(), skins);
+            buildFrames(model.get(), m_begin + frameOffset, frameCount, frameVertexCount, version, meshes);
+
+            return model.release();
         }
 
         DkmParser::DkmSkinList DkmParser::parseSkins(const char* begin, const size_t skinCount) {
@@ -275,45 +284,45 @@ namespace TrenchBroom {
             return skins;
         }
 
-        DkmParser::DkmFrameList DkmParser::parseFrames(const char* begin, const size_t frameCount, const size_t frameVertexCount, const int version) {
+        DkmParser::DkmFrame DkmParser::parseFrame(const char* begin, const size_t frameIndex, const size_t frameVertexCount, const int version) {
             assert(version == 1 || version == 2);
-            DkmFrameList frames(frameCount, DkmFrame(frameVertexCount));
+            const auto vertexSize = version == 1 ? sizeof(DkmVertex1) : sizeof(DkmVertex2);
+            const auto frameSize = 2 * 3 * sizeof(float) + DkmLayout::FrameNameLength + frameVertexCount * vertexSize;
+            DkmFrame frame(frameVertexCount);
 
-            const char* cursor = begin;
-            for (size_t i = 0; i < frameCount; ++i) {
-                frames[i].scale = readVec3f(cursor);
-                frames[i].offset = readVec3f(cursor);
-                readBytes(cursor, frames[i].name, DkmLayout::FrameNameLength);
+            const char* cursor = begin + frameIndex * frameSize;
+            frame.scale = readVec3f(cursor);
+            frame.offset = readVec3f(cursor);
+            readBytes(cursor, frame.name, DkmLayout::FrameNameLength);
 
-                if (version == 1) {
-                    std::vector<DkmVertex1> packedVertices(frameVertexCount);
-                    readVector(cursor, packedVertices);
+            if (version == 1) {
+                std::vector<DkmVertex1> packedVertices(frameVertexCount);
+                readVector(cursor, packedVertices);
 
-                    for (size_t j = 0; j < frameVertexCount; ++j) {
-                        frames[i].vertices[j].x = packedVertices[j].x;
-                        frames[i].vertices[j].y = packedVertices[j].y;
-                        frames[i].vertices[j].z = packedVertices[j].z;
-                        frames[i].vertices[j].normalIndex = packedVertices[j].normalIndex;
-                    }
-                } else {
-                    std::vector<DkmVertex2> packedVertices(frameVertexCount);
-                    readVector(cursor, packedVertices);
+                for (size_t j = 0; j < frameVertexCount; ++j) {
+                    frame.vertices[j].x = packedVertices[j].x;
+                    frame.vertices[j].y = packedVertices[j].y;
+                    frame.vertices[j].z = packedVertices[j].z;
+                    frame.vertices[j].normalIndex = packedVertices[j].normalIndex;
+                }
+            } else {
+                std::vector<DkmVertex2> packedVertices(frameVertexCount);
+                readVector(cursor, packedVertices);
 
-                    /* Version 2 vertices are packed into a 32bit integer
-                     * X occupies the first 11 bits
-                     * Y occupies the following 10 bits
-                     * Z occupies the following 11 bits
-                     */
-                    for (size_t j = 0; j < frameVertexCount; ++j) {
-                        frames[i].vertices[j].x = (packedVertices[j].xyz & 0xFFE00000) >> 21;
-                        frames[i].vertices[j].y = (packedVertices[j].xyz & 0x1FF800) >> 11;
-                        frames[i].vertices[j].z = (packedVertices[j].xyz & 0x7FF);
-                        frames[i].vertices[j].normalIndex = packedVertices[j].normalIndex;
-                    }
+                /* Version 2 vertices are packed into a 32bit integer
+                 * X occupies the first 11 bits
+                 * Y occupies the following 10 bits
+                 * Z occupies the following 11 bits
+                 */
+                for (size_t j = 0; j < frameVertexCount; ++j) {
+                    frame.vertices[j].x = (packedVertices[j].xyz & 0xFFE00000) >> 21;
+                    frame.vertices[j].y = (packedVertices[j].xyz & 0x1FF800) >> 11;
+                    frame.vertices[j].z = (packedVertices[j].xyz & 0x7FF);
+                    frame.vertices[j].normalIndex = packedVertices[j].normalIndex;
                 }
             }
-            
-            return frames;
+
+            return frame;
         }
 
         DkmParser::DkmMeshList DkmParser::parseMeshes(const char* begin, const size_t commandCount) {
@@ -339,16 +348,6 @@ namespace TrenchBroom {
             return meshes;
         }
 
-        Assets::EntityModel* DkmParser::buildModel(const DkmSkinList& skins, const DkmFrameList& frames, const DkmMeshList& meshes) {
-            using ModelPtr = std::unique_ptr<Assets::EntityModel>;
-            ModelPtr model = std::make_unique<Assets::EntityModel>(m_name);
-
-            loadSkins(model.get(), skins);
-            buildFrames(model.get(), frames, meshes);
-
-            return model.release();
-        }
-
         void DkmParser::loadSkins(Assets::EntityModel* model, const DkmParser::DkmSkinList& skins) {
             for (const auto& skin : skins) {
                 const auto skinPath = findSkin(skin);
@@ -386,34 +385,48 @@ namespace TrenchBroom {
             }
         }
 
-        void DkmParser::buildFrames(Assets::EntityModel* model, const DkmParser::DkmFrameList& frames, const DkmParser::DkmMeshList& meshes) {
-            for (const auto& frame: frames) {
-                size_t vertexCount = 0;
-                Renderer::IndexRangeMap::Size size;
-                for (const auto& md2Mesh : meshes) {
-                    vertexCount += md2Mesh.vertices.size();
-                    if (md2Mesh.type == DkmMesh::Fan)
-                        size.inc(GL_TRIANGLE_FAN);
-                    else
-                        size.inc(GL_TRIANGLE_STRIP);
+        void DkmParser::buildFrames(Assets::EntityModel* model, const char* framesBegin, const size_t frameCount, const size_t frameVertexCount, const int version, const DkmMeshList& meshes) const {
+            if (m_file == nullptr) {
+                for (size_t i = 0; i < frameCount; ++i) {
+                    const auto frame = parseFrame(framesBegin, i, frameVertexCount, version);
+                    auto builder = buildFrame(frame, meshes);
+                    model->addFrame(frame.name, builder.vertices(), builder.indexArray());
                 }
+            } else {
+                // the decoder keeps the file open so that framesBegin stays valid
+                const auto file = m_file;
+                model->addLazyFrames(frameCount, [file, framesBegin, frameVertexCount, version, meshes](Assets::EntityModel& lazyModel, const size_t frameIndex) {
+                    const auto frame = parseFrame(framesBegin, frameIndex, frameVertexCount, version);
+                    auto builder = buildFrame(frame, meshes);
+                    lazyModel.setFrame(frameIndex, frame.name, builder.vertices(), builder.indexArray());
+                });
+            }
+        }
 
-                Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec> builder(vertexCount, size);
-                for (const auto& md2Mesh : meshes) {
-                    if (!md2Mesh.vertices.empty()) {
-                        vertexCount += md2Mesh.vertices.size();
-                        if (md2Mesh.type == DkmMesh::Fan)
-                            builder.addTriangleFan(getVertices(frame, md2Mesh.vertices));
-                        else
-                            builder.addTriangleStrip(getVertices(frame, md2Mesh.vertices));
-                    }
-                }
+        DkmParser::FrameBuilder DkmParser::buildFrame(const DkmFrame& frame, const DkmMeshList& meshes) {
+            size_t vertexCount = 0;
+            Renderer::IndexRangeMap::Size size;
+            for (const auto& md2Mesh : meshes) {
+                vertexCount += md2Mesh.vertices.size();
+                if (md2Mesh.type == DkmMesh::Fan)
+                    size.inc(GL_TRIANGLE_FAN);
+                else
+                    size.inc(GL_TRIANGLE_STRIP);
+            }
 
-                model->addFrame(frame.name, builder.vertices(), builder.indexArray());
+            FrameBuilder builder(vertexCount, size);
+            for (const auto& md2Mesh : meshes) {
+                if (!md2Mesh.vertices.empty()) {
+                    if (md2Mesh.type == DkmMesh::Fan)
+                        builder.addTriangleFan(getVertices(frame, md2Mesh.vertices));
+                    else
+                        builder.addTriangleStrip(getVertices(frame, md2Mesh.vertices));
+                }
             }
+            return builder;
         }
 
-        Assets::EntityModel::VertexList DkmParser::getVertices(const DkmFrame& frame, const DkmMeshVertexList& meshVertices) const {
+        Assets::EntityModel::VertexList DkmParser::getVertices(const DkmFrame& frame, const DkmMeshVertexList& meshVertices) {
             typedef Assets::EntityModel::Vertex Vertex;
 
             Vertex::List result(0);
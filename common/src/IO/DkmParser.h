@@ -24,6 +24,8 @@
 #include "Assets/AssetTypes.h"
 #include "Assets/EntityModel.h"
 #include "IO/EntityModelParser.h"
+#include "IO/MappedFile.h"
+#include "Renderer/IndexRangeMapBuilder.h"
 
 #include <vector>
 
@@ -87,7 +89,6 @@ namespace TrenchBroom {
                 vm::vec3f vertex(size_t index) const;
                 const vm::vec3f& normal(size_t index) const;
             };
-            typedef std::vector<DkmFrame> DkmFrameList;
 
             struct DkmMeshVertex {
                 vm::vec2f texCoords;
@@ -108,26 +109,33 @@ namespace TrenchBroom {
                 DkmMesh(int i_vertexCount);
             };
             typedef std::vector<DkmMesh> DkmMeshList;
-            
+
+            typedef Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec> FrameBuilder;
             
             String m_name;
             const char* m_begin;
             /* const char* m_end; */
+            MappedFile::Ptr m_file;
             const FileSystem& m_fs;
         public:
             DkmParser(const String& name, const char* begin, const char* end, const FileSystem& fs);
+            /**
+             * Creates a parser whose models decode their frames when they are first used. The models keep the given
+             * file open.
+             */
+            DkmParser(const String& name, MappedFile::Ptr file, const FileSystem& fs);
         private:
             Assets::EntityModel* doParseModel() override;
             DkmSkinList parseSkins(const char* begin, size_t skinCount);
-            DkmFrameList parseFrames(const char* begin, size_t frameCount, size_t frameVertexCount, int version);
+            static DkmFrame parseFrame(const char* begin, size_t frameIndex, size_t frameVertexCount, int version);
             DkmMeshList parseMeshes(const char* begin, size_t commandCount);
 
-            Assets::EntityModel* buildModel(const DkmSkinList& skins, const DkmFrameList& frames, const DkmMeshList& meshes);
             void loadSkins(Assets::EntityModel* model, const DkmSkinList& skins);
             const IO::Path findSkin(const DkmSkin& skin) const;
-            void buildFrames(Assets::EntityModel* model, const DkmFrameList& frames, const DkmMeshList& meshes);
+            void buildFrames(Assets::EntityModel* model, const char* framesBegin, size_t frameCount, size_t frameVertexCount, int version, const DkmMeshList& meshes) const;
+            static FrameBuilder buildFrame(const DkmFrame& frame, const DkmMeshList& meshes);
 
-            Assets::EntityModel::VertexList getVertices(const DkmFrame& frame, const DkmMeshVertexList& meshVertices) const;
+            static Assets::EntityModel::VertexList getVertices(const DkmFrame& frame, const DkmMeshVertexList& meshVertices);
         };
     }
 }
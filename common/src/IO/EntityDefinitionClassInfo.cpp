@@ -22,6 +22,8 @@
 #include "Assets/AttributeDefinition.h"
 #include "Model/EntityAttributes.h"
 
+#include <memory>
+
 namespace TrenchBroom {
     namespace IO {
         EntityDefinitionClassInfo::EntityDefinitionClassInfo() :
@@ -148,7 +150,7 @@ namespace TrenchBroom {
                         Assets::AttributeDefinitionMap::iterator classAttributeIt = m_attributes.find(baseAttribute->name());
                         if (classAttributeIt != std::end(m_attributes)) {
                             // the class already has a definition for this attribute, attempt merging them
-                            mergeProperties(classAttributeIt->second.get(), baseAttribute.get());
+                            classAttributeIt->second = mergeProperties(classAttributeIt->second, baseAttribute.get());
                         } else {
                             // the class doesn't have a definition for this attribute, add the base class attribute
                             addAttributeDefinition(baseAttribute);
@@ -160,15 +162,16 @@ namespace TrenchBroom {
             }
         }
 
-        void EntityDefinitionClassInfo::mergeProperties(Assets::AttributeDefinition* classAttribute, const Assets::AttributeDefinition* baseclassAttribute) {
+        Assets::AttributeDefinitionPtr EntityDefinitionClassInfo::mergeProperties(Assets::AttributeDefinitionPtr classAttribute, const Assets::AttributeDefinition* baseclassAttribute) {
             // for now, only merge spawnflags
             if (baseclassAttribute->type() == Assets::AttributeDefinition::Type_FlagsAttribute &&
                 classAttribute->type() == Assets::AttributeDefinition::Type_FlagsAttribute &&
                 baseclassAttribute->name() == Model::AttributeNames::Spawnflags &&
                 classAttribute->name() == Model::AttributeNames::Spawnflags) {
                 
+                // merge into a copy, the class attribute may be shared with other class infos
                 const Assets::FlagsAttributeDefinition* baseclassFlags = static_cast<const Assets::FlagsAttributeDefinition*>(baseclassAttribute);
-                Assets::FlagsAttributeDefinition* classFlags = static_cast<Assets::FlagsAttributeDefinition*>(classAttribute);
+                auto classFlags = std::make_shared<Assets::FlagsAttributeDefinition>(static_cast<const Assets::FlagsAttributeDefinition&>(*classAttribute));
                 
                 for (int i = 0; i < 24; ++i) {
                     const Assets::FlagsAttributeOption* baseclassFlag = baseclassFlags->option(static_cast<int>(1 << i));
@@ -177,7 +180,9 @@ namespace TrenchBroom {
                     if (baseclassFlag != nullptr && classFlag == nullptr)
                         classFlags->addOption(baseclassFlag->value(), baseclassFlag->shortDescription(), baseclassFlag->longDescription(), baseclassFlag->isDefault());
                 }
+                return classFlags;
             }
+            return classAttribute;
         }
     }
 }
@@ -77,7 +77,7 @@ namespace TrenchBroom {
         
             void resolveBaseClasses(const EntityDefinitionClassInfoMap& baseClasses, const StringList& classnames);
         private:
-            static void mergeProperties(Assets::AttributeDefinition* classAttribute, const Assets::AttributeDefinition* baseclassAttribute);
+            static Assets::AttributeDefinitionPtr mergeProperties(Assets::AttributeDefinitionPtr classAttribute, const Assets::AttributeDefinition* baseclassAttribute);
         };
     }
 }
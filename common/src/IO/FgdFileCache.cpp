@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "FgdFileCache.h"
+
+#include "IO/ContentHash.h"
+
+#include <iterator>
+
+namespace TrenchBroom {
+    namespace IO {
+        FgdFileCache::Statement FgdFileCache::Statement::message(const Logger::LogLevel level, const String& text) {
+            Statement statement;
+            statement.type = Type_Message;
+            statement.line = 0;
+            statement.level = level;
+            statement.text = text;
+            return statement;
+        }
+
+        FgdFileCache::Statement FgdFileCache::Statement::include(const size_t line, const String& path) {
+            Statement statement;
+            statement.type = Type_Include;
+            statement.line = line;
+            statement.level = Logger::LogLevel_Debug;
+            statement.text = path;
+            return statement;
+        }
+
+        FgdFileCache::Statement FgdFileCache::Statement::classDefinition(const Type type, const EntityDefinitionClassInfo& classInfo, const StringList& superClasses) {
+            Statement statement;
+            statement.type = type;
+            statement.line = classInfo.line();
+            statement.level = Logger::LogLevel_Debug;
+            statement.classInfo = classInfo;
+            statement.superClasses = superClasses;
+            return statement;
+        }
+
+        FgdFileCache::Key FgdFileCache::key(const char* begin, const char* end) {
+            return contentHash(begin, end);
+        }
+
+        FgdFileCache::StatementListPtr FgdFileCache::find(const Path& path, const Key key) const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_entries.find(path);
+            if (it == std::end(m_entries) || it->second.key != key) {
+                return nullptr;
+            }
+            return it->second.statements;
+        }
+
+        void FgdFileCache::store(const Path& path, const Key key, StatementListPtr statements) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries[path] = Entry{ key, std::move(statements) };
+        }
+
+        void FgdFileCache::clear() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.clear();
+        }
+
+        size_t FgdFileCache::size() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_entries.size();
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_FgdFileCache
+#define TrenchBroom_FgdFileCache
+
+#include "Logger.h"
+#include "StringUtils.h"
+#include "IO/ContentHash.h"
+#include "IO/EntityDefinitionClassInfo.h"
+#include "IO/Path.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Remembers the statements of FGD files that were parsed before, so that a file needs to be tokenized
+         * again only if its contents have changed.
+         *
+         * The statements of a file do not depend on the files that include it: base classes are resolved and
+         * included files are loaded when the statements are turned into entity definitions. The messages that
+         * were logged while parsing a file are stored in the order in which they occurred relative to the other
+         * statements so that they can be logged again.
+         *
+         * Entries are keyed by the path of the file and validated against a hash of its contents. The cache is
+         * safe to use from multiple threads.
+         */
+        class FgdFileCache {
+        public:
+            struct Statement {
+                typedef enum {
+                    Type_Message,
+                    Type_Include,
+                    Type_BaseClass,
+                    Type_PointClass,
+                    Type_SolidClass
+                } Type;
+
+                Type type;
+                size_t line;
+                Logger::LogLevel level;
+                String text; // the message or the included path
+                EntityDefinitionClassInfo classInfo; // with unresolved base classes
+                StringList superClasses;
+
+                static Statement message(Logger::LogLevel level, const String& text);
+                static Statement include(size_t line, const String& path);
+                static Statement classDefinition(Type type, const EntityDefinitionClassInfo& classInfo, const StringList& superClasses);
+            };
+
+            typedef std::vector<Statement> StatementList;
+            typedef std::shared_ptr<const StatementList> StatementListPtr;
+            typedef ContentHash Key;
+        private:
+            struct Entry {
+                Key key;
+                StatementListPtr statements;
+            };
+
+            mutable std::mutex m_mutex;
+            std::map<Path, Entry> m_entries;
+        public:
+            /**
+             * Returns the key of a file with the given contents.
+             */
+            static Key key(const char* begin, const char* end);
+
+            /**
+             * Returns the statements of the file with the given path if they were stored with the given key, and
+             * null otherwise.
+             */
+            StatementListPtr find(const Path& path, Key key) const;
+            void store(const Path& path, Key key, StatementListPtr statements);
+
+            void clear();
+            size_t size() const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_FgdFileCache) */
@@ -124,16 +124,19 @@ namespace TrenchBroom {
             return Token(FgdToken::Eof, nullptr, nullptr, length(), line(), column());
         }
 
-        FgdParser::FgdParser(const char* begin, const char* end, const Color& defaultEntityColor, const Path& path) :
+        FgdParser::FgdParser(const char* begin, const char* end, const Color& defaultEntityColor, const Path& path, FgdFileCache* cache) :
         m_defaultEntityColor(defaultEntityColor),
+        m_begin(begin),
+        m_end(end),
+        m_cache(cache),
         m_tokenizer(FgdTokenizer(begin, end)) {
             if (!path.isEmpty()) {
                 pushIncludePath(path);
             }
         }
         
-        FgdParser::FgdParser(const String& str, const Color& defaultEntityColor, const Path& path) :
-        FgdParser(str.c_str(), str.c_str() + str.size(), defaultEntityColor, path) {}
+        FgdParser::FgdParser(const String& str, const Color& defaultEntityColor, const Path& path, FgdFileCache* cache) :
+        FgdParser(str.c_str(), str.c_str() + str.size(), defaultEntityColor, path, cache) {}
 
         FgdParser::TokenNameMap FgdParser::tokenNames() const {
             using namespace FgdToken;
@@ -169,6 +172,29 @@ namespace TrenchBroom {
             }
         };
 
+        /**
+         * Records the messages logged while parsing a file as statements, so that they are logged in the right order
+         * when the statements are turned into definitions, even if the statements are taken from the cache.
+         */
+        class FgdParser::StatementRecorder : public ParserStatus {
+        private:
+            ParserStatus& m_status;
+            FgdFileCache::StatementList& m_statements;
+        public:
+            StatementRecorder(ParserStatus& status, FgdFileCache::StatementList& statements) :
+            ParserStatus(nullptr),
+            m_status(status),
+            m_statements(statements) {}
+        private:
+            void doProgress(const double progress) override {
+                m_status.progress(progress);
+            }
+
+            void doLog(const Logger::LogLevel level, const String& str) override {
+                m_statements.push_back(FgdFileCache::Statement::message(level, str));
+            }
+        };
+
         void FgdParser::pushIncludePath(const Path& path) {
             ensure(path.isAbsolute(), "include path must be absolute");
             assert(!isRecursiveInclude(path));
@@ -193,13 +219,69 @@ namespace TrenchBroom {
         }
 
         Assets::EntityDefinitionList FgdParser::doParseDefinitions(ParserStatus& status) {
-            Assets::EntityDefinitionList definitions;
+            const auto path = m_paths.empty() ? Path("") : m_paths.back();
+            const auto statements = parseStatements(status, path, m_begin, m_end);
+            return buildDefinitions(status, *statements);
+        }
+
+        FgdFileCache::StatementListPtr FgdParser::parseStatements(ParserStatus& status, const Path& path, const char* begin, const char* end) {
+            const auto useCache = m_cache != nullptr && !path.isEmpty();
+            const auto key = useCache ? FgdFileCache::key(begin, end) : FgdFileCache::Key(0);
+            if (useCache) {
+                auto statements = m_cache->find(path, key);
+                if (statements != nullptr) {
+                    status.log(Logger::LogLevel_Debug, "Using cached statements of '" + path.asString() + "'");
+                    return statements;
+                }
+            }
+
+            auto statements = std::make_shared<FgdFileCache::StatementList>();
+            StatementRecorder recorder(status, *statements);
+            m_tokenizer.replaceState(begin, end);
             try {
                 auto token = m_tokenizer.peekToken();
                 while (!token.hasType(FgdToken::Eof)) {
-                    parseDefinitionOrInclude(status, definitions);
+                    parseStatement(recorder, *statements);
                     token = m_tokenizer.peekToken();
                 }
+            } catch (...) {
+                for (const auto& statement : *statements) {
+                    if (statement.type == FgdFileCache::Statement::Type_Message) {
+                        status.log(statement.level, statement.text);
+                    }
+                }
+                throw;
+            }
+
+            if (useCache) {
+                m_cache->store(path, key, statements);
+            }
+            return statements;
+        }
+
+        Assets::EntityDefinitionList FgdParser::buildDefinitions(ParserStatus& status, const FgdFileCache::StatementList& statements) {
+            Assets::EntityDefinitionList definitions;
+            try {
+                for (const auto& statement : statements) {
+                    switch (statement.type) {
+                        case FgdFileCache::Statement::Type_Message:
+                            status.log(statement.level, statement.text);
+                            break;
+                        case FgdFileCache::Statement::Type_Include:
+                            VectorUtils::append(definitions, handleInclude(status, statement.line, Path(statement.text)));
+                            break;
+                        case FgdFileCache::Statement::Type_BaseClass:
+                            addBaseClass(status, resolveClass(statement));
+                            break;
+                        case FgdFileCache::Statement::Type_PointClass:
+                            definitions.push_back(createPointClass(status, resolveClass(statement)));
+                            break;
+                        case FgdFileCache::Statement::Type_SolidClass:
+                            definitions.push_back(createSolidClass(status, resolveClass(statement)));
+                            break;
+                        switchDefault()
+                    }
+                }
                 return definitions;
             } catch (...) {
                 VectorUtils::clearAndDelete(definitions);
@@ -207,39 +289,64 @@ namespace TrenchBroom {
             }
         }
 
-        void FgdParser::parseDefinitionOrInclude(ParserStatus& status, Assets::EntityDefinitionList& definitions) {
+        Assets::EntityDefinition* FgdParser::createSolidClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo) const {
+            if (classInfo.hasSize()) {
+                status.warn(classInfo.line(), classInfo.column(), "Solid entity definition must not have a size");
+            }
+            if (classInfo.hasModelDefinition()) {
+                status.warn(classInfo.line(), classInfo.column(), "Solid entity definition must not have model definitions");
+            }
+            return new Assets::BrushEntityDefinition(classInfo.name(), classInfo.color(), classInfo.description(), classInfo.attributeList());
+        }
+        
+        Assets::EntityDefinition* FgdParser::createPointClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo) const {
+            return new Assets::PointEntityDefinition(classInfo.name(), classInfo.color(), classInfo.size(), classInfo.description(), classInfo.attributeList(), classInfo.modelDefinition());
+        }
+        
+        void FgdParser::addBaseClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo) {
+            if (m_baseClasses.count(classInfo.name()) > 0) {
+                status.warn(classInfo.line(), classInfo.column(), "Redefinition of base class '" + classInfo.name() + "'");
+            }
+            m_baseClasses[classInfo.name()] = classInfo;
+        }
+
+        EntityDefinitionClassInfo FgdParser::resolveClass(const FgdFileCache::Statement& statement) const {
+            // resolve a copy, the statement may be cached
+            auto classInfo = statement.classInfo;
+            classInfo.resolveBaseClasses(m_baseClasses, statement.superClasses);
+            return classInfo;
+        }
+
+        void FgdParser::parseStatement(ParserStatus& status, FgdFileCache::StatementList& statements) {
             auto token = expect(status, FgdToken::Eof | FgdToken::Word, m_tokenizer.peekToken());
             if (token.hasType(FgdToken::Eof)) {
                 return;
             }
 
             if (StringUtils::caseInsensitiveEqual(token.data(), "@include")) {
-                const auto includedDefinitions = parseInclude(status);
-                VectorUtils::append(definitions, includedDefinitions);
+                statements.push_back(parseInclude(status));
             } else {
-                auto* definition = parseDefinition(status);
+                parseDefinition(status, statements);
                 status.progress(m_tokenizer.progress());
-                if (definition != nullptr) {
-                    definitions.push_back(definition);
-                }
             }
         }
 
-        Assets::EntityDefinition* FgdParser::parseDefinition(ParserStatus& status) {
+        void FgdParser::parseDefinition(ParserStatus& status, FgdFileCache::StatementList& statements) {
             auto token = expect(status, FgdToken::Word, m_tokenizer.nextToken());
 
             const auto classname = token.data();
+            StringList superClasses;
             if (StringUtils::caseInsensitiveEqual(classname, "@SolidClass")) {
-                return parseSolidClass(status);
+                const auto classInfo = parseClass(status, superClasses);
+                statements.push_back(FgdFileCache::Statement::classDefinition(FgdFileCache::Statement::Type_SolidClass, classInfo, superClasses));
             } else if (StringUtils::caseInsensitiveEqual(classname, "@PointClass")) {
-                return parsePointClass(status);
+                const auto classInfo = parseClass(status, superClasses);
+                statements.push_back(FgdFileCache::Statement::classDefinition(FgdFileCache::Statement::Type_PointClass, classInfo, superClasses));
             } else if (StringUtils::caseInsensitiveEqual(classname, "@BaseClass")) {
-                const auto baseClass = parseBaseClass(status);
-                m_baseClasses[baseClass.name()] = baseClass;
-                return nullptr;
+                const auto classInfo = parseClass(status, superClasses);
+                statements.push_back(FgdFileCache::Statement::classDefinition(FgdFileCache::Statement::Type_BaseClass, classInfo, superClasses));
             } else if (StringUtils::caseInsensitiveEqual(classname, "@Main")) {
                 skipMainClass(status);
-                return nullptr;
             } else {
                 const auto msg = "Unknown entity definition class '" + classname + "'";
                 status.error(token.line(), token.column(), msg);
@@ -247,34 +354,9 @@ namespace TrenchBroom {
             }
         }
         
-        Assets::EntityDefinition* FgdParser::parseSolidClass(ParserStatus& status) {
-            EntityDefinitionClassInfo classInfo = parseClass(status);
-            if (classInfo.hasSize()) {
-                status.warn(classInfo.line(), classInfo.column(), "Solid entity definition must not have a size");
-            }
-            if (classInfo.hasModelDefinition()) {
-                status.warn(classInfo.line(), classInfo.column(), "Solid entity definition must not have model definitions");
-            }
-            return new Assets::BrushEntityDefinition(classInfo.name(), classInfo.color(), classInfo.description(), classInfo.attributeList());
-        }
-        
-        Assets::EntityDefinition* FgdParser::parsePointClass(ParserStatus& status) {
-            const auto classInfo = parseClass(status);
-            return new Assets::PointEntityDefinition(classInfo.name(), classInfo.color(), classInfo.size(), classInfo.description(), classInfo.attributeList(), classInfo.modelDefinition());
-        }
-        
-        EntityDefinitionClassInfo FgdParser::parseBaseClass(ParserStatus& status) {
-            const auto classInfo = parseClass(status);
-            if (m_baseClasses.count(classInfo.name()) > 0) {
-                status.warn(classInfo.line(), classInfo.column(), "Redefinition of base class '" + classInfo.name() + "'");
-            }
-            return classInfo;
-        }
-        
-        EntityDefinitionClassInfo FgdParser::parseClass(ParserStatus& status) {
+        EntityDefinitionClassInfo FgdParser::parseClass(ParserStatus& status, StringList& superClasses) {
             auto token = expect(status, FgdToken::Word | FgdToken::Equality, m_tokenizer.nextToken());
             
-            StringList superClasses;
             EntityDefinitionClassInfo classInfo(token.line(), token.column(), m_defaultEntityColor);
             
             while (token.type() == FgdToken::Word) {
@@ -319,7 +401,6 @@ namespace TrenchBroom {
             }
             
             classInfo.addAttributeDefinitions(parseProperties(status));
-            classInfo.resolveBaseClasses(m_baseClasses, superClasses);
             return classInfo;
         }
 
@@ -700,40 +781,37 @@ namespace TrenchBroom {
             }
         }
 
-        Assets::EntityDefinitionList FgdParser::parseInclude(ParserStatus& status) {
+        FgdFileCache::Statement FgdParser::parseInclude(ParserStatus& status) {
             auto token = expect(status, FgdToken::Word, m_tokenizer.nextToken());
             assert(StringUtils::caseInsensitiveEqual(token.data(), "@include"));
 
             expect(status, FgdToken::String, token = m_tokenizer.nextToken());
-            const auto path = Path(token.data());
-            return handleInclude(status, path);
+            return FgdFileCache::Statement::include(m_tokenizer.line(), token.data());
         }
 
-        Assets::EntityDefinitionList FgdParser::handleInclude(ParserStatus& status, const Path& path) {
-            const auto snapshot = m_tokenizer.snapshot();
+        Assets::EntityDefinitionList FgdParser::handleInclude(ParserStatus& status, const size_t line, const Path& path) {
             auto result = Assets::EntityDefinitionList(0);
             try {
-                status.debug(m_tokenizer.line(), "Parsing included file '" + path.asString() + "'");
+                status.debug(line, "Parsing included file '" + path.asString() + "'");
                 const auto file = m_fileSystem.openFile(path);
                 const auto filePath = file->path();
-                status.debug(m_tokenizer.line(), "Resolved '" + path.asString() + "' to '" + filePath.asString() + "'");
+                status.debug(line, "Resolved '" + path.asString() + "' to '" + filePath.asString() + "'");
 
                 if (!isRecursiveInclude(filePath)) {
                     const PushIncludePath pushIncludePath(this, filePath);
-                    m_tokenizer.replaceState(file->begin(), file->end());
-                    result = doParseDefinitions(status);
+                    const auto statements = parseStatements(status, filePath, file->begin(), file->end());
+                    result = buildDefinitions(status, *statements);
                 } else {
                     auto str = StringStream();
                     str << "Skipping recursively included file: " << path.asString() << " (" << filePath << ")";
-                    status.error(m_tokenizer.line(), str.str());
+                    status.error(line, str.str());
                 }
             } catch (const Exception &e) {
                 auto str = StringStream();
                 str << "Failed to parse included file: " << e.what();
-                status.error(m_tokenizer.line(), str.str());
+                status.error(line, str.str());
             }
 
-            m_tokenizer.restore(snapshot);
             return result;
         }
     }
@@ -26,6 +26,7 @@
 #include "Assets/AssetTypes.h"
 #include "IO/EntityDefinitionClassInfo.h"
 #include "IO/EntityDefinitionParser.h"
+#include "IO/FgdFileCache.h"
 #include "IO/FileSystemHierarchy.h"
 #include "IO/Parser.h"
 #include "IO/Token.h"
@@ -77,6 +78,9 @@ namespace TrenchBroom {
             };
             
             Color m_defaultEntityColor;
+            const char* m_begin;
+            const char* m_end;
+            FgdFileCache* m_cache;
 
             std::list<Path> m_paths;
             FileSystemHierarchy m_fileSystem;
@@ -84,10 +88,15 @@ namespace TrenchBroom {
             FgdTokenizer m_tokenizer;
             EntityDefinitionClassInfoMap m_baseClasses;
         public:
-            FgdParser(const char* begin, const char* end, const Color& defaultEntityColor, const Path& path = Path(""));
-            FgdParser(const String& str, const Color& defaultEntityColor, const Path& path = Path(""));
+            /**
+             * Creates a parser for the given FGD file. If a cache is given, the statements of the file and of the
+             * files it includes are looked up in and added to the cache. This requires the path of the file.
+             */
+            FgdParser(const char* begin, const char* end, const Color& defaultEntityColor, const Path& path = Path(""), FgdFileCache* cache = nullptr);
+            FgdParser(const String& str, const Color& defaultEntityColor, const Path& path = Path(""), FgdFileCache* cache = nullptr);
         private:
             class PushIncludePath;
+            class StatementRecorder;
             void pushIncludePath(const Path& path);
             void popIncludePath();
 
@@ -96,13 +105,17 @@ namespace TrenchBroom {
             TokenNameMap tokenNames() const override;
             Assets::EntityDefinitionList doParseDefinitions(ParserStatus& status) override;
 
-            void parseDefinitionOrInclude(ParserStatus& status, Assets::EntityDefinitionList& definitions);
+            FgdFileCache::StatementListPtr parseStatements(ParserStatus& status, const Path& path, const char* begin, const char* end);
+            Assets::EntityDefinitionList buildDefinitions(ParserStatus& status, const FgdFileCache::StatementList& statements);
 
-            Assets::EntityDefinition* parseDefinition(ParserStatus& status);
-            Assets::EntityDefinition* parseSolidClass(ParserStatus& status);
-            Assets::EntityDefinition* parsePointClass(ParserStatus& status);
-            EntityDefinitionClassInfo parseBaseClass(ParserStatus& status);
-            EntityDefinitionClassInfo parseClass(ParserStatus& status);
+            Assets::EntityDefinition* createSolidClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo) const;
+            Assets::EntityDefinition* createPointClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo) const;
+            void addBaseClass(ParserStatus& status, const EntityDefinitionClassInfo& classInfo);
+            EntityDefinitionClassInfo resolveClass(const FgdFileCache::Statement& statement) const;
+
+            void parseStatement(ParserStatus& status, FgdFileCache::StatementList& statements);
+            void parseDefinition(ParserStatus& status, FgdFileCache::StatementList& statements);
+            EntityDefinitionClassInfo parseClass(ParserStatus& status, StringList& superClasses);
             void skipMainClass(ParserStatus& status);
             
             StringList parseSuperClasses(ParserStatus& status);
@@ -131,8 +144,8 @@ namespace TrenchBroom {
             Color parseColor(ParserStatus& status);
             String parseString(ParserStatus& status);
 
-            Assets::EntityDefinitionList parseInclude(ParserStatus& status);
-            Assets::EntityDefinitionList handleInclude(ParserStatus& status, const Path& path);
+            FgdFileCache::Statement parseInclude(ParserStatus& status);
+            Assets::EntityDefinitionList handleInclude(ParserStatus& status, size_t line, const Path& path);
         };
     }
 }
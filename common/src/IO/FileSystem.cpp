@@ -20,6 +20,7 @@
 #include "FileSystem.h"
 
 #include "Exceptions.h"
+#include "Parallel.h"
 
 #include "IO/FileMatcher.h"
 
@@ -89,6 +90,14 @@ namespace TrenchBroom {
             }
         }
 
+        MappedFile::List FileSystem::openFiles(const Path::List& paths, const size_t threadCount) const {
+            MappedFile::List result(paths.size());
+            parallelFor(paths.size(), threadCount, [&](const size_t i) {
+                result[i] = openFile(paths[i]);
+            });
+            return result;
+        }
+
         WritableFileSystem::WritableFileSystem() {}
 
         /*
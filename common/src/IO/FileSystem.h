@@ -64,6 +64,12 @@ namespace TrenchBroom {
             
             Path::List getDirectoryContents(const Path& path) const;
             const MappedFile::Ptr openFile(const Path& path) const;
+
+            /**
+             * Opens the files with the given paths using up to the given number of threads and returns them in the
+             * order of the given paths. This lets file systems that decompress their files do so in parallel.
+             */
+            MappedFile::List openFiles(const Path::List& paths, size_t threadCount) const;
         private:
             template <class M>
             void doFindItems(const Path& searchPath, const M& matcher, const bool recurse, Path::List& result) const {
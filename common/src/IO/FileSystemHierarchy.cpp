@@ -25,6 +25,8 @@
 #include "IO/FileMatcher.h"
 #include "IO/IdPakFileSystem.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace IO {
         FileSystemHierarchy::FileSystemHierarchy() {}
@@ -36,16 +38,24 @@ namespace TrenchBroom {
         void FileSystemHierarchy::pushFileSystem(FileSystem* fileSystem) {
             ensure(fileSystem != nullptr, "filesystem is null");
             m_fileSystems.push_back(fileSystem);
+            invalidateIndex();
         }
 
         void FileSystemHierarchy::popFileSystem() {
             ensure(!m_fileSystems.empty(), "filesystem hierarchy is empty");
             delete m_fileSystems.back();
             m_fileSystems.pop_back();
+            invalidateIndex();
         }
 
         void FileSystemHierarchy::clear() {
             VectorUtils::clearAndDelete(m_fileSystems);
+            invalidateIndex();
+        }
+
+        void FileSystemHierarchy::invalidateIndex() {
+            std::lock_guard<std::mutex> lock(m_indexMutex);
+            m_index.clear();
         }
 
         Path FileSystemHierarchy::doMakeAbsolute(const Path& relPath) const {
@@ -58,13 +68,10 @@ namespace TrenchBroom {
         }
 
         bool FileSystemHierarchy::doDirectoryExists(const Path& path) const {
-            for (auto it = m_fileSystems.rbegin(), end = m_fileSystems.rend(); it != end; ++it) {
-                const auto* fileSystem = *it;
-                if (fileSystem->directoryExists(path)) {
-                    return true;
-                }
-            }
-            return false;
+            const InternedPath internedPath(path);
+
+            std::lock_guard<std::mutex> lock(m_indexMutex);
+            return findDirectory(internedPath) != nullptr;
         }
         
         bool FileSystemHierarchy::doFileExists(const Path& path) const {
@@ -72,32 +79,105 @@ namespace TrenchBroom {
         }
         
         FileSystem* FileSystemHierarchy::findFileSystemContaining(const Path& path) const {
-            for (auto it = m_fileSystems.rbegin(), end = m_fileSystems.rend(); it != end; ++it) {
-                auto* fileSystem = *it;
-                if (fileSystem->fileExists(path)) {
-                    return fileSystem;
+            const auto fileSystems = findFileSystemsContaining(path);
+            return !fileSystems.empty() ? fileSystems.front() : nullptr;
+        }
+
+        FileSystemHierarchy::FileSystemList FileSystemHierarchy::findFileSystemsContaining(const Path& path) const {
+            const InternedPath internedPath(path);
+
+            std::lock_guard<std::mutex> lock(m_indexMutex);
+            Item* item = findItem(internedPath);
+            return item != nullptr ? findOwners(*item, internedPath, ItemType::File) : FileSystemList();
+        }
+
+        FileSystemHierarchy::Directory* FileSystemHierarchy::findDirectory(const InternedPath& path) const {
+            const InternedPath key = path.caseFolded();
+            const auto it = m_index.find(key);
+            if (it != std::end(m_index)) {
+                return &it->second;
+            }
+
+            FileSystemList fileSystems;
+            if (path.isEmpty()) {
+                fileSystems.assign(m_fileSystems.rbegin(), m_fileSystems.rend());
+            } else {
+                Item* item = findItem(path);
+                if (item == nullptr) {
+                    return nullptr;
+                }
+                fileSystems = findOwners(*item, path, ItemType::Directory);
+            }
+
+            if (fileSystems.empty()) {
+                return nullptr;
+            }
+
+            // only the file systems that contain this directory are listed, and the first spelling of a name wins
+            Directory directory;
+            for (FileSystem* fileSystem : fileSystems) {
+                for (const Path& name : fileSystem->getDirectoryContents(path.path())) {
+                    Item& item = directory[(path + name).caseFolded()];
+                    if (item.owners.empty()) {
+                        item.name = name;
+                    }
+                    if (item.owners.empty() || item.owners.back().fileSystem != fileSystem) {
+                        item.owners.push_back(Owner{ fileSystem, ItemType::Unknown });
+                    }
+                }
+            }
+            return &(m_index[key] = std::move(directory));
+        }
+
+        FileSystemHierarchy::Item* FileSystemHierarchy::findItem(const InternedPath& path) const {
+            if (path.isEmpty()) {
+                return nullptr;
+            }
+
+            Directory* parent = findDirectory(path.deleteLastComponent());
+            if (parent == nullptr) {
+                return nullptr;
+            }
+
+            const auto it = parent->find(path.caseFolded());
+            return it != std::end(*parent) ? &it->second : nullptr;
+        }
+
+        FileSystemHierarchy::FileSystemList FileSystemHierarchy::findOwners(Item& item, const InternedPath& path, const ItemType type) {
+            FileSystemList result;
+            for (Owner& owner : item.owners) {
+                // the type is only determined when it is needed since doing so is costly for disk file systems
+                if (owner.type == ItemType::Unknown) {
+                    owner.type = owner.fileSystem->directoryExists(path.path()) ? ItemType::Directory : ItemType::File;
+                }
+                if (owner.type == type) {
+                    result.push_back(owner.fileSystem);
                 }
             }
-            return nullptr;
+            return result;
         }
 
         Path::List FileSystemHierarchy::doGetDirectoryContents(const Path& path) const {
             Path::List result;
-            for (auto it = m_fileSystems.rbegin(), end = m_fileSystems.rend(); it != end; ++it) {
-                const auto* fileSystem = *it;
-                if (fileSystem->directoryExists(path)) {
-                    const Path::List contents = fileSystem->getDirectoryContents(path);
-                    VectorUtils::append(result, contents);
+
+            const InternedPath internedPath(path);
+
+            std::lock_guard<std::mutex> lock(m_indexMutex);
+            const Directory* directory = findDirectory(internedPath);
+            if (directory != nullptr) {
+                result.reserve(directory->size());
+                for (const auto& entry : *directory) {
+                    result.push_back(entry.second.name);
                 }
             }
             
-            VectorUtils::sortAndRemoveDuplicates(result);
+            std::sort(std::begin(result), std::end(result));
             return result;
         }
         
         const MappedFile::Ptr FileSystemHierarchy::doOpenFile(const Path& path) const {
-            for (auto it = m_fileSystems.rbegin(), end = m_fileSystems.rend(); it != end; ++it) {
-                const FileSystem* fileSystem = *it;
+            for (const FileSystem* fileSystem : findFileSystemsContaining(path)) {
+                // skip file systems from which the file was removed since the index was built
                 if (fileSystem->fileExists(path)) {
                     const auto file = fileSystem->openFile(path);
                     if (file.get() != nullptr) {
@@ -129,26 +209,31 @@ namespace TrenchBroom {
         void WritableFileSystemHierarchy::doCreateFile(const Path& path, const String& contents) {
             ensure(m_writableFileSystem != nullptr, "writableFileSystem is null");
             m_writableFileSystem->createFile(path, contents);
+            invalidateIndex();
         }
 
         void WritableFileSystemHierarchy::doCreateDirectory(const Path& path) {
             ensure(m_writableFileSystem != nullptr, "writableFileSystem is null");
             m_writableFileSystem->createDirectory(path);
+            invalidateIndex();
         }
         
         void WritableFileSystemHierarchy::doDeleteFile(const Path& path) {
             ensure(m_writableFileSystem != nullptr, "writableFileSystem is null");
             m_writableFileSystem->deleteFile(path);
+            invalidateIndex();
         }
         
         void WritableFileSystemHierarchy::doCopyFile(const Path& sourcePath, const Path& destPath, const bool overwrite) {
             ensure(m_writableFileSystem != nullptr, "writableFileSystem is null");
             m_writableFileSystem->copyFile(sourcePath, destPath, overwrite);
+            invalidateIndex();
         }
         
         void WritableFileSystemHierarchy::doMoveFile(const Path& sourcePath, const Path& destPath, const bool overwrite) {
             ensure(m_writableFileSystem != nullptr, "writableFileSystem is null");
             m_writableFileSystem->moveFile(sourcePath, destPath, overwrite);
+            invalidateIndex();
         }
     }
 }
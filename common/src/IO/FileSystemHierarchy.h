@@ -24,18 +24,54 @@
 #include "SharedPointer.h"
 #include "StringUtils.h"
 #include "IO/FileSystem.h"
+#include "IO/InternedPath.h"
 #include "IO/Path.h"
 
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom {
     namespace IO {
         class Path;
         
+        /**
+         * Merges a stack of file systems, where the file systems that were pushed last take precedence.
+         *
+         * Lookups are answered from a case insensitive index of the merged directories instead of asking every file
+         * system. A directory is added to the index when it is first accessed by listing it in those file systems that
+         * contain it, and the index is kept until the file systems change. Changes to the contents of the file systems
+         * themselves are not detected, call invalidateIndex() to pick them up.
+         */
         class FileSystemHierarchy : public virtual FileSystem {
         private:
             typedef std::vector<FileSystem*> FileSystemList;
             FileSystemList m_fileSystems;
+
+            enum class ItemType {
+                Unknown,
+                File,
+                Directory
+            };
+
+            struct Owner {
+                FileSystem* fileSystem;
+                ItemType type;
+            };
+
+            /**
+             * An item of a merged directory and the file systems containing it, in order of precedence.
+             */
+            struct Item {
+                Path name;
+                std::vector<Owner> owners;
+            };
+
+            typedef std::unordered_map<InternedPath, Item, InternedPath::Hash> Directory;
+            typedef std::unordered_map<InternedPath, Directory, InternedPath::Hash> Index;
+
+            mutable std::mutex m_indexMutex;
+            mutable Index m_index;
         public:
             FileSystemHierarchy();
             virtual ~FileSystemHierarchy() override;
@@ -43,11 +79,21 @@ namespace TrenchBroom {
             void pushFileSystem(FileSystem* fileSystem);
             void popFileSystem();
             virtual void clear();
+
+            /**
+             * Discards the index so that changes to the contents of the file systems become visible.
+             */
+            void invalidateIndex();
         private:
             Path doMakeAbsolute(const Path& relPath) const override;
             bool doDirectoryExists(const Path& path) const override;
             bool doFileExists(const Path& path) const override;
             FileSystem* findFileSystemContaining(const Path& path) const;
+            FileSystemList findFileSystemsContaining(const Path& path) const;
+
+            Directory* findDirectory(const InternedPath& path) const;
+            Item* findItem(const InternedPath& path) const;
+            static FileSystemList findOwners(Item& item, const InternedPath& path, ItemType type);
             
             Path::List doGetDirectoryContents(const Path& path) const override;
             const MappedFile::Ptr doOpenFile(const Path& path) const override;
@@ -25,6 +25,7 @@
 #include "Assets/Texture.h"
 #include "IO/CharArrayReader.h"
 #include "IO/Path.h"
+#include "IO/ContentHash.h"
 
 #include <cstring>
 
@@ -74,6 +75,32 @@ namespace TrenchBroom {
 
             return new Assets::Texture(textureName(imageName, path), imageWidth, imageHeight, Color(), buffers, format, Assets::TextureType::Opaque);
         }
+
+        Assets::Texture* FreeImageTextureReader::doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const {
+            const size_t                imageSize       = static_cast<size_t>(end - begin);
+            BYTE*                       imageBegin      = reinterpret_cast<BYTE*>(const_cast<char*>(begin));
+            FIMEMORY*                   imageMemory     = FreeImage_OpenMemory(imageBegin, static_cast<DWORD>(imageSize));
+            const FREE_IMAGE_FORMAT     imageFormat     = FreeImage_GetFileTypeFromMemory(imageMemory);
+            // formats that don't support loading only the header load the entire image
+            FIBITMAP*                   image           = FreeImage_LoadFromMemory(imageFormat, imageMemory, FIF_LOAD_NOPIXELS);
+
+            const String                imageName       = path.filename();
+            const size_t                imageWidth      = static_cast<size_t>(FreeImage_GetWidth(image));
+            const size_t                imageHeight     = static_cast<size_t>(FreeImage_GetHeight(image));
+
+            FreeImage_Unload(image);
+            FreeImage_CloseMemory(imageMemory);
+
+            if (imageWidth == 0 || imageHeight == 0) {
+                return nullptr;
+            }
+            return new Assets::Texture(textureName(imageName, path), imageWidth, imageHeight);
+        }
+
+        uint64_t FreeImageTextureReader::doGetCacheKey() const {
+            // decoding compressed images and scaling the mip levels takes much longer than reading a cache entry
+            return contentHash("image", m_mipCount);
+        }
     }
 
 }
@@ -34,6 +34,8 @@ namespace TrenchBroom {
             FreeImageTextureReader(const NameStrategy& nameStrategy, size_t mipCount);
         private:
             Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const override;
+            Assets::Texture* doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const override;
+            uint64_t doGetCacheKey() const override;
         };
     }
 }
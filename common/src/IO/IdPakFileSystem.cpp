@@ -60,14 +60,8 @@ namespace TrenchBroom {
                 const String entryName(entryNameBuffer);
                 const size_t entryAddress = readSize<int32_t>(cursor);
                 const size_t entryLength = readSize<int32_t>(cursor);
-                assert(m_file->begin() + entryAddress + entryLength <= m_file->end());
                 
-                const char* entryBegin = m_file->begin() + entryAddress;
-                const char* entryEnd = entryBegin + entryLength;
-                const Path filePath(StringUtils::toLower(entryName));
-                MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
-
-                m_root.addFile(filePath, new SimpleFile(entryFile));
+                addEntry(StringUtils::toLower(entryName), entryAddress, entryLength);
             }
         }
     }
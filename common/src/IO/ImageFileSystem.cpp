@@ -23,144 +23,112 @@
 #include "IO/DiskFileSystem.h"
 #include "IO/IOUtils.h"
 
-#include <cassert>
+#include <algorithm>
+#include <iterator>
 
 namespace TrenchBroom {
     namespace IO {
-        ImageFileSystem::File::~File() = default;
-        
-        MappedFile::Ptr ImageFileSystem::File::open() {
-            return doOpen();
-        }
-        
-        ImageFileSystem::SimpleFile::SimpleFile(MappedFile::Ptr file) :
-        m_file(file) {}
-        
-        MappedFile::Ptr ImageFileSystem::SimpleFile::doOpen() {
-            return m_file;
-        }
-        
-        ImageFileSystem::Directory::Directory(const Path& path) :
-        m_path(path) {}
-        
-        ImageFileSystem::Directory::~Directory() {
-            MapUtils::clearAndDelete(m_directories);
-            MapUtils::clearAndDelete(m_files);
-        }
-        
-        void ImageFileSystem::Directory::addFile(const Path& path, MappedFile::Ptr file) {
-            addFile(path, new SimpleFile(file));
-        }
-
-        void ImageFileSystem::Directory::addFile(const Path& path, File* file) {
-            ensure(file != nullptr, "file is null");
-            const auto filename = path.lastComponent();
-            if (path.length() == 1) {
-                // silently overwrite duplicates, the latest entries win
-                MapUtils::insertOrReplaceAndDelete(m_files, filename, file);
-            } else {
-                auto& dir = findOrCreateDirectory(path.deleteLastComponent());
-                dir.addFile(filename, file);
-            }
+        // archive entry names are plain ASCII, so case folding does not need to consider the locale
+        static char foldCase(const char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
         }
-        
-        bool ImageFileSystem::Directory::directoryExists(const Path& path) const {
-            if (path.isEmpty()) {
-                return true;
-            }
 
-            auto it = m_directories.find(path.firstComponent());
-            if (it == std::end(m_directories)) {
-                return false;
-            } else {
-                return it->second->directoryExists(path.deleteFirstComponent());
-            }
+        static bool foldedLess(const String& lhs, const String& rhs) {
+            return std::lexicographical_compare(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs),
+                                                [](const char l, const char r) { return foldCase(l) < foldCase(r); });
         }
-        
-        bool ImageFileSystem::Directory::fileExists(const Path& path) const {
-            if (path.length() == 1) {
-                return m_files.count(path) > 0;
-            }
 
-            auto it = m_directories.find(path.firstComponent());
-            if (it == std::end(m_directories)) {
+        static bool foldedPrefix(const String& str, const String& prefix) {
+            if (str.size() < prefix.size())
                 return false;
-            } else {
-                return it->second->fileExists(path.deleteFirstComponent());
+            for (size_t i = 0; i < prefix.size(); ++i) {
+                if (foldCase(str[i]) != foldCase(prefix[i]))
+                    return false;
             }
+            return true;
         }
-        
-        const ImageFileSystem::Directory& ImageFileSystem::Directory::findDirectory(const Path& path) const {
-            if (path.isEmpty()) {
-                return *this;
-            }
 
-            auto it = m_directories.find(path.firstComponent());
-            if (it == std::end(m_directories)) {
-                throw FileSystemException("Path does not exist: '" + (m_path + path).asString() + "'");
-            } else {
-                return it->second->findDirectory(path.deleteFirstComponent());
-            }
+        static bool foldedEqual(const String& lhs, const String& rhs) {
+            return lhs.size() == rhs.size() && foldedPrefix(lhs, rhs);
         }
-        
-        const MappedFile::Ptr ImageFileSystem::Directory::findFile(const Path& path) const {
-            assert(!path.isEmpty());
-            
-            const auto name = path.firstComponent();
-            if (path.length() == 1) {
-                auto it = m_files.find(name);
-                if (it == std::end(m_files)) {
-                    throw FileSystemException("File not found: '" + (m_path + path).asString() + "'");
-                } else {
-                    return it->second->open();
-                }
-            } else {
-                auto it = m_directories.find(name);
-                if (it == std::end(m_directories)) {
-                    throw FileSystemException("File not found: '" + (m_path + path).asString() + "'");
+
+        static String normalizeName(const String& name) {
+            String result;
+            result.reserve(name.size());
+            for (const char c : StringUtils::trim(name)) {
+                if (c == '/' || c == '\\') {
+                    if (!result.empty() && result.back() != '/')
+                        result.push_back('/');
                 } else {
-                    return it->second->findFile(path.deleteFirstComponent());
+                    result.push_back(c);
                 }
             }
+            if (!result.empty() && result.back() == '/')
+                result.pop_back();
+            return result;
         }
-        
-        Path::List ImageFileSystem::Directory::contents() const {
-            Path::List contents;
-            
-            for (const auto& entry : m_directories) {
-                contents.push_back(Path(entry.first));
-            }
-
-            for (const auto& entry : m_files) {
-                contents.push_back(Path(entry.first));
-            }
 
-            return contents;
+        static String makeKey(const Path& path) {
+            return path.isEmpty() ? String() : path.asString('/');
         }
-        
-        ImageFileSystem::Directory& ImageFileSystem::Directory::findOrCreateDirectory(const Path& path) {
-            if (path.isEmpty()) {
-                return *this;
-            }
 
-            const auto name = path.firstComponent();
-            auto it = m_directories.lower_bound(name);
-            if (it == std::end(m_directories) || name != it->first) {
-                it = m_directories.insert(it, std::make_pair(name, new Directory(m_path + Path(name))));
-            }
-            return it->second->findOrCreateDirectory(path.deleteFirstComponent());
-        }
-        
+        ImageFileSystem::Entry::Entry(const String& i_name, const size_t i_offset, const size_t i_size, const size_t i_uncompressedSize, const bool i_compressed) :
+        name(i_name),
+        offset(i_offset),
+        size(i_size),
+        uncompressedSize(i_uncompressedSize),
+        compressed(i_compressed) {}
+
         ImageFileSystem::ImageFileSystem(const Path& path, MappedFile::Ptr file) :
         m_path(path),
-        m_file(file),
-        m_root(Path("")) {}
-        
+        m_file(file) {}
         
         ImageFileSystem::~ImageFileSystem() = default;
 
         void ImageFileSystem::initialize() {
             doReadDirectory();
+            sortEntries();
+        }
+
+        void ImageFileSystem::addEntry(const String& name, const size_t offset, const size_t size) {
+            addEntry(name, offset, size, size, false);
+        }
+
+        void ImageFileSystem::addEntry(const String& name, const size_t offset, const size_t size, const size_t uncompressedSize, const bool compressed) {
+            if (offset > m_file->size() || size > m_file->size() - offset) {
+                throw FileSystemException("Entry '" + name + "' is out of bounds");
+            }
+
+            const auto normalizedName = normalizeName(name);
+            if (!normalizedName.empty()) {
+                m_entries.emplace_back(normalizedName, offset, size, uncompressedSize, compressed);
+            }
+        }
+
+        void ImageFileSystem::sortEntries() {
+            std::stable_sort(std::begin(m_entries), std::end(m_entries), [](const Entry& lhs, const Entry& rhs) {
+                return foldedLess(lhs.name, rhs.name);
+            });
+
+            // silently drop duplicates, the latest entries win
+            auto out = std::begin(m_entries);
+            for (auto it = std::begin(m_entries), end = std::end(m_entries); it != end; ++it) {
+                const auto next = std::next(it);
+                if (next == end || !foldedEqual(it->name, next->name)) {
+                    if (out != it) {
+                        *out = std::move(*it);
+                    }
+                    ++out;
+                }
+            }
+            m_entries.erase(out, std::end(m_entries));
+            m_entries.shrink_to_fit();
+        }
+
+        ImageFileSystem::EntryList::const_iterator ImageFileSystem::findEntry(const String& key) const {
+            return std::lower_bound(std::begin(m_entries), std::end(m_entries), key, [](const Entry& entry, const String& k) {
+                return foldedLess(entry.name, k);
+            });
         }
         
         Path ImageFileSystem::doMakeAbsolute(const Path& relPath) const {
@@ -168,24 +136,54 @@ namespace TrenchBroom {
         }
         
         bool ImageFileSystem::doDirectoryExists(const Path& path) const {
-            const auto searchPath = path.makeLowerCase();
-            return m_root.directoryExists(searchPath);
+            if (path.isEmpty()) {
+                return true;
+            }
+
+            const auto prefix = makeKey(path) + "/";
+            const auto it = findEntry(prefix);
+            return it != std::end(m_entries) && foldedPrefix(it->name, prefix);
         }
         
         bool ImageFileSystem::doFileExists(const Path& path) const {
-            const auto searchPath = path.makeLowerCase();
-            return m_root.fileExists(searchPath);
+            const auto key = makeKey(path);
+            const auto it = findEntry(key);
+            return it != std::end(m_entries) && foldedEqual(it->name, key);
         }
         
         Path::List ImageFileSystem::doGetDirectoryContents(const Path& path) const {
-            const auto searchPath = path.makeLowerCase();
-            const auto& directory = m_root.findDirectory(path);
-            return directory.contents();
+            const auto prefix = path.isEmpty() ? String() : makeKey(path) + "/";
+
+            // all entries below the directory are adjacent in the table, and so are the entries of each subdirectory
+            Path::List contents;
+            String previous;
+            for (auto it = findEntry(prefix), end = std::end(m_entries); it != end && foldedPrefix(it->name, prefix); ++it) {
+                const auto separator = it->name.find('/', prefix.size());
+                const auto name = it->name.substr(prefix.size(), separator == String::npos ? String::npos : separator - prefix.size());
+                if (contents.empty() || !foldedEqual(name, previous)) {
+                    contents.push_back(Path(name));
+                    previous = name;
+                }
+            }
+
+            if (contents.empty() && !path.isEmpty()) {
+                throw FileSystemException("Path does not exist: '" + path.asString() + "'");
+            }
+            return contents;
         }
         
         const MappedFile::Ptr ImageFileSystem::doOpenFile(const Path& path) const {
-            const auto searchPath = path.makeLowerCase();
-            return m_root.findFile(path);
+            const auto key = makeKey(path);
+            const auto it = findEntry(key);
+            if (it == std::end(m_entries) || !foldedEqual(it->name, key)) {
+                throw FileSystemException("File not found: '" + path.asString() + "'");
+            }
+            return doOpenEntry(Path(it->name), *it);
+        }
+
+        MappedFile::Ptr ImageFileSystem::doOpenEntry(const Path& path, const Entry& entry) const {
+            const auto* begin = m_file->begin() + entry.offset;
+            return std::make_shared<MappedFileView>(m_file, path, begin, begin + entry.size);
         }
     }
 }
@@ -24,65 +24,54 @@
 #include "IO/FileSystem.h"
 #include "IO/Path.h"
 
-#include <map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
+        /**
+         * Base class for file systems backed by an archive file such as a PAK or a WAD file.
+         *
+         * Subclasses read the archive's directory in doReadDirectory and record every file it contains by calling
+         * addEntry. The entries are kept in a flat table that is sorted by their case folded names once the directory
+         * has been read, so mounting an archive does not create any per file objects. Views of the archive's contents
+         * are only created when a file is opened.
+         */
         class ImageFileSystem : public FileSystem {
         protected:
-            class File {
-            public:
-                virtual ~File();
-                
-                MappedFile::Ptr open();
-            private:
-                virtual MappedFile::Ptr doOpen() = 0;
-            };
-            
-            class SimpleFile : public File {
-            private:
-                MappedFile::Ptr m_file;
-            public:
-                SimpleFile(MappedFile::Ptr file);
-            private:
-                MappedFile::Ptr doOpen() override;
-            };
-            
-            class Directory {
-            private:
-                typedef std::map<Path, Directory*, Path::Less<StringUtils::CaseInsensitiveStringLess>> DirMap;
-                typedef std::map<Path, File*,      Path::Less<StringUtils::CaseInsensitiveStringLess>> FileMap;
-                
-                Path m_path;
-                DirMap m_directories;
-                FileMap m_files;
-            public:
-                Directory(const Path& path);
-                ~Directory();
-                
-                void addFile(const Path& path, MappedFile::Ptr file);
-                void addFile(const Path& path, File* file);
-                
-                bool directoryExists(const Path& path) const;
-                bool fileExists(const Path& path) const;
-                
-                const Directory& findDirectory(const Path& path) const;
-                const MappedFile::Ptr findFile(const Path& path) const;
-                Path::List contents() const;
-            private:
-                Directory& findOrCreateDirectory(const Path& path);
+            struct Entry {
+                String name;
+                size_t offset;
+                size_t size;
+                size_t uncompressedSize;
+                bool compressed;
+
+                Entry(const String& i_name, size_t i_offset, size_t i_size, size_t i_uncompressedSize, bool i_compressed);
             };
+        private:
+            typedef std::vector<Entry> EntryList;
         protected:
             Path m_path;
             MappedFile::Ptr m_file;
-            Directory m_root;
+        private:
+            EntryList m_entries;
         protected:
             ImageFileSystem(const Path& path, MappedFile::Ptr file);
         public:
             virtual ~ImageFileSystem() override;
         protected:
             void initialize();
+
+            /**
+             * Records a file contained in the archive. The given name is the path of the file relative to the root of
+             * the archive, and the given offset and size denote the location of the file's data in the archive. If
+             * the archive contains several files with the same name, the last one wins.
+             */
+            void addEntry(const String& name, size_t offset, size_t size);
+            void addEntry(const String& name, size_t offset, size_t size, size_t uncompressedSize, bool compressed);
         private:
+            void sortEntries();
+            EntryList::const_iterator findEntry(const String& key) const;
+
             Path doMakeAbsolute(const Path& relPath) const override;
             bool doDirectoryExists(const Path& path) const override;
             bool doFileExists(const Path& path) const override;
@@ -91,6 +80,12 @@ namespace TrenchBroom {
             const MappedFile::Ptr doOpenFile(const Path& path) const override;
         private:
             virtual void doReadDirectory() = 0;
+        protected:
+            /**
+             * Returns the contents of the given entry. The default implementation returns a view of the entry's data
+             * in the archive.
+             */
+            virtual MappedFile::Ptr doOpenEntry(const Path& path, const Entry& entry) const;
         };
     }
 }
@@ -0,0 +1,217 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "InternedPath.h"
+
+#include "Exceptions.h"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace {
+            /*
+             * Stores every interned path as a component appended to its interned parent. The entries are kept in fixed
+             * size chunks that are never moved, so they can be read without locking once a handle to them exists.
+             */
+            class PathTable {
+            public:
+                static constexpr uint32_t EmptyPath = 0;
+                static constexpr uint32_t RootPath = 1;
+
+                struct Entry {
+                    Path path;
+                    String component;
+                    uint32_t parent;
+                    uint32_t folded;
+                    size_t hash;
+                };
+            private:
+                static constexpr size_t ChunkBits = 10;
+                static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+                static constexpr size_t MaxChunks = size_t(1) << 16;
+
+                struct Key {
+                    uint32_t parent;
+                    std::string_view component;
+
+                    bool operator==(const Key& other) const {
+                        return parent == other.parent && component == other.component;
+                    }
+                };
+
+                struct KeyHash {
+                    size_t operator()(const Key& key) const {
+                        return combineHash(key.parent, std::hash<std::string_view>()(key.component));
+                    }
+                };
+
+                std::shared_mutex m_mutex;
+                std::unordered_map<Key, uint32_t, KeyHash> m_indices;
+                std::unique_ptr<Entry[]> m_chunks[MaxChunks];
+                size_t m_count;
+            public:
+                static PathTable& instance() {
+                    static PathTable table;
+                    return table;
+                }
+
+                const Entry& entry(const uint32_t index) const {
+                    return m_chunks[index >> ChunkBits][index & (ChunkSize - 1)];
+                }
+
+                uint32_t child(const uint32_t parent, const String& component) {
+                    {
+                        std::shared_lock<std::shared_mutex> lock(m_mutex);
+                        const auto it = m_indices.find(Key{ parent, component });
+                        if (it != std::end(m_indices)) {
+                            return it->second;
+                        }
+                    }
+
+                    // intern the lower case variant first, this takes the lock again
+                    const String lowerCaseComponent = StringUtils::toLower(component);
+                    const uint32_t foldedParent = entry(parent).folded;
+                    const bool isFolded = foldedParent == parent && lowerCaseComponent == component;
+                    const uint32_t folded = isFolded ? 0 : child(foldedParent, lowerCaseComponent);
+
+                    std::unique_lock<std::shared_mutex> lock(m_mutex);
+                    const auto it = m_indices.find(Key{ parent, component });
+                    if (it != std::end(m_indices)) {
+                        return it->second;
+                    }
+
+                    const Entry& parentEntry = entry(parent);
+                    const uint32_t index = add(parentEntry.path + Path(component), component, parent, folded, combineHash(parentEntry.hash, std::hash<String>()(component)));
+                    if (isFolded) {
+                        entryAt(index).folded = index;
+                    }
+
+                    const Entry& childEntry = entry(index);
+                    m_indices.insert(std::make_pair(Key{ parent, childEntry.component }, index));
+                    return index;
+                }
+            private:
+                PathTable() :
+                m_count(0) {
+                    add(Path(""), "", EmptyPath, EmptyPath, 0);
+                    add(Path(String(1, Path::separator())), "", RootPath, RootPath, 1);
+                }
+
+                static size_t combineHash(const size_t seed, const size_t hash) {
+                    return seed ^ (hash + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+                }
+
+                Entry& entryAt(const size_t index) {
+                    return m_chunks[index >> ChunkBits][index & (ChunkSize - 1)];
+                }
+
+                uint32_t add(const Path& path, const String& component, const uint32_t parent, const uint32_t folded, const size_t hash) {
+                    const size_t index = m_count;
+                    const size_t chunk = index >> ChunkBits;
+                    if (chunk >= MaxChunks) {
+                        throw PathException("Too many interned paths");
+                    }
+                    if (m_chunks[chunk] == nullptr) {
+                        m_chunks[chunk].reset(new Entry[ChunkSize]);
+                    }
+
+                    Entry& entry = entryAt(index);
+                    entry.path = path;
+                    entry.component = component;
+                    entry.parent = parent;
+                    entry.folded = folded;
+                    entry.hash = hash;
+
+                    ++m_count;
+                    return static_cast<uint32_t>(index);
+                }
+            };
+        }
+
+        static uint32_t appendComponents(uint32_t index, const StringList& components) {
+            auto& table = PathTable::instance();
+            for (const String& component : components) {
+                if (component == ".") {
+                    continue;
+                }
+
+                const auto& entry = table.entry(index);
+                if (component == ".." && !entry.component.empty() && entry.component != "..") {
+                    index = entry.parent;
+                } else {
+                    index = table.child(index, component);
+                }
+            }
+            return index;
+        }
+
+        InternedPath::InternedPath(const uint32_t index) :
+        m_index(index) {}
+
+        InternedPath::InternedPath() :
+        m_index(PathTable::EmptyPath) {}
+
+        InternedPath::InternedPath(const Path& path) :
+        m_index(appendComponents(path.isAbsolute() ? PathTable::RootPath : PathTable::EmptyPath, path.m_components)) {}
+
+        InternedPath InternedPath::operator+(const Path& rhs) const {
+            if (rhs.isAbsolute())
+                throw PathException("Cannot concatenate absolute path");
+            return InternedPath(appendComponents(m_index, rhs.m_components));
+        }
+
+        bool InternedPath::operator==(const InternedPath& rhs) const {
+            return m_index == rhs.m_index;
+        }
+
+        bool InternedPath::operator!=(const InternedPath& rhs) const {
+            return m_index != rhs.m_index;
+        }
+
+        bool InternedPath::operator<(const InternedPath& rhs) const {
+            return m_index < rhs.m_index;
+        }
+
+        const Path& InternedPath::path() const {
+            return PathTable::instance().entry(m_index).path;
+        }
+
+        bool InternedPath::isEmpty() const {
+            return m_index == PathTable::EmptyPath || m_index == PathTable::RootPath;
+        }
+
+        InternedPath InternedPath::deleteLastComponent() const {
+            return InternedPath(PathTable::instance().entry(m_index).parent);
+        }
+
+        InternedPath InternedPath::caseFolded() const {
+            return InternedPath(PathTable::instance().entry(m_index).folded);
+        }
+
+        size_t InternedPath::hash() const {
+            return PathTable::instance().entry(m_index).hash;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_InternedPath
+#define TrenchBroom_InternedPath
+
+#include "StringUtils.h"
+#include "IO/Path.h"
+
+#include <cstdint>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * A handle to a canonical path in a global, thread safe table. Every prefix of an interned path is stored once
+         * along with its hash and its lower case variant, so handles are compared, hashed, shortened and case folded in
+         * constant time and without allocating. Interning a path only allocates when one of its prefixes is seen for
+         * the first time.
+         *
+         * Interned paths are never released, so only paths from a bounded set such as asset paths should be interned.
+         */
+        class InternedPath {
+        public:
+            struct Hash {
+                size_t operator()(const InternedPath& path) const {
+                    return path.hash();
+                }
+            };
+        private:
+            uint32_t m_index;
+
+            explicit InternedPath(uint32_t index);
+        public:
+            /**
+             * Creates an empty relative path.
+             */
+            InternedPath();
+
+            /**
+             * Interns the canonical form of the given path. Unlike Path::makeCanonical, leading ".." components that
+             * cannot be resolved are kept.
+             */
+            explicit InternedPath(const Path& path);
+
+            InternedPath operator+(const Path& rhs) const;
+
+            /**
+             * Compares the handles, which orders paths by the time they were first interned.
+             */
+            bool operator==(const InternedPath& rhs) const;
+            bool operator!=(const InternedPath& rhs) const;
+            bool operator<(const InternedPath& rhs) const;
+
+            const Path& path() const;
+            bool isEmpty() const;
+            InternedPath deleteLastComponent() const;
+
+            /**
+             * Returns the interned lower case variant of this path.
+             */
+            InternedPath caseFolded() const;
+            size_t hash() const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_InternedPath) */
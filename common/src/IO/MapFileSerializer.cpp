@@ -19,128 +19,113 @@
 
 #include "MapFileSerializer.h"
 #include "Exceptions.h"
+#include "Parallel.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/NumberFormatter.h"
 #include "IO/Path.h"
+#include "Model/Brush.h"
 #include "Model/BrushFace.h"
 
+#include <algorithm>
+#include <memory>
+
 namespace TrenchBroom {
     namespace IO {
         class QuakeFileSerializer : public MapFileSerializer {
-        private:
-            String FacePointFormat;
-            String TextureInfoFormat;
         public:
             QuakeFileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g )";
-
-                FacePointFormat = str.str();
-                TextureInfoFormat = " %s %.6g %.6g %.6g %.6g %.6g";
-            }
+            MapFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
-                std::fprintf(stream, "\n");
-                return 1;
+            void doWriteBrushFace(String& buffer, const FaceData& face) const override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
+                buffer += '\n';
             }
         protected:
-            void writeFacePoints(FILE* stream, Model::BrushFace* face) {
-                const Model::BrushFace::Points& points = face->points();
-
-                std::fprintf(stream, FacePointFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z());
+            void writeFacePoints(String& buffer, const FaceData& face) const {
+                const Model::BrushFace::Points& points = face.points;
+
+                for (size_t i = 0; i < 3; ++i) {
+                    buffer += i == 0 ? "( " : " ( ";
+                    writeDecimal(buffer, points[i].x(), FloatPrecision);
+                    buffer += ' ';
+                    writeDecimal(buffer, points[i].y(), FloatPrecision);
+                    buffer += ' ';
+                    writeDecimal(buffer, points[i].z(), FloatPrecision);
+                    buffer += " )";
+                }
             }
 
-            void writeTextureInfo(FILE* stream, Model::BrushFace* face) {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                std::fprintf(stream, TextureInfoFormat.c_str(),
-                             textureName.c_str(),
-                             face->xOffset(),
-                             face->yOffset(),
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+            void writeTextureInfo(String& buffer, const FaceData& face) const {
+                const String& textureName = face.attributes.textureName().empty() ? Model::BrushFace::NoTextureName : face.attributes.textureName();
+                buffer += ' ';
+                buffer += textureName;
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.xOffset(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.yOffset(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.rotation(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.xScale(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.yScale(), 6);
             }
         };
 
         class Quake2FileSerializer : public QuakeFileSerializer {
-        private:
-            String SurfaceAttributesFormat;
         public:
             Quake2FileSerializer(FILE* stream) :
-            QuakeFileSerializer(stream) {
-                SurfaceAttributesFormat = " %d %d %.6g";
-            }
+            QuakeFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
+            void doWriteBrushFace(String& buffer, const FaceData& face) const override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
 
-                if (face->hasSurfaceAttributes()) {
-                    writeSurfaceAttributes(stream, face);
+                if (face.hasSurfaceAttributes()) {
+                    writeSurfaceAttributes(buffer, face);
                 }
 
-                std::fprintf(stream, "\n");
-                return 1;
+                buffer += '\n';
             }
         protected:
-            void writeSurfaceAttributes(FILE* stream, Model::BrushFace* face) {
-                std::fprintf(stream, SurfaceAttributesFormat.c_str(),
-                             face->surfaceContents(),
-                             face->surfaceFlags(),
-                             face->surfaceValue());
+            void writeSurfaceAttributes(String& buffer, const FaceData& face) const {
+                buffer += ' ';
+                writeInteger(buffer, face.attributes.surfaceContents());
+                buffer += ' ';
+                writeInteger(buffer, face.attributes.surfaceFlags());
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.surfaceValue(), 6);
             }
         };
 
 
         class DaikatanaFileSerializer : public Quake2FileSerializer {
-        private:
-            String SurfaceColorFormat;
         public:
             DaikatanaFileSerializer(FILE* stream) :
-            Quake2FileSerializer(stream) {
-                SurfaceColorFormat = " %d %d %d";
-            }
+            Quake2FileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
+            void doWriteBrushFace(String& buffer, const FaceData& face) const override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
 
-                if (face->hasSurfaceAttributes() || face->hasColor()) {
-                    writeSurfaceAttributes(stream, face);
+                if (face.hasSurfaceAttributes() || face.hasColor()) {
+                    writeSurfaceAttributes(buffer, face);
                 }
-                if (face->hasColor()) {
-                    writeSurfaceColor(stream, face);
+                if (face.hasColor()) {
+                    writeSurfaceColor(buffer, face);
                 }
 
-                std::fprintf(stream, "\n");
-                return 1;
+                buffer += '\n';
             }
         protected:
-            void writeSurfaceColor(FILE* stream, Model::BrushFace* face) {
-                std::fprintf(stream, SurfaceColorFormat.c_str(),
-                             static_cast<int>(face->color().r()),
-                             static_cast<int>(face->color().g()),
-                             static_cast<int>(face->color().b()));
+            void writeSurfaceColor(String& buffer, const FaceData& face) const {
+                buffer += ' ';
+                writeInteger(buffer, static_cast<int>(face.attributes.color().r()));
+                buffer += ' ';
+                writeInteger(buffer, static_cast<int>(face.attributes.color().g()));
+                buffer += ' ';
+                writeInteger(buffer, static_cast<int>(face.attributes.color().b()));
             }
         };
 
@@ -149,124 +134,173 @@ namespace TrenchBroom {
             Hexen2FileSerializer(FILE* stream):
             QuakeFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
-                std::fprintf(stream, "0 \n"); // extra value written here
-                return 1;
+            void doWriteBrushFace(String& buffer, const FaceData& face) const override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
+                buffer += "0 \n"; // extra value written here
             }
         };
         
         class ValveFileSerializer : public QuakeFileSerializer {
-        private:
-            String ValveTextureInfoFormat;
         public:
             ValveFileSerializer(FILE* stream) :
-            QuakeFileSerializer(stream),
-            ValveTextureInfoFormat(" %s [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g") {}
+            QuakeFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeValveTextureInfo(stream, face);
-                std::fprintf(stream, "\n");
-                return 1;
+            void doWriteBrushFace(String& buffer, const FaceData& face) const override {
+                writeFacePoints(buffer, face);
+                writeValveTextureInfo(buffer, face);
+                buffer += '\n';
             }
         private:
-            void writeValveTextureInfo(FILE* stream, Model::BrushFace* face) {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const vm::vec3 xAxis = face->textureXAxis();
-                const vm::vec3 yAxis = face->textureYAxis();
-
-                std::fprintf(stream, ValveTextureInfoFormat.c_str(),
-                             textureName.c_str(),
-
-                             xAxis.x(),
-                             xAxis.y(),
-                             xAxis.z(),
-                             face->xOffset(),
-
-                             yAxis.x(),
-                             yAxis.y(),
-                             yAxis.z(),
-                             face->yOffset(),
-
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+            void writeValveTextureInfo(String& buffer, const FaceData& face) const {
+                const String& textureName = face.attributes.textureName().empty() ? Model::BrushFace::NoTextureName : face.attributes.textureName();
+                const vm::vec3& xAxis = face.textureXAxis;
+                const vm::vec3& yAxis = face.textureYAxis;
+
+                buffer += ' ';
+                buffer += textureName;
+
+                buffer += " [ ";
+                writeDecimal(buffer, xAxis.x(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, xAxis.y(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, xAxis.z(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.xOffset(), 6);
+
+                buffer += " ] [ ";
+                writeDecimal(buffer, yAxis.x(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, yAxis.y(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, yAxis.z(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.yOffset(), 6);
+
+                buffer += " ] ";
+                writeDecimal(buffer, face.attributes.rotation(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.xScale(), 6);
+                buffer += ' ';
+                writeDecimal(buffer, face.attributes.yScale(), 6);
             }
         };
 
-        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat::Type format, FILE* stream) {
+        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat::Type format, FILE* stream, const size_t threadCount) {
+            return NodeSerializer::Ptr(createFileSerializer(format, stream, threadCount).release());
+        }
+
+        std::unique_ptr<MapFileSerializer> MapFileSerializer::createFileSerializer(const Model::MapFormat::Type format, FILE* stream, const size_t threadCount) {
+            std::unique_ptr<MapFileSerializer> serializer;
             switch (format) {
                 case Model::MapFormat::Standard:
-                    return NodeSerializer::Ptr(new QuakeFileSerializer(stream));
+                    serializer.reset(new QuakeFileSerializer(stream));
+                    break;
                 case Model::MapFormat::Quake2:
-                    return NodeSerializer::Ptr(new Quake2FileSerializer(stream));
+                    serializer.reset(new Quake2FileSerializer(stream));
+                    break;
                 case Model::MapFormat::Daikatana:
-                    return NodeSerializer::Ptr(new DaikatanaFileSerializer(stream));
+                    serializer.reset(new DaikatanaFileSerializer(stream));
+                    break;
                 case Model::MapFormat::Valve:
-                    return NodeSerializer::Ptr(new ValveFileSerializer(stream));
+                    serializer.reset(new ValveFileSerializer(stream));
+                    break;
                 case Model::MapFormat::Hexen2:
-                    return NodeSerializer::Ptr(new Hexen2FileSerializer(stream));
+                    serializer.reset(new Hexen2FileSerializer(stream));
+                    break;
                 case Model::MapFormat::Unknown:
                 default:
                     throw FileFormatException("Unknown map file format");
             }
+            serializer->m_threadCount = threadCount;
+            return serializer;
         }
         
         MapFileSerializer::MapFileSerializer(FILE* stream) :
         m_line(1),
-        m_stream(stream) {
-            ensure(m_stream != nullptr, "stream is null");
+        m_inBrush(false),
+        m_stream(stream),
+        m_threadCount(1) {}
+
+        MapFileSerializer::Output MapFileSerializer::takeOutput() {
+            closeBlock();
+
+            Output result;
+            using std::swap;
+            swap(result, m_output);
+            return result;
         }
-        
+
         void MapFileSerializer::doBeginFile() {}
-        void MapFileSerializer::doEndFile() {}
+
+        void MapFileSerializer::doEndFile() {
+            if (m_stream != nullptr)
+                flush();
+        }
 
         void MapFileSerializer::doBeginEntity(const Model::Node* node) {
-            std::fprintf(m_stream, "// entity %u\n", entityNo());
+            writeObjectNo("// entity ", entityNo());
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            write("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndEntity(Model::Node* node) {
-            std::fprintf(m_stream, "}\n");
+            write("}\n");
             ++m_line;
             setFilePosition(node);
         }
         
         void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) { 
-            std::fprintf(m_stream, "\"%s\" \"%s\"\n",
-                         escapeEntityAttribute( attribute.name()).c_str(),
-                         escapeEntityAttribute(attribute.value()).c_str());
+            write("\"");
+            write(escapeEntityAttribute(attribute.name()));
+            write("\" \"");
+            write(escapeEntityAttribute(attribute.value()));
+            write("\"\n");
             ++m_line;
         }
         
         void MapFileSerializer::doBeginBrush(const Model::Brush* brush) {
-            std::fprintf(m_stream, "// brush %u\n", brushNo());
+            writeObjectNo("// brush ", brushNo());
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            write("{\n");
             ++m_line;
+
+            // the faces are formatted when the pending output is flushed
+            m_output.brushes.push_back(brush->faceData());
+            m_inBrush = true;
         }
         
         void MapFileSerializer::doEndBrush(Model::Brush* brush) {
-            std::fprintf(m_stream, "}\n");
+            m_inBrush = false;
+            write("}\n");
             ++m_line;
             setFilePosition(brush);
+
+            if (m_stream != nullptr && m_output.brushes.size() >= MaxPendingBrushes)
+                flush();
         }
         
         void MapFileSerializer::doBrushFace(Model::BrushFace* face) {
-            const size_t lines = doWriteBrushFace(m_stream, face);
-            face->setFilePosition(m_line, lines);
-            m_line += lines;
+            if (m_stream != nullptr)
+                face->setFilePosition(m_line, 1);
+            ++m_line;
+
+            // faces that are serialized without their brush, e.g. when copying faces, must be queued one by one
+            if (!m_inBrush) {
+                m_output.brushes.push_back(std::make_shared<const BrushFaceDataList>(1, BrushFaceData(face)));
+                if (m_stream != nullptr && m_output.brushes.size() >= MaxPendingBrushes)
+                    flush();
+            }
         }
         
         void MapFileSerializer::setFilePosition(Model::Node* node) {
             const size_t start = startLine();
-            node->setFilePosition(start, m_line - start);
+            if (m_stream != nullptr)
+                node->setFilePosition(start, m_line - start);
         }
 
         size_t MapFileSerializer::startLine() {
@@ -275,5 +309,92 @@ namespace TrenchBroom {
             m_startLineStack.pop_back();
             return result;
         }
+
+        void MapFileSerializer::write(const char* str) {
+            // text that follows a brush starts a new block
+            const size_t brushesBegin = m_output.blocks.empty() ? 0 : m_output.blocks.back().brushesEnd;
+            if (m_output.brushes.size() > brushesBegin)
+                closeBlock();
+            m_output.text += str;
+        }
+
+        void MapFileSerializer::write(const String& str) {
+            write(str.c_str());
+        }
+
+        void MapFileSerializer::writeObjectNo(const char* prefix, const ObjectNo no) {
+            write(prefix);
+            writeInteger(m_output.text, static_cast<long>(no));
+            m_output.text += '\n';
+        }
+
+        void MapFileSerializer::closeBlock() {
+            m_output.blocks.push_back(Block { m_output.text.size(), m_output.brushes.size() });
+        }
+
+        void MapFileSerializer::flush() {
+            closeBlock();
+            writeOutput(m_output);
+
+            m_output.text.clear();
+            m_output.brushes.clear();
+            m_output.blocks.clear();
+        }
+
+        void MapFileSerializer::writeOutput(const Output& output) const {
+            ensure(m_stream != nullptr, "stream is null");
+
+            const String& text = output.text;
+            const BrushList& brushes = output.brushes;
+            const BlockList& blocks = output.blocks;
+            if (blocks.empty())
+                return;
+
+            // split the blocks into runs with roughly the same number of brushes
+            const size_t runCount = std::min(blocks.size(), m_threadCount > 1 ? 4 * m_threadCount : size_t(1));
+            std::vector<size_t> runEnds;
+            runEnds.reserve(runCount);
+            for (size_t i = 0; i < blocks.size() && runEnds.size() + 1 < runCount; ++i) {
+                if (blocks[i].brushesEnd * runCount >= (runEnds.size() + 1) * brushes.size())
+                    runEnds.push_back(i + 1);
+            }
+            if (runEnds.empty() || runEnds.back() != blocks.size())
+                runEnds.push_back(blocks.size());
+
+            std::vector<String> runs(runEnds.size());
+            parallelFor(runs.size(), m_threadCount, [&](const size_t run) {
+                String& buffer = runs[run];
+                size_t i = run > 0 ? runEnds[run - 1] : 0;
+                size_t textBegin = i > 0 ? blocks[i - 1].textEnd : 0;
+                size_t brushesBegin = i > 0 ? blocks[i - 1].brushesEnd : 0;
+
+                buffer.reserve((blocks[runEnds[run] - 1].brushesEnd - brushesBegin) * 6 * 96);
+                for (; i < runEnds[run]; ++i) {
+                    const Block& block = blocks[i];
+                    buffer.append(text, textBegin, block.textEnd - textBegin);
+                    for (size_t j = brushesBegin; j < block.brushesEnd; ++j) {
+                        for (const FaceData& face : *brushes[j])
+                            doWriteBrushFace(buffer, face);
+                    }
+                    textBegin = block.textEnd;
+                    brushesBegin = block.brushesEnd;
+                }
+            });
+
+            for (const String& run : runs) {
+                if (std::fwrite(run.data(), 1, run.size(), m_stream) != run.size())
+                    throw FileSystemException("Could not write map file");
+            }
+        }
+
+        void MapFileSerializer::writeDecimal(String& buffer, const double value, const int precision) {
+            char str[MaxFormattedNumberLength];
+            buffer.append(str, formatDecimal(value, precision, str));
+        }
+
+        void MapFileSerializer::writeInteger(String& buffer, const long value) {
+            char str[MaxFormattedNumberLength];
+            buffer.append(str, formatInteger(value, str));
+        }
     }
 }
@@ -20,27 +20,79 @@
 #ifndef TrenchBroom_MapFileSerializer
 #define TrenchBroom_MapFileSerializer
 
+#include "IO/BrushFaceData.h"
 #include "IO/NodeSerializer.h"
 #include "Model/MapFormat.h"
-#include "Model/Brush.h"
 #include "Model/Node.h"
 
 #include <cstdio>
+#include <memory>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
         class Path;
         
+        /**
+         * Writes map files in the formats of the Quake engine family. The output is collected in a buffer and written
+         * in large blocks. The brush faces are formatted whenever the buffer is flushed, and if more than one thread
+         * is used, the pending brushes are split into runs which are formatted in parallel and written in order. The
+         * pending brushes are kept as the face data that the brushes cache, so serializing a brush copies no faces.
+         *
+         * If no stream is given, the output is kept in memory until it is taken with takeOutput. In that case, the file
+         * positions of the nodes are left unchanged, since the output is not written to the file they refer to.
+         */
         class MapFileSerializer : public NodeSerializer {
+        public:
+            typedef BrushFaceData FaceData;
+            typedef std::vector<BrushFaceDataListPtr> BrushList;
+
+            /**
+             * A part of the pending output, consisting of the text that was written since the previous part, followed
+             * by a number of brushes. Both are given by their end offsets into the pending text and brushes.
+             */
+            struct Block {
+                size_t textEnd;
+                size_t brushesEnd;
+            };
+            typedef std::vector<Block> BlockList;
+
+            /**
+             * Output that has been serialized, but not written yet. It does not refer to any nodes.
+             */
+            struct Output {
+                String text;
+                BrushList brushes;
+                BlockList blocks;
+            };
         private:
             typedef std::vector<size_t> LineStack;
+
+            static const size_t MaxPendingBrushes = 4096;
+
             LineStack m_startLineStack;
             size_t m_line;
+            // whether the faces passed to doBrushFace belong to a brush whose face data has been queued already
+            bool m_inBrush;
             FILE* m_stream;
+            size_t m_threadCount;
+
+            Output m_output;
         public:
-            static Ptr create(Model::MapFormat::Type format, FILE* stream);
+            static Ptr create(Model::MapFormat::Type format, FILE* stream, size_t threadCount = 1);
+            static std::unique_ptr<MapFileSerializer> createFileSerializer(Model::MapFormat::Type format, FILE* stream, size_t threadCount = 1);
         protected:
             MapFileSerializer(FILE* file);
+        public:
+            /**
+             * Returns the output that has not been written yet and clears it.
+             */
+            Output takeOutput();
+
+            /**
+             * Writes the given output to the stream. This does not change the state of this serializer.
+             */
+            void writeOutput(const Output& output) const;
         private:
             void doBeginFile() override;
             void doEndFile() override;
@@ -54,8 +106,21 @@ namespace TrenchBroom {
         private:
             void setFilePosition(Model::Node* node);
             size_t startLine();
+
+            void write(const char* str);
+            void write(const String& str);
+            void writeObjectNo(const char* prefix, ObjectNo no);
+            void closeBlock();
+            void flush();
+        protected:
+            static void writeDecimal(String& buffer, double value, int precision);
+            static void writeInteger(String& buffer, long value);
         private:
-            virtual size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) = 0;
+            /**
+             * Writes the given face on a single line, including the line break. This may be called concurrently for
+             * different faces.
+             */
+            virtual void doWriteBrushFace(String& buffer, const FaceData& face) const = 0;
         };
     }
 }
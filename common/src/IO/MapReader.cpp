@@ -28,6 +28,7 @@
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/ModelFactory.h"
+#include "Parallel.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -59,27 +60,43 @@ namespace TrenchBroom {
         StandardMapParser(begin, end),
         m_factory(nullptr),
         m_brushParent(nullptr),
-        m_currentNode(nullptr) {}
+        m_currentNode(nullptr),
+        m_threadCount(1) {}
         
         MapReader::MapReader(const String& str) :
         StandardMapParser(str),
         m_factory(nullptr),
         m_brushParent(nullptr),
-        m_currentNode(nullptr) {}
+        m_currentNode(nullptr),
+        m_threadCount(1) {}
         
         MapReader::~MapReader() {
             VectorUtils::clearAndDelete(m_faces);
+            for (auto& deferredBrush : m_deferredBrushes) {
+                VectorUtils::clearAndDelete(deferredBrush.faces);
+                delete deferredBrush.brush;
+            }
+            // nodes that were parsed, but not added because parsing failed
+            for (auto& entry : m_deferredNodes) {
+                delete entry.second;
+            }
+        }
+
+        void MapReader::setThreadCount(const size_t threadCount) {
+            m_threadCount = threadCount;
         }
 
         void MapReader::readEntities(Model::MapFormat::Type format, const vm::bbox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
-            parseEntities(format, status);
+            parseEntitiesInParallel(format, m_threadCount, status);
+            createDeferredBrushes(status);
             resolveNodes(status);
         }
         
         void MapReader::readBrushes(Model::MapFormat::Type format, const vm::bbox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
             parseBrushes(format, status);
+            createDeferredBrushes(status);
         }
         
         void MapReader::readBrushFaces(Model::MapFormat::Type format, const vm::bbox3& worldBounds, ParserStatus& status) {
@@ -223,16 +240,20 @@ namespace TrenchBroom {
         }
 
         void MapReader::createBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            if (m_threadCount > 1) {
+                m_deferredBrushes.push_back(DeferredBrush { m_faces, startLine, lineCount, extraAttributes, nullptr, "" });
+                m_deferredNodes.push_back(std::make_pair(m_brushParent, nullptr));
+                m_faces.clear();
+                return;
+            }
+
             try {
                 // sort the faces by the weight of their plane normals like QBSP does
                 Model::BrushFace::sortFaces(m_faces);
                 
                 Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces);
-                setFilePosition(brush, startLine, lineCount);
-                setExtraAttributes(brush, extraAttributes);
-                
-                onBrush(m_brushParent, brush, status);
                 m_faces.clear();
+                addBrush(m_brushParent, brush, startLine, lineCount, extraAttributes, status);
             } catch (GeometryException& e) {
                 StringStream msg;
                 msg << "Skipping brush: " << e.what();
@@ -242,6 +263,63 @@ namespace TrenchBroom {
 
         }
 
+        void MapReader::createDeferredBrushes(ParserStatus& status) {
+            if (m_deferredBrushes.empty() && m_deferredNodes.empty())
+                return;
+
+            // Only the brush geometry is built on the worker threads. Errors are reported and the nodes are added
+            // on this thread, in file order, so that the result does not depend on the number of threads.
+            parallelFor(m_deferredBrushes.size(), m_threadCount, [this](const size_t index) {
+                DeferredBrush& deferredBrush = m_deferredBrushes[index];
+                try {
+                    // sort the faces by the weight of their plane normals like QBSP does
+                    Model::BrushFace::sortFaces(deferredBrush.faces);
+                    deferredBrush.brush = m_factory->createBrush(m_worldBounds, deferredBrush.faces);
+                } catch (GeometryException& e) {
+                    deferredBrush.error = e.what();
+                }
+                deferredBrush.faces.clear(); // the faces are now owned by the brush or have been deleted by its constructor
+            });
+
+            size_t brushIndex = 0;
+            for (auto& entry : m_deferredNodes) {
+                Model::Node* parent = entry.first;
+                Model::Node* node = entry.second;
+                if (node != nullptr) {
+                    entry.second = nullptr; // the node is now owned by its parent
+                    onNode(parent, node, status);
+                } else {
+                    DeferredBrush& deferredBrush = m_deferredBrushes[brushIndex++];
+                    if (deferredBrush.brush != nullptr) {
+                        Model::Brush* brush = deferredBrush.brush;
+                        deferredBrush.brush = nullptr; // the brush is now owned by its parent
+                        addBrush(parent, brush, deferredBrush.startLine, deferredBrush.lineCount, deferredBrush.extraAttributes, status);
+                    } else {
+                        StringStream msg;
+                        msg << "Skipping brush: " << deferredBrush.error;
+                        status.error(deferredBrush.startLine, msg.str());
+                    }
+                }
+            }
+            assert(brushIndex == m_deferredBrushes.size());
+
+            m_deferredBrushes.clear();
+            m_deferredNodes.clear();
+        }
+
+        void MapReader::addBrush(Model::Node* parent, Model::Brush* brush, const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            setFilePosition(brush, startLine, lineCount);
+            setExtraAttributes(brush, extraAttributes);
+            onBrush(parent, brush, status);
+        }
+
+        void MapReader::addNode(Model::Node* parent, Model::Node* node, ParserStatus& status) {
+            if (m_threadCount > 1)
+                m_deferredNodes.push_back(std::make_pair(parent, node));
+            else
+                onNode(parent, node, status);
+        }
+
         MapReader::ParentInfo::Type MapReader::storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status) {
             const String& layerIdStr = findAttribute(attributes, Model::AttributeNames::Layer);
             if (!StringUtils::isBlank(layerIdStr)) {
@@ -250,7 +328,7 @@ namespace TrenchBroom {
                     const Model::IdType layerId = static_cast<Model::IdType>(rawId);
                     Model::Layer* layer = MapUtils::find(m_layers, layerId, static_cast<Model::Layer*>(nullptr));
                     if (layer != nullptr)
-                        onNode(layer, node, status);
+                        addNode(layer, node, status);
                     else
                         m_unresolvedNodes.push_back(std::make_pair(node, ParentInfo::layer(layerId)));
                     return ParentInfo::Type_Layer;
@@ -267,7 +345,7 @@ namespace TrenchBroom {
                         const Model::IdType groupId = static_cast<Model::IdType>(rawId);
                         Model::Group* group = MapUtils::find(m_groups, groupId, static_cast<Model::Group*>(nullptr));
                         if (group != nullptr)
-                            onNode(group, node, status);
+                            addNode(group, node, status);
                         else
                             m_unresolvedNodes.push_back(std::make_pair(node, ParentInfo::group(groupId)));
                         return ParentInfo::Type_Group;
@@ -279,7 +357,7 @@ namespace TrenchBroom {
                 }
             }
             
-            onNode(nullptr, node, status);
+            addNode(nullptr, node, status);
             return ParentInfo::Type_None;
         }
 
@@ -70,6 +70,26 @@ namespace TrenchBroom {
             
             typedef std::pair<Model::Node*, ParentInfo> NodeParentPair;
             typedef std::vector<NodeParentPair> NodeParentList;
+
+            /**
+             * A brush whose geometry is built after the entire file has been parsed.
+             */
+            struct DeferredBrush {
+                Model::BrushFaceList faces;
+                size_t startLine;
+                size_t lineCount;
+                ExtraAttributes extraAttributes;
+                Model::Brush* brush;
+                String error;
+            };
+            typedef std::vector<DeferredBrush> DeferredBrushList;
+
+            /**
+             * Records that the given node must be added to the given parent. If the node is null, the next deferred
+             * brush is added instead. This keeps the order of the children identical to the order in the file.
+             */
+            typedef std::pair<Model::Node*, Model::Node*> ParentNodePair;
+            typedef std::vector<ParentNodePair> ParentNodeList;
             
             vm::bbox3 m_worldBounds;
             Model::ModelFactory* m_factory;
@@ -81,6 +101,10 @@ namespace TrenchBroom {
             LayerMap m_layers;
             GroupMap m_groups;
             NodeParentList m_unresolvedNodes;
+
+            size_t m_threadCount;
+            DeferredBrushList m_deferredBrushes;
+            ParentNodeList m_deferredNodes;
         protected:
             MapReader(const char* begin, const char* end);
             MapReader(const String& str);
@@ -90,6 +114,16 @@ namespace TrenchBroom {
             void readBrushFaces(Model::MapFormat::Type format, const vm::bbox3& worldBounds, ParserStatus& status);
         public:
             virtual ~MapReader() override;
+
+            /**
+             * Sets the number of threads used to parse entities and to build the brush geometry. If the given number
+             * is greater than 1, large files are split into chunks of entities that are parsed on worker threads, and
+             * the brush geometry is built on worker threads once the entire file has been parsed. Otherwise, each
+             * brush is built immediately when it is parsed. In either case, the resulting node tree is the same.
+             *
+             * @param threadCount the number of threads
+             */
+            void setThreadCount(size_t threadCount);
         private: // implement MapParser interface
             void onFormatSet(Model::MapFormat::Type format) override;
             void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) override;
@@ -102,6 +136,9 @@ namespace TrenchBroom {
             void createGroup(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void createEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
             void createBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status);
+            void createDeferredBrushes(ParserStatus& status);
+            void addBrush(Model::Node* parent, Model::Brush* brush, size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status);
+            void addNode(Model::Node* parent, Model::Node* node, ParserStatus& status);
 
             ParentInfo::Type storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status);
             void stripParentAttributes(Model::AttributableNode* attributable, ParentInfo::Type parentType);
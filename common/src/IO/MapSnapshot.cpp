@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MapSnapshot.h"
+
+#include "Exceptions.h"
+#include "IO/DiskIO.h"
+#include "IO/IOUtils.h"
+#include "IO/NodeWriter.h"
+#include "IO/Path.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        MapSnapshot::MapSnapshot(const Model::MapFormat::Type format, const String& gameName, MapFileSerializer::Output output) :
+        m_format(format),
+        m_gameName(gameName),
+        m_output(std::move(output)) {}
+
+        MapSnapshot::Ptr MapSnapshot::take(Model::World* world, const String& gameName) {
+            // the writer takes ownership of the serializer
+            MapFileSerializer* serializer = MapFileSerializer::createFileSerializer(world->format(), nullptr).release();
+            NodeWriter writer(world, serializer);
+            writer.writeMap();
+
+            return std::make_shared<MapSnapshot>(world->format(), gameName, serializer->takeOutput());
+        }
+
+        void MapSnapshot::write(const Path& path, const size_t threadCount) const {
+            const Path tempPath = path.addExtension("tmp");
+            {
+                OpenFile open(tempPath, true);
+                writeGameComment(open.file, m_gameName, Model::formatName(m_format));
+
+                const std::unique_ptr<MapFileSerializer> serializer = MapFileSerializer::createFileSerializer(m_format, open.file, threadCount);
+                serializer->writeOutput(m_output);
+
+                if (std::fflush(open.file) != 0 || std::ferror(open.file) != 0)
+                    throw FileSystemException("Could not write map file: " + tempPath.asString());
+            }
+            Disk::moveFile(tempPath, path, true);
+        }
+    }
+}
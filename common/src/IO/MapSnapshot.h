@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_MapSnapshot
+#define TrenchBroom_MapSnapshot
+
+#include "StringUtils.h"
+#include "IO/MapFileSerializer.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <memory>
+
+namespace TrenchBroom {
+    namespace IO {
+        class Path;
+
+        /**
+         * An immutable copy of the contents of a map file. Taking a snapshot serializes the entities and shares the
+         * immutable face data that the brushes cache, so it neither copies nor formats any faces. Brushes that have not
+         * changed since the last snapshot reuse their cached face data. The snapshot does not refer to the world, so it
+         * can be written on another thread while the map is being edited.
+         *
+         * Taking a snapshot still visits every node and formats every entity, so its cost is linear in the size of the
+         * map even if nothing has changed.
+         */
+        class MapSnapshot {
+        public:
+            typedef std::shared_ptr<const MapSnapshot> Ptr;
+        private:
+            Model::MapFormat::Type m_format;
+            String m_gameName;
+            MapFileSerializer::Output m_output;
+        public:
+            MapSnapshot(Model::MapFormat::Type format, const String& gameName, MapFileSerializer::Output output);
+
+            /**
+             * Takes a snapshot of the given world. This must be called on the thread that owns the world. Unlike
+             * writing the map, this does not change the file positions of the nodes.
+             */
+            static Ptr take(Model::World* world, const String& gameName);
+
+            /**
+             * Writes this snapshot to the given path. The data is written to a temporary file first, which is then
+             * renamed, so that the file at the given path is either replaced entirely or not at all. This may be
+             * called on any thread.
+             */
+            void write(const Path& path, size_t threadCount) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapSnapshot) */
@@ -228,6 +228,13 @@ namespace TrenchBroom {
         /* m_end(end), */
         m_palette(palette),
         m_fs(fs) {}
+
+        Md2Parser::Md2Parser(const String& name, MappedFile::Ptr file, const Assets::Palette& palette, const FileSystem& fs) :
+        m_name(name),
+        m_begin(file->begin()),
+        m_file(std::move(file)),
+        m_palette(palette),
+        m_fs(fs) {}
         
         // http://tfc.duke.free.fr/old/models/md2.htm
         Assets::EntityModel* Md2Parser::doParseModel() {
@@ -258,10 +265,13 @@ namespace TrenchBroom {
             const size_t commandOffset = readSize<int32_t>(cursor);
 
             const Md2SkinList skins = parseSkins(m_begin + skinOffset, skinCount);
-            const Md2FrameList frames = parseFrames(m_begin + frameOffset, frameCount, frameVertexCount);
             const Md2MeshList meshes = parseMeshes(m_begin + commandOffset, commandCount);
-            
-            return buildModel(skins, frames, meshes);
+
+            auto model = std::make_unique<Assets::EntityModel>(m_name);
+            loadSkins(model.get(), skins);
+            buildFrames(model.get(), m_begin + frameOffset, frameCount, frameVertexCount, meshes);
+
+            return model.release();
         }
 
         Md2Parser::Md2SkinList Md2Parser::parseSkins(const char* begin, const size_t skinCount) {
@@ -270,18 +280,17 @@ namespace TrenchBroom {
             return skins;
         }
 
-        Md2Parser::Md2FrameList Md2Parser::parseFrames(const char* begin, const size_t frameCount, const size_t frameVertexCount) {
-            Md2FrameList frames(frameCount, Md2Frame(frameVertexCount));
+        Md2Parser::Md2Frame Md2Parser::parseFrame(const char* begin, const size_t frameIndex, const size_t frameVertexCount) {
+            const auto frameSize = 2 * 3 * sizeof(float) + Md2Layout::FrameNameLength + frameVertexCount * sizeof(Md2Vertex);
+            Md2Frame frame(frameVertexCount);
 
-            const char* cursor = begin;
-            for (size_t i = 0; i < frameCount; ++i) {
-                frames[i].scale = readVec3f(cursor);
-                frames[i].offset = readVec3f(cursor);
-                readBytes(cursor, frames[i].name, Md2Layout::FrameNameLength);
-                readVector(cursor, frames[i].vertices);
-            }
-            
-            return frames;
+            const char* cursor = begin + frameIndex * frameSize;
+            frame.scale = readVec3f(cursor);
+            frame.offset = readVec3f(cursor);
+            readBytes(cursor, frame.name, Md2Layout::FrameNameLength);
+            readVector(cursor, frame.vertices);
+
+            return frame;
         }
 
         Md2Parser::Md2MeshList Md2Parser::parseMeshes(const char* begin, const size_t commandCount) {
@@ -304,16 +313,6 @@ namespace TrenchBroom {
             return meshes;
         }
 
-        Assets::EntityModel* Md2Parser::buildModel(const Md2SkinList& skins, const Md2FrameList& frames, const Md2MeshList& meshes) {
-            using ModelPtr = std::unique_ptr<Assets::EntityModel>;
-            ModelPtr model = std::make_unique<Assets::EntityModel>(m_name);
-
-            loadSkins(model.get(), skins);
-            buildFrames(model.get(), frames, meshes);
-
-            return model.release();
-        }
-
         void Md2Parser::loadSkins(Assets::EntityModel* model, const Md2SkinList& skins) {
             for (const auto& skin : skins) {
                 const Path skinPath(String(skin.name));
@@ -321,35 +320,49 @@ namespace TrenchBroom {
             }
         }
 
-        void Md2Parser::buildFrames(Assets::EntityModel* model, const Md2Parser::Md2FrameList& frames, const Md2Parser::Md2MeshList& meshes) {
-            for (const auto& frame: frames) {
-                size_t vertexCount = 0;
-                Renderer::IndexRangeMap::Size size;
-                for (const auto& md2Mesh : meshes) {
-                    vertexCount += md2Mesh.vertices.size();
-                    if (md2Mesh.type == Md2Mesh::Fan)
-                        size.inc(GL_TRIANGLE_FAN);
-                    else
-                        size.inc(GL_TRIANGLE_STRIP);
+        void Md2Parser::buildFrames(Assets::EntityModel* model, const char* framesBegin, const size_t frameCount, const size_t frameVertexCount, const Md2MeshList& meshes) const {
+            if (m_file == nullptr) {
+                for (size_t i = 0; i < frameCount; ++i) {
+                    const auto frame = parseFrame(framesBegin, i, frameVertexCount);
+                    auto builder = buildFrame(frame, meshes);
+                    model->addFrame(frame.name, builder.vertices(), builder.indexArray());
                 }
+            } else {
+                // the decoder keeps the file open so that framesBegin stays valid
+                const auto file = m_file;
+                model->addLazyFrames(frameCount, [file, framesBegin, frameVertexCount, meshes](Assets::EntityModel& lazyModel, const size_t frameIndex) {
+                    const auto frame = parseFrame(framesBegin, frameIndex, frameVertexCount);
+                    auto builder = buildFrame(frame, meshes);
+                    lazyModel.setFrame(frameIndex, frame.name, builder.vertices(), builder.indexArray());
+                });
+            }
+        }
 
-                Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec> builder(vertexCount, size);
-                for (const auto& md2Mesh : meshes) {
-                    if (!md2Mesh.vertices.empty()) {
-                        vertexCount += md2Mesh.vertices.size();
-                        if (md2Mesh.type == Md2Mesh::Fan) {
-                            builder.addTriangleFan(getVertices(frame, md2Mesh.vertices));
-                        } else {
-                            builder.addTriangleStrip(getVertices(frame, md2Mesh.vertices));
-                        }
+        Md2Parser::FrameBuilder Md2Parser::buildFrame(const Md2Frame& frame, const Md2MeshList& meshes) {
+            size_t vertexCount = 0;
+            Renderer::IndexRangeMap::Size size;
+            for (const auto& md2Mesh : meshes) {
+                vertexCount += md2Mesh.vertices.size();
+                if (md2Mesh.type == Md2Mesh::Fan)
+                    size.inc(GL_TRIANGLE_FAN);
+                else
+                    size.inc(GL_TRIANGLE_STRIP);
+            }
+
+            FrameBuilder builder(vertexCount, size);
+            for (const auto& md2Mesh : meshes) {
+                if (!md2Mesh.vertices.empty()) {
+                    if (md2Mesh.type == Md2Mesh::Fan) {
+                        builder.addTriangleFan(getVertices(frame, md2Mesh.vertices));
+                    } else {
+                        builder.addTriangleStrip(getVertices(frame, md2Mesh.vertices));
                     }
                 }
-
-                model->addFrame(frame.name, builder.vertices(), builder.indexArray());
             }
+            return builder;
         }
 
-        Assets::EntityModel::VertexList Md2Parser::getVertices(const Md2Frame& frame, const Md2MeshVertexList& meshVertices) const {
+        Assets::EntityModel::VertexList Md2Parser::getVertices(const Md2Frame& frame, const Md2MeshVertexList& meshVertices) {
             typedef Assets::EntityModel::Vertex Vertex;
 
             Vertex::List result(0);
@@ -25,6 +25,8 @@
 #include "Assets/EntityModel.h"
 #include "Assets/TextureCollection.h"
 #include "IO/EntityModelParser.h"
+#include "IO/MappedFile.h"
+#include "Renderer/IndexRangeMapBuilder.h"
 
 #include <vecmath/vec.h>
 
@@ -73,7 +75,6 @@ namespace TrenchBroom {
                 vm::vec3f vertex(size_t index) const;
                 const vm::vec3f& normal(size_t index) const;
             };
-            using Md2FrameList = std::vector<Md2Frame>;
 
             struct Md2MeshVertex {
                 vm::vec2f texCoords;
@@ -94,26 +95,33 @@ namespace TrenchBroom {
                 explicit Md2Mesh(int i_vertexCount);
             };
             using Md2MeshList =  std::vector<Md2Mesh>;
-            
+
+            using FrameBuilder = Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec>;
             
             String m_name;
             const char* m_begin;
             /* const char* m_end; */
+            MappedFile::Ptr m_file;
             const Assets::Palette& m_palette;
             const FileSystem& m_fs;
         public:
             Md2Parser(const String& name, const char* begin, const char* end, const Assets::Palette& palette, const FileSystem& fs);
+            /**
+             * Creates a parser whose models decode their frames when they are first used. The models keep the given
+             * file open.
+             */
+            Md2Parser(const String& name, MappedFile::Ptr file, const Assets::Palette& palette, const FileSystem& fs);
         private:
             Assets::EntityModel* doParseModel() override;
             Md2SkinList parseSkins(const char* begin, size_t skinCount);
-            Md2FrameList parseFrames(const char* begin, size_t frameCount, size_t frameVertexCount);
+            static Md2Frame parseFrame(const char* begin, size_t frameIndex, size_t frameVertexCount);
             Md2MeshList parseMeshes(const char* begin, size_t commandCount);
 
-            Assets::EntityModel* buildModel(const Md2SkinList& skins, const Md2FrameList& frames, const Md2MeshList& meshes);
             void loadSkins(Assets::EntityModel* model, const Md2SkinList& skins);
-            void buildFrames(Assets::EntityModel* model, const Md2FrameList& frames, const Md2MeshList& meshes);
+            void buildFrames(Assets::EntityModel* model, const char* framesBegin, size_t frameCount, size_t frameVertexCount, const Md2MeshList& meshes) const;
+            static FrameBuilder buildFrame(const Md2Frame& frame, const Md2MeshList& meshes);
 
-            Assets::EntityModel::VertexList getVertices(const Md2Frame& frame, const Md2MeshVertexList& meshVertices) const;
+            static Assets::EntityModel::VertexList getVertices(const Md2Frame& frame, const Md2MeshVertexList& meshVertices);
         };
     }
 }
@@ -219,6 +219,15 @@ namespace TrenchBroom {
             unused(m_end);
         }
 
+        MdlParser::MdlParser(const String& name, MappedFile::Ptr file, const Assets::Palette& palette) :
+        m_name(name),
+        m_begin(file->begin()),
+        m_end(file->end()),
+        m_file(std::move(file)),
+        m_palette(palette) {
+            assert(m_begin < m_end);
+        }
+
         Assets::EntityModel* MdlParser::doParseModel() {
             const auto* cursor = m_begin + MdlLayout::HeaderScale;
             const auto scale = readVec3f(cursor);
@@ -241,7 +250,8 @@ namespace TrenchBroom {
             const auto skinVertices = parseSkinVertices(cursor, skinVertexCount);
             const auto skinTriangles = parseSkinTriangles(cursor, skinTriangleCount);
 
-            parseFrames(cursor, model.get(), frameCount, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
+            const auto frames = findFrames(cursor, frameCount, skinVertexCount);
+            parseFrames(model.get(), frames, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
 
             return model.release();
         }
@@ -305,26 +315,47 @@ namespace TrenchBroom {
             return triangles;
         }
 
-        void MdlParser::parseFrames(const char*& cursor, Assets::EntityModel* model, const size_t count, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, const size_t skinWidth, const size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) {
+        std::vector<const char*> MdlParser::findFrames(const char*& cursor, const size_t count, const size_t vertexCount) {
+            const auto frameSize = MdlLayout::SimpleFrameName + MdlLayout::SimpleFrameLength + vertexCount * 4;
+
+            std::vector<const char*> frames;
+            frames.reserve(count);
             for (size_t i = 0; i < count; ++i) {
                 const auto type = readInt<int32_t>(cursor);
                 if (type == 0) { // single frame
-                    parseFrame(cursor, model, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
-                } else { // frame group, but we only read the first frame
+                    frames.push_back(cursor);
+                    cursor += frameSize;
+                } else { // frame group, but we only use the first frame
                     const auto* base = cursor;
                     const auto groupFrameCount = readSize<int32_t>(cursor);
 
                     const auto* frameCursor = base + MdlLayout::MultiFrameTimes + groupFrameCount * sizeof(float);
-                    parseFrame(frameCursor, model, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
+                    frames.push_back(frameCursor);
+
+                    // forward to after the last group frame
+                    cursor = frameCursor + groupFrameCount * frameSize;
+                }
+            }
+            return frames;
+        }
 
-                    // forward to after the last group frame as if we had read them all
-                    const auto offset = (groupFrameCount - 1) * (MdlLayout::SimpleFrameName + MdlLayout::SimpleFrameLength + skinVertices.size() * 4);
-                    cursor = frameCursor + offset;
+        void MdlParser::parseFrames(Assets::EntityModel* model, const std::vector<const char*>& frames, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, const size_t skinWidth, const size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) const {
+            if (m_file == nullptr) {
+                for (const auto* frameCursor : frames) {
+                    auto frame = parseFrame(frameCursor, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
+                    model->addFrame(frame.name, frame.builder.vertices(), frame.builder.indexArray());
                 }
+            } else {
+                // the decoder keeps the file open so that the frame cursors stay valid
+                const auto file = m_file;
+                model->addLazyFrames(frames.size(), [file, frames, skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale](Assets::EntityModel& lazyModel, const size_t frameIndex) {
+                    auto frame = parseFrame(frames[frameIndex], skinTriangles, skinVertices, skinWidth, skinHeight, origin, scale);
+                    lazyModel.setFrame(frameIndex, frame.name, frame.builder.vertices(), frame.builder.indexArray());
+                });
             }
         }
 
-        void MdlParser::parseFrame(const char*& cursor, Assets::EntityModel* model, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, const size_t skinWidth, const size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) {
+        MdlParser::MdlFrame MdlParser::parseFrame(const char* cursor, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, const size_t skinWidth, const size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) {
             using Vertex = Assets::EntityModel::Vertex;
             using VertexList = Vertex::List;
 
@@ -365,13 +396,13 @@ namespace TrenchBroom {
             Renderer::IndexRangeMap::Size size;
             size.inc(GL_TRIANGLES, frameTriangles.size());
 
-            Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec> builder(frameTriangles.size() * 3, size);
-            builder.addTriangles(frameTriangles);
+            MdlFrame frame{ String(name), FrameBuilder(frameTriangles.size() * 3, size) };
+            frame.builder.addTriangles(frameTriangles);
+            return frame;
 
-            model->addFrame(String(name), builder.vertices(), builder.indexArray());
         }
 
-        vm::vec3f MdlParser::unpackFrameVertex(const PackedFrameVertex& vertex, const vm::vec3f& origin, const vm::vec3f& scale) const {
+        vm::vec3f MdlParser::unpackFrameVertex(const PackedFrameVertex& vertex, const vm::vec3f& origin, const vm::vec3f& scale) {
             vm::vec3f result;
             for (size_t i = 0; i < 3; ++i) {
                 result[i] = origin[i] + scale[i]*static_cast<float>(vertex[i]);
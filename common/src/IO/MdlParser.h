@@ -23,7 +23,10 @@
 #include "StringUtils.h"
 #include "ByteBuffer.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/EntityModel.h"
 #include "IO/EntityModelParser.h"
+#include "IO/MappedFile.h"
+#include "Renderer/IndexRangeMapBuilder.h"
 
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
@@ -56,22 +59,36 @@ namespace TrenchBroom {
             typedef std::vector<MdlSkinTriangle> MdlSkinTriangleList;
             typedef vm::vec<unsigned char, 4> PackedFrameVertex;
             typedef std::vector<PackedFrameVertex> PackedFrameVertexList;
+
+            typedef Renderer::IndexRangeMapBuilder<Assets::EntityModel::Vertex::Spec> FrameBuilder;
+
+            struct MdlFrame {
+                String name;
+                FrameBuilder builder;
+            };
             
             String m_name;
             const char* m_begin;
             const char* m_end;
+            MappedFile::Ptr m_file;
             const Assets::Palette& m_palette;
         public:
             MdlParser(const String& name, const char* begin, const char* end, const Assets::Palette& palette);
+            /**
+             * Creates a parser whose models decode their frames when they are first used. The models keep the given
+             * file open.
+             */
+            MdlParser(const String& name, MappedFile::Ptr file, const Assets::Palette& palette);
         private:
             Assets::EntityModel* doParseModel() override;
 
             void parseSkins(const char*& cursor, Assets::EntityModel* model, size_t count, size_t width, size_t height, int flags);
             MdlSkinVertexList parseSkinVertices(const char*& cursor, size_t count);
             MdlSkinTriangleList parseSkinTriangles(const char*& cursor, size_t count);
-            void parseFrames(const char*& cursor, Assets::EntityModel* model, size_t count, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale);
-            void parseFrame(const char*& cursor, Assets::EntityModel* model, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale);
-            vm::vec3f unpackFrameVertex(const PackedFrameVertex& vertex, const vm::vec3f& origin, const vm::vec3f& scale) const;
+            std::vector<const char*> findFrames(const char*& cursor, size_t count, size_t vertexCount);
+            void parseFrames(Assets::EntityModel* model, const std::vector<const char*>& frames, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) const;
+            static MdlFrame parseFrame(const char* cursor, const MdlSkinTriangleList& skinTriangles, const MdlSkinVertexList& skinVertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale);
+            static vm::vec3f unpackFrameVertex(const PackedFrameVertex& vertex, const vm::vec3f& origin, const vm::vec3f& scale);
         };
     }
 }
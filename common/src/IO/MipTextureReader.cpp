@@ -47,9 +47,10 @@ namespace TrenchBroom {
         Assets::Texture* MipTextureReader::doReadTexture(const char* const begin, const char* const end, const Path& path) const {
             static const size_t MipLevels = 4;
             
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MipLevels);
-            static size_t offset[MipLevels];
+            // textures are read concurrently, so all buffers must be local
+            Color tempColor, averageColor;
+            Assets::TextureBuffer::List buffers(MipLevels);
+            size_t offset[MipLevels];
             
             CharArrayReader reader(begin, end);
             const String name = reader.readString(MipLayout::TextureNameLength);
@@ -85,5 +86,23 @@ namespace TrenchBroom {
 
             return new Assets::Texture(textureName(name, path), width, height, averageColor, buffers, GL_RGBA, type);
         }
+
+        Assets::Texture* MipTextureReader::doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const {
+            static const size_t MipLevels = 4;
+            size_t offset[MipLevels];
+
+            CharArrayReader reader(begin, end);
+            const String name = reader.readString(MipLayout::TextureNameLength);
+            const size_t width = reader.readSize<int32_t>();
+            const size_t height = reader.readSize<int32_t>();
+            for (size_t i = 0; i < MipLevels; ++i)
+                offset[i] = reader.readSize<int32_t>();
+
+            if (!doGetPalette(reader, offset, width, height).initialized()) {
+                return nullptr;
+            }
+
+            return new Assets::Texture(textureName(name, path), width, height);
+        }
     }
 }
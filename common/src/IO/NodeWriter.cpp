@@ -98,9 +98,9 @@ namespace TrenchBroom {
             void doVisit(Model::Brush* brush) override   { stopRecursion();  }
         };
         
-        NodeWriter::NodeWriter(Model::World* world, FILE* stream) :
+        NodeWriter::NodeWriter(Model::World* world, FILE* stream, const size_t threadCount) :
         m_world(world),
-        m_serializer(MapFileSerializer::create(m_world->format(), stream)) {}
+        m_serializer(MapFileSerializer::create(m_world->format(), stream, threadCount)) {}
         
         NodeWriter::NodeWriter(Model::World* world, std::ostream& stream) :
         m_world(world),
@@ -40,7 +40,7 @@ namespace TrenchBroom {
             Model::World* m_world;
             NodeSerializer::Ptr m_serializer;
         public:
-            NodeWriter(Model::World* world, FILE* stream);
+            NodeWriter(Model::World* world, FILE* stream, size_t threadCount = 1);
             NodeWriter(Model::World* world, std::ostream& stream);
             NodeWriter(Model::World* world, NodeSerializer* serializer);
             
@@ -0,0 +1,238 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "NumberFormatter.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace IO {
+        // 5^i for all i such that 5^i * 2^53 fits into 128 bits with room to spare
+        static const uint64_t PowersOfFive[] = {
+            1ull, 5ull, 25ull, 125ull, 625ull, 3125ull, 15625ull, 78125ull, 390625ull, 1953125ull, 9765625ull,
+            48828125ull, 244140625ull, 1220703125ull, 6103515625ull, 30517578125ull, 152587890625ull,
+            762939453125ull, 3814697265625ull, 19073486328125ull, 95367431640625ull
+        };
+        static const int MaxScale = 20;
+
+        static const uint64_t PowersOfTen[] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+            1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+            100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+            1000000000000000000ull
+        };
+
+        static int digitCount(uint64_t value) {
+            int count = 1;
+            while (value >= 10) {
+                value /= 10;
+                ++count;
+            }
+            return count;
+        }
+
+        static char* writeDigits(uint64_t value, const int count, char* buffer) {
+            for (int i = count - 1; i >= 0; --i) {
+                buffer[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            return buffer + count;
+        }
+
+        static void multiply(const uint64_t a, const uint64_t b, uint64_t& hi, uint64_t& lo) {
+            const uint64_t aLo = a & 0xFFFFFFFFull;
+            const uint64_t aHi = a >> 32;
+            const uint64_t bLo = b & 0xFFFFFFFFull;
+            const uint64_t bHi = b >> 32;
+
+            const uint64_t ll = aLo * bLo;
+            const uint64_t lh = aLo * bHi;
+            const uint64_t hl = aHi * bLo;
+            const uint64_t hh = aHi * bHi;
+
+            const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFull) + (hl & 0xFFFFFFFFull);
+            lo = (ll & 0xFFFFFFFFull) | (mid << 32);
+            hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        }
+
+        static bool bit(const uint64_t hi, const uint64_t lo, const int index) {
+            return ((index < 64 ? lo >> index : hi >> (index - 64)) & 1) != 0;
+        }
+
+        static bool anyBitBelow(const uint64_t hi, const uint64_t lo, const int index) {
+            if (index == 0)
+                return false;
+            if (index < 64)
+                return (lo & ((uint64_t(1) << index) - 1)) != 0;
+            if (index == 64)
+                return lo != 0;
+            return lo != 0 || (hi & ((uint64_t(1) << (index - 64)) - 1)) != 0;
+        }
+
+        /**
+         * Computes mantissa * 2^exponent * 10^scale exactly and splits it into its integer part and whether that must
+         * be rounded up to round to nearest with ties to even, like printf does. Returns false if the computation
+         * would not fit into 128 bits or if the integer part would not fit into 64 bits.
+         */
+        static bool scale(const uint64_t mantissa, const int exponent, const int scale, uint64_t& integerPart, bool& roundUp) {
+            assert(scale >= 0 && scale <= MaxScale);
+
+            // mantissa * 2^exponent * 10^scale = mantissa * 5^scale * 2^(exponent + scale)
+            uint64_t hi, lo;
+            multiply(mantissa, PowersOfFive[scale], hi, lo);
+
+            const int shift = exponent + scale;
+            if (shift >= 0) {
+                if (hi != 0 || shift >= 64 || (lo >> (63 - shift)) != 0)
+                    return false;
+                integerPart = lo << shift;
+                roundUp = false;
+                return true;
+            }
+
+            const int s = -shift;
+            if (s >= 128)
+                return false;
+            if (s < 64) {
+                if ((hi >> s) != 0)
+                    return false;
+                integerPart = (lo >> s) | (hi << (64 - s));
+            } else {
+                integerPart = hi >> (s - 64);
+            }
+
+            // the fractional part is exactly one half if its highest bit is set and all others are clear
+            roundUp = bit(hi, lo, s - 1) && (anyBitBelow(hi, lo, s - 1) || (integerPart & 1) != 0);
+            return true;
+        }
+
+        static char* formatDecimalSlow(const double value, const int precision, char* buffer) {
+            char str[MaxFormattedNumberLength + 1];
+            const int length = std::snprintf(str, sizeof(str), "%.*g", precision, value);
+            assert(length > 0 && static_cast<size_t>(length) <= MaxFormattedNumberLength);
+            std::memcpy(buffer, str, static_cast<size_t>(length));
+            return buffer + length;
+        }
+
+        char* formatDecimal(const double value, const int precision, char* buffer) {
+            assert(precision >= 1 && precision <= 17);
+
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            const bool negative = (bits >> 63) != 0;
+            const int biasedExponent = static_cast<int>((bits >> 52) & 0x7FF);
+            const uint64_t fraction = bits & ((uint64_t(1) << 52) - 1);
+
+            char* out = buffer;
+            if (biasedExponent == 0 && fraction == 0) {
+                if (negative)
+                    *out++ = '-';
+                *out++ = '0';
+                return out;
+            }
+
+            // subnormal numbers, infinity and NaN
+            if (biasedExponent == 0 || biasedExponent == 0x7FF)
+                return formatDecimalSlow(value, precision, buffer);
+
+            // the value is mantissa * 2^exponent
+            const uint64_t mantissa = fraction | (uint64_t(1) << 52);
+            const int exponent = biasedExponent - 1075;
+
+            // floor(log10(2^(exponent + 52))), which is either the decimal exponent of the value or one less
+            int decimalExponent = ((exponent + 52) * 78913) >> 18;
+
+            // find the first precision digits of the value, rounded correctly
+            uint64_t digits = 0;
+            bool found = false;
+            for (int attempt = 0; attempt < 2 && !found; ++attempt) {
+                const int s = precision - 1 - decimalExponent;
+                if (s < 0 || s > MaxScale)
+                    return formatDecimalSlow(value, precision, buffer);
+
+                uint64_t integerPart;
+                bool roundUp;
+                if (!scale(mantissa, exponent, s, integerPart, roundUp))
+                    return formatDecimalSlow(value, precision, buffer);
+
+                if (integerPart >= PowersOfTen[precision]) {
+                    ++decimalExponent;
+                } else {
+                    digits = integerPart + (roundUp ? 1 : 0);
+                    if (digits == PowersOfTen[precision]) {
+                        digits = PowersOfTen[precision - 1];
+                        ++decimalExponent;
+                    }
+                    found = true;
+                }
+            }
+
+            // printf uses the exponential notation for these
+            if (!found || decimalExponent < -4 || decimalExponent >= precision)
+                return formatDecimalSlow(value, precision, buffer);
+
+            // remove trailing zeros
+            int digitsLength = precision;
+            while (digitsLength > 1 && digits % 10 == 0) {
+                digits /= 10;
+                --digitsLength;
+            }
+
+            if (negative)
+                *out++ = '-';
+
+            char str[MaxFormattedNumberLength];
+            writeDigits(digits, digitsLength, str);
+
+            if (decimalExponent >= 0) {
+                const int integerLength = decimalExponent + 1;
+                for (int i = 0; i < integerLength; ++i)
+                    *out++ = i < digitsLength ? str[i] : '0';
+                if (digitsLength > integerLength) {
+                    *out++ = '.';
+                    for (int i = integerLength; i < digitsLength; ++i)
+                        *out++ = str[i];
+                }
+            } else {
+                *out++ = '0';
+                *out++ = '.';
+                for (int i = 0; i < -decimalExponent - 1; ++i)
+                    *out++ = '0';
+                for (int i = 0; i < digitsLength; ++i)
+                    *out++ = str[i];
+            }
+            return out;
+        }
+
+        char* formatInteger(const long value, char* buffer) {
+            char* out = buffer;
+            uint64_t magnitude = static_cast<uint64_t>(value);
+            if (value < 0) {
+                *out++ = '-';
+                magnitude = ~magnitude + 1;
+            }
+            return writeDigits(magnitude, digitCount(magnitude), out);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_NumberFormatter
+#define TrenchBroom_NumberFormatter
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * The maximum number of characters written by formatDecimal and formatInteger.
+         */
+        static const size_t MaxFormattedNumberLength = 32;
+
+        /**
+         * Formats the given number into the given buffer. The result is identical to calling std::snprintf with the
+         * format "%.<precision>g", including the rounding of the last digit, but numbers that are written in fixed
+         * point notation are formatted without going through std::snprintf. With a precision of 17, every double is
+         * written such that parsing the result yields the same double.
+         *
+         * This function is thread safe. The result is not null terminated.
+         *
+         * @param value the number to format
+         * @param precision the maximum number of significant digits, must be between 1 and 17
+         * @param buffer the buffer to write to, must have room for MaxFormattedNumberLength characters
+         * @return a pointer past the last written character
+         */
+        char* formatDecimal(double value, int precision, char* buffer);
+
+        /**
+         * Formats the given number into the given buffer. The result is identical to calling std::snprintf with the
+         * format "%ld".
+         *
+         * This function is thread safe. The result is not null terminated.
+         *
+         * @param value the number to format
+         * @param buffer the buffer to write to, must have room for MaxFormattedNumberLength characters
+         * @return a pointer past the last written character
+         */
+        char* formatInteger(long value, char* buffer);
+    }
+}
+
+#endif /* defined(TrenchBroom_NumberFormatter) */
@@ -0,0 +1,170 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NumberParser.h"
+
+#include "StringUtils.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace IO {
+        // all powers of ten that can be represented exactly by a double
+        static const double ExactPowersOfTen[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        static const int MaxExactPowerOfTen = 22;
+
+        // the largest integer such that it and all smaller integers can be represented exactly by a double
+        static const uint64_t MaxExactMantissa = uint64_t(1) << 53;
+
+        static bool isDigit(const char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        static double parseDecimalSlow(const char* begin, const char* end) {
+            char buffer[64];
+            const size_t length = static_cast<size_t>(end - begin);
+            if (length < sizeof(buffer)) {
+                std::memcpy(buffer, begin, length);
+                buffer[length] = 0;
+                return std::strtod(buffer, nullptr);
+            }
+
+            const String str(begin, length);
+            return std::strtod(str.c_str(), nullptr);
+        }
+
+        static long parseIntegerSlow(const char* begin, const char* end) {
+            char buffer[64];
+            const size_t length = static_cast<size_t>(end - begin);
+            if (length < sizeof(buffer)) {
+                std::memcpy(buffer, begin, length);
+                buffer[length] = 0;
+                return std::atol(buffer);
+            }
+
+            const String str(begin, length);
+            return std::atol(str.c_str());
+        }
+
+        double parseDecimal(const char* begin, const char* end) {
+            const char* c = begin;
+
+            bool negative = false;
+            if (c < end && (*c == '+' || *c == '-')) {
+                negative = *c == '-';
+                ++c;
+            }
+
+            uint64_t mantissa = 0;
+            int significantDigits = 0;
+            int exponent = 0;
+            bool hasDigits = false;
+
+            while (c < end && isDigit(*c)) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*c - '0');
+                if (mantissa != 0)
+                    ++significantDigits;
+                hasDigits = true;
+                ++c;
+            }
+
+            if (c < end && *c == '.') {
+                ++c;
+                while (c < end && isDigit(*c)) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*c - '0');
+                    if (mantissa != 0)
+                        ++significantDigits;
+                    --exponent;
+                    hasDigits = true;
+                    ++c;
+                }
+            }
+
+            // more than 19 digits might have overflowed the mantissa
+            if (!hasDigits || significantDigits > 19)
+                return parseDecimalSlow(begin, end);
+
+            if (c < end && (*c == 'e' || *c == 'E')) {
+                // the exponent is only consumed if it contains at least one digit
+                const char* e = c + 1;
+                bool negativeExponent = false;
+                if (e < end && (*e == '+' || *e == '-')) {
+                    negativeExponent = *e == '-';
+                    ++e;
+                }
+
+                if (e < end && isDigit(*e)) {
+                    int explicitExponent = 0;
+                    while (e < end && isDigit(*e)) {
+                        if (explicitExponent < 10000)
+                            explicitExponent = explicitExponent * 10 + (*e - '0');
+                        ++e;
+                    }
+                    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+                    c = e;
+                }
+            }
+
+            // anything else, e.g. hexadecimal numbers, is left to the C library
+            if (c != end)
+                return parseDecimalSlow(begin, end);
+
+            if (mantissa == 0)
+                return negative ? -0.0 : 0.0;
+
+            // If both the mantissa and the power of ten are exact, a single multiplication or division yields the
+            // correctly rounded result.
+            if (mantissa > MaxExactMantissa || exponent < -MaxExactPowerOfTen || exponent > MaxExactPowerOfTen)
+                return parseDecimalSlow(begin, end);
+
+            double result = static_cast<double>(mantissa);
+            if (exponent < 0)
+                result /= ExactPowersOfTen[-exponent];
+            else
+                result *= ExactPowersOfTen[exponent];
+            return negative ? -result : result;
+        }
+
+        long parseInteger(const char* begin, const char* end) {
+            const char* c = begin;
+
+            bool negative = false;
+            if (c < end && (*c == '+' || *c == '-')) {
+                negative = *c == '-';
+                ++c;
+            }
+
+            if (c == end || !isDigit(*c))
+                return parseIntegerSlow(begin, end);
+
+            unsigned long result = 0;
+            while (c < end && isDigit(*c)) {
+                result = result * 10 + static_cast<unsigned long>(*c - '0');
+                ++c;
+            }
+
+            return negative ? -static_cast<long>(result) : static_cast<long>(result);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_NumberParser
+#define TrenchBroom_NumberParser
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Parses a decimal number from the given character range. The result is identical to calling std::atof on a
+         * null terminated copy of the range, but the common case of numbers with at most 15 significant digits and
+         * a small exponent is handled without copying the range. Only numbers that cannot be converted exactly on
+         * the fast path fall back to std::strtod.
+         *
+         * This function is thread safe.
+         *
+         * @param begin the start of the range
+         * @param end the end of the range
+         * @return the parsed number, or 0 if the range does not start with a number
+         */
+        double parseDecimal(const char* begin, const char* end);
+
+        /**
+         * Parses an integer number from the given character range. The result is identical to calling std::atol on a
+         * null terminated copy of the range if the number fits into a long.
+         *
+         * This function is thread safe.
+         *
+         * @param begin the start of the range
+         * @param end the end of the range
+         * @return the parsed number, or 0 if the range does not start with a number
+         */
+        long parseInteger(const char* begin, const char* end);
+    }
+}
+
+#endif /* defined(TrenchBroom_NumberParser) */
@@ -46,6 +46,11 @@ namespace TrenchBroom {
             void warn(size_t line, const String& str);
             void error(size_t line, const String& str);
             void errorAndThrow(size_t line, const String& str);
+
+            /**
+             * Logs a message that already contains its file position, e.g. one that was recorded by another status.
+             */
+            void log(Logger::LogLevel level, const String& str);
         private:
             void log(Logger::LogLevel level, size_t line, size_t column, const String& str);
             String buildMessage(size_t line, size_t column, const String& str) const;
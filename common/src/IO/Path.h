@@ -27,6 +27,8 @@
 
 namespace TrenchBroom {
     namespace IO {
+        class InternedPath;
+
         class Path {
         public:
             typedef std::vector<Path> List;
@@ -58,6 +60,8 @@ namespace TrenchBroom {
             
             StringList m_components;
             bool m_absolute;
+
+            friend class InternedPath;
             
             Path(bool absolute, const StringList& components);
         public:
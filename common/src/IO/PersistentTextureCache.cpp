@@ -0,0 +1,249 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "PersistentTextureCache.h"
+
+#include "Exceptions.h"
+#include "Assets/Texture.h"
+#include "IO/DiskIO.h"
+#include "IO/FileMatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace PersistentTextureCacheLayout {
+            static const char Magic[4] = { 'T', 'B', 'T', 'X' };
+            static const uint32_t Version = 1;
+            static const uint32_t MaxMipCount = 16;
+
+            struct Header {
+                char magic[4];
+                uint32_t version;
+                uint32_t width;
+                uint32_t height;
+                uint32_t format;
+                uint32_t type;
+                float averageColor[4];
+                uint32_t mipCount;
+                uint32_t reserved;
+            };
+            // followed by one uint64_t per mip level holding its size in bytes, followed by the mip levels
+        }
+
+        /**
+         * Returns a name that is unique among all running instances of the application. The counter makes it unique
+         * within this process, and the random prefix, which is chosen once per process, makes it unique across
+         * processes.
+         */
+        static String temporaryName() {
+            static const uint64_t processToken = (static_cast<uint64_t>(std::random_device()()) << 32) ^ static_cast<uint64_t>(std::time(nullptr));
+            static std::atomic<size_t> nextTemporaryId(0);
+
+            std::stringstream name;
+            name << std::hex << processToken << '-' << nextTemporaryId++ << ".tmp";
+            return name.str();
+        }
+
+        PersistentTextureCache::PersistentTextureCache(const Path& directory) :
+        m_directory(directory) {}
+
+        const Path& PersistentTextureCache::directory() const {
+            return m_directory;
+        }
+
+        Assets::Texture* PersistentTextureCache::read(const Key key, const String& name) const {
+            using namespace PersistentTextureCacheLayout;
+
+            const auto path = entryPath(key);
+            if (!Disk::fileExists(path)) {
+                return nullptr;
+            }
+
+            MappedFile::Ptr file;
+            try {
+                file = Disk::openFile(path);
+            } catch (const Exception&) {
+                return nullptr;
+            }
+
+            const char* cur = file->begin();
+            const char* end = file->end();
+            if (static_cast<size_t>(end - cur) < sizeof(Header)) {
+                return nullptr;
+            }
+
+            Header header;
+            std::memcpy(&header, cur, sizeof(Header));
+            cur += sizeof(Header);
+
+            if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+                header.width == 0 || header.height == 0 ||
+                header.mipCount == 0 || header.mipCount > MaxMipCount ||
+                (header.format != GL_RGBA && header.format != GL_RGB && header.format != GL_BGR) ||
+                header.type > static_cast<uint32_t>(Assets::TextureType::Masked) ||
+                static_cast<size_t>(end - cur) < header.mipCount * sizeof(uint64_t)) {
+                return nullptr;
+            }
+
+            uint64_t mipSizes[MaxMipCount];
+            std::memcpy(mipSizes, cur, header.mipCount * sizeof(uint64_t));
+            cur += header.mipCount * sizeof(uint64_t);
+
+            const auto bytesPerPixel = Assets::bytesPerPixelForFormat(header.format);
+            Assets::TextureBuffer::List buffers(header.mipCount);
+            for (size_t i = 0; i < header.mipCount; ++i) {
+                const auto mipSize = Assets::sizeAtMipLevel(header.width, header.height, i);
+                if (mipSizes[i] < bytesPerPixel * mipSize.x() * mipSize.y() || static_cast<uint64_t>(end - cur) < mipSizes[i]) {
+                    return nullptr;
+                }
+
+                const auto size = static_cast<size_t>(mipSizes[i]);
+                buffers[i] = Assets::TextureBuffer(size);
+                std::memcpy(buffers[i].ptr(), cur, size);
+                cur += size;
+            }
+
+            const Color averageColor(header.averageColor[0], header.averageColor[1], header.averageColor[2], header.averageColor[3]);
+            return new Assets::Texture(name, header.width, header.height, averageColor, buffers, header.format, static_cast<Assets::TextureType>(header.type));
+        }
+
+        void PersistentTextureCache::write(const Key key, const Assets::Texture& texture) const {
+            using namespace PersistentTextureCacheLayout;
+
+            const auto& buffers = texture.buffers();
+            if (buffers.empty() || buffers.size() > MaxMipCount) {
+                return;
+            }
+
+            Header header;
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.version = Version;
+            header.width = static_cast<uint32_t>(texture.width());
+            header.height = static_cast<uint32_t>(texture.height());
+            header.format = static_cast<uint32_t>(texture.format());
+            header.type = static_cast<uint32_t>(texture.type());
+            for (size_t i = 0; i < 4; ++i)
+                header.averageColor[i] = texture.averageColor()[i];
+            header.mipCount = static_cast<uint32_t>(buffers.size());
+            header.reserved = 0;
+
+            // several threads and instances may write the same entry, so every write goes to its own temporary file
+            const auto path = entryPath(key);
+            const auto temporaryPath = path.addExtension(temporaryName());
+
+            try {
+                Disk::ensureDirectoryExists(path.deleteLastComponent());
+
+                {
+                    std::ofstream stream(temporaryPath.asString().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                    stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+                    for (const auto& buffer : buffers) {
+                        const uint64_t size = buffer.size();
+                        stream.write(reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+                    }
+                    for (const auto& buffer : buffers) {
+                        stream.write(reinterpret_cast<const char*>(buffer.ptr()), static_cast<std::streamsize>(buffer.size()));
+                    }
+                    if (!stream) {
+                        throw FileSystemException("Could not write texture cache entry '" + temporaryPath.asString() + "'");
+                    }
+                }
+
+                Disk::moveFile(temporaryPath, path, true);
+            } catch (const Exception&) {
+                try {
+                    if (Disk::fileExists(temporaryPath)) {
+                        Disk::deleteFile(temporaryPath);
+                    }
+                } catch (const Exception&) {}
+            }
+        }
+
+        void PersistentTextureCache::prune(const size_t maxSize) const {
+            struct Entry {
+                Path path;
+                size_t size;
+                std::time_t modificationTime;
+            };
+
+            // a temporary file may still be written by another instance, so only old ones are deleted
+            static const std::time_t MaxTemporaryFileAge = 24 * 60 * 60;
+
+            try {
+                if (!Disk::directoryExists(m_directory)) {
+                    return;
+                }
+
+                const auto now = std::time(nullptr);
+                for (const auto& path : Disk::findItemsRecursively(m_directory, FileExtensionMatcher("tmp"))) {
+                    try {
+                        if (now - Disk::fileModificationTime(path) > MaxTemporaryFileAge) {
+                            Disk::deleteFile(path);
+                        }
+                    } catch (const Exception&) {}
+                }
+
+                std::vector<Entry> entries;
+                size_t totalSize = 0;
+                for (const auto& path : Disk::findItemsRecursively(m_directory, FileExtensionMatcher("tex"))) {
+                    try {
+                        entries.push_back(Entry { path, Disk::fileSize(path), Disk::fileModificationTime(path) });
+                        totalSize += entries.back().size;
+                    } catch (const Exception&) {}
+                }
+
+                if (totalSize <= maxSize) {
+                    return;
+                }
+
+                std::sort(std::begin(entries), std::end(entries), [](const Entry& lhs, const Entry& rhs) {
+                    return lhs.modificationTime < rhs.modificationTime;
+                });
+
+                for (const auto& entry : entries) {
+                    if (totalSize <= maxSize) {
+                        break;
+                    }
+                    try {
+                        Disk::deleteFile(entry.path);
+                        totalSize -= entry.size;
+                    } catch (const Exception&) {}
+                }
+            } catch (const Exception&) {}
+        }
+
+        Path PersistentTextureCache::entryPath(const Key key) const {
+            std::stringstream name;
+            name << std::hex << std::setw(16) << std::setfill('0') << key;
+            const auto str = name.str();
+            // spread the entries over subdirectories to keep the directories small
+            return m_directory + Path(str.substr(0, 2)) + Path(str + ".tex");
+        }
+    }
+}
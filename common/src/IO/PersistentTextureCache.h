@@ -0,0 +1,80 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_PersistentTextureCache
+#define TrenchBroom_PersistentTextureCache
+
+#include "StringUtils.h"
+#include "Assets/AssetTypes.h"
+#include "IO/ContentHash.h"
+#include "IO/Path.h"
+
+#include <cstdint>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Stores decoded textures on disk so that they need not be decoded again when they are loaded the next time.
+         *
+         * Every entry is keyed by a hash of the texture file's contents and a hash of everything else that the
+         * decoded image depends on, such as the number of mip levels. An entry is a file consisting of a small header followed by
+         * the RGBA mip levels and is read with a single memory mapping. Entries are written to a temporary file first
+         * and then renamed, so a partially written entry is never visible.
+         *
+         * The cache is safe to use from multiple threads. It is best effort: entries that cannot be read or written
+         * are ignored. The cache does not limit its size by itself, call prune() to delete the oldest entries.
+         */
+        class PersistentTextureCache {
+        public:
+            using Key = ContentHash;
+
+            static const size_t DefaultMaxSize = size_t(1024) * 1024 * 1024;
+        private:
+            Path m_directory;
+        public:
+            explicit PersistentTextureCache(const Path& directory);
+
+            const Path& directory() const;
+
+            /**
+             * Returns the texture that was stored with the given key, using the given name, or null if there is no
+             * such entry or it cannot be read.
+             */
+            Assets::Texture* read(Key key, const String& name) const;
+
+            /**
+             * Stores the image data of the given texture with the given key. The texture must not have been
+             * uploaded yet.
+             */
+            void write(Key key, const Assets::Texture& texture) const;
+
+            /**
+             * Deletes the least recently written entries until the total size of the remaining entries is at most
+             * maxSize bytes, and deletes temporary files that were left behind by writes that did not complete. This
+             * lists the entire cache directory, so it should only be called once, e.g. at startup.
+             */
+            void prune(size_t maxSize) const;
+        private:
+            Path entryPath(Key key) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_PersistentTextureCache) */
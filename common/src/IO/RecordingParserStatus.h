@@ -0,0 +1,49 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RecordingParserStatus
+#define TrenchBroom_RecordingParserStatus
+
+#include "IO/ParserStatus.h"
+
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Records the messages that are logged while parsing so that they can be logged later by another status,
+         * e.g. when parsing on a worker thread that must not log directly.
+         */
+        class RecordingParserStatus : public ParserStatus {
+        private:
+            typedef std::pair<Logger::LogLevel, String> Message;
+            std::vector<Message> m_messages;
+        public:
+            RecordingParserStatus();
+
+            void replay(ParserStatus& status) const;
+        private:
+            void doProgress(double progress) override;
+            void doLog(Logger::LogLevel level, const String& str) override;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_RecordingParserStatus) */
@@ -21,10 +21,18 @@
 
 #include "Logger.h"
 #include "TemporarilySetAny.h"
+#include "IO/ParserStatus.h"
 #include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
 
 #include <vecmath/vec.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace TrenchBroom {
     namespace IO {
         const String& QuakeMapTokenizer::NumberDelim() {
@@ -115,11 +123,185 @@ namespace TrenchBroom {
             return Token(QuakeMapToken::Eof, nullptr, nullptr, length(), line(), column());
         }
 
+        /**
+         * Parses a chunk of entities on its own and records the resulting callbacks and log messages so that they can
+         * be replayed on another thread later.
+         */
+        class StandardMapParser::ChunkParser : public StandardMapParser {
+        private:
+            typedef enum {
+                Event_BeginEntity,
+                Event_EndEntity,
+                Event_BeginBrush,
+                Event_EndBrush,
+                Event_BrushFace,
+                Event_Message
+            } EventType;
+
+            struct Event {
+                EventType type;
+                size_t line;
+                size_t lineCount;
+                size_t index;
+            };
+
+            struct Entity {
+                Model::EntityAttribute::List attributes;
+                ExtraAttributes extraAttributes;
+            };
+
+            struct Face {
+                vm::vec3 point1;
+                vm::vec3 point2;
+                vm::vec3 point3;
+                Model::BrushFaceAttributes attribs;
+                vm::vec3 texAxisX;
+                vm::vec3 texAxisY;
+            };
+
+            typedef std::pair<Logger::LogLevel, String> Message;
+
+            class RecordingStatus : public ParserStatus {
+            private:
+                ChunkParser& m_parser;
+            public:
+                RecordingStatus(ChunkParser& parser) :
+                ParserStatus(nullptr),
+                m_parser(parser) {}
+            private:
+                void doProgress(const double progress) override {}
+
+                void doLog(const Logger::LogLevel level, const String& str) override {
+                    m_parser.m_events.push_back(Event { Event_Message, 0, 0, m_parser.m_messages.size() });
+                    m_parser.m_messages.push_back(Message(level, str));
+                }
+            };
+
+            std::vector<Event> m_events;
+            std::vector<Entity> m_entities;
+            std::vector<ExtraAttributes> m_brushExtraAttributes;
+            std::vector<Face> m_faces;
+            std::vector<Message> m_messages;
+
+            size_t m_entityCount;
+            size_t m_closedEntityCount;
+            size_t m_endLine;
+            size_t m_endColumn;
+            bool m_failed;
+        public:
+            ChunkParser(const EntityChunk& chunk) :
+            StandardMapParser(chunk.begin, chunk.end),
+            m_entityCount(0),
+            m_closedEntityCount(0),
+            m_endLine(chunk.line),
+            m_endColumn(chunk.column),
+            m_failed(false) {
+                m_tokenizer.restore(TokenizerState::Position { chunk.begin, chunk.line, chunk.column, false });
+            }
+
+            void parse(const Model::MapFormat::Type format) {
+                setFormat(format);
+
+                RecordingStatus status(*this);
+                try {
+                    Token token = m_tokenizer.peekToken();
+                    while (token.type() != QuakeMapToken::Eof) {
+                        expect(QuakeMapToken::OBrace, token);
+                        ++m_entityCount;
+                        parseEntity(status);
+                        m_endLine = m_tokenizer.line();
+                        m_endColumn = m_tokenizer.column();
+                        token = m_tokenizer.peekToken();
+                    }
+                } catch (...) {
+                    // the serial parser will run into the same problem and report it
+                    m_failed = true;
+                }
+            }
+
+            /**
+             * Indicates whether parsing this chunk on its own gave the same result as parsing it as part of the file.
+             * This is the case if every entity of the chunk was closed, and the last one was closed right where the
+             * given next chunk starts. For the last chunk, this only requires that no error occurred.
+             */
+            bool succeeded(const EntityChunk* next) const {
+                if (m_failed)
+                    return false;
+                if (next == nullptr)
+                    return true;
+                return (m_closedEntityCount == m_entityCount &&
+                        m_endLine == next->line &&
+                        m_endColumn == next->column);
+            }
+
+            void replay(StandardMapParser& parser, ParserStatus& status) const {
+                for (const Event& event : m_events) {
+                    switch (event.type) {
+                        case Event_BeginEntity: {
+                            const Entity& entity = m_entities[event.index];
+                            parser.beginEntity(event.line, entity.attributes, entity.extraAttributes, status);
+                            break;
+                        }
+                        case Event_EndEntity:
+                            parser.endEntity(event.line, event.lineCount, status);
+                            break;
+                        case Event_BeginBrush:
+                            parser.beginBrush(event.line, status);
+                            break;
+                        case Event_EndBrush:
+                            parser.endBrush(event.line, event.lineCount, m_brushExtraAttributes[event.index], status);
+                            break;
+                        case Event_BrushFace: {
+                            const Face& face = m_faces[event.index];
+                            parser.brushFace(event.line, face.point1, face.point2, face.point3, face.attribs, face.texAxisX, face.texAxisY, status);
+                            break;
+                        }
+                        case Event_Message: {
+                            const Message& message = m_messages[event.index];
+                            status.log(message.first, message.second);
+                            break;
+                        }
+                        switchDefault()
+                    }
+                }
+            }
+        private:
+            void onFormatSet(const Model::MapFormat::Type format) override {}
+
+            void onBeginEntity(const size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) override {
+                m_events.push_back(Event { Event_BeginEntity, line, 0, m_entities.size() });
+                m_entities.push_back(Entity { attributes, extraAttributes });
+            }
+
+            void onEndEntity(const size_t startLine, const size_t lineCount, ParserStatus& status) override {
+                m_events.push_back(Event { Event_EndEntity, startLine, lineCount, 0 });
+                ++m_closedEntityCount;
+            }
+
+            void onBeginBrush(const size_t line, ParserStatus& status) override {
+                m_events.push_back(Event { Event_BeginBrush, line, 0, 0 });
+            }
+
+            void onEndBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) override {
+                m_events.push_back(Event { Event_EndBrush, startLine, lineCount, m_brushExtraAttributes.size() });
+                m_brushExtraAttributes.push_back(extraAttributes);
+            }
+
+            void onBrushFace(const size_t line, const vm::vec3& point1, const vm::vec3& point2, const vm::vec3& point3, const Model::BrushFaceAttributes& attribs, const vm::vec3& texAxisX, const vm::vec3& texAxisY, ParserStatus& status) override {
+                m_events.push_back(Event { Event_BrushFace, line, 0, m_faces.size() });
+                m_faces.push_back(Face { point1, point2, point3, attribs, texAxisX, texAxisY });
+            }
+        };
+
         StandardMapParser::StandardMapParser(const char* begin, const char* end) :
+        m_begin(begin),
+        m_end(end),
         m_tokenizer(QuakeMapTokenizer(begin, end)),
         m_format(Model::MapFormat::Unknown) {}
         
         StandardMapParser::StandardMapParser(const String& str) :
+        m_begin(str.c_str()),
+        m_end(str.c_str() + str.size()),
         m_tokenizer(QuakeMapTokenizer(str)),
         m_format(Model::MapFormat::Unknown) {}
         
@@ -176,13 +358,95 @@ namespace TrenchBroom {
         
         void StandardMapParser::parseEntities(const Model::MapFormat::Type format, ParserStatus& status) {
             setFormat(format);
+            parseRemainingEntities(status);
+        }
 
-            Token token = m_tokenizer.peekToken();
-            while (token.type() != QuakeMapToken::Eof) {
-                expect(QuakeMapToken::OBrace, token);
-                parseEntity(status);
-                token = m_tokenizer.peekToken();
+        void StandardMapParser::parseEntitiesInParallel(const Model::MapFormat::Type format, const size_t threadCount, ParserStatus& status) {
+            setFormat(format);
+
+            const size_t chunkSize = std::max(MinChunkSize, static_cast<size_t>(m_end - m_begin) / (std::max(threadCount, size_t(1)) * 8));
+            const EntityChunkList chunks = findEntityChunks(m_begin, m_end, chunkSize);
+            if (threadCount <= 1 || chunks.size() <= 1) {
+                parseRemainingEntities(status);
+                return;
             }
+
+            // the workers may only parse a limited number of chunks ahead of the replayed ones to bound memory usage
+            const size_t maxPendingChunks = 2 * threadCount;
+            std::vector<std::unique_ptr<ChunkParser>> parsedChunks(chunks.size());
+            size_t nextChunk = 0;
+            size_t replayedChunks = 0;
+            bool cancelled = false;
+
+            std::mutex mutex;
+            std::condition_variable condition;
+
+            const auto work = [&]() {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true) {
+                    condition.wait(lock, [&]() {
+                        return cancelled || nextChunk == chunks.size() || nextChunk < replayedChunks + maxPendingChunks;
+                    });
+                    if (cancelled || nextChunk == chunks.size())
+                        return;
+
+                    const size_t index = nextChunk++;
+                    lock.unlock();
+
+                    auto parser = std::make_unique<ChunkParser>(chunks[index]);
+                    parser->parse(format);
+
+                    lock.lock();
+                    parsedChunks[index] = std::move(parser);
+                    condition.notify_all();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            const auto stopWorkers = [&]() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cancelled = true;
+                }
+                condition.notify_all();
+                for (auto& worker : workers)
+                    worker.join();
+                workers.clear();
+            };
+
+            try {
+                for (size_t i = 0; i < threadCount - 1; ++i)
+                    workers.emplace_back(work);
+
+                for (size_t i = 0; i < chunks.size(); ++i) {
+                    std::unique_ptr<ChunkParser> parser;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [&]() { return parsedChunks[i] != nullptr; });
+                        parser = std::move(parsedChunks[i]);
+                    }
+
+                    const EntityChunk* next = i + 1 < chunks.size() ? &chunks[i + 1] : nullptr;
+                    if (!parser->succeeded(next)) {
+                        // continue serially from the start of this chunk, which also reports parse errors as usual
+                        stopWorkers();
+                        m_tokenizer.restore(TokenizerState::Position { chunks[i].begin, chunks[i].line, chunks[i].column, false });
+                        parseRemainingEntities(status);
+                        return;
+                    }
+
+                    parser->replay(*this, status);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ++replayedChunks;
+                    }
+                    condition.notify_all();
+                }
+            } catch (...) {
+                stopWorkers();
+                throw;
+            }
+            stopWorkers();
         }
         
         void StandardMapParser::parseBrushes(const Model::MapFormat::Type format, ParserStatus& status) {
@@ -217,6 +481,114 @@ namespace TrenchBroom {
             formatSet(format);
         }
 
+        static const char* skipQuotedString(const char* c, const char* end, const bool allowTrailingBackslash) {
+            bool escaped = false;
+            while (c < end) {
+                if (*c == '"') {
+                    if (!escaped)
+                        return c + 1;
+                    // see QuakeMapTokenizer, a backslash before a closing quotation mark can be part of the string
+                    if (allowTrailingBackslash && c + 1 < end && (c[1] == '\n' || c[1] == '}'))
+                        return c + 1;
+                }
+                escaped = *c == '\\' && !escaped;
+                ++c;
+            }
+            return end;
+        }
+
+        static bool isMapWhitespace(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        StandardMapParser::EntityChunkList StandardMapParser::findEntityChunks(const char* begin, const char* end, const size_t chunkSize) {
+            EntityChunkList chunks;
+            EntityChunk chunk { begin, end, 1, 1 };
+
+            // follows the rules of QuakeMapTokenizer closely enough that braces in comments, strings and texture names
+            // are not taken for entity boundaries
+            size_t depth = 0;
+            size_t parentheses = 0;
+            const char* c = begin;
+            while (c < end) {
+                if (depth == 2 && parentheses == 3 && !isMapWhitespace(*c)) {
+                    // the texture name follows the third closing parenthesis of a face
+                    if (*c == '"') {
+                        c = skipQuotedString(c + 1, end, false);
+                    } else {
+                        while (c < end && !isMapWhitespace(*c))
+                            ++c;
+                    }
+                    parentheses = 0;
+                    continue;
+                }
+
+                switch (*c) {
+                    case '/':
+                        if (c + 1 < end && c[1] == '/') {
+                            if (c + 3 < end && c[2] == '/' && c[3] == ' ') {
+                                // a comment with extra attributes, these are tokenized like everything else
+                                c += 3;
+                            } else {
+                                while (c < end && *c != '\n' && *c != '\r')
+                                    ++c;
+                            }
+                        } else {
+                            ++c;
+                        }
+                        break;
+                    case '"':
+                        c = skipQuotedString(c + 1, end, true);
+                        break;
+                    case '{':
+                        if (depth < 2)
+                            ++depth;
+                        parentheses = 0;
+                        ++c;
+                        break;
+                    case ')':
+                        if (depth == 2)
+                            ++parentheses;
+                        ++c;
+                        break;
+                    case '}':
+                        ++c;
+                        if (depth > 0 && --depth == 0 && c < end && static_cast<size_t>(c - chunk.begin) >= chunkSize) {
+                            size_t line = chunk.line;
+                            size_t column = chunk.column;
+                            for (const char* p = chunk.begin; p < c; ++p) {
+                                if (*p == '\n') {
+                                    ++line;
+                                    column = 1;
+                                } else {
+                                    ++column;
+                                }
+                            }
+
+                            chunk.end = c;
+                            chunks.push_back(chunk);
+                            chunk = EntityChunk { c, end, line, column };
+                        }
+                        break;
+                    default:
+                        ++c;
+                        break;
+                }
+            }
+
+            chunks.push_back(chunk);
+            return chunks;
+        }
+
+        void StandardMapParser::parseRemainingEntities(ParserStatus& status) {
+            Token token = m_tokenizer.peekToken();
+            while (token.type() != QuakeMapToken::Eof) {
+                expect(QuakeMapToken::OBrace, token);
+                parseEntity(status);
+                token = m_tokenizer.peekToken();
+            }
+        }
+
         void StandardMapParser::parseEntity(ParserStatus& status) {
             Token token = m_tokenizer.nextToken();
             if (token.type() == QuakeMapToken::Eof)
@@ -29,6 +29,8 @@
 
 #include <vecmath/forward.h>
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace IO {
         namespace QuakeMapToken {
@@ -67,6 +69,24 @@ namespace TrenchBroom {
             typedef QuakeMapTokenizer::Token Token;
             typedef std::set<Model::AttributeName> AttributeNames;
 
+            /**
+             * A part of the file that contains a sequence of top level entities. Each chunk except the last ends with
+             * the closing brace of an entity.
+             */
+            struct EntityChunk {
+                const char* begin;
+                const char* end;
+                size_t line;
+                size_t column;
+            };
+            typedef std::vector<EntityChunk> EntityChunkList;
+
+            class ChunkParser;
+
+            static const size_t MinChunkSize = 256 * 1024;
+
+            const char* m_begin;
+            const char* m_end;
             QuakeMapTokenizer m_tokenizer;
             Model::MapFormat::Type m_format;
         public:
@@ -78,13 +98,24 @@ namespace TrenchBroom {
             Model::MapFormat::Type detectFormat();
             
             void parseEntities(Model::MapFormat::Type format, ParserStatus& status);
+
+            /**
+             * Parses the entities like parseEntities, but splits the file into chunks of top level entities and parses
+             * these on the given number of threads. The callbacks are made on the calling thread and in file order, so
+             * they receive the same calls as with parseEntities. If a chunk cannot be parsed on its own, the file is
+             * parsed serially from the start of that chunk on.
+             */
+            void parseEntitiesInParallel(Model::MapFormat::Type format, size_t threadCount, ParserStatus& status);
             void parseBrushes(Model::MapFormat::Type format, ParserStatus& status);
             void parseBrushFaces(Model::MapFormat::Type format, ParserStatus& status);
             
             void reset();
         private:
             void setFormat(Model::MapFormat::Type format);
-            
+
+            static EntityChunkList findEntityChunks(const char* begin, const char* end, size_t chunkSize);
+
+            void parseRemainingEntities(ParserStatus& status);
             void parseEntity(ParserStatus& status);
             void parseEntityAttribute(Model::EntityAttribute::List& attributes, AttributeNames& names, ParserStatus& status);
             void parseBrush(ParserStatus& status);
@@ -19,7 +19,10 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "Exceptions.h"
+#include "Parallel.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
 #include "IO/DiskIO.h"
@@ -39,49 +42,102 @@ namespace TrenchBroom {
         TextureCollectionLoader::~TextureCollectionLoader() {}
 
         Assets::TextureCollection* TextureCollectionLoader::loadTextureCollection(const Path& path, const StringList& textureExtensions, const TextureReader& textureReader) {
-            std::unique_ptr<Assets::TextureCollection> collection(new Assets::TextureCollection(path));
-            
-            for (auto file : doFindTextures(path, textureExtensions)) {
-                auto* texture = textureReader.readTexture(file->begin(), file->end(), file->path());
-                if (texture != nullptr) {
-                    collection->addTexture(texture);
+            auto results = loadTextureCollections(Path::List(1, path), textureExtensions, textureReader, defaultThreadCount());
+            auto& result = results.front();
+            if (result.collection == nullptr) {
+                throw AssetException(result.error);
+            }
+            return result.collection.release();
+        }
+
+        TextureCollectionLoader::ResultList TextureCollectionLoader::loadTextureCollections(const Path::List& paths, const StringList& textureExtensions, const TextureReader& textureReader, const size_t threadCount) {
+            return loadTextureCollections(paths, textureExtensions, threadCount, [&textureReader](MappedFile::Ptr file) {
+                return textureReader.readTexture(file);
+            });
+        }
+
+        TextureCollectionLoader::ResultList TextureCollectionLoader::loadLazyTextureCollections(const Path::List& paths, const StringList& textureExtensions, std::shared_ptr<const TextureReader> textureReader, const size_t threadCount) {
+            return loadTextureCollections(paths, textureExtensions, threadCount, [&textureReader](MappedFile::Ptr file) {
+                return TextureReader::readLazyTexture(textureReader, file);
+            });
+        }
+
+        TextureCollectionLoader::ResultList TextureCollectionLoader::loadTextureCollections(const Path::List& paths, const StringList& textureExtensions, const size_t threadCount, const ReadTexture& readTexture) {
+            ResultList results(paths.size());
+            std::vector<MappedFile::List> files(paths.size());
+
+            // the collections are searched in parallel, the threads that are left over are used to open their files
+            const auto fileThreadCount = std::max(threadCount / std::max(paths.size(), size_t(1)), size_t(1));
+            parallelFor(paths.size(), threadCount, [&](const size_t i) {
+                try {
+                    files[i] = doFindTextures(paths[i], textureExtensions, fileThreadCount);
+                } catch (const Exception& e) {
+                    results[i].error = e.what();
+                }
+            });
+
+            struct Job {
+                size_t collectionIndex;
+                MappedFile::Ptr file;
+                std::unique_ptr<Assets::Texture> texture;
+                String error;
+            };
+
+            std::vector<Job> jobs;
+            for (size_t i = 0; i < files.size(); ++i) {
+                for (auto& file : files[i]) {
+                    jobs.push_back(Job{ i, std::move(file), nullptr, "" });
                 }
             }
-            
-            return collection.release();
+
+            parallelFor(jobs.size(), threadCount, [&](const size_t i) {
+                auto& job = jobs[i];
+                try {
+                    job.texture.reset(readTexture(job.file));
+                } catch (const Exception& e) {
+                    job.error = e.what();
+                }
+            });
+
+            for (size_t i = 0; i < paths.size(); ++i) {
+                if (results[i].error.empty()) {
+                    results[i].collection = std::make_unique<Assets::TextureCollection>(paths[i]);
+                }
+            }
+
+            // the jobs are in the order of the files, so the textures are added in the same order as before
+            for (auto& job : jobs) {
+                auto& result = results[job.collectionIndex];
+                if (!job.error.empty()) {
+                    if (result.collection != nullptr) {
+                        result.collection.reset();
+                        result.error = job.error;
+                    }
+                } else if (result.collection != nullptr && job.texture != nullptr) {
+                    result.collection->addTexture(job.texture.release());
+                }
+            }
+
+            return results;
         }
 
         FileTextureCollectionLoader::FileTextureCollectionLoader(const IO::Path::List& searchPaths) :
         m_searchPaths(searchPaths) {}
 
-        MappedFile::List FileTextureCollectionLoader::doFindTextures(const Path& path, const StringList& extensions) {
+        MappedFile::List FileTextureCollectionLoader::doFindTextures(const Path& path, const StringList& extensions, const size_t threadCount) {
             const auto wadPath = Disk::resolvePath(m_searchPaths, path);
             
             WadFileSystem wadFS(wadPath);
             const auto paths = wadFS.findItems(Path(""), FileExtensionMatcher(extensions));
-            
-            MappedFile::List result;
-            result.reserve(paths.size());
-            
-            std::transform(std::begin(paths), std::end(paths), std::back_inserter(result),
-                           [&wadFS](const Path& filePath) { return wadFS.openFile(filePath); });
-            
-            return result;
+            return wadFS.openFiles(paths, threadCount);
         }
 
         DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(const FileSystem& gameFS) :
         m_gameFS(gameFS) {}
 
-        MappedFile::List DirectoryTextureCollectionLoader::doFindTextures(const Path& path, const StringList& extensions) {
+        MappedFile::List DirectoryTextureCollectionLoader::doFindTextures(const Path& path, const StringList& extensions, const size_t threadCount) {
             const auto paths = m_gameFS.findItems(path, FileExtensionMatcher(extensions));
-            
-            MappedFile::List result;
-            result.reserve(paths.size());
-            
-            std::transform(std::begin(paths), std::end(paths), std::back_inserter(result),
-                           [this](const Path& filePath) { return m_gameFS.openFile(filePath); });
-            
-            return result;
+            return m_gameFS.openFiles(paths, threadCount);
         }
     }
 }
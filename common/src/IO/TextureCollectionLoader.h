@@ -24,6 +24,7 @@
 #include "IO/MappedFile.h"
 #include "IO/Path.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -31,6 +32,7 @@ namespace TrenchBroom {
     class Logger;
     
     namespace Assets {
+        class Texture;
         class TextureCollection;
         class TextureReader;
         class TextureManager;
@@ -43,14 +45,47 @@ namespace TrenchBroom {
         class TextureCollectionLoader {
         public:
             typedef std::unique_ptr<TextureCollectionLoader> Ptr;
+
+            /**
+             * The outcome of loading a single texture collection. If the collection could not be loaded, the
+             * collection is null and the error contains the reason.
+             */
+            struct Result {
+                std::unique_ptr<Assets::TextureCollection> collection;
+                String error;
+            };
+            typedef std::vector<Result> ResultList;
         protected:
             TextureCollectionLoader();
         public:
             virtual ~TextureCollectionLoader();
         public:
             Assets::TextureCollection* loadTextureCollection(const Path& path, const StringList& textureExtensions, const TextureReader& textureReader);
+
+            /**
+             * Loads the texture collections with the given paths using up to the given number of threads. The
+             * texture files of all collections are decoded together, so the threads stay busy regardless of how the
+             * textures are distributed among the collections. The given texture reader must therefore be safe to
+             * use concurrently.
+             *
+             * The results are returned in the order of the given paths.
+             */
+            ResultList loadTextureCollections(const Path::List& paths, const StringList& textureExtensions, const TextureReader& textureReader, size_t threadCount);
+
+            /**
+             * Like loadTextureCollections, but only reads the name and size of every texture. The image data is
+             * decoded by the given reader when a texture is first used, see Assets::TextureCache.
+             */
+            ResultList loadLazyTextureCollections(const Path::List& paths, const StringList& textureExtensions, std::shared_ptr<const TextureReader> textureReader, size_t threadCount);
         private:
-            virtual MappedFile::List doFindTextures(const Path& path, const StringList& extensions) = 0;
+            using ReadTexture = std::function<Assets::Texture*(MappedFile::Ptr)>;
+            ResultList loadTextureCollections(const Path::List& paths, const StringList& textureExtensions, size_t threadCount, const ReadTexture& readTexture);
+
+            /**
+             * Returns the texture files of the collection with the given path. The files may be opened using up to
+             * the given number of threads.
+             */
+            virtual MappedFile::List doFindTextures(const Path& path, const StringList& extensions, size_t threadCount) = 0;
         };
         
         class FileTextureCollectionLoader : public TextureCollectionLoader {
@@ -59,7 +94,7 @@ namespace TrenchBroom {
         public:
             FileTextureCollectionLoader(const Path::List& searchPaths);
         private:
-            MappedFile::List doFindTextures(const Path& path, const StringList& extensions) override;
+            MappedFile::List doFindTextures(const Path& path, const StringList& extensions, size_t threadCount) override;
         };
         
         class DirectoryTextureCollectionLoader : public TextureCollectionLoader {
@@ -68,7 +103,7 @@ namespace TrenchBroom {
         public:
             DirectoryTextureCollectionLoader(const FileSystem& gameFS);
         private:
-            MappedFile::List doFindTextures(const Path& path, const StringList& extensions) override;
+            MappedFile::List doFindTextures(const Path& path, const StringList& extensions, size_t threadCount) override;
         };
     }
 }
@@ -19,7 +19,9 @@
 
 #include "TextureLoader.h"
 
+#include "Parallel.h"
 #include "Assets/Palette.h"
+#include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
 #include "EL/Interpolator.h"
 #include "IO/FileSystem.h"
@@ -48,16 +50,16 @@ namespace TrenchBroom {
         TextureLoader::ReaderPtr TextureLoader::createTextureReader(const EL::VariableStore& variables, const FileSystem& gameFS, const Model::GameConfig::TextureConfig& textureConfig, Logger* logger) {
             if (textureConfig.format.format == "idmip") {
                 TextureReader::PathSuffixNameStrategy nameStrategy(1, true);
-                return std::make_unique<IdMipTextureReader>(nameStrategy, loadPalette(variables, gameFS, textureConfig, logger));
+                return std::make_shared<IdMipTextureReader>(nameStrategy, loadPalette(variables, gameFS, textureConfig, logger));
             } else if (textureConfig.format.format == "hlmip") {
                 TextureReader::PathSuffixNameStrategy nameStrategy(1, true);
-                return std::make_unique<HlMipTextureReader>(nameStrategy);
+                return std::make_shared<HlMipTextureReader>(nameStrategy);
             } else if (textureConfig.format.format == "wal") {
                 TextureReader::PathSuffixNameStrategy nameStrategy(2, true);
-                return std::make_unique<WalTextureReader>(nameStrategy, loadPalette(variables, gameFS, textureConfig, logger));
+                return std::make_shared<WalTextureReader>(nameStrategy, loadPalette(variables, gameFS, textureConfig, logger));
             } else if (textureConfig.format.format == "image") {
                 TextureReader::PathSuffixNameStrategy nameStrategy(2, true);
-                return std::make_unique<FreeImageTextureReader>(nameStrategy, 4);
+                return std::make_shared<FreeImageTextureReader>(nameStrategy, 4);
             } else {
                 throw GameException("Unknown texture format '" + textureConfig.format.format + "'");
             }
@@ -116,10 +118,22 @@ namespace TrenchBroom {
             }
         }
 
+        void TextureLoader::setCache(std::shared_ptr<const PersistentTextureCache> cache) {
+            m_textureReader->setCache(std::move(cache));
+        }
+
         Assets::TextureCollection* TextureLoader::loadTextureCollection(const Path& path) {
             return m_textureCollectionLoader->loadTextureCollection(path, m_textureExtensions, *m_textureReader);
         }
 
+        TextureCollectionLoader::ResultList TextureLoader::loadTextureCollections(const Path::List& paths, const bool lazy) {
+            if (lazy) {
+                return m_textureCollectionLoader->loadLazyTextureCollections(paths, m_textureExtensions, m_textureReader, defaultThreadCount());
+            } else {
+                return m_textureCollectionLoader->loadTextureCollections(paths, m_textureExtensions, *m_textureReader, defaultThreadCount());
+            }
+        }
+
         void TextureLoader::loadTextures(const Path::List& paths, Assets::TextureManager& textureManager) {
             textureManager.setTextureCollections(paths, *this);
         }
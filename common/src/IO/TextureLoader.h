@@ -42,12 +42,14 @@ namespace TrenchBroom {
     
     namespace IO {
         class FileSystem;
+        class PersistentTextureCache;
         class TextureCollectionLoader;
         class TextureReader;
         
         class TextureLoader {
         private:
-            using ReaderPtr = std::unique_ptr<TextureReader>;
+            // shared with the lazily loaded textures, which need the reader to decode their image data
+            using ReaderPtr = std::shared_ptr<TextureReader>;
             using LoaderPtr = std::unique_ptr<TextureCollectionLoader>;
 
             StringList m_textureExtensions;
@@ -64,7 +66,10 @@ namespace TrenchBroom {
             static bool isValidPalettePath(const FileSystem& gameFS, const IO::Path& path);
             static LoaderPtr createTextureCollectionLoader(const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig);
         public:
+            void setCache(std::shared_ptr<const PersistentTextureCache> cache);
+
             Assets::TextureCollection* loadTextureCollection(const Path& path);
+            TextureCollectionLoader::ResultList loadTextureCollections(const Path::List& paths, bool lazy);
             void loadTextures(const Path::List& paths, Assets::TextureManager& textureManager);
 
             deleteCopyAndAssignment(TextureLoader)
@@ -19,9 +19,13 @@
 
 #include "TextureReader.h"
 
+#include "Assets/Texture.h"
+#include "IO/ContentHash.h"
 #include "IO/FileSystem.h"
+#include "IO/PersistentTextureCache.h"
 
 #include <algorithm>
+#include <memory>
 
 namespace TrenchBroom {
     namespace IO {
@@ -68,13 +72,64 @@ namespace TrenchBroom {
         TextureReader::~TextureReader() {
             delete m_nameStrategy;
         }
+
+        void TextureReader::setCache(std::shared_ptr<const PersistentTextureCache> cache) {
+            m_cache = std::move(cache);
+        }
         
         Assets::Texture* TextureReader::readTexture(MappedFile::Ptr file) const {
             return readTexture(file->begin(), file->end(), file->path());
         }
 
         Assets::Texture* TextureReader::readTexture(const char* const begin, const char* const end, const Path& path) const {
-            return doReadTexture(begin, end, path);
+            const auto cacheKey = doGetCacheKey();
+            if (m_cache == nullptr || cacheKey == 0) {
+                return doReadTexture(begin, end, path);
+            }
+
+            // the name depends on the path, so it is not stored in the cache
+            std::unique_ptr<Assets::Texture> header(doReadTextureHeader(begin, end, path));
+            if (header == nullptr) {
+                return nullptr;
+            }
+
+            const auto key = contentHash(begin, end, cacheKey);
+            auto* cached = m_cache->read(key, header->name());
+            if (cached != nullptr) {
+                if (cached->width() == header->width() && cached->height() == header->height()) {
+                    return cached;
+                }
+                delete cached;
+            }
+
+            auto* texture = doReadTexture(begin, end, path);
+            if (texture != nullptr) {
+                m_cache->write(key, *texture);
+            }
+            return texture;
+        }
+
+        Assets::Texture* TextureReader::readLazyTexture(std::shared_ptr<const TextureReader> reader, MappedFile::Ptr file) {
+            std::unique_ptr<Assets::Texture> header(reader->doReadTextureHeader(file->begin(), file->end(), file->path()));
+            if (header == nullptr) {
+                return nullptr;
+            }
+
+            return new Assets::Texture(header->name(), header->width(), header->height(), [reader, file]() {
+                return reader->readTexture(file);
+            });
+        }
+
+        Assets::Texture* TextureReader::doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const {
+            std::unique_ptr<Assets::Texture> texture(doReadTexture(begin, end, path));
+            if (texture == nullptr) {
+                return nullptr;
+            }
+            return new Assets::Texture(texture->name(), texture->width(), texture->height());
+        }
+
+        uint64_t TextureReader::doGetCacheKey() const {
+            return 0;
         }
 
         String TextureReader::textureName(const String& textureName, const Path& path) const {
@@ -24,9 +24,13 @@
 #include "Assets/AssetTypes.h"
 #include "IO/MappedFile.h"
 
+#include <cstdint>
+#include <memory>
+
 namespace TrenchBroom {
     namespace IO {
         class Path;
+        class PersistentTextureCache;
         
         class TextureReader {
         public:
@@ -70,17 +74,44 @@ namespace TrenchBroom {
             };
         private:
             NameStrategy* m_nameStrategy;
+            std::shared_ptr<const PersistentTextureCache> m_cache;
         protected:
             TextureReader(const NameStrategy& nameStrategy);
         public:
             virtual ~TextureReader();
+
+            /**
+             * Sets the cache in which decoded textures are looked up before they are decoded and stored after they
+             * were decoded. Pass null to disable caching.
+             */
+            void setCache(std::shared_ptr<const PersistentTextureCache> cache);
             
             Assets::Texture* readTexture(MappedFile::Ptr file) const;
             Assets::Texture* readTexture(const char* const begin, const char* const end, const Path& path) const;
+
+            /**
+             * Reads only the name and size of the texture in the given file and returns a texture that decodes its
+             * image data with the given reader when it is first used. The returned texture keeps the reader and the
+             * file alive. Returns null if the texture cannot be read.
+             */
+            static Assets::Texture* readLazyTexture(std::shared_ptr<const TextureReader> reader, MappedFile::Ptr file);
         protected:
             String textureName(const String& textureName, const Path& path) const;
         private:
             virtual Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const = 0;
+            /**
+             * Returns a texture without image data that has the name and size of the texture in the given file. The
+             * default implementation decodes the entire texture, so readers should override this if they can read
+             * the size without decoding the image data.
+             */
+            virtual Assets::Texture* doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const;
+            /**
+             * Returns a hash of everything other than the contents of a texture file that the decoded texture
+             * depends on, e.g. the reader's settings, or 0 if decoded textures should not be cached. The default
+             * implementation returns 0 because reading a cache entry is only faster than decoding if decoding is
+             * expensive.
+             */
+            virtual uint64_t doGetCacheKey() const;
         public:
             static size_t mipSize(size_t width, size_t height, size_t mipLevel);
             
@@ -21,10 +21,9 @@
 #define TrenchBroom_Token
 
 #include "StringUtils.h"
+#include "IO/NumberParser.h"
 
 #include <cassert>
-#include <cstdlib>
-#include <cstring>
 
 namespace TrenchBroom {
     namespace IO {
@@ -94,25 +93,12 @@ namespace TrenchBroom {
             
             template <typename T>
             T toFloat() const {
-                static const size_t BufferSize = 256;
-                static char buffer[BufferSize];
-                assert(length() < BufferSize);
-                
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T f = static_cast<T>(std::atof(buffer));
-                return f;
+                return static_cast<T>(parseDecimal(m_begin, m_end));
             }
             
             template <typename T>
             T toInteger() const {
-                static char buffer[64];
-                assert(length() < 64);
-                
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T i = static_cast<T>(std::atoi(buffer));
-                return i;
+                return static_cast<T>(parseInteger(m_begin, m_end));
             }
         };
     }
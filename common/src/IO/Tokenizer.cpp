@@ -138,5 +138,16 @@ namespace TrenchBroom {
         void TokenizerState::restore(const TokenizerState& snapshot) {
             *this = snapshot;
         }
+
+        TokenizerState::Position TokenizerState::position() const {
+            return Position { m_cur, m_line, m_column, m_escaped };
+        }
+
+        void TokenizerState::restore(const Position& position) {
+            m_cur = position.cur;
+            m_line = position.line;
+            m_column = position.column;
+            m_escaped = position.escaped;
+        }
     }
 }
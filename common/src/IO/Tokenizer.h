@@ -30,6 +30,17 @@
 namespace TrenchBroom {
     namespace IO {
         class TokenizerState {
+        public:
+            /**
+             * The part of the state that changes while tokenizing. Unlike a snapshot of the entire state, saving and
+             * restoring a position does not allocate, so it is used to peek at tokens and to backtrack.
+             */
+            struct Position {
+                const char* cur;
+                size_t line;
+                size_t column;
+                bool escaped;
+            };
         private:
             const char* m_begin;
             const char* m_cur;
@@ -73,6 +84,9 @@ namespace TrenchBroom {
             
             TokenizerState snapshot() const;
             void restore(const TokenizerState& snapshot);
+
+            Position position() const;
+            void restore(const Position& position);
         };
         
         template <typename TokenType>
@@ -86,15 +100,15 @@ namespace TrenchBroom {
 
             class SaveState {
             private:
-                StatePtr m_state;
-                TokenizerState m_snapshot;
+                TokenizerState& m_state;
+                TokenizerState::Position m_position;
             public:
-                SaveState(StatePtr state) :
+                SaveState(TokenizerState& state) :
                 m_state(state),
-                m_snapshot(m_state->snapshot()) {}
+                m_position(m_state.position()) {}
                 
                 ~SaveState() {
-                    m_state->restore(m_snapshot);
+                    m_state.restore(m_position);
                 }
             };
 
@@ -131,7 +145,7 @@ namespace TrenchBroom {
             }
 
             Token peekToken(const TokenType skipTokens = 0) {
-                SaveState oldState(m_state);
+                SaveState oldState(*m_state);
                 return nextToken(skipTokens);
             }
 
@@ -206,6 +220,10 @@ namespace TrenchBroom {
             void restore(const TokenizerState& snapshot) {
                 m_state->restore(snapshot);
             }
+
+            void restore(const TokenizerState::Position& position) {
+                m_state->restore(position);
+            }
         protected:
             size_t offset(const char* ptr) const {
                 return m_state->offset(ptr);
@@ -254,7 +272,7 @@ namespace TrenchBroom {
                 if (curChar() != '+' && curChar() != '-' && !isDigit(curChar()))
                     return nullptr;
 
-                const TokenizerState previous = *m_state;
+                const TokenizerState::Position previous = m_state->position();
                 if (curChar() == '+' || curChar() == '-')
                     advance();
                 while (!eof() && isDigit(curChar()))
@@ -262,7 +280,7 @@ namespace TrenchBroom {
                 if (eof() || isAnyOf(curChar(), delims))
                     return curPos();
 
-                *m_state = previous;
+                m_state->restore(previous);
                 return nullptr;
             }
 
@@ -270,7 +288,7 @@ namespace TrenchBroom {
                 if (curChar() != '+' && curChar() != '-' && curChar() != '.' && !isDigit(curChar()))
                     return nullptr;
 
-                const TokenizerState previous = *m_state;
+                const TokenizerState::Position previous = m_state->position();
                 if (curChar() != '.') {
                     advance();
                     readDigits();
@@ -292,7 +310,7 @@ namespace TrenchBroom {
                 if (eof() || isAnyOf(curChar(), delims))
                     return curPos();
 
-                *m_state = previous;
+                m_state->restore(previous);
                 return nullptr;
             }
             
@@ -99,13 +99,7 @@ namespace TrenchBroom {
                 reader.seekForward(WadLayout::DirEntryNameOffset);
                 const auto entryName = reader.readString(WadLayout::DirEntryNameSize) + "." + entryType;
                 
-                const auto* entryBegin = m_file->begin() + entryAddress;
-                const auto* entryEnd = entryBegin + entrySize;
-                assert(entryEnd <= m_file->end());
-                
-                const auto path = IO::Path(entryName);
-                auto file = std::make_shared<MappedFileView>(m_file, path, entryBegin, entryEnd);
-                m_root.addFile(path, file);
+                addEntry(entryName, entryAddress, entrySize);
             }
         }
     }
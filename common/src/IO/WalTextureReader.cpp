@@ -45,11 +45,35 @@ namespace TrenchBroom {
             }
         }
 
+        Assets::Texture* WalTextureReader::doReadTextureHeader(const char* const begin, const char* const end, const Path& path) const {
+            CharArrayReader reader(begin, end);
+            const char version = reader.readChar<char>();
+
+            if (version == 3) {
+                const auto name = reader.readString(WalLayout::TextureNameLength);
+                reader.seekForward(3); // garbage
+
+                const auto width = reader.readSize<uint32_t>();
+                const auto height = reader.readSize<uint32_t>();
+                return new Assets::Texture(textureName(name, path), width, height);
+            } else {
+                reader.seekFromBegin(0);
+                const String name = reader.readString(WalLayout::TextureNameLength);
+                const size_t width = reader.readSize<uint32_t>();
+                const size_t height = reader.readSize<uint32_t>();
+
+                if (!m_palette.initialized()) {
+                    return nullptr;
+                }
+                return new Assets::Texture(textureName(name, path), width, height);
+            }
+        }
+
         Assets::Texture* WalTextureReader::readQ2Wal(CharArrayReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 4;
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBuffer::List buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const String name = reader.readString(WalLayout::TextureNameLength);
             const size_t width = reader.readSize<uint32_t>();
@@ -68,9 +92,9 @@ namespace TrenchBroom {
 
         Assets::Texture* WalTextureReader::readDkWal(CharArrayReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 9;
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBuffer::List buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const char version = reader.readChar<char>();
             ensure(version == 3, "Unknown WAL texture version");
@@ -114,7 +138,7 @@ namespace TrenchBroom {
         }
 
         void WalTextureReader::readMips(const Assets::Palette& palette, const size_t mipLevels, const size_t offsets[], const size_t width, const size_t height, CharArrayReader& reader, Assets::TextureBuffer::List& buffers, Color& averageColor) {
-            static Color tempColor;
+            Color tempColor;
 
             for (size_t i = 0; i < mipLevels; ++i) {
                 const auto offset = offsets[i];
@@ -0,0 +1,244 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ZipFileSystem.h"
+
+#include "Exceptions.h"
+#include "IO/CharArrayReader.h"
+
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace ZipLayout {
+            static const size_t EndOfDirectorySignature   = 0x06054b50;
+            static const size_t EndOfDirectoryLength      = 22;
+            static const size_t MaxCommentLength          = 0xFFFF;
+            static const size_t EntryCountOffset          = 10;
+            static const size_t DirectoryOffsetOffset     = 16;
+
+            static const size_t DirectoryEntrySignature   = 0x02014b50;
+            static const size_t DirectoryEntryLength      = 46;
+            static const size_t DirectoryEntryFlagsOffset = 8;
+
+            static const size_t LocalHeaderSignature      = 0x04034b50;
+            static const size_t LocalHeaderLength         = 30;
+            static const size_t LocalHeaderNameOffset     = 26;
+
+            static const size_t Zip64Size                 = 0xFFFFFFFF;
+            static const size_t Zip64EntryCount           = 0xFFFF;
+
+            static const size_t EncryptedFlag             = 0x1;
+            static const size_t MethodStored              = 0;
+            static const size_t MethodDeflated            = 8;
+        }
+
+        const size_t ZipFileSystem::DefaultCacheSize = 64u * 1024u * 1024u;
+
+        ZipFileSystem::ZipFileSystem(const Path& path, MappedFile::Ptr file, const size_t cacheSize) :
+        ImageFileSystem(path, file),
+        m_cacheSize(cacheSize),
+        m_cacheUsage(0) {
+            initialize();
+        }
+
+        size_t ZipFileSystem::cacheUsage() const {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            return m_cacheUsage;
+        }
+
+        void ZipFileSystem::doReadDirectory() {
+            CharArrayReader reader(m_file->begin(), m_file->end());
+            if (m_file->size() < ZipLayout::EndOfDirectoryLength) {
+                throw FileSystemException("File does not contain a zip directory");
+            }
+
+            // the end of directory record is followed by a comment of variable length, so search for it backwards
+            const auto maxDistance = std::min(m_file->size(), ZipLayout::EndOfDirectoryLength + ZipLayout::MaxCommentLength);
+            size_t endOfDirectory = m_file->size();
+            for (size_t distance = ZipLayout::EndOfDirectoryLength; distance <= maxDistance; ++distance) {
+                reader.seekFromBegin(m_file->size() - distance);
+                if (reader.readSize<uint32_t>() == ZipLayout::EndOfDirectorySignature) {
+                    endOfDirectory = m_file->size() - distance;
+                    break;
+                }
+            }
+
+            if (endOfDirectory == m_file->size()) {
+                throw FileSystemException("File does not contain a zip directory");
+            }
+
+            reader.seekFromBegin(endOfDirectory + ZipLayout::EntryCountOffset);
+            const auto entryCount = reader.readSize<uint16_t>();
+            reader.seekFromBegin(endOfDirectory + ZipLayout::DirectoryOffsetOffset);
+            const auto directoryOffset = reader.readSize<uint32_t>();
+
+            if (entryCount == ZipLayout::Zip64EntryCount || directoryOffset == ZipLayout::Zip64Size) {
+                throw FileSystemException("Zip64 archives are not supported");
+            }
+            if (directoryOffset >= endOfDirectory) {
+                throw FileSystemException("Zip directory is out of bounds");
+            }
+
+            reader.seekFromBegin(directoryOffset);
+            for (size_t i = 0; i < entryCount; ++i) {
+                if (!reader.canRead(ZipLayout::DirectoryEntryLength) || reader.readSize<uint32_t>() != ZipLayout::DirectoryEntrySignature) {
+                    throw FileSystemException("Invalid zip directory entry");
+                }
+
+                reader.seekForward(ZipLayout::DirectoryEntryFlagsOffset - 4);
+                const auto flags = reader.readSize<uint16_t>();
+                const auto method = reader.readSize<uint16_t>();
+                reader.seekForward(8); // modification time and date, crc
+                const auto compressedSize = reader.readSize<uint32_t>();
+                const auto uncompressedSize = reader.readSize<uint32_t>();
+                const auto nameLength = reader.readSize<uint16_t>();
+                const auto extraLength = reader.readSize<uint16_t>();
+                const auto commentLength = reader.readSize<uint16_t>();
+                reader.seekForward(8); // disk number, internal and external attributes
+                const auto localHeaderOffset = reader.readSize<uint32_t>();
+
+                if (!reader.canRead(nameLength + extraLength + commentLength)) {
+                    throw FileSystemException("Invalid zip directory entry");
+                }
+
+                const auto entryName = String(reader.cur<char>(), nameLength);
+                reader.seekForward(nameLength);
+                if (extraLength + commentLength > 0) {
+                    reader.seekForward(extraLength + commentLength);
+                }
+
+                const auto directory = !entryName.empty() && entryName.back() == '/';
+                // entries whose sizes or offset are stored in zip64 extra fields are not supported
+                const auto zip64 = compressedSize == ZipLayout::Zip64Size ||
+                                   uncompressedSize == ZipLayout::Zip64Size ||
+                                   localHeaderOffset == ZipLayout::Zip64Size;
+                const auto supported = !zip64 &&
+                                       (flags & ZipLayout::EncryptedFlag) == 0 &&
+                                       (method == ZipLayout::MethodStored || method == ZipLayout::MethodDeflated);
+                if (!directory && supported) {
+                    // the offset refers to the local header, which is only read when the entry is opened
+                    addEntry(entryName, localHeaderOffset, compressedSize, uncompressedSize, method == ZipLayout::MethodDeflated);
+                }
+            }
+        }
+
+        MappedFile::Ptr ZipFileSystem::doOpenEntry(const Path& path, const Entry& entry) const {
+            if (!entry.compressed) {
+                const auto* begin = findEntryData(entry);
+                return std::make_shared<MappedFileView>(m_file, path, begin, begin + entry.size);
+            }
+
+            auto file = findCachedFile(entry.offset);
+            if (file == nullptr) {
+                file = cacheFile(entry.offset, inflate(path, entry));
+            }
+            return file;
+        }
+
+        const char* ZipFileSystem::findEntryData(const Entry& entry) const {
+            if (m_file->size() < ZipLayout::LocalHeaderLength || entry.offset > m_file->size() - ZipLayout::LocalHeaderLength) {
+                throw FileSystemException("Zip entry '" + entry.name + "' is out of bounds");
+            }
+
+            CharArrayReader reader(m_file->begin(), m_file->end());
+            reader.seekFromBegin(entry.offset);
+            if (reader.readSize<uint32_t>() != ZipLayout::LocalHeaderSignature) {
+                throw FileSystemException("Invalid zip entry header for '" + entry.name + "'");
+            }
+
+            // the local header may have different extra data than the central directory entry
+            reader.seekForward(ZipLayout::LocalHeaderNameOffset - 4);
+            const auto nameLength = reader.readSize<uint16_t>();
+            const auto extraLength = reader.readSize<uint16_t>();
+
+            const auto dataOffset = entry.offset + ZipLayout::LocalHeaderLength + nameLength + extraLength;
+            if (dataOffset > m_file->size() || entry.size > m_file->size() - dataOffset) {
+                throw FileSystemException("Zip entry '" + entry.name + "' is out of bounds");
+            }
+            return m_file->begin() + dataOffset;
+        }
+
+        MappedFile::Ptr ZipFileSystem::inflate(const Path& path, const Entry& entry) const {
+            const auto* data = findEntryData(entry);
+
+            wxMemoryInputStream compressedStream(data, entry.size);
+            wxZlibInputStream inflateStream(compressedStream, wxZLIB_NO_HEADER);
+
+            std::unique_ptr<char[]> buffer(new char[entry.uncompressedSize]);
+            size_t bytesRead = 0;
+            while (bytesRead < entry.uncompressedSize && inflateStream.CanRead()) {
+                inflateStream.Read(buffer.get() + bytesRead, entry.uncompressedSize - bytesRead);
+                if (inflateStream.LastRead() == 0) {
+                    break;
+                }
+                bytesRead += inflateStream.LastRead();
+            }
+
+            if (bytesRead != entry.uncompressedSize) {
+                throw FileSystemException("Could not decompress zip entry '" + entry.name + "'");
+            }
+
+            // the buffer takes ownership of the decompressed data
+            return std::make_shared<MappedFileBuffer>(path, buffer.release(), entry.uncompressedSize);
+        }
+
+        MappedFile::Ptr ZipFileSystem::findCachedFile(const size_t offset) const {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            const auto it = m_cache.find(offset);
+            if (it == std::end(m_cache)) {
+                return nullptr;
+            }
+
+            m_cachedEntries.splice(std::begin(m_cachedEntries), m_cachedEntries, it->second.position);
+            return it->second.file;
+        }
+
+        MappedFile::Ptr ZipFileSystem::cacheFile(const size_t offset, MappedFile::Ptr file) const {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+            // another thread may have decompressed the same entry in the meantime
+            const auto it = m_cache.find(offset);
+            if (it != std::end(m_cache)) {
+                return it->second.file;
+            }
+
+            m_cachedEntries.push_front(offset);
+            m_cache.insert(std::make_pair(offset, CacheEntry{ std::begin(m_cachedEntries), file }));
+            m_cacheUsage += file->size();
+
+            // evicted buffers stay alive as long as they are in use elsewhere
+            while (m_cacheUsage > m_cacheSize && m_cachedEntries.size() > 1) {
+                const auto evicted = m_cache.find(m_cachedEntries.back());
+                m_cacheUsage -= evicted->second.file->size();
+                m_cache.erase(evicted);
+                m_cachedEntries.pop_back();
+            }
+
+            return file;
+        }
+    }
+}
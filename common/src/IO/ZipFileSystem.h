@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_ZipFileSystem
+#define TrenchBroom_ZipFileSystem
+
+#include "Macros.h"
+#include "IO/ImageFileSystem.h"
+#include "IO/Path.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * A file system for zip archives such as Quake 3 PK3 files. Only the archive's central directory is read
+         * when it is mounted. Compressed entries are inflated when they are opened, and the decompressed buffers are
+         * kept in a cache that drops the least recently opened ones once their total size exceeds the cache size.
+         *
+         * Stored and deflated entries are supported. Encrypted entries, other compression methods and zip64
+         * archives are not.
+         *
+         * Files can be opened concurrently; entries that are not cached are decompressed in parallel.
+         */
+        class ZipFileSystem : public ImageFileSystem {
+        public:
+            static const size_t DefaultCacheSize;
+        private:
+            struct CacheEntry {
+                std::list<size_t>::iterator position;
+                MappedFile::Ptr file;
+            };
+
+            const size_t m_cacheSize;
+            mutable std::mutex m_cacheMutex;
+            mutable size_t m_cacheUsage;
+
+            // the offsets of the cached entries, the most recently opened one first
+            mutable std::list<size_t> m_cachedEntries;
+            mutable std::unordered_map<size_t, CacheEntry> m_cache;
+        public:
+            ZipFileSystem(const Path& path, MappedFile::Ptr file, size_t cacheSize = DefaultCacheSize);
+
+            /**
+             * Returns the total size of the decompressed buffers that are currently cached.
+             */
+            size_t cacheUsage() const;
+        private:
+            void doReadDirectory() override;
+            MappedFile::Ptr doOpenEntry(const Path& path, const Entry& entry) const override;
+
+            const char* findEntryData(const Entry& entry) const;
+            MappedFile::Ptr inflate(const Path& path, const Entry& entry) const;
+
+            MappedFile::Ptr findCachedFile(size_t offset) const;
+            MappedFile::Ptr cacheFile(size_t offset, MappedFile::Ptr file) const;
+
+            deleteCopyAndAssignment(ZipFileSystem)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_ZipFileSystem) */
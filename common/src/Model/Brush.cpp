@@ -40,6 +40,7 @@
 #include <vecmath/mat.h>
 #include <vecmath/segment.h>
 #include <vecmath/polygon.h>
+#include <vecmath/intersection.h>
 #include <vecmath/util.h>
 
 #include <algorithm>
@@ -1360,13 +1361,13 @@ namespace TrenchBroom {
                 return BrushFaceHit();
             }
 
-            for (auto* face : m_faces) {
-                const auto distance = face->intersectWithRay(ray);
-                if (!vm::isnan(distance)) {
-                    return BrushFaceHit(face, distance);
-                }
+            // brushes are convex, so the ray enters the brush through the face plane that it crosses last from the front
+            const auto [distance, it] = vm::intersectConvex(ray, std::begin(m_faces), std::end(m_faces),
+                [](const BrushFace* face) -> const vm::plane3& { return face->boundary(); });
+            if (it == std::end(m_faces)) {
+                return BrushFaceHit();
             }
-            return BrushFaceHit();
+            return BrushFaceHit(*it, distance);
         }
 
         Node* Brush::doGetContainer() const {
@@ -1467,10 +1468,27 @@ namespace TrenchBroom {
 
         void Brush::invalidateVertexCache() {
             m_brushRendererBrushCache.invalidateVertexCache();
+            invalidateFaceData();
         }
 
         Renderer::BrushRendererBrushCache& Brush::brushRendererBrushCache() const {
             return m_brushRendererBrushCache;
         }
+
+        void Brush::invalidateFaceData() {
+            m_faceData.reset();
+        }
+
+        IO::BrushFaceDataListPtr Brush::faceData() const {
+            if (m_faceData == nullptr) {
+                auto faceData = std::make_shared<IO::BrushFaceDataList>();
+                faceData->reserve(m_faces.size());
+                for (const auto* face : m_faces) {
+                    faceData->emplace_back(face);
+                }
+                m_faceData = std::move(faceData);
+            }
+            return m_faceData;
+        }
     }
 }
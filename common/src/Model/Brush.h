@@ -24,6 +24,7 @@
 #include "Hit.h"
 #include "ProjectingSequence.h"
 #include "Polyhedron_Matcher.h"
+#include "IO/BrushFaceData.h"
 #include "Model/BrushContentType.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Node.h"
@@ -87,6 +88,7 @@ namespace TrenchBroom {
             mutable bool m_transparent;
             mutable bool m_contentTypeValid;
             mutable Renderer::BrushRendererBrushCache m_brushRendererBrushCache;
+            mutable IO::BrushFaceDataListPtr m_faceData;
         public:
             Brush(const vm::bbox3& worldBounds, const BrushFaceList& faces);
             ~Brush() override;
@@ -300,6 +302,18 @@ namespace TrenchBroom {
              */
             void invalidateVertexCache();
             Renderer::BrushRendererBrushCache& brushRendererBrushCache() const;
+
+        public: // serializer cache
+            /**
+             * Only exposed to be called by BrushFace, for changes that do not affect the vertex cache
+             */
+            void invalidateFaceData();
+
+            /**
+             * Returns the data of this brush's faces that is needed to write them to a map file. The data is created
+             * when this is first called after the brush has changed, and is shared until the brush changes again.
+             */
+            IO::BrushFaceDataListPtr faceData() const;
         };
     }
 }
@@ -57,6 +57,7 @@ namespace TrenchBroom {
         m_selected(false),
         m_texCoordSystem(texCoordSystem),
         m_geometry(nullptr),
+        m_rendererCacheIndex(0),
         m_attribs(attribs) {
             ensure(m_texCoordSystem != nullptr, "texCoordSystem is null");
             setPoints(point0, point1, point2);
@@ -142,6 +143,7 @@ namespace TrenchBroom {
         
         void BrushFace::restoreTexCoordSystemSnapshot(const TexCoordSystemSnapshot* coordSystemSnapshot) {
             coordSystemSnapshot->restore(m_texCoordSystem);
+            invalidateVertexCache();
         }
 
         void BrushFace::copyTexCoordSystemFromFace(const TexCoordSystemSnapshot* coordSystemSnapshot, const BrushFaceAttributes& attribs, const vm::plane3& sourceFacePlane, const WrapStyle wrapStyle) {
@@ -162,6 +164,7 @@ namespace TrenchBroom {
                 const auto offsetChange = desriedCoords - currentCoords;
                 m_attribs.setOffset(correct(m_attribs.modOffset(m_attribs.offset() + offsetChange), 4));
             }
+            invalidateVertexCache();
         }
         
         Brush* BrushFace::brush() const {
@@ -342,6 +345,7 @@ namespace TrenchBroom {
 
         void BrushFace::setColor(const Color& color) {
             m_attribs.setColor(color);
+            invalidateFaceData();
         }
 
         void BrushFace::updateTexture(Assets::TextureManager* textureManager) {
@@ -412,18 +416,21 @@ namespace TrenchBroom {
             m_attribs.setSurfaceContents(surfaceContents);
             if (m_brush != nullptr)
                 m_brush->faceDidChange();
+            invalidateFaceData();
         }
 
         void BrushFace::setSurfaceFlags(const int surfaceFlags) {
             if (surfaceFlags == m_attribs.surfaceFlags())
                 return;
             m_attribs.setSurfaceFlags(surfaceFlags);
+            invalidateFaceData();
         }
 
         void BrushFace::setSurfaceValue(const float surfaceValue) {
             if (surfaceValue == m_attribs.surfaceValue())
                 return;
             m_attribs.setSurfaceValue(surfaceValue);
+            invalidateFaceData();
         }
 
         void BrushFace::setAttributes(const BrushFace* other) {
@@ -687,6 +694,12 @@ namespace TrenchBroom {
             }
         }
 
+        void BrushFace::invalidateFaceData() {
+            if (m_brush != nullptr) {
+                m_brush->invalidateFaceData();
+            }
+        }
+
         void BrushFace::setMarked(const bool marked) const {
             m_markedToRenderFace = marked;
         }
@@ -694,5 +707,13 @@ namespace TrenchBroom {
         bool BrushFace::isMarked() const {
             return m_markedToRenderFace;
         }
+
+        void BrushFace::setRendererCacheIndex(const size_t index) const {
+            m_rendererCacheIndex = index;
+        }
+
+        size_t BrushFace::rendererCacheIndex() const {
+            return m_rendererCacheIndex;
+        }
     }
 }
@@ -89,6 +89,7 @@ namespace TrenchBroom {
 
             // brush renderer
             mutable bool m_markedToRenderFace;
+            mutable size_t m_rendererCacheIndex;
         protected:
             BrushFaceAttributes m_attribs;
         public:
@@ -209,8 +210,9 @@ namespace TrenchBroom {
             void setPoints(const vm::vec3& point0, const vm::vec3& point1, const vm::vec3& point2);
             void correctPoints();
 
-            // renderer cache
+            // renderer and serializer caches
             void invalidateVertexCache();
+            void invalidateFaceData();
         public: // brush renderer
             /**
              * This is used to cache results of evaluating the BrushRenderer Filter.
@@ -220,6 +222,13 @@ namespace TrenchBroom {
              */
             void setMarked(bool marked) const;
             bool isMarked() const;
+
+            /**
+             * This is used to look up the index of this face in the brush's renderer cache while the cache is built.
+             * It's only valid within a call to `BrushRendererBrushCache::validateVertexCache`.
+             */
+            void setRendererCacheIndex(size_t index) const;
+            size_t rendererCacheIndex() const;
         private:
             BrushFace(const BrushFace& other);
             BrushFace& operator=(const BrushFace& other);
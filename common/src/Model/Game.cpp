@@ -57,6 +57,10 @@ namespace TrenchBroom {
             return doCheckAdditionalSearchPaths(searchPaths);
         }
 
+        void Game::refreshFileSystem() {
+            doRefreshFileSystem();
+        }
+
         CompilationConfig& Game::compilationConfig() {
             return doCompilationConfig();
         }
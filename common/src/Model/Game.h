@@ -65,6 +65,11 @@ namespace TrenchBroom {
             
             typedef std::map<IO::Path, String> PathErrors;
             PathErrors checkAdditionalSearchPaths(const IO::Path::List& searchPaths) const;
+
+            /**
+             * Picks up files that were added to or removed from the game file system since it was last accessed.
+             */
+            void refreshFileSystem();
             
             CompilationConfig& compilationConfig();
             
@@ -108,6 +113,7 @@ namespace TrenchBroom {
             virtual void doSetGamePath(const IO::Path& gamePath, Logger* logger) = 0;
             virtual void doSetAdditionalSearchPaths(const IO::Path::List& searchPaths, Logger* logger) = 0;
             virtual PathErrors doCheckAdditionalSearchPaths(const IO::Path::List& searchPaths) const = 0;
+            virtual void doRefreshFileSystem() = 0;
             
             virtual CompilationConfig& doCompilationConfig() = 0;
             virtual size_t doMaxPropertyLength() const = 0;
@@ -20,6 +20,7 @@
 #include "GameImpl.h"
 
 #include "Macros.h"
+#include "Parallel.h"
 #include "Assets/Palette.h"
 #include "IO/BrushFaceReader.h"
 #include "IO/Bsp29Parser.h"
@@ -27,6 +28,7 @@
 #include "IO/DkmParser.h"
 #include "IO/DkPakFileSystem.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/FgdFileCache.h"
 #include "IO/FgdParser.h"
 #include "IO/FileMatcher.h"
 #include "IO/FileSystem.h"
@@ -38,10 +40,12 @@
 #include "IO/NodeReader.h"
 #include "IO/NodeWriter.h"
 #include "IO/ObjSerializer.h"
+#include "IO/PersistentTextureCache.h"
 #include "IO/WorldReader.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
 #include "IO/TextureLoader.h"
+#include "IO/ZipFileSystem.h"
 #include "Model/AttributableNodeVariableStore.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
@@ -55,12 +59,25 @@
 #include "Exceptions.h"
 
 #include <cstdio>
+#include <memory>
 
 namespace TrenchBroom {
     namespace Model {
+        static std::shared_ptr<const IO::PersistentTextureCache> sharedTextureCache() {
+            // the cache is shared by all games and pruned once when it is first used
+            static const auto cache = [] {
+                auto result = std::make_shared<IO::PersistentTextureCache>(IO::SystemPaths::userDataDirectory() + IO::Path("TextureCache"));
+                result->prune(IO::PersistentTextureCache::DefaultMaxSize);
+                return result;
+            }();
+            return cache;
+        }
+
         GameImpl::GameImpl(GameConfig& config, const IO::Path& gamePath, Logger* logger) :
         m_config(config),
-        m_gamePath(gamePath) {
+        m_gamePath(gamePath),
+        m_textureCache(sharedTextureCache()),
+        m_fgdFileCache(std::make_shared<IO::FgdFileCache>()) {
             initializeFileSystem(logger);
         }
         
@@ -68,11 +85,11 @@ namespace TrenchBroom {
             const GameConfig::FileSystemConfig& fileSystemConfig = m_config.fileSystemConfig();
             if (!m_gamePath.isEmpty() && IO::Disk::directoryExists(m_gamePath)) {
                 addSearchPath(fileSystemConfig.searchPath, logger);
-                addPackages(m_gamePath + fileSystemConfig.searchPath);
+                addPackages(m_gamePath + fileSystemConfig.searchPath, logger);
 
                 for (const IO::Path& searchPath : m_additionalSearchPaths) {
                     addSearchPath(searchPath, logger);
-                    addPackages(m_gamePath + searchPath);
+                    addPackages(m_gamePath + searchPath, logger);
             }
         }
         }
@@ -85,7 +102,7 @@ namespace TrenchBroom {
             }
         }
         
-        void GameImpl::addPackages(const IO::Path& searchPath) {
+        void GameImpl::addPackages(const IO::Path& searchPath, Logger* logger) {
             const GameConfig::FileSystemConfig& fileSystemConfig = m_config.fileSystemConfig();
             const GameConfig::PackageFormatConfig& packageFormatConfig = fileSystemConfig.packageFormat;
 
@@ -96,13 +113,19 @@ namespace TrenchBroom {
                 const IO::DiskFileSystem diskFS(searchPath);
                 const IO::Path::List packages = diskFS.findItems(IO::Path(""), IO::FileExtensionMatcher(packageExtensions));
                 for (const IO::Path& packagePath : packages) {
-                    IO::MappedFile::Ptr packageFile = diskFS.openFile(packagePath);
-                    ensure(packageFile.get() != nullptr, "packageFile is null");
-
-                    if (StringUtils::caseInsensitiveEqual(packageFormat, "idpak")) {
-                        m_gameFS.pushFileSystem(new IO::IdPakFileSystem(packagePath, packageFile));
-                    } else if (StringUtils::caseInsensitiveEqual(packageFormat, "dkpak")) {
-                        m_gameFS.pushFileSystem(new IO::DkPakFileSystem(packagePath, packageFile));
+                    try {
+                        IO::MappedFile::Ptr packageFile = diskFS.openFile(packagePath);
+                        ensure(packageFile.get() != nullptr, "packageFile is null");
+
+                        if (StringUtils::caseInsensitiveEqual(packageFormat, "idpak")) {
+                            m_gameFS.pushFileSystem(new IO::IdPakFileSystem(packagePath, packageFile));
+                        } else if (StringUtils::caseInsensitiveEqual(packageFormat, "dkpak")) {
+                            m_gameFS.pushFileSystem(new IO::DkPakFileSystem(packagePath, packageFile));
+                        } else if (StringUtils::caseInsensitiveEqual(packageFormat, "zip")) {
+                            m_gameFS.pushFileSystem(new IO::ZipFileSystem(packagePath, packageFile));
+                        }
+                    } catch (const FileSystemException& e) {
+                        logger->error("Could not add package '" + packagePath.asString() + "': " + String(e.what()));
                     }
                 }
             }
@@ -140,6 +163,10 @@ namespace TrenchBroom {
             return result;
         }
 
+        void GameImpl::doRefreshFileSystem() {
+            m_gameFS.invalidateIndex();
+        }
+
         CompilationConfig& GameImpl::doCompilationConfig() {
             return m_config.compilationConfig();
         }
@@ -167,6 +194,7 @@ namespace TrenchBroom {
             IO::SimpleParserStatus parserStatus(logger);
             const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
             IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder());
+            reader.setThreadCount(defaultThreadCount());
             return reader.read(format, worldBounds, parserStatus);
         }
 
@@ -176,7 +204,7 @@ namespace TrenchBroom {
             IO::OpenFile open(path, true);
             IO::writeGameComment(open.file, gameName(), mapFormatName);
 
-            IO::NodeWriter writer(world, open.file);
+            IO::NodeWriter writer(world, open.file, defaultThreadCount());
             writer.writeMap();
         }
 
@@ -231,6 +259,7 @@ namespace TrenchBroom {
 
             const IO::Path::List fileSearchPaths = textureCollectionSearchPaths(documentPath);
             IO::TextureLoader textureLoader(variables, m_gameFS, fileSearchPaths, m_config.textureConfig(), logger);
+            textureLoader.setCache(m_textureCache);
             textureLoader.loadTextures(paths, textureManager);
         }
 
@@ -304,7 +333,7 @@ namespace TrenchBroom {
             Assets::EntityDefinitionList definitions;
             if (StringUtils::caseInsensitiveEqual("fgd", extension)) {
                 const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
-                IO::FgdParser parser(file->begin(), file->end(), defaultColor, file->path());
+                IO::FgdParser parser(file->begin(), file->end(), defaultColor, file->path(), m_fgdFileCache.get());
                 definitions = parser.parseDefinitions(status);
             } else if (StringUtils::caseInsensitiveEqual("def", extension)) {
                 const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
@@ -394,19 +423,19 @@ namespace TrenchBroom {
         Assets::EntityModel* GameImpl::loadMdlModel(const String& name, const IO::MappedFile::Ptr& file) const {
             const Assets::Palette palette = loadTexturePalette();
 
-            IO::MdlParser parser(name, file->begin(), file->end(), palette);
+            IO::MdlParser parser(name, file, palette);
             return parser.parseModel();
         }
 
         Assets::EntityModel* GameImpl::loadMd2Model(const String& name, const IO::MappedFile::Ptr& file) const {
             const Assets::Palette palette = loadTexturePalette();
 
-            IO::Md2Parser parser(name, file->begin(), file->end(), palette, m_gameFS);
+            IO::Md2Parser parser(name, file, palette, m_gameFS);
             return parser.parseModel();
         }
 
         Assets::EntityModel* GameImpl::loadDkmModel(const String& name, const IO::MappedFile::Ptr& file) const {
-            IO::DkmParser parser(name, file->begin(), file->end(), m_gameFS);
+            IO::DkmParser parser(name, file, m_gameFS);
             return parser.parseModel();
         }
 
@@ -28,8 +28,15 @@
 #include "Model/GameConfig.h"
 #include "Model/ModelTypes.h"
 
+#include <memory>
+
 namespace TrenchBroom {
     class Logger;
+
+    namespace IO {
+        class FgdFileCache;
+        class PersistentTextureCache;
+    }
     
     namespace Model {
         class GameImpl : public Game {
@@ -39,18 +46,21 @@ namespace TrenchBroom {
             IO::Path::List m_additionalSearchPaths;
             
             IO::FileSystemHierarchy m_gameFS;
+            std::shared_ptr<const IO::PersistentTextureCache> m_textureCache;
+            std::shared_ptr<IO::FgdFileCache> m_fgdFileCache;
         public:
             GameImpl(GameConfig& config, const IO::Path& gamePath, Logger* logger);
         private:
             void initializeFileSystem(Logger* logger);
             void addSearchPath(const IO::Path& searchPath, Logger* logger);
-            void addPackages(const IO::Path& searchPath);
+            void addPackages(const IO::Path& searchPath, Logger* logger);
         private:
             const String& doGameName() const override;
             IO::Path doGamePath() const override;
             void doSetGamePath(const IO::Path& gamePath, Logger* logger) override;
             void doSetAdditionalSearchPaths(const IO::Path::List& searchPaths, Logger* logger) override;
             PathErrors doCheckAdditionalSearchPaths(const IO::Path::List& searchPaths) const override;
+            void doRefreshFileSystem() override;
 
             CompilationConfig& doCompilationConfig() override;
 
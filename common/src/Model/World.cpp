@@ -19,6 +19,7 @@
 
 #include "World.h"
 
+#include "Parallel.h"
 #include "Model/AssortNodesVisitor.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
@@ -32,6 +33,7 @@ namespace TrenchBroom {
         m_defaultLayer(nullptr),
         // m_nodeTree(VecCodeComputer<vm::vec3>(worldBounds)),
         m_updateNodeTree(true) {
+            m_nodeTree.setThreadCount(defaultThreadCount());
             addOrUpdateAttribute(AttributeNames::Classname, AttributeValues::WorldspawnClassname);
             createDefaultLayer(worldBounds);
         }
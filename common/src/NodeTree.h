@@ -25,6 +25,7 @@
 
 #include <functional>
 #include <list>
+#include <vector>
 
 template <typename T, size_t S, typename U, typename Cmp = std::less<U>>
 class NodeTree {
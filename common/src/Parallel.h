@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Parallel_h
+#define TrenchBroom_Parallel_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    /**
+     * Returns the number of worker threads to use for parallel work by default. This is the number of hardware
+     * threads reported by the system, or 1 if that number cannot be determined.
+     */
+    inline size_t defaultThreadCount() {
+        const auto count = std::thread::hardware_concurrency();
+        return count > 0 ? static_cast<size_t>(count) : 1u;
+    }
+
+    /**
+     * Calls the given function for every index in [0, count) using up to the given number of threads, including
+     * the calling thread. The indices are handed out dynamically so that uneven work loads are balanced. The
+     * function must be safe to call concurrently for different indices.
+     *
+     * If the function throws, the remaining indices are skipped and the first exception is rethrown on the calling
+     * thread once all workers have finished.
+     *
+     * @param count the number of indices
+     * @param threadCount the maximum number of threads to use, a value of 0 or 1 runs everything on the calling thread
+     * @param func the function to call, must accept a single size_t argument
+     */
+    template <typename F>
+    void parallelFor(const size_t count, const size_t threadCount, F&& func) {
+        const size_t workerCount = std::min(std::max(threadCount, size_t(1)), count);
+        if (workerCount <= 1) {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+
+        const auto work = [&]() {
+            try {
+                size_t i;
+                while (!failed && (i = next++) < count)
+                    func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!failed.exchange(true))
+                    exception = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount - 1);
+        for (size_t i = 0; i < workerCount - 1; ++i)
+            workers.emplace_back(work);
+        work();
+
+        for (auto& worker : workers)
+            worker.join();
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+}
+
+#endif
@@ -29,7 +29,10 @@
 #include <vecmath/scalar.h>
 #include <vecmath/util.h>
 
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
 
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::VertexDistanceCmp {
@@ -316,17 +319,46 @@ void Polyhedron<T,FP,VP>::setBounds(const vm::bbox<T,3>& bounds, Callback& callb
     m_bounds = bounds;
 }
 
+/**
+ * Copies all elements of a polyhedron in bulk. The copies are created type by type in the order of the original lists,
+ * so that consecutive elements of the copy are allocated close to each other. Originals are mapped to their copies
+ * using sorted arrays, which avoids allocating a tree node for every element.
+ */
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::Copy {
 private:
-    typedef std::map<const Vertex*, Vertex*> VertexMap;
-    typedef typename VertexMap::value_type VertexMapEntry;
-    
-    typedef std::map<const HalfEdge*, HalfEdge*> HalfEdgeMap;
-    typedef typename HalfEdgeMap::value_type HalfEdgeMapEntry;
-    
-    VertexMap m_vertexMap;
-    HalfEdgeMap m_halfEdgeMap;
+    template <typename E>
+    class ElementMap {
+    private:
+        typedef std::pair<const E*, E*> Entry;
+        std::vector<Entry> m_entries;
+    public:
+        void reserve(const size_t size) {
+            m_entries.reserve(size);
+        }
+
+        void insert(const E* original, E* copy) {
+            m_entries.emplace_back(original, copy);
+        }
+
+        // must be called after all elements have been inserted and before the first lookup
+        void sort() {
+            std::sort(std::begin(m_entries), std::end(m_entries), [](const Entry& lhs, const Entry& rhs) {
+                return std::less<const E*>()(lhs.first, rhs.first);
+            });
+        }
+
+        E* find(const E* original) const {
+            const auto it = std::lower_bound(std::begin(m_entries), std::end(m_entries), original, [](const Entry& entry, const E* element) {
+                return std::less<const E*>()(entry.first, element);
+            });
+            assert(it != std::end(m_entries) && it->first == original);
+            return it->second;
+        }
+    };
+
+    ElementMap<Vertex> m_vertexMap;
+    ElementMap<HalfEdge> m_halfEdgeMap;
     
     VertexList m_vertices;
     EdgeList m_edges;
@@ -336,25 +368,29 @@ public:
     Copy(const FaceList& originalFaces, const EdgeList& originalEdges, const VertexList& originalVertices, Polyhedron& destination) :
     m_destination(destination) {
         copyVertices(originalVertices);
-        copyFaces(originalFaces);
+        copyFaces(originalFaces, originalEdges);
         copyEdges(originalEdges);
         swapContents();
     }
 private:
     void copyVertices(const VertexList& originalVertices) {
+        m_vertexMap.reserve(originalVertices.size());
         if (!originalVertices.empty()) {
             const Vertex* firstVertex = originalVertices.front();
             const Vertex* currentVertex = firstVertex;
             do {
                 Vertex* copy = new Vertex(currentVertex->position());
-                assertResult(MapUtils::insertOrFail(m_vertexMap, currentVertex, copy));
+                m_vertexMap.insert(currentVertex, copy);
                 m_vertices.append(copy, 1);
                 currentVertex = currentVertex->next();
             } while (currentVertex != firstVertex);
         }
+        m_vertexMap.sort();
     }
     
-    void copyFaces(const FaceList& originalFaces) {
+    void copyFaces(const FaceList& originalFaces, const EdgeList& originalEdges) {
+        // every edge of a closed polyhedron has two half edges, each of which belongs to a face
+        m_halfEdgeMap.reserve(2u * originalEdges.size());
         if (!originalFaces.empty()) {
             const Face* firstFace = originalFaces.front();
             const Face* currentFace = firstFace;
@@ -363,6 +399,7 @@ private:
                 currentFace = currentFace->next();
             } while (currentFace != firstFace);
         }
+        m_halfEdgeMap.sort();
     }
     
     void copyFace(const Face* originalFace) {
@@ -371,7 +408,9 @@ private:
         const HalfEdge* firstHalfEdge = originalFace->m_boundary.front();
         const HalfEdge* currentHalfEdge = firstHalfEdge;
         do {
-            myBoundary.append(copyHalfEdge(currentHalfEdge), 1);
+            HalfEdge* copy = copyHalfEdge(currentHalfEdge);
+            m_halfEdgeMap.insert(currentHalfEdge, copy);
+            myBoundary.append(copy, 1);
             currentHalfEdge = currentHalfEdge->next();
         } while (currentHalfEdge != firstHalfEdge);
         
@@ -379,32 +418,8 @@ private:
         m_faces.append(copy, 1);
     }
     
-    HalfEdgeList copyBoundary(const HalfEdgeList& original) {
-        HalfEdgeList result;
-        
-        const HalfEdge* firstHalfEdge = original.front();
-        const HalfEdge* currentHalfEdge = firstHalfEdge;
-        do {
-            result.append(copyHalfEdge(currentHalfEdge), 1);
-            currentHalfEdge = currentHalfEdge->next();
-        } while (currentHalfEdge != firstHalfEdge);
-        
-        return result;
-    }
-    
-    HalfEdge* copyHalfEdge(const HalfEdge* original) {
-        const Vertex* originalOrigin = original->origin();
-        
-        Vertex* myOrigin = findVertex(originalOrigin);
-        HalfEdge* copy = new HalfEdge(myOrigin);
-        m_halfEdgeMap.insert(std::make_pair(original, copy));
-        return copy;
-    }
-    
-    Vertex* findVertex(const Vertex* original) {
-        typename VertexMap::iterator it = m_vertexMap.find(original);
-        assert(it != std::end(m_vertexMap));
-        return it->second;
+    HalfEdge* copyHalfEdge(const HalfEdge* original) const {
+        return new HalfEdge(m_vertexMap.find(original->origin()));
     }
     
     void copyEdges(const EdgeList& originalEdges) {
@@ -428,18 +443,10 @@ private:
     }
     
     HalfEdge* findOrCopyHalfEdge(const HalfEdge* original) {
-        const auto insertPos = MapUtils::findInsertPos(m_halfEdgeMap, original);
-        if (!insertPos.first) {
-            const Vertex* originalOrigin = original->origin();
-            Vertex* myOrigin = findVertex(originalOrigin);
-            HalfEdge* copy = new HalfEdge(myOrigin);
-            m_halfEdgeMap.insert(insertPos.second, std::make_pair(original, copy));
-            return copy;
-        }
-        
-        const auto it = insertPos.second;
-        assert(it != std::begin(m_halfEdgeMap));
-        return std::prev(it)->second;
+        // only the half edges of faces have been copied already, the half edges of a polyhedron without faces have not
+        if (original->face() == nullptr)
+            return copyHalfEdge(original);
+        return m_halfEdgeMap.find(original);
     }
     
     void swapContents() {
@@ -120,6 +120,8 @@ namespace TrenchBroom {
 
         Preference<int> TextureMinFilter(IO::Path("Renderer/Texture mode min filter"), 0x2700);
         Preference<int> TextureMagFilter(IO::Path("Renderer/Texture mode mag filter"), 0x2600);
+        Preference<bool> TextureLazyLoading(IO::Path("Renderer/Texture lazy loading"), false);
+        Preference<int> TextureMemoryBudget(IO::Path("Renderer/Texture memory budget"), 512); // in MiB
 
         Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
 
@@ -117,6 +117,8 @@ namespace TrenchBroom {
         
         extern Preference<int> TextureMinFilter;
         extern Preference<int> TextureMagFilter;
+        extern Preference<bool> TextureLazyLoading;
+        extern Preference<int> TextureMemoryBudget;
         
         extern Preference<bool> TextureLock;
         
@@ -28,13 +28,19 @@
 #include "Model/NodeVisitor.h"
 #include "Renderer/IndexArrayMapBuilder.h"
 #include "Renderer/BrushRendererArrays.h"
+#include "Renderer/Camera.h"
+#include "Renderer/Frustum.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/TexturedIndexArrayBuilder.h"
 #include "Renderer/VertexSpec.h"
 
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -114,16 +120,42 @@ namespace TrenchBroom {
                                    EdgeRenderPolicy::RenderAll);
         }
 
+        // Chunk
+
+        BrushRenderer::Chunk::Chunk() :
+        vertexArray(std::make_shared<BrushVertexArray>()),
+        edgeIndices(std::make_shared<BrushIndexArray>()),
+        transparentFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        opaqueFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        boundsValid(false) {}
+
+        // BrushInfo
+
+        size_t BrushRenderer::BrushInfo::indexCount() const {
+            size_t result = edgeIndicesKey != nullptr ? edgeIndicesKey->size : 0u;
+            for (const auto& [texture, opaqueKey] : opaqueFaceIndicesKeys) {
+                result += opaqueKey->size;
+            }
+            for (const auto& [texture, transparentKey] : transparentFaceIndicesKeys) {
+                result += transparentKey->size;
+            }
+            return result;
+        }
+
         // BrushRenderer
 
+        const FloatType BrushRenderer::DefaultChunkSize = 2048.0;
+
         BrushRenderer::BrushRenderer(const bool transparent) :
         m_filter(new NoFilter(transparent)),
+        m_chunkSize(0.0),
         m_showEdges(false),
         m_grayscale(false),
         m_tint(false),
         m_showOccludedEdges(false),
         m_transparencyAlpha(1.0f),
-        m_showHiddenBrushes(false) {
+        m_showHiddenBrushes(false),
+        m_threadCount(defaultThreadCount()) {
             clear();
         }
         
@@ -152,8 +184,15 @@ namespace TrenchBroom {
                 }
             }
 
+            // only the brushes that were removed by the previous call can be shown again
+            removeHiddenBrushes(toAdd);
+
             for (auto brush : toRemove) {
-                removeBrush(brush);
+                if (m_brushInfo.find(brush) != m_brushInfo.end()) {
+                    hideBrush(brush);
+                } else {
+                    removeBrush(brush);
+                }
             }
             for (auto brush : toAdd) {
                 addBrush(brush);
@@ -161,6 +200,7 @@ namespace TrenchBroom {
         }
 
         void BrushRenderer::invalidate() {
+            removeHiddenBrushes();
             for (auto& brush : m_allBrushes) {
                 // this will also invalidate already invalid brushes, which
                 // is unnecessary
@@ -169,12 +209,17 @@ namespace TrenchBroom {
             m_invalidBrushes = m_allBrushes;
 
             assert(m_brushInfo.empty());
-            assert(m_transparentFaces->empty());
-            assert(m_opaqueFaces->empty());
+            assert(m_chunks.empty());
         }
 
         void BrushRenderer::invalidateBrushes(const Model::BrushList& brushes) {
             for (auto& brush : brushes) {
+                // hidden brushes must not be shown again
+                if (auto it = m_hiddenBrushes.find(brush); it != m_hiddenBrushes.end()) {
+                    m_hiddenBrushes.erase(it);
+                    removeBrushFromVbo(brush);
+                    continue;
+                }
                 // skip brushes that are not in the renderer
                 if (m_allBrushes.find(brush) == m_allBrushes.end()) {
                     assert(m_brushInfo.find(brush) == m_brushInfo.end());
@@ -197,15 +242,8 @@ namespace TrenchBroom {
             m_brushInfo.clear();
             m_allBrushes.clear();
             m_invalidBrushes.clear();
-
-            m_vertexArray = std::make_shared<BrushVertexArray>();
-            m_edgeIndices = std::make_shared<BrushIndexArray>();
-            m_transparentFaces = std::make_shared<TextureToBrushIndicesMap>();
-            m_opaqueFaces = std::make_shared<TextureToBrushIndicesMap>();
-
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            m_hiddenBrushes.clear();
+            m_chunks.clear();
         }
 
         void BrushRenderer::setFaceColor(const Color& faceColor) {
@@ -251,6 +289,19 @@ namespace TrenchBroom {
             }
         }
 
+        void BrushRenderer::setThreadCount(const size_t threadCount) {
+            m_threadCount = threadCount;
+        }
+
+        void BrushRenderer::setChunkSize(const FloatType chunkSize) {
+            const auto newChunkSize = std::max(chunkSize, 0.0);
+            if (newChunkSize != m_chunkSize) {
+                // the brushes must be moved to different chunks
+                invalidate();
+                m_chunkSize = newChunkSize;
+            }
+        }
+
         void BrushRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             renderOpaque(renderContext, renderBatch);
             renderTransparent(renderContext, renderBatch);
@@ -260,10 +311,11 @@ namespace TrenchBroom {
             if (!m_allBrushes.empty()) {
                 if (!valid())
                     validate();
+                const auto chunks = visibleChunks(renderContext.camera());
                 if (renderContext.showFaces())
-                    renderOpaqueFaces(renderBatch);
+                    renderOpaqueFaces(chunks, renderBatch);
                 if (renderContext.showEdges() || m_showEdges)
-                    renderEdges(renderBatch);
+                    renderEdges(chunks, renderBatch);
             }
         }
         
@@ -272,29 +324,56 @@ namespace TrenchBroom {
                 if (!valid())
                     validate();
                 if (renderContext.showFaces())
-                    renderTransparentFaces(renderBatch);
+                    renderTransparentFaces(visibleChunks(renderContext.camera()), renderBatch);
             }
         }
 
-        void BrushRenderer::renderOpaqueFaces(RenderBatch& renderBatch) {
-            m_opaqueFaceRenderer.setGrayscale(m_grayscale);
-            m_opaqueFaceRenderer.setTint(m_tint);
-            m_opaqueFaceRenderer.setTintColor(m_tintColor);
-            m_opaqueFaceRenderer.render(renderBatch);
+        void BrushRenderer::renderOpaqueFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            for (auto* chunk : chunks) {
+                FaceRenderer& faceRenderer = chunk->opaqueFaceRenderer;
+                faceRenderer.setGrayscale(m_grayscale);
+                faceRenderer.setTint(m_tint);
+                faceRenderer.setTintColor(m_tintColor);
+                faceRenderer.render(renderBatch);
+            }
         }
         
-        void BrushRenderer::renderTransparentFaces(RenderBatch& renderBatch) {
-            m_transparentFaceRenderer.setGrayscale(m_grayscale);
-            m_transparentFaceRenderer.setTint(m_tint);
-            m_transparentFaceRenderer.setTintColor(m_tintColor);
-            m_transparentFaceRenderer.setAlpha(m_transparencyAlpha);
-            m_transparentFaceRenderer.render(renderBatch);
+        void BrushRenderer::renderTransparentFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            for (auto* chunk : chunks) {
+                FaceRenderer& faceRenderer = chunk->transparentFaceRenderer;
+                faceRenderer.setGrayscale(m_grayscale);
+                faceRenderer.setTint(m_tint);
+                faceRenderer.setTintColor(m_tintColor);
+                faceRenderer.setAlpha(m_transparencyAlpha);
+                faceRenderer.render(renderBatch);
+            }
         }
         
-        void BrushRenderer::renderEdges(RenderBatch& renderBatch) {
-            if (m_showOccludedEdges)
-                m_edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
-            m_edgeRenderer.render(renderBatch, m_edgeColor);
+        void BrushRenderer::renderEdges(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            for (auto* chunk : chunks) {
+                if (m_showOccludedEdges)
+                    chunk->edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
+                chunk->edgeRenderer.render(renderBatch, m_edgeColor);
+            }
+        }
+
+        std::vector<BrushRenderer::Chunk*> BrushRenderer::visibleChunks(const Camera& camera) {
+            std::vector<Chunk*> result;
+            result.reserve(m_chunks.size());
+
+            if (m_chunkSize > 0.0) {
+                const Frustum frustum(camera);
+                for (auto& [key, chunk] : m_chunks) {
+                    if (frustum.intersects(vm::bbox3f(chunk.bounds))) {
+                        result.push_back(&chunk);
+                    }
+                }
+            } else {
+                for (auto& [key, chunk] : m_chunks) {
+                    result.push_back(&chunk);
+                }
+            }
+            return result;
         }
 
         class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
@@ -321,18 +400,102 @@ namespace TrenchBroom {
             }
         };
 
+        /**
+         * Evaluates the given filter for the given brush and builds the brush's vertices if it is rendered. This only
+         * touches the brush and its faces, so it can be called for different brushes concurrently.
+         */
+        static BrushRenderer::Filter::RenderSettings prepareBrush(const BrushRenderer::Filter& filter, const Model::Brush* brush) {
+            using Filter = BrushRenderer::Filter;
+
+            // evaluate filter. only evaluate the filter once per brush.
+            const auto settings = filter.markFaces(brush);
+            [[maybe_unused]] const auto [renderType, facePolicy, edgePolicy] = settings;
+
+            if (facePolicy != Filter::FaceRenderPolicy::RenderNone ||
+                edgePolicy != Filter::EdgeRenderPolicy::RenderNone) {
+                brush->brushRendererBrushCache().validateVertexCache(brush);
+            }
+            return settings;
+        }
+
+        // validating a few brushes, e.g. after an edit, is not worth starting threads
+        static const size_t MinParallelBrushes = 256;
+
         void BrushRenderer::validate() {
             assert(!valid());
 
-            for (auto brush : m_invalidBrushes) {
-                validateBrush(brush);
+            // The filter and the vertices of each brush are computed in parallel, but the brushes must be added to the
+            // vertex and index arrays one after another because they share the allocation trackers.
+            const std::vector<const Model::Brush*> brushes(std::begin(m_invalidBrushes), std::end(m_invalidBrushes));
+            std::vector<Filter::RenderSettings> settings(brushes.size());
+
+            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
+            const auto threadCount = brushes.size() >= MinParallelBrushes ? m_threadCount : 1u;
+            parallelFor(brushes.size(), threadCount, [&](const size_t i) {
+                settings[i] = prepareBrush(wrapper, brushes[i]);
+            });
+
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                validateBrush(brushes[i], settings[i]);
             }
             m_invalidBrushes.clear();
             assert(valid());
 
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            // only the bounds of chunks that lost brushes must be recomputed
+            for (auto& [key, chunk] : m_chunks) {
+                if (!chunk.boundsValid) {
+                    assert(!chunk.brushes.empty());
+                    // hidden brushes may have been deleted already, so only their stored bounds may be used
+                    chunk.bounds = m_brushInfo.at(*std::begin(chunk.brushes)).bounds;
+                    for (const auto* brush : chunk.brushes) {
+                        chunk.bounds = vm::merge(chunk.bounds, m_brushInfo.at(brush).bounds);
+                    }
+                    chunk.boundsValid = true;
+                }
+
+                chunk.opaqueFaceRenderer = FaceRenderer(chunk.vertexArray, chunk.opaqueFaces, m_faceColor);
+                chunk.transparentFaceRenderer = FaceRenderer(chunk.vertexArray, chunk.transparentFaces, m_faceColor);
+                chunk.edgeRenderer = IndexedEdgeRenderer(chunk.vertexArray, chunk.edgeIndices);
+            }
+        }
+
+        size_t BrushRenderer::chunkCount() const {
+            assert(valid());
+            return m_chunks.size();
+        }
+
+        size_t BrushRenderer::visibleChunkCount(const Camera& camera) {
+            assert(valid());
+            return visibleChunks(camera).size();
+        }
+
+        BrushRenderer::MemoryUsage BrushRenderer::memoryUsage() const {
+            assert(valid());
+
+            MemoryUsage result{0u, 0u, 0u, 0u};
+            for (const auto& [brush, info] : m_brushInfo) {
+                // hidden brushes may have been deleted already
+                if (m_hiddenBrushes.find(brush) != m_hiddenBrushes.end()) {
+                    continue;
+                }
+
+                result.brushCount += 1u;
+                result.brushCacheBytes += brush->brushRendererBrushCache().memoryUsage();
+                result.vertexBytes += info.vertexHolderKey->size * sizeof(BrushRendererBrushCache::Vertex);
+                result.indexBytes += info.indexCount() * sizeof(GLuint);
+            }
+            return result;
+        }
+
+        BrushRenderer::ChunkMap::iterator BrushRenderer::findOrCreateChunk(const Model::Brush* brush) {
+            ChunkKey key = ChunkKey::zero;
+            if (m_chunkSize > 0.0) {
+                const auto center = brush->bounds().center();
+                for (size_t i = 0; i < 3; ++i) {
+                    key[i] = static_cast<long>(std::floor(center[i] / m_chunkSize));
+                }
+            }
+            return m_chunks.try_emplace(key).first;
         }
 
         static size_t triIndicesCountForPolygon(const size_t vertexCount) {
@@ -351,6 +514,7 @@ namespace TrenchBroom {
         }
 
         static inline bool shouldRenderEdge(const BrushRendererBrushCache::CachedEdge& edge,
+                                            const std::vector<BrushRendererBrushCache::CachedFace>& faces,
                                             const BrushRenderer::Filter::EdgeRenderPolicy policy) {
             using EdgeRenderPolicy = BrushRenderer::Filter::EdgeRenderPolicy;
 
@@ -358,9 +522,9 @@ namespace TrenchBroom {
                 case EdgeRenderPolicy::RenderAll:
                     return true;
                 case EdgeRenderPolicy::RenderIfEitherFaceMarked:
-                    return edge.face1->isMarked() || edge.face2->isMarked();
+                    return faces[edge.faceIndex1].face->isMarked() || faces[edge.faceIndex2].face->isMarked();
                 case EdgeRenderPolicy::RenderIfBothFacesMarked:
-                    return edge.face1->isMarked() && edge.face2->isMarked();
+                    return faces[edge.faceIndex1].face->isMarked() && faces[edge.faceIndex2].face->isMarked();
                 case EdgeRenderPolicy::RenderNone:
                     return false;
                     switchDefault()
@@ -374,15 +538,28 @@ namespace TrenchBroom {
                 return 0;
             }
 
+            const auto& brushCache = brush->brushRendererBrushCache();
+            const auto& faces = brushCache.cachedFacesSortedByTexture();
+
             size_t indexCount = 0;
-            for (const auto& edge : brush->brushRendererBrushCache().cachedEdges()) {
-                if (shouldRenderEdge(edge, policy)) {
+            for (const auto& edge : brushCache.cachedEdges()) {
+                if (shouldRenderEdge(edge, faces, policy)) {
                     indexCount += 2;
                 }
             }
             return indexCount;
         }
 
+        static void getMarkedFaces(const Model::Brush* brush, std::vector<bool>& result) {
+            const auto& faces = brush->brushRendererBrushCache().cachedFacesSortedByTexture();
+
+            result.clear();
+            result.reserve(faces.size());
+            for (const auto& cache : faces) {
+                result.push_back(cache.face->isMarked());
+            }
+        }
+
         static void getMarkedEdgeIndices(const Model::Brush* brush,
                                          const BrushRenderer::Filter::EdgeRenderPolicy policy,
                                          const GLuint brushVerticesStartIndex,
@@ -393,24 +570,23 @@ namespace TrenchBroom {
                 return;
             }
 
+            const auto& brushCache = brush->brushRendererBrushCache();
+            const auto& faces = brushCache.cachedFacesSortedByTexture();
+
             size_t i = 0;
-            for (const auto& edge : brush->brushRendererBrushCache().cachedEdges()) {
-                if (shouldRenderEdge(edge, policy)) {
+            for (const auto& edge : brushCache.cachedEdges()) {
+                if (shouldRenderEdge(edge, faces, policy)) {
                     dest[i++] = static_cast<GLuint>(brushVerticesStartIndex + edge.vertexIndex1RelativeToBrush);
                     dest[i++] = static_cast<GLuint>(brushVerticesStartIndex + edge.vertexIndex2RelativeToBrush);
                 }
             }
         }
 
-        void BrushRenderer::validateBrush(const Model::Brush* brush) {
+        void BrushRenderer::validateBrush(const Model::Brush* brush, const Filter::RenderSettings& settings) {
             assert(m_allBrushes.find(brush) != m_allBrushes.end());
             assert(m_invalidBrushes.find(brush) != m_invalidBrushes.end());
             assert(m_brushInfo.find(brush) == m_brushInfo.end());
 
-            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
-
-            // evaluate filter. only evaluate the filter once per brush.
-            const auto settings = wrapper.markFaces(brush);
             const auto [renderType, facePolicy, edgePolicy] = settings;
 
             if (facePolicy == Filter::FaceRenderPolicy::RenderNone &&
@@ -419,17 +595,33 @@ namespace TrenchBroom {
                 return;
             }
 
+            const auto chunkIt = findOrCreateChunk(brush);
+            Chunk& chunk = chunkIt->second;
+            chunk.brushes.insert(brush);
+            if (chunk.boundsValid) {
+                chunk.bounds = vm::merge(chunk.bounds, brush->bounds());
+            } else if (chunk.brushes.size() == 1u) {
+                chunk.bounds = brush->bounds();
+                chunk.boundsValid = true;
+            }
+
             BrushInfo& info = m_brushInfo[brush];
+            info.chunk = chunkIt;
+            info.bounds = brush->bounds();
+            info.cacheGeneration = brush->brushRendererBrushCache().generation();
+            info.settings = settings;
 
-            // collect vertices
-            auto& brushCache = brush->brushRendererBrushCache();
-            brushCache.validateVertexCache(brush);
+            // collect vertices, the cache was validated in prepareBrush
+            const auto& brushCache = brush->brushRendererBrushCache();
             const auto& cachedVertices = brushCache.cachedVertices();
             ensure(!cachedVertices.empty(), "Brush must have cached vertices");
 
-            assert(m_vertexArray != nullptr);
-            auto [vertBlock, dest] = m_vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
-            std::memcpy(dest, cachedVertices.data(), cachedVertices.size() * sizeof(*dest));
+            // remember the face marks so that showBrush can tell whether the filter result has changed
+            getMarkedFaces(brush, info.markedFaces);
+
+            assert(chunk.vertexArray != nullptr);
+            auto [vertBlock, dest] = chunk.vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
+            brushCache.writeVertices(dest);
             info.vertexHolderKey = vertBlock;
 
             const GLuint brushVerticesStartIndex = static_cast<GLuint>(vertBlock->pos);
@@ -438,7 +630,7 @@ namespace TrenchBroom {
             {
                 const size_t edgeIndexCount = countMarkedEdgeIndices(brush, edgePolicy);
                 if (edgeIndexCount > 0) {
-                    auto[key, dest] = m_edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
+                    auto[key, dest] = chunk.edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
                     info.edgeIndicesKey = key;
                     getMarkedEdgeIndices(brush, edgePolicy, brushVerticesStartIndex, dest);
                 } else {
@@ -455,7 +647,7 @@ namespace TrenchBroom {
             const size_t facesSortedByTexSize = facesSortedByTex.size();
 
             std::shared_ptr<TextureToBrushIndicesMap> faceVboPtr = \
-                (renderType == Filter::RenderOpacity::Opaque) ? m_opaqueFaces : m_transparentFaces;
+                (renderType == Filter::RenderOpacity::Opaque) ? chunk.opaqueFaces : chunk.transparentFaces;
 
             size_t nextI;
             for (size_t i = 0; i < facesSortedByTexSize; i = nextI) {
@@ -520,6 +712,9 @@ namespace TrenchBroom {
             // i.e. insert the brush as "invalid" if it's not already present.
             // if it is present, its validity is unchanged.
             if (m_allBrushes.find(brush) == m_allBrushes.end()) {
+                if (m_hiddenBrushes.find(brush) != m_hiddenBrushes.end() && showBrush(brush)) {
+                    return;
+                }
                 assert(m_brushInfo.find(brush) == m_brushInfo.end());
 
                 [[maybe_unused]] auto result = m_allBrushes.insert(brush);
@@ -548,6 +743,80 @@ namespace TrenchBroom {
             removeBrushFromVbo(brush);
         }
 
+        void BrushRenderer::hideBrush(const Model::Brush* brush) {
+            assert(m_invalidBrushes.find(brush) == m_invalidBrushes.end());
+
+            m_allBrushes.erase(brush);
+            m_hiddenBrushes.insert(brush);
+
+            BrushInfo& info = m_brushInfo.at(brush);
+            Chunk& chunk = info.chunk->second;
+            assert(info.hiddenIndices.empty());
+            info.hiddenIndices.reserve(info.indexCount());
+
+            // the vertices stay where they are, only the indices referring to them are zeroed
+            if (info.edgeIndicesKey != nullptr) {
+                chunk.edgeIndices->hideElementsWithKey(info.edgeIndicesKey, info.hiddenIndices);
+            }
+            for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
+                chunk.opaqueFaces->at(texture)->hideElementsWithKey(opaqueKey, info.hiddenIndices);
+            }
+            for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
+                chunk.transparentFaces->at(texture)->hideElementsWithKey(transparentKey, info.hiddenIndices);
+            }
+        }
+
+        bool BrushRenderer::showBrush(const Model::Brush* brush) {
+            assert(m_allBrushes.find(brush) == m_allBrushes.end());
+
+            m_hiddenBrushes.erase(brush);
+
+            BrushInfo& info = m_brushInfo.at(brush);
+            if (info.cacheGeneration != brush->brushRendererBrushCache().generation()) {
+                // the brush has changed since it was hidden
+                removeBrushFromVbo(brush);
+                return false;
+            }
+
+            // the filter result may have changed without changing the brush, e.g. if an entity property has changed
+            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
+            const auto settings = wrapper.markFaces(brush);
+            std::vector<bool> markedFaces;
+            getMarkedFaces(brush, markedFaces);
+            if (settings != info.settings || markedFaces != info.markedFaces) {
+                removeBrushFromVbo(brush);
+                return false;
+            }
+
+            Chunk& chunk = info.chunk->second;
+            const GLuint* hiddenIndices = info.hiddenIndices.data();
+            if (info.edgeIndicesKey != nullptr) {
+                hiddenIndices = chunk.edgeIndices->restoreElementsWithKey(info.edgeIndicesKey, hiddenIndices);
+            }
+            for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
+                hiddenIndices = chunk.opaqueFaces->at(texture)->restoreElementsWithKey(opaqueKey, hiddenIndices);
+            }
+            for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
+                hiddenIndices = chunk.transparentFaces->at(texture)->restoreElementsWithKey(transparentKey, hiddenIndices);
+            }
+            assert(hiddenIndices == info.hiddenIndices.data() + info.hiddenIndices.size());
+            info.hiddenIndices.clear();
+
+            m_allBrushes.insert(brush);
+            return true;
+        }
+
+        void BrushRenderer::removeHiddenBrushes(const std::set<const Model::Brush*>& keep) {
+            for (auto it = std::begin(m_hiddenBrushes); it != std::end(m_hiddenBrushes); ) {
+                if (keep.find(*it) == keep.end()) {
+                    removeBrushFromVbo(*it);
+                    it = m_hiddenBrushes.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
         void BrushRenderer::removeBrushFromVbo(const Model::Brush* brush) {
             auto it = m_brushInfo.find(brush);
 
@@ -558,32 +827,42 @@ namespace TrenchBroom {
             }
 
             const BrushInfo& info = it->second;
+            Chunk& chunk = info.chunk->second;
 
             // update Vbo's
-            m_vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
+            chunk.vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
             if (info.edgeIndicesKey != nullptr) {
-                m_edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
+                chunk.edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
             }
 
             for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_opaqueFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.opaqueFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(opaqueKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_opaqueFaces->erase(texture);
+                    chunk.opaqueFaces->erase(texture);
                 }
             }
             for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_transparentFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.transparentFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(transparentKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_transparentFaces->erase(texture);
+                    chunk.transparentFaces->erase(texture);
                 }
             }
 
+            chunk.brushes.erase(brush);
+            if (chunk.brushes.empty()) {
+                // this releases the chunk's vertex and index arrays
+                m_chunks.erase(info.chunk);
+            } else {
+                // the bounds can only shrink, so they are recomputed lazily in validate()
+                chunk.boundsValid = false;
+            }
+
             m_brushInfo.erase(it);
         }
     }
@@ -26,10 +26,18 @@
 #include "Renderer/FaceRenderer.h"
 #include "Model/Brush.h"
 #include "Renderer/AllocationTracker.h"
+#include "Parallel.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+#include <vecmath/bbox.h>
 
 #include <tuple>
 #include <map>
+#include <memory>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -37,6 +45,7 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class Camera;
         class RenderBatch;
         class RenderContext;
         class Vbo;
@@ -123,16 +132,62 @@ namespace TrenchBroom {
                 NoFilter(const NoFilter& other);
                 NoFilter& operator=(const NoFilter& other);
             };
+        public:
+            /**
+             * The chunk size that MapRenderer uses for the brushes that are not selected.
+             */
+            static const FloatType DefaultChunkSize;
+
+            struct MemoryUsage {
+                size_t brushCount;
+                size_t brushCacheBytes;
+                size_t vertexBytes;
+                size_t indexBytes;
+            };
         private:
             class FilterWrapper;
+
+            /**
+             * The brushes are grouped into chunks, and every chunk has its own vertex and index arrays. In chunked mode,
+             * a chunk holds the brushes whose centers are in the same cubic cell of the chunk size, and chunks whose
+             * bounds are outside of the camera's view frustum are not rendered. Otherwise, all brushes are stored in a
+             * single chunk that is always rendered.
+             */
+            struct Chunk {
+                BrushVertexArrayPtr vertexArray;
+                BrushIndexArrayPtr edgeIndices;
+                std::shared_ptr<TextureToBrushIndicesMap> transparentFaces;
+                std::shared_ptr<TextureToBrushIndicesMap> opaqueFaces;
+
+                FaceRenderer opaqueFaceRenderer;
+                FaceRenderer transparentFaceRenderer;
+                IndexedEdgeRenderer edgeRenderer;
+
+                std::set<const Model::Brush*> brushes;
+                vm::bbox3 bounds;
+                bool boundsValid;
+
+                Chunk();
+            };
+
+            using ChunkKey = vm::vec<long,3>;
+            using ChunkMap = std::map<ChunkKey, Chunk>;
         private:
             Filter* m_filter;
 
             struct BrushInfo {
+                ChunkMap::iterator chunk;
                 AllocationTracker::Block* vertexHolderKey;
                 AllocationTracker::Block* edgeIndicesKey;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> opaqueFaceIndicesKeys;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> transparentFaceIndicesKeys;
+                vm::bbox3 bounds;
+                size_t cacheGeneration;
+                Filter::RenderSettings settings;
+                std::vector<bool> markedFaces;
+                std::vector<GLuint> hiddenIndices;
+
+                size_t indexCount() const;
             };
             /**
              * Tracks all brushes that are stored in the VBO, with the information necessary to remove them
@@ -147,15 +202,16 @@ namespace TrenchBroom {
             std::set<const Model::Brush*> m_allBrushes;
             std::set<const Model::Brush*> m_invalidBrushes;
 
-            BrushVertexArrayPtr m_vertexArray;
-            BrushIndexArrayPtr m_edgeIndices;
-            std::shared_ptr<TextureToBrushIndicesMap> m_transparentFaces;
-            std::shared_ptr<TextureToBrushIndicesMap> m_opaqueFaces;
+            /**
+             * Brushes that were removed by the last call to setBrushes(). They are still in the VBO, but their indices
+             * are zeroed out, so that they can be shown again cheaply if the next call to setBrushes() adds them
+             * back, e.g. when the selection is toggled. They are not in m_allBrushes.
+             */
+            std::set<const Model::Brush*> m_hiddenBrushes;
+
+            ChunkMap m_chunks;
+            FloatType m_chunkSize;
 
-            FaceRenderer m_opaqueFaceRenderer;
-            FaceRenderer m_transparentFaceRenderer;
-            IndexedEdgeRenderer m_edgeRenderer;
-            
             Color m_faceColor;
             bool m_showEdges;
             Color m_edgeColor;
@@ -167,16 +223,20 @@ namespace TrenchBroom {
             float m_transparencyAlpha;
             
             bool m_showHiddenBrushes;
+
+            size_t m_threadCount;
         public:
             template <typename FilterT>
             BrushRenderer(const FilterT& filter) :
             m_filter(new FilterT(filter)),
+            m_chunkSize(0.0),
             m_showEdges(false),
             m_grayscale(false),
             m_tint(false),
             m_showOccludedEdges(false),
             m_transparencyAlpha(1.0f),
-            m_showHiddenBrushes(false) {
+            m_showHiddenBrushes(false),
+            m_threadCount(defaultThreadCount()) {
                 clear();
             }
             
@@ -190,6 +250,9 @@ namespace TrenchBroom {
             void addBrushes(const Model::BrushList& brushes);
             /**
              * New brushes are invalidated, brushes already in the BrushRenderer are not invalidated.
+             *
+             * Removed brushes are only hidden until the next call, and unchanged brushes that are added back by the
+             * next call are shown again without evaluating the filter or copying their vertices.
              */
             void setBrushes(const Model::BrushList& brushes);
             void clear();
@@ -201,8 +264,8 @@ namespace TrenchBroom {
              *
              * Until a brush is invalidated, we don't re-evaluate the Filter, and don't check the Brush object for modification.
              *
-             * Additionally, calling `invalidate()` guarantees the m_brushInfo, m_transparentFaces, and m_opaqueFaces
-             * maps will be empty, so the BrushRenderer will not have any lingering Texture* pointers.
+             * Additionally, calling `invalidate()` guarantees the m_brushInfo and m_chunks maps will be empty, so the
+             * BrushRenderer will not have any lingering Texture* pointers.
              */
             void invalidate();
             void invalidateBrushes(const Model::BrushList& brushes);
@@ -218,25 +281,80 @@ namespace TrenchBroom {
             void setOccludedEdgeColor(const Color& occludedEdgeColor);
             void setTransparencyAlpha(float transparencyAlpha);
             void setShowHiddenBrushes(bool showHiddenBrushes);
+
+            /**
+             * Sets the number of threads that evaluate the filter and build the vertices of the invalid brushes in
+             * validate(). A value of 0 or 1 validates all brushes on the calling thread.
+             */
+            void setThreadCount(size_t threadCount);
+
+            /**
+             * Switches to chunked mode if the given chunk size is positive, and back to storing all brushes in a single
+             * chunk otherwise. Changing the chunk size invalidates all brushes.
+             */
+            void setChunkSize(FloatType chunkSize);
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
-            void renderOpaqueFaces(RenderBatch& renderBatch);
-            void renderTransparentFaces(RenderBatch& renderBatch);
-            void renderEdges(RenderBatch& renderBatch);
+            void renderOpaqueFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
+            void renderTransparentFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
+            void renderEdges(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
+
+            /**
+             * Returns the chunks that intersect with the view frustum of the given camera, or all chunks if this
+             * renderer is not in chunked mode.
+             */
+            std::vector<Chunk*> visibleChunks(const Camera& camera);
 
         public:
             /**
              * Only exposed for benchmarking.
              */
             void validate();
+
+            /**
+             * Only exposed for testing. The renderer must be valid.
+             */
+            size_t chunkCount() const;
+            size_t visibleChunkCount(const Camera& camera);
+
+            /**
+             * Returns the memory used by the brushes that are currently rendered, both by their vertex caches and by
+             * their vertices and indices in this renderer's VBOs. The renderer must be valid.
+             */
+            MemoryUsage memoryUsage() const;
         private:
-            void validateBrush(const Model::Brush* brush);
+            ChunkMap::iterator findOrCreateChunk(const Model::Brush* brush);
+
+            /**
+             * Copies the cached vertices of the given brush into the vertex array and adds its indices to the index
+             * arrays according to the given settings. The filter must have been evaluated and the brush's vertex
+             * cache must have been validated already, see validate().
+             */
+            void validateBrush(const Model::Brush* brush, const Filter::RenderSettings& settings);
             void addBrush(const Model::Brush* brush);
             void removeBrush(const Model::Brush* brush);
 
+            /**
+             * Zeroes out the indices of the given brush, which must be in the VBO, and keeps them in its BrushInfo.
+             */
+            void hideBrush(const Model::Brush* brush);
+
+            /**
+             * Restores the indices of the given hidden brush if neither the brush nor the result of the filter for it
+             * have changed since it was hidden, and otherwise removes it from the VBO. The filter is evaluated again
+             * because it depends on state that does not change the brush, e.g. the properties of its entity. Returns
+             * whether the brush was restored.
+             */
+            bool showBrush(const Model::Brush* brush);
+
+            /**
+             * Removes all hidden brushes from the VBO, except for the given ones if they are hidden.
+             */
+            void removeHiddenBrushes(const std::set<const Model::Brush*>& keep = std::set<const Model::Brush*>());
+
             /**
              * If the given brush is not currently in the VBO, it's silently ignored.
              * Otherwise, it's removed from the VBO (having its indices zeroed out, causing it to no longer draw).
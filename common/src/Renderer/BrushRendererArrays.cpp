@@ -128,6 +128,19 @@ namespace TrenchBroom {
             m_indexHolder.zeroRange(pos, size);
         }
 
+        void BrushIndexArray::hideElementsWithKey(AllocationTracker::Block* key, std::vector<GLuint>& hiddenElements) {
+            const GLuint* src = m_indexHolder.getPointerToWriteElementsTo(key->pos, key->size);
+            hiddenElements.insert(std::end(hiddenElements), src, src + key->size);
+
+            m_indexHolder.zeroRange(key->pos, key->size);
+        }
+
+        const GLuint* BrushIndexArray::restoreElementsWithKey(AllocationTracker::Block* key, const GLuint* hiddenElements) {
+            GLuint* dest = m_indexHolder.getPointerToWriteElementsTo(key->pos, key->size);
+            std::memcpy(dest, hiddenElements, key->size * sizeof(GLuint));
+            return hiddenElements + key->size;
+        }
+
         void BrushIndexArray::render(const PrimType primType) const {
             assert(m_indexHolder.prepared());
             m_indexHolder.render(primType, 0, m_indexHolder.size());
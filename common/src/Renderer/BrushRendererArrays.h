@@ -243,6 +243,19 @@ namespace TrenchBroom {
              */
             void zeroElementsWithKey(AllocationTracker::Block* key);
 
+            /**
+             * Appends the indices of the given allocation to the given vector and zeroes them, but keeps the
+             * allocation, so that they can be put back with restoreElementsWithKey() without allocating again.
+             */
+            void hideElementsWithKey(AllocationTracker::Block* key, std::vector<GLuint>& hiddenElements);
+
+            /**
+             * Writes the indices that were hidden by hideElementsWithKey() back to the given allocation.
+             *
+             * Returns a pointer to the indices following the ones that were restored.
+             */
+            const GLuint* restoreElementsWithKey(AllocationTracker::Block* key, const GLuint* hiddenElements);
+
             void render(const PrimType primType) const;
             bool prepared() const;
             void prepare(Vbo& vbo);
@@ -23,26 +23,38 @@
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace TrenchBroom {
     namespace Renderer {
+        // the caches of different brushes may be validated concurrently
+        static std::atomic<size_t> NextGeneration(1);
+
+        BrushRendererBrushCache::CachedVertex::CachedVertex(const vm::vec3f& i_position,
+                                                            const vm::vec2f& i_texCoords)
+                : position(i_position),
+                  texCoords(i_texCoords) {}
+
         BrushRendererBrushCache::CachedFace::CachedFace(Model::BrushFace* i_face,
                                                         const size_t i_indexOfFirstVertexRelativeToBrush)
                 : texture(i_face->texture()),
                   face(i_face),
-                  vertexCount(i_face->vertexCount()),
-                  indexOfFirstVertexRelativeToBrush(i_indexOfFirstVertexRelativeToBrush) {}
+                  vertexCount(static_cast<GLuint>(i_face->vertexCount())),
+                  indexOfFirstVertexRelativeToBrush(static_cast<GLuint>(i_indexOfFirstVertexRelativeToBrush)) {}
 
-        BrushRendererBrushCache::CachedEdge::CachedEdge(Model::BrushFace* i_face1,
-                                                        Model::BrushFace* i_face2,
+        BrushRendererBrushCache::CachedEdge::CachedEdge(const size_t i_faceIndex1,
+                                                        const size_t i_faceIndex2,
                                                         const size_t i_vertexIndex1RelativeToBrush,
                                                         const size_t i_vertexIndex2RelativeToBrush)
-                : face1(i_face1),
-                  face2(i_face2),
-                  vertexIndex1RelativeToBrush(i_vertexIndex1RelativeToBrush),
-                  vertexIndex2RelativeToBrush(i_vertexIndex2RelativeToBrush) {}
+                : faceIndex1(static_cast<GLuint>(i_faceIndex1)),
+                  faceIndex2(static_cast<GLuint>(i_faceIndex2)),
+                  vertexIndex1RelativeToBrush(static_cast<GLuint>(i_vertexIndex1RelativeToBrush)),
+                  vertexIndex2RelativeToBrush(static_cast<GLuint>(i_vertexIndex2RelativeToBrush)) {}
 
         BrushRendererBrushCache::BrushRendererBrushCache()
-                : m_rendererCacheValid(false) {}
+                : m_rendererCacheValid(false),
+                  m_generation(0) {}
 
         void BrushRendererBrushCache::invalidateVertexCache() {
             m_rendererCacheValid = false;
@@ -58,8 +70,13 @@ namespace TrenchBroom {
 
             // build vertex cache and face cache
 
+            size_t vertexCount = 0;
+            for (const Model::BrushFace* face : brush->faces()) {
+                vertexCount += face->vertexCount();
+            }
+
             m_cachedVertices.clear();
-            m_cachedVertices.reserve(brush->vertexCount());
+            m_cachedVertices.reserve(vertexCount);
 
             m_cachedFacesSortedByTexture.clear();
             m_cachedFacesSortedByTexture.reserve(brush->faceCount());
@@ -80,7 +97,7 @@ namespace TrenchBroom {
                     vertex->setPayload(static_cast<GLuint>(currentIndex));
 
                     const auto& position = vertex->position();
-                    m_cachedVertices.emplace_back(vm::vec3f(position), vm::vec3f(face->boundary().normal), face->textureCoords(position));
+                    m_cachedVertices.emplace_back(vm::vec3f(position), face->textureCoords(position));
 
                     // The boundary is in CCW order, but the renderer expects CW order:
                     current = current->previous();
@@ -102,19 +119,28 @@ namespace TrenchBroom {
             m_cachedEdges.clear();
             m_cachedEdges.reserve(brush->edgeCount());
 
+            // Store the index of each face in the sorted face cache in the face, like the vertex indices above, so that
+            // the faces of an edge can be looked up in constant time.
+            for (size_t i = 0; i < m_cachedFacesSortedByTexture.size(); ++i) {
+                m_cachedFacesSortedByTexture[i].face->setRendererCacheIndex(i);
+            }
+
             for (const Model::BrushEdge* currentEdge : brush->edges()) {
-                const auto face1 = currentEdge->firstFace()->payload();
-                const auto face2 = currentEdge->secondFace()->payload();
+                const auto faceIndex1 = currentEdge->firstFace()->payload()->rendererCacheIndex();
+                const auto faceIndex2 = currentEdge->secondFace()->payload()->rendererCacheIndex();
+                assert(m_cachedFacesSortedByTexture[faceIndex1].face == currentEdge->firstFace()->payload());
+                assert(m_cachedFacesSortedByTexture[faceIndex2].face == currentEdge->secondFace()->payload());
                 const auto vertexIndex1RelativeToBrush = currentEdge->firstVertex()->payload();
                 const auto vertexIndex2RelativeToBrush = currentEdge->secondVertex()->payload();
 
-                m_cachedEdges.emplace_back(face1, face2, vertexIndex1RelativeToBrush, vertexIndex2RelativeToBrush);
+                m_cachedEdges.emplace_back(faceIndex1, faceIndex2, vertexIndex1RelativeToBrush, vertexIndex2RelativeToBrush);
             }
 
             m_rendererCacheValid = true;
+            m_generation = NextGeneration++;
         }
 
-        const std::vector<BrushRendererBrushCache::Vertex>& BrushRendererBrushCache::cachedVertices() const {
+        const std::vector<BrushRendererBrushCache::CachedVertex>& BrushRendererBrushCache::cachedVertices() const {
             assert(m_rendererCacheValid);
             return m_cachedVertices;
         }
@@ -128,5 +154,29 @@ namespace TrenchBroom {
             assert(m_rendererCacheValid);
             return m_cachedEdges;
         }
+
+        void BrushRendererBrushCache::writeVertices(Vertex* dest) const {
+            assert(m_rendererCacheValid);
+            for (const CachedFace& cachedFace : m_cachedFacesSortedByTexture) {
+                const vm::vec3f normal(cachedFace.face->boundary().normal);
+                const auto* vertex = m_cachedVertices.data() + cachedFace.indexOfFirstVertexRelativeToBrush;
+                auto* current = dest + cachedFace.indexOfFirstVertexRelativeToBrush;
+                for (GLuint i = 0; i < cachedFace.vertexCount; ++i) {
+                    *current++ = Vertex(vertex->position, normal, vertex->texCoords);
+                    ++vertex;
+                }
+            }
+        }
+
+        size_t BrushRendererBrushCache::memoryUsage() const {
+            return sizeof(*this) +
+                   m_cachedVertices.capacity() * sizeof(CachedVertex) +
+                   m_cachedEdges.capacity() * sizeof(CachedEdge) +
+                   m_cachedFacesSortedByTexture.capacity() * sizeof(CachedFace);
+        }
+
+        size_t BrushRendererBrushCache::generation() const {
+            return m_rendererCacheValid ? m_generation : 0;
+        }
     }
 }
@@ -20,8 +20,12 @@
 #ifndef TrenchBroom_BrushRendererBrushCache
 #define TrenchBroom_BrushRendererBrushCache
 
+#include "Renderer/GL.h"
 #include "Renderer/VertexSpec.h"
 
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+
 #include <vector>
 
 namespace TrenchBroom {
@@ -40,33 +44,49 @@ namespace TrenchBroom {
             using VertexSpec = Renderer::VertexSpecs::P3NT2;
             using Vertex = VertexSpec::Vertex;
 
+            /**
+             * The cache keeps a vertex for every vertex of every face, so it omits the normal, which is the same for
+             * all vertices of a face. Use writeVertices() to expand the cached vertices to the VBO vertex format.
+             */
+            struct CachedVertex {
+                vm::vec3f position;
+                vm::vec2f texCoords;
+
+                CachedVertex(const vm::vec3f& i_position,
+                             const vm::vec2f& i_texCoords);
+            };
+
             struct CachedFace {
                 const Assets::Texture* texture;
                 Model::BrushFace* face;
-                size_t vertexCount;
-                size_t indexOfFirstVertexRelativeToBrush;
+                GLuint vertexCount;
+                GLuint indexOfFirstVertexRelativeToBrush;
 
                 CachedFace(Model::BrushFace* i_face,
                            size_t i_indexOfFirstVertexRelativeToBrush);
             };
 
+            /**
+             * The faces of an edge are given by their indices in cachedFacesSortedByTexture().
+             */
             struct CachedEdge {
-                Model::BrushFace* face1;
-                Model::BrushFace* face2;
-                size_t vertexIndex1RelativeToBrush;
-                size_t vertexIndex2RelativeToBrush;
+                GLuint faceIndex1;
+                GLuint faceIndex2;
+                GLuint vertexIndex1RelativeToBrush;
+                GLuint vertexIndex2RelativeToBrush;
 
-                CachedEdge(Model::BrushFace* i_face1,
-                           Model::BrushFace* i_face2,
+                CachedEdge(size_t i_faceIndex1,
+                           size_t i_faceIndex2,
                            size_t i_vertexIndex1RelativeToBrush,
                            size_t i_vertexIndex2RelativeToBrush);
             };
 
         private:
-            std::vector<Vertex> m_cachedVertices;
+            std::vector<CachedVertex> m_cachedVertices;
             std::vector<CachedEdge> m_cachedEdges;
             std::vector<CachedFace> m_cachedFacesSortedByTexture;
             bool m_rendererCacheValid;
+            size_t m_generation;
 
         public:
             BrushRendererBrushCache();
@@ -88,9 +108,26 @@ namespace TrenchBroom {
             /**
              * Returns all vertices for all faces of the brush.
              */
-            const std::vector<Vertex>& cachedVertices() const;
+            const std::vector<CachedVertex>& cachedVertices() const;
             const std::vector<CachedFace>& cachedFacesSortedByTexture() const;
             const std::vector<CachedEdge>& cachedEdges() const;
+
+            /**
+             * Writes the cached vertices with the normals of their faces to the given destination, which must have
+             * room for cachedVertices().size() vertices.
+             */
+            void writeVertices(Vertex* dest) const;
+
+            /**
+             * Returns the number of bytes of memory used by this cache, including unused capacity.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Returns a number that is unique to the current contents of the cache, or 0 if the cache is not valid.
+             * This lets BrushRenderer check whether a brush has changed since it was uploaded.
+             */
+            size_t generation() const;
         };
     }
 }
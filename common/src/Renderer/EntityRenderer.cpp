@@ -100,6 +100,8 @@ namespace TrenchBroom {
         }
 
         void EntityRenderer::reloadModels() {
+            // entities without a model are rendered as solid boxes
+            invalidateBounds();
             m_modelRenderer.updateEntities(std::begin(m_entities), std::end(m_entities));
         }
 
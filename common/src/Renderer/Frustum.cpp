@@ -0,0 +1,58 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Frustum.h"
+
+#include "Renderer/Camera.h"
+
+#include <vecmath/vec.h>
+#include <vecmath/bbox.h>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        Frustum::Frustum(const Camera& camera) {
+            vm::plane3f top, right, bottom, left;
+            camera.frustumPlanes(top, right, bottom, left);
+            m_planes = { top, right, bottom, left };
+
+            // orthographic cameras are placed outside of the world in the 2D views, so their near and far planes are
+            // not meaningful
+            if (camera.perspectiveProjection()) {
+                const auto& position = camera.position();
+                const auto& direction = camera.direction();
+                m_planes.emplace_back(position + camera.nearPlane() * direction, -direction);
+                m_planes.emplace_back(position + camera.farPlane() * direction, direction);
+            }
+        }
+
+        bool Frustum::intersects(const vm::bbox3f& bounds) const {
+            for (const auto& plane : m_planes) {
+                // the corner of the box that is farthest behind the plane
+                vm::vec3f corner;
+                for (size_t i = 0; i < 3; ++i) {
+                    corner[i] = plane.normal[i] >= 0.0f ? bounds.min[i] : bounds.max[i];
+                }
+                if (plane.pointDistance(corner) > 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Frustum
+#define TrenchBroom_Frustum
+
+#include <vecmath/forward.h>
+#include <vecmath/plane.h>
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class Camera;
+
+        /**
+         * The view volume of a camera, used to cull objects on the CPU before any draw calls are issued for them. The
+         * volume is bounded by the camera's side planes, and for perspective cameras, also by its near and far planes.
+         */
+        class Frustum {
+        private:
+            // the normals point out of the view volume
+            std::vector<vm::plane3f> m_planes;
+        public:
+            explicit Frustum(const Camera& camera);
+
+            /**
+             * Checks whether the given bounding box is at least partially contained in this frustum. A box is only
+             * rejected if it is entirely in front of one of the planes, so some boxes near the edges of the frustum
+             * that are not visible are reported as visible.
+             *
+             * @param bounds the bounding box to check
+             * @return true if the given box may be visible, and false if it is certainly not visible
+             */
+            bool intersects(const vm::bbox3f& bounds) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Frustum) */
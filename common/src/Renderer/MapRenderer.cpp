@@ -189,6 +189,10 @@ namespace TrenchBroom {
         void MapRenderer::commitPendingChanges() {
             View::MapDocumentSPtr document = lock(m_document);
             document->commitPendingAssets();
+
+            // replace the placeholders of entities whose models have been loaded in the background
+            if (document->entityModelManager().commitLoadedModels())
+                reloadEntityModels();
         }
         
         class SetupGL : public Renderable {
@@ -310,6 +314,7 @@ namespace TrenchBroom {
             
             renderer->setBrushFaceColor(pref(Preferences::FaceColor));
             renderer->setBrushEdgeColor(pref(Preferences::EdgeColor));
+            renderer->setBrushChunkSize(BrushRenderer::DefaultChunkSize);
         }
         
         void MapRenderer::setupSelectionRenderer(ObjectRenderer* renderer) {
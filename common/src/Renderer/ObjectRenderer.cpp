@@ -132,6 +132,10 @@ namespace TrenchBroom {
         void ObjectRenderer::setBrushEdgeColor(const Color& brushEdgeColor) {
             m_brushRenderer.setEdgeColor(brushEdgeColor);
         }
+
+        void ObjectRenderer::setBrushChunkSize(const FloatType chunkSize) {
+            m_brushRenderer.setChunkSize(chunkSize);
+        }
         
         void ObjectRenderer::setShowHiddenObjects(const bool showHiddenObjects) {
             m_entityRenderer.setShowHiddenEntities(showHiddenObjects);
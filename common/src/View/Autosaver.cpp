@@ -19,15 +19,48 @@
 
 #include "Autosaver.h"
 
+#include "Parallel.h"
 #include "StringUtils.h"
 #include "TemporarilySetAny.h"
 #include "IO/DiskFileSystem.h"
 #include "View/MapDocument.h"
 
+#include <wx/string.h>
+
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 namespace TrenchBroom {
     namespace View {
+        /**
+         * Collects the messages that are logged on the background thread so that they can be passed to the actual
+         * logger on the main thread.
+         */
+        class Autosaver::BackupLogger : public Logger {
+        private:
+            LogMessageList& m_messages;
+        public:
+            BackupLogger(LogMessageList& messages) :
+            m_messages(messages) {}
+        private:
+            void doLog(const LogLevel level, const String& message) override {
+                m_messages.push_back(LogMessage { level, message });
+            }
+
+            void doLog(const LogLevel level, const wxString& message) override {
+                doLog(level, message.ToStdString());
+            }
+        };
+
+        Autosaver::Timings::Timings() :
+        count(0),
+        lastSnapshotTime(0.0),
+        maxSnapshotTime(0.0),
+        totalSnapshotTime(0.0),
+        lastWriteTime(0.0),
+        maxWriteTime(0.0) {}
+
         Autosaver::Autosaver(View::MapDocumentWPtr document, const time_t saveInterval, const time_t idleInterval, const size_t maxBackups) :
         m_document(document),
         m_logger(nullptr),
@@ -42,10 +75,22 @@ namespace TrenchBroom {
         
         Autosaver::~Autosaver() {
             unbindObservers();
+            if (m_pendingBackup.valid())
+                m_pendingBackup.wait();
             triggerAutosave(nullptr);
+            if (m_pendingBackup.valid())
+                m_pendingBackup.wait();
         }
         
         void Autosaver::triggerAutosave(Logger* logger) {
+            TemporarilySetAny<Logger*> setLogger(m_logger, logger);
+
+            // only one backup is written at a time
+            if (backupPending())
+                return;
+            if (m_pendingBackup.valid())
+                finishBackup();
+
             const time_t currentTime = time(nullptr);
             
             MapDocumentSPtr document = lock(m_document);
@@ -64,43 +109,85 @@ namespace TrenchBroom {
             if (!IO::Disk::fileExists(IO::Disk::fixPath(document->path())))
                 return;
             
-            TemporarilySetAny<Logger*> setLogger(m_logger, logger);
             autosave(document);
         }
+
+        const Autosaver::Timings& Autosaver::timings() const {
+            return m_timings;
+        }
         
         void Autosaver::autosave(MapDocumentSPtr document) {
             const IO::Path& mapPath = document->path();
             assert(IO::Disk::fileExists(IO::Disk::fixPath(mapPath)));
-            
+
+            const auto start = std::chrono::steady_clock::now();
+            IO::MapSnapshot::Ptr snapshot = document->takeSnapshot();
+            const std::chrono::duration<double, std::milli> snapshotTime = std::chrono::steady_clock::now() - start;
+
+            m_lastSaveTime = time(nullptr);
+            m_lastModificationCount = document->modificationCount();
+
+            ++m_timings.count;
+            m_timings.lastSnapshotTime = snapshotTime.count();
+            m_timings.maxSnapshotTime = std::max(m_timings.maxSnapshotTime, snapshotTime.count());
+            m_timings.totalSnapshotTime += snapshotTime.count();
+
+            m_pendingBackup = std::async(std::launch::async, &Autosaver::writeBackup, snapshot, mapPath, m_maxBackups);
+        }
+
+        bool Autosaver::backupPending() const {
+            return m_pendingBackup.valid() && m_pendingBackup.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        }
+
+        void Autosaver::finishBackup() {
+            assert(m_pendingBackup.valid());
+            const BackupResult result = m_pendingBackup.get();
+
+            m_timings.lastWriteTime = result.writeTime;
+            m_timings.maxWriteTime = std::max(m_timings.maxWriteTime, result.writeTime);
+
+            if (m_logger != nullptr) {
+                for (const LogMessage& message : result.messages)
+                    m_logger->log(message.level, message.str);
+                m_logger->debug("Autosave blocked the editor for %.1f ms and took %.1f ms to write", m_timings.lastSnapshotTime, m_timings.lastWriteTime);
+            }
+        }
+
+        Autosaver::BackupResult Autosaver::writeBackup(IO::MapSnapshot::Ptr snapshot, const IO::Path& mapPath, const size_t maxBackups) {
+            BackupResult result;
+            BackupLogger logger(result.messages);
+
+            const auto start = std::chrono::steady_clock::now();
+
             const IO::Path mapFilename = mapPath.lastComponent();
             const IO::Path mapBasename = mapFilename.deleteExtension();
             
             try {
-                IO::WritableDiskFileSystem fs = createBackupFileSystem(mapPath);
+                IO::WritableDiskFileSystem fs = createBackupFileSystem(mapPath, logger);
                 IO::Path::List backups = collectBackups(fs, mapBasename);
                 
-                thinBackups(fs, backups);
+                thinBackups(fs, backups, maxBackups, logger);
                 cleanBackups(fs, backups, mapBasename);
 
-                assert(backups.size() < m_maxBackups);
+                assert(backups.size() < maxBackups);
                 const size_t backupNo = backups.size() + 1;
                 
                 const IO::Path backupFilePath = fs.makeAbsolute(makeBackupName(mapBasename, backupNo));
 
-                m_lastSaveTime = time(nullptr);
-                m_lastModificationCount = document->modificationCount();
-                document->saveDocumentTo(backupFilePath);
-                
-                if (m_logger != nullptr)
-                    m_logger->info("Created autosave backup at %s", backupFilePath.asString().c_str());
-                
+                // leave one core to the main thread
+                snapshot->write(backupFilePath, std::max(defaultThreadCount(), size_t(2)) - 1);
+
+                logger.info("Created autosave backup at %s", backupFilePath.asString().c_str());
             } catch (const FileSystemException&) {
-                if (m_logger != nullptr)
-                    m_logger->error("Aborting autosave");
+                logger.error("Aborting autosave");
             }
+
+            const std::chrono::duration<double, std::milli> writeTime = std::chrono::steady_clock::now() - start;
+            result.writeTime = writeTime.count();
+            return result;
         }
         
-        IO::WritableDiskFileSystem Autosaver::createBackupFileSystem(const IO::Path& mapPath) const {
+        IO::WritableDiskFileSystem Autosaver::createBackupFileSystem(const IO::Path& mapPath, Logger& logger) {
             const IO::Path basePath = mapPath.deleteLastComponent();
             const IO::Path autosavePath = basePath + IO::Path("autosave");
 
@@ -108,8 +195,7 @@ namespace TrenchBroom {
                 // ensures that the directory exists or is created if it doesn't
                 return IO::WritableDiskFileSystem(autosavePath, true);
             } catch (const FileSystemException& e) {
-                if (m_logger != nullptr)
-                    m_logger->error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
+                logger.error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
                 throw e;
             }
         }
@@ -142,29 +228,27 @@ namespace TrenchBroom {
             return extractBackupNo(lhs) < extractBackupNo(rhs);
         }
         
-        IO::Path::List Autosaver::collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const {
+        IO::Path::List Autosaver::collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) {
             IO::Path::List backups = fs.findItems(IO::Path(""), BackupFileMatcher(mapBasename));
             std::sort(std::begin(backups), std::end(backups), compareBackupsByNo);
             return backups;
         }
         
-        void Autosaver::thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) const {
-            while (backups.size() > m_maxBackups - 1) {
+        void Autosaver::thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const size_t maxBackups, Logger& logger) {
+            while (backups.size() > maxBackups - 1) {
                 const IO::Path filename = backups.front();
                 try {
                     fs.deleteFile(filename);
-                    if (m_logger != nullptr)
-                        m_logger->debug("Deleted autosave backup %s", filename.asString().c_str());
+                    logger.debug("Deleted autosave backup %s", filename.asString().c_str());
                     backups.erase(std::begin(backups));
                 } catch (const FileSystemException& e) {
-                    if (m_logger != nullptr)
-                        m_logger->error("Cannot delete autosave backup %s", filename.asString().c_str());
+                    logger.error("Cannot delete autosave backup %s", filename.asString().c_str());
                     throw e;
                 }
             }
         }
         
-        void Autosaver::cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const {
+        void Autosaver::cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) {
             for (size_t i = 0; i < backups.size(); ++i) {
                 const IO::Path& oldName = backups[i].lastComponent();
                 const IO::Path newName = makeBackupName(mapBasename, i + 1);
@@ -174,7 +258,7 @@ namespace TrenchBroom {
             }
         }
         
-        IO::Path Autosaver::makeBackupName(const IO::Path& mapBasename, const size_t index) const {
+        IO::Path Autosaver::makeBackupName(const IO::Path& mapBasename, const size_t index) {
             StringStream str;
             str << mapBasename.asString() << "." << index << ".map";
             return IO::Path(str.str());
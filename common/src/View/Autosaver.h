@@ -20,14 +20,16 @@
 #ifndef TrenchBroom_Autosaver
 #define TrenchBroom_Autosaver
 
+#include "Logger.h"
+#include "IO/MapSnapshot.h"
 #include "IO/Path.h"
 #include "View/ViewTypes.h"
 
 #include <ctime>
+#include <future>
+#include <vector>
 
 namespace TrenchBroom {
-    class Logger;
-    
     namespace IO {
         class WritableDiskFileSystem;
     }
@@ -35,8 +37,40 @@ namespace TrenchBroom {
     namespace View {
         class Command;
         
+        /**
+         * Periodically writes backups of the document. Only taking a snapshot of the map happens on the main thread,
+         * while the snapshot is written and the old backups are thinned out on a background thread.
+         */
         class Autosaver {
+        public:
+            /**
+             * Timing counters for the autosaves, in milliseconds. The snapshot time is the time that the main thread
+             * is blocked by an autosave, and the write time is the time spent on the background thread.
+             */
+            struct Timings {
+                size_t count;
+                double lastSnapshotTime;
+                double maxSnapshotTime;
+                double totalSnapshotTime;
+                double lastWriteTime;
+                double maxWriteTime;
+
+                Timings();
+            };
         private:
+            class BackupLogger;
+
+            struct LogMessage {
+                Logger::LogLevel level;
+                String str;
+            };
+            typedef std::vector<LogMessage> LogMessageList;
+
+            struct BackupResult {
+                LogMessageList messages;
+                double writeTime;
+            };
+
             View::MapDocumentWPtr m_document;
             Logger* m_logger;
             
@@ -47,19 +81,27 @@ namespace TrenchBroom {
             time_t m_lastSaveTime;
             time_t m_lastModificationTime;
             size_t m_lastModificationCount;
+
+            std::future<BackupResult> m_pendingBackup;
+            Timings m_timings;
         public:
             Autosaver(View::MapDocumentWPtr document, time_t saveInterval = 10 * 60, time_t idleInterval = 3, size_t maxBackups = 50);
             ~Autosaver();
             
             void triggerAutosave(Logger* logger);
+
+            const Timings& timings() const;
         private:
             void autosave(View::MapDocumentSPtr document);
-            IO::WritableDiskFileSystem createBackupFileSystem(const IO::Path& mapPath) const;
-            IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
-            bool isBackup(const IO::Path& backupPath, const IO::Path& mapBasename) const;
-            void thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) const;
-            void cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const;
-            IO::Path makeBackupName(const IO::Path& mapBasename, const size_t index) const;
+            bool backupPending() const;
+            void finishBackup();
+
+            static BackupResult writeBackup(IO::MapSnapshot::Ptr snapshot, const IO::Path& mapPath, size_t maxBackups);
+            static IO::WritableDiskFileSystem createBackupFileSystem(const IO::Path& mapPath, Logger& logger);
+            static IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename);
+            static void thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, size_t maxBackups, Logger& logger);
+            static void cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename);
+            static IO::Path makeBackupName(const IO::Path& mapBasename, const size_t index);
         private:
             void bindObservers();
             void unbindObservers();
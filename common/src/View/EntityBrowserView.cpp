@@ -189,7 +189,7 @@ namespace TrenchBroom {
                 const auto actualSize = fontManager().font(actualFont).measure(definition->name());
                 
                 const auto spec = definition->defaultModel();
-                const auto* model = safeGetModel(m_entityModelManager, spec, m_logger);
+                auto* model = safeGetModel(m_entityModelManager, spec, m_logger);
                 Renderer::TexturedIndexRangeRenderer* modelRenderer = nullptr;
                 
                 vm::bbox3f rotatedBounds;
@@ -27,6 +27,7 @@
 #include "Assets/Texture.h"
 #include "Assets/TextureManager.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/RecordingParserStatus.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
 #include "Model/AttributeNameWithDoubleQuotationMarksIssueGenerator.h"
@@ -112,11 +113,20 @@
 
 #include <vecmath/util.h>
 
+#include <wx/app.h>
+
+#include <algorithm>
 #include <cassert>
+#include <future>
 #include <numeric>
 
 namespace TrenchBroom {
     namespace View {
+        static size_t textureMemoryBudget() {
+            const auto megabytes = std::max(pref(Preferences::TextureMemoryBudget), 1);
+            return static_cast<size_t>(megabytes) * 1024u * 1024u;
+        }
+
         const vm::bbox3 MapDocument::DefaultWorldBounds(-16384.0, 16384.0);
         const String MapDocument::DefaultDocumentName("unnamed.map");
         
@@ -139,6 +149,9 @@ namespace TrenchBroom {
         m_lastSelectionBounds(0.0, 32.0),
         m_selectionBoundsValid(true),
         m_viewEffectsService(nullptr) {
+            m_textureManager->setLazyLoading(pref(Preferences::TextureLazyLoading), textureMemoryBudget());
+            // the map views commit entity models that were loaded in the background when they are idle
+            m_entityModelManager->setLoadCallback([]() { wxWakeUpIdle(); });
             bindObservers();
         }
         
@@ -276,6 +289,12 @@ namespace TrenchBroom {
             ensure(m_world != nullptr, "world is null");
             m_game->writeMap(m_world, path);
         }
+
+        IO::MapSnapshot::Ptr MapDocument::takeSnapshot() {
+            ensure(m_game.get() != nullptr, "game is null");
+            ensure(m_world != nullptr, "world is null");
+            return IO::MapSnapshot::take(m_world, m_game->gameName());
+        }
         
         void MapDocument::exportDocumentAs(const Model::ExportFormat format, const IO::Path& path) {
             m_game->exportMap(m_world, format, path);
@@ -1519,16 +1538,16 @@ namespace TrenchBroom {
             Notifier0::NotifyBeforeAndAfter notifyTextureCollections(textureCollectionsWillChangeNotifier, textureCollectionsDidChangeNotifier);
 
             info("Reloading texture collections");
+            m_game->refreshFileSystem();
             unloadTextures();
             loadTextures();
             setTextures();
         }
 
         void MapDocument::loadAssets() {
-            loadEntityDefinitions();
-            setEntityDefinitions();
             loadEntityModels();
-            loadTextures();
+            loadEntityDefinitions([this]() { loadTextures(); });
+            setEntityDefinitions();
             setTextures();
         }
         
@@ -1539,12 +1558,33 @@ namespace TrenchBroom {
         }
         
         void MapDocument::loadEntityDefinitions() {
+            loadEntityDefinitions([]() {});
+        }
+
+        /**
+         * Loads the entity definitions on a worker thread and calls the given function on this thread in the
+         * meantime. The messages of the parser are logged after it has finished.
+         */
+        void MapDocument::loadEntityDefinitions(const std::function<void()>& meanwhile) {
             const Assets::EntityDefinitionFileSpec spec = entityDefinitionFile();
+            const IO::Path::List searchPaths = externalSearchPaths();
+
+            IO::RecordingParserStatus recordingStatus;
+            auto definitions = std::async(std::launch::async, [this, &spec, &searchPaths, &recordingStatus]() {
+                const IO::Path path = m_game->findEntityDefinitionFile(spec, searchPaths);
+                return std::make_pair(path, m_game->loadEntityDefinitions(recordingStatus, path));
+            });
+
+            meanwhile();
+            definitions.wait();
+
+            IO::SimpleParserStatus status(this);
+            recordingStatus.replay(status);
+
             try {
-                const IO::Path path = m_game->findEntityDefinitionFile(spec, externalSearchPaths());
-                IO::SimpleParserStatus status(this);
-                m_entityDefinitionManager->loadDefinitions(path, *m_game, status);
-                info("Loaded entity definition file " + path.lastComponent().asString());
+                const auto result = definitions.get();
+                m_entityDefinitionManager->setDefinitions(result.second);
+                info("Loaded entity definition file " + result.first.lastComponent().asString());
             } catch (const Exception& e) {
                 if (spec.builtin())
                     error("Could not load builtin entity definition file '%s': %s", spec.path().asString().c_str(), e.what());
@@ -1629,6 +1669,7 @@ namespace TrenchBroom {
         }
 
         void MapDocument::reloadEntityDefinitions() {
+            m_game->refreshFileSystem();
             unloadEntityDefinitions();
             clearEntityModels();
             loadEntityDefinitions();
@@ -1812,9 +1853,10 @@ namespace TrenchBroom {
             if (isGamePathPreference(path)) {
                 const Model::GameFactory& gameFactory = Model::GameFactory::instance();
                 const IO::Path newGamePath = gameFactory.gamePath(m_game->gameName());
-                m_game->setGamePath(newGamePath, this);
                 
+                // models might still be loading from the old game path
                 clearEntityModels();
+                m_game->setGamePath(newGamePath, this);
                 
                 unsetTextures();
                 loadTextures();
@@ -1825,6 +1867,15 @@ namespace TrenchBroom {
                        path == Preferences::TextureMagFilter.path()) {
                 m_entityModelManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
                 m_textureManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
+            } else if (path == Preferences::TextureLazyLoading.path() ||
+                       path == Preferences::TextureMemoryBudget.path()) {
+                m_textureManager->setLazyLoading(pref(Preferences::TextureLazyLoading), textureMemoryBudget());
+                if (path == Preferences::TextureLazyLoading.path()) {
+                    // the loaded collections must be discarded, otherwise they are reused
+                    unloadTextures();
+                    loadTextures();
+                    setTextures();
+                }
             }
         }
 
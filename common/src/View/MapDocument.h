@@ -24,6 +24,7 @@
 #include "TrenchBroom.h"
 #include "Assets/AssetTypes.h"
 #include "Assets/EntityDefinitionFileSpec.h"
+#include "IO/MapSnapshot.h"
 #include "IO/Path.h"
 #include "Model/EntityColor.h"
 #include "Model/MapFacade.h"
@@ -39,6 +40,7 @@
 #include <vecmath/bbox.h>
 #include <vecmath/util.h>
 
+#include <functional>
 #include <memory>
 
 class Color;
@@ -187,6 +189,7 @@ namespace TrenchBroom {
             void saveDocument();
             void saveDocumentAs(const IO::Path& path);
             void saveDocumentTo(const IO::Path& path);
+            IO::MapSnapshot::Ptr takeSnapshot();
             void exportDocumentAs(Model::ExportFormat format, const IO::Path& path);
         private:
             void doSaveDocument(const IO::Path& path);
@@ -409,6 +412,7 @@ namespace TrenchBroom {
             void unloadAssets();
             
             void loadEntityDefinitions();
+            void loadEntityDefinitions(const std::function<void()>& meanwhile);
             void unloadEntityDefinitions();
             
             void loadEntityModels();
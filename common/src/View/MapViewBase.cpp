@@ -261,6 +261,7 @@ namespace TrenchBroom {
         void MapViewBase::bindEvents() {
             Bind(wxEVT_SET_FOCUS, &MapViewBase::OnSetFocus, this);
             Bind(wxEVT_KILL_FOCUS, &MapViewBase::OnKillFocus, this);
+            Bind(wxEVT_IDLE, &MapViewBase::OnIdle, this);
 
             Bind(wxEVT_MENU, &MapViewBase::OnToggleClipSide,               this, CommandIds::Actions::ToggleClipSide);
             Bind(wxEVT_MENU, &MapViewBase::OnPerformClip,                  this, CommandIds::Actions::PerformClip);
@@ -748,6 +749,16 @@ namespace TrenchBroom {
             event.Skip();
         }
 
+        void MapViewBase::OnIdle(wxIdleEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            // entity models that were loaded in the background are committed when the view is rendered
+            MapDocumentSPtr document = lock(m_document);
+            if (document->entityModelManager().hasLoadedModels())
+                Refresh();
+            event.Skip();
+        }
+
         void MapViewBase::OnActivateFrame(wxActivateEvent& event) {
             if (IsBeingDeleted()) return;
 
@@ -204,6 +204,7 @@ namespace TrenchBroom {
         private: // other events
             void OnSetFocus(wxFocusEvent& event);
             void OnKillFocus(wxFocusEvent& event);
+            void OnIdle(wxIdleEvent& event);
             void OnActivateFrame(wxActivateEvent& event);
         protected: // accelerator table management
             void updateAcceleratorTable();
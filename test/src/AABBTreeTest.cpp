@@ -23,6 +23,11 @@
 #include <vecmath/ray.h>
 #include "AABBTree.h"
 
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
 using AABB = AABBTree<double, 3, size_t>;
 using BOX = AABB::Box;
 using RAY = vm::ray<AABB::FloatType, AABB::Components>;
@@ -468,6 +473,127 @@ TEST(AABBTreeTest, findIntersectorsFromInsideRootBBox) {
     assertIntersectors(tree, RAY(VEC(0.0,  0.0,  0.0), VEC::pos_x), { 2u });
 }
 
+static std::vector<BOX> makeRandomBoxes(const size_t count) {
+    std::mt19937 random(0);
+    std::uniform_real_distribution<double> position(-1024.0, 1024.0);
+    std::uniform_real_distribution<double> size(1.0, 64.0);
+
+    std::vector<BOX> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const VEC min(position(random), position(random), position(random));
+        result.push_back(BOX(min, min + VEC(size(random), size(random), size(random))));
+    }
+    return result;
+}
+
+static void assertBuildFindsAllIntersectors(const size_t threadCount) {
+    const auto boxes = makeRandomBoxes(5000);
+    std::vector<size_t> items(boxes.size());
+    std::iota(std::begin(items), std::end(items), 0u);
+
+    AABB tree;
+    tree.setThreadCount(threadCount);
+    tree.clearAndBuild(items, [&](const size_t i) { return boxes[i]; });
+
+    auto bounds = boxes.front();
+    for (const auto& box : boxes) {
+        bounds = merge(bounds, box);
+        ASSERT_TRUE(tree.contains(box, static_cast<size_t>(&box - boxes.data())));
+    }
+    ASSERT_EQ(bounds, tree.bounds());
+    ASSERT_LT(tree.height(), 40u);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> coord(-1.0, 1.0);
+    for (size_t i = 0; i < 100; ++i) {
+        const RAY ray(VEC(coord(random), coord(random), coord(random)) * 1024.0, normalize(VEC(coord(random), coord(random), coord(random))));
+
+        std::set<size_t> expected;
+        for (size_t j = 0; j < boxes.size(); ++j) {
+            if (boxes[j].contains(ray.origin) || !vm::isnan(intersect(ray, boxes[j]))) {
+                expected.insert(j);
+            }
+        }
+
+        std::set<size_t> actual;
+        tree.findIntersectors(ray, std::inserter(actual, std::end(actual)));
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(AABBTreeTest, clearAndBuild) {
+    assertBuildFindsAllIntersectors(1);
+}
+
+TEST(AABBTreeTest, clearAndBuildInParallel) {
+    assertBuildFindsAllIntersectors(4);
+}
+
+TEST(AABBTreeTest, clearAndBuildWithCoincidingBoxes) {
+    const BOX bounds(VEC(0.0, 0.0, 0.0), VEC(1.0, 1.0, 1.0));
+    const std::vector<size_t> items({ 1u, 2u, 3u, 4u, 5u });
+
+    AABB tree;
+    tree.clearAndBuild(items, [&](const size_t) { return bounds; });
+
+    ASSERT_EQ(bounds, tree.bounds());
+    ASSERT_EQ(4u, tree.height());
+    assertIntersectors(tree, RAY(VEC(-1.0, 0.5, 0.5), VEC::pos_x), { 1u, 2u, 3u, 4u, 5u });
+}
+
+TEST(AABBTreeTest, insertAndRemoveAfterClearAndBuild) {
+    const std::vector<size_t> items({ 1u, 2u, 3u });
+
+    AABB tree;
+    tree.clearAndBuild(items, [](const size_t i) { return makeBounds(2 * i, 2 * i + 1); });
+    tree.insert(makeBounds(8, 9), 4u);
+
+    ASSERT_TRUE(tree.remove(makeBounds(4, 5), 2u));
+    ASSERT_FALSE(tree.contains(makeBounds(4, 5), 2u));
+    assertIntersectors(tree, RAY(VEC(0.0, 0.0, 0.0), VEC::pos_x), { 1u, 3u, 4u });
+}
+
+TEST(AABBTreeTest, findIntersectorsAfterUpdate) {
+    AABB tree;
+    tree.insert(makeBounds(0, 1), 1u);
+    tree.insert(makeBounds(2, 3), 2u);
+    tree.insert(makeBounds(4, 5), 3u);
+    assertIntersectors(tree, RAY(VEC(0.5, -2.0, 0.0), VEC::pos_y), { 1u });
+
+    // overlapping bounds are refit in place
+    tree.update(makeBounds(0, 1), makeBounds(1, 2), 1u);
+    ASSERT_TRUE(tree.contains(makeBounds(1, 2), 1u));
+    assertIntersectors(tree, RAY(VEC(0.5, -2.0, 0.0), VEC::pos_y), {});
+    assertIntersectors(tree, RAY(VEC(1.5, -2.0, 0.0), VEC::pos_y), { 1u });
+    assertIntersectors(tree, RAY(VEC(2.0, -2.0, 0.0), VEC::pos_y), { 1u, 2u });
+
+    // disjoint bounds are removed and inserted again
+    tree.update(makeBounds(4, 5), makeBounds(8, 9), 3u);
+    ASSERT_TRUE(tree.contains(makeBounds(8, 9), 3u));
+    assertIntersectors(tree, RAY(VEC(4.5, -2.0, 0.0), VEC::pos_y), {});
+    assertIntersectors(tree, RAY(VEC(8.5, -2.0, 0.0), VEC::pos_y), { 3u });
+    ASSERT_EQ(BOX(VEC(1.0, -1.0, -1.0), VEC(9.0, 1.0, 1.0)), tree.bounds());
+}
+
+TEST(AABBTreeTest, findContainers) {
+    AABB tree;
+    tree.insert(makeBounds(0, 2), 1u);
+    tree.insert(makeBounds(1, 3), 2u);
+    tree.insert(makeBounds(4, 5), 3u);
+
+    const auto findContainers = [&](const double x) {
+        std::set<AABB::DataType> result;
+        tree.findContainers(VEC(x, 0.0, 0.0), std::inserter(result, std::end(result)));
+        return result;
+    };
+
+    ASSERT_EQ(std::set<AABB::DataType>({ 1u }), findContainers(0.5));
+    ASSERT_EQ(std::set<AABB::DataType>({ 1u, 2u }), findContainers(1.5));
+    ASSERT_EQ(std::set<AABB::DataType>({ 3u }), findContainers(5.0));
+    ASSERT_EQ(std::set<AABB::DataType>(), findContainers(3.5));
+}
+
 void assertTree(const std::string& exp, const AABB& actual) {
     std::stringstream str;
     actual.print(str);
@@ -0,0 +1,146 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+class AllocatedObject : public Allocator<AllocatedObject, 16, 4096> {
+public:
+    size_t value;
+    char padding[40];
+
+    explicit AllocatedObject(const size_t i_value) :
+    value(i_value) {}
+};
+
+class alignas(64) AlignedObject : public Allocator<AlignedObject> {
+public:
+    double values[3];
+};
+
+typedef std::vector<std::unique_ptr<AllocatedObject>> ObjectList;
+
+static ObjectList createObjects(const size_t count) {
+    ObjectList result;
+    for (size_t i = 0; i < count; ++i)
+        result.emplace_back(new AllocatedObject(i));
+    return result;
+}
+
+TEST(AllocatorTest, allocateAndFree) {
+    // enough objects to need several chunks
+    ObjectList objects = createObjects(1000);
+
+    // live blocks are distinct
+    std::set<const AllocatedObject*> addresses;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        ASSERT_EQ(i, objects[i]->value);
+        ASSERT_TRUE(addresses.insert(objects[i].get()).second);
+    }
+
+    // free in random order and reuse the blocks
+    std::mt19937 random(0);
+    std::shuffle(std::begin(objects), std::end(objects), random);
+    objects.resize(objects.size() / 2);
+
+    std::vector<size_t> values;
+    for (size_t i = 0; i < objects.size(); ++i)
+        values.push_back(objects[i]->value);
+
+    ObjectList more = createObjects(1000);
+
+    // the values of the remaining objects survive further allocations
+    for (size_t i = 0; i < objects.size(); ++i)
+        ASSERT_EQ(values[i], objects[i]->value);
+
+    // the new objects don't overlap each other or the remaining objects
+    addresses.clear();
+    for (size_t i = 0; i < objects.size(); ++i)
+        ASSERT_TRUE(addresses.insert(objects[i].get()).second);
+    for (size_t i = 0; i < more.size(); ++i) {
+        ASSERT_EQ(i, more[i]->value);
+        ASSERT_TRUE(addresses.insert(more[i].get()).second);
+    }
+}
+
+#ifdef TB_ENABLE_ALLOCATOR
+TEST(AllocatorTest, reuseFreedBlock) {
+    ObjectList objects = createObjects(10);
+
+    const AllocatedObject* freed = objects[5].get();
+    objects[5].reset();
+
+    // the block that was just freed is at the top of the thread's cache
+    objects[5].reset(new AllocatedObject(5));
+    ASSERT_EQ(freed, objects[5].get());
+    for (size_t i = 0; i < objects.size(); ++i)
+        ASSERT_EQ(i, objects[i]->value);
+}
+#endif
+
+TEST(AllocatorTest, allocateAlignedObjects) {
+    std::vector<std::unique_ptr<AlignedObject>> objects;
+    for (size_t i = 0; i < 1000; ++i) {
+        objects.emplace_back(new AlignedObject());
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(objects.back().get()) % 64u);
+    }
+}
+
+TEST(AllocatorTest, allocateAndFreeConcurrently) {
+    const size_t threadCount = 4;
+    const size_t objectCount = 20000;
+
+    // every thread creates objects and frees the ones created by its neighbour
+    std::vector<ObjectList> objects(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i)
+        threads.emplace_back([&objects, i]() { objects[i] = createObjects(objectCount); });
+    for (std::thread& thread : threads)
+        thread.join();
+    threads.clear();
+
+    std::set<const AllocatedObject*> addresses;
+    for (const ObjectList& list : objects) {
+        for (size_t i = 0; i < list.size(); ++i) {
+            ASSERT_EQ(i, list[i]->value);
+            ASSERT_TRUE(addresses.insert(list[i].get()).second);
+        }
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&objects, i, threadCount]() {
+            ObjectList mine = createObjects(objectCount);
+            objects[(i + 1) % threadCount].clear();
+            for (size_t j = 0; j < mine.size(); ++j)
+                ASSERT_EQ(j, mine[j]->value);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+}
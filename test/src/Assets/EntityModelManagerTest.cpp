@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "Assets/ModelDefinition.h"
+#include "Assets/Texture.h"
+#include "IO/EntityModelLoader.h"
+#include "IO/Path.h"
+
+#include <vecmath/vec.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class TestModelLoader : public IO::EntityModelLoader {
+        public:
+            mutable std::atomic<size_t> loadCount;
+        public:
+            TestModelLoader() :
+            loadCount(0) {}
+        private:
+            EntityModel* doLoadEntityModel(const IO::Path& path) const override {
+                ++loadCount;
+                if (path == IO::Path("broken.mdl"))
+                    throw GameException("Could not load model broken.mdl");
+
+                using Vertex = EntityModel::Vertex;
+                EntityModel* model = new EntityModel(path.asString());
+                model->addSkin(new Texture("skin", 16, 16));
+                model->addFrame("frame", EntityModel::VertexList({
+                    Vertex(vm::vec3f(0.0f, 0.0f, 0.0f), vm::vec2f(0.0f, 0.0f)),
+                    Vertex(vm::vec3f(1.0f, 0.0f, 0.0f), vm::vec2f(1.0f, 0.0f)),
+                    Vertex(vm::vec3f(0.0f, 1.0f, 0.0f), vm::vec2f(0.0f, 1.0f))
+                }), EntityModel::Indices(GL_TRIANGLES, 0, 3));
+                return model;
+            }
+        };
+
+        static bool waitForLoadedModels(const EntityModelManager& manager) {
+            for (size_t i = 0; i < 10000; ++i) {
+                if (manager.hasLoadedModels())
+                    return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return false;
+        }
+
+        TEST(EntityModelManagerTest, modelsAreLoadedInBackground) {
+            TestModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0, 2);
+            manager.setLoader(&loader);
+
+            const ModelSpecification broken(IO::Path("broken.mdl"));
+            ASSERT_EQ(nullptr, manager.renderer(broken));
+            ASSERT_TRUE(waitForLoadedModels(manager));
+            ASSERT_FALSE(manager.commitLoadedModels());
+
+            // failed models are not loaded again
+            ASSERT_EQ(nullptr, manager.renderer(broken));
+            ASSERT_EQ(nullptr, manager.safeGetModel(broken.path));
+            ASSERT_EQ(1u, loader.loadCount);
+
+            // pending models are not requested twice
+            const ModelSpecification spec(IO::Path("model.mdl"));
+            ASSERT_EQ(nullptr, manager.renderer(spec));
+            ASSERT_FALSE(manager.hasModel(spec));
+            ASSERT_TRUE(waitForLoadedModels(manager));
+            ASSERT_TRUE(manager.commitLoadedModels());
+            ASSERT_FALSE(manager.hasLoadedModels());
+            ASSERT_EQ(2u, loader.loadCount);
+
+            ASSERT_NE(nullptr, manager.renderer(spec));
+            ASSERT_TRUE(manager.hasModel(spec));
+            ASSERT_EQ(manager.model(spec.path), manager.safeGetModel(spec.path));
+            ASSERT_EQ(2u, loader.loadCount);
+        }
+
+        TEST(EntityModelManagerTest, clearDiscardsLoadedModels) {
+            TestModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0, 2);
+            manager.setLoader(&loader);
+
+            const ModelSpecification spec(IO::Path("model.mdl"));
+            ASSERT_EQ(nullptr, manager.renderer(spec));
+            manager.clear();
+            ASSERT_FALSE(manager.hasLoadedModels());
+            ASSERT_FALSE(manager.commitLoadedModels());
+
+            // the model is requested again after clearing
+            ASSERT_EQ(nullptr, manager.renderer(spec));
+            ASSERT_TRUE(waitForLoadedModels(manager));
+            ASSERT_TRUE(manager.commitLoadedModels());
+            ASSERT_NE(nullptr, manager.renderer(spec));
+        }
+
+        TEST(EntityModelManagerTest, modelsAreLoadedImmediatelyWithoutThreads) {
+            TestModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0, 0);
+            manager.setLoader(&loader);
+
+            const ModelSpecification spec(IO::Path("model.mdl"));
+            ASSERT_NE(nullptr, manager.renderer(spec));
+            ASSERT_FALSE(manager.hasLoadedModels());
+            ASSERT_EQ(1u, loader.loadCount);
+        }
+    }
+}
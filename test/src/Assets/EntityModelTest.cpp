@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Assets/EntityModel.h"
+#include "Assets/Texture.h"
+#include "Renderer/TexturedIndexRangeRenderer.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        static EntityModel::VertexList makeTriangle(const float offset) {
+            using Vertex = EntityModel::Vertex;
+            return EntityModel::VertexList({
+                Vertex(vm::vec3f(offset, 0.0f, 0.0f), vm::vec2f(0.0f, 0.0f)),
+                Vertex(vm::vec3f(offset + 1.0f, 0.0f, 0.0f), vm::vec2f(1.0f, 0.0f)),
+                Vertex(vm::vec3f(offset, 1.0f, 0.0f), vm::vec2f(0.0f, 1.0f))
+            });
+        }
+
+        TEST(EntityModelTest, lazyFramesAreDecodedWhenUsed) {
+            EntityModel model("model");
+            model.addSkin(new Texture("skin", 16, 16));
+
+            std::vector<size_t> decodedFrames;
+            model.addLazyFrames(3, [&decodedFrames](EntityModel& lazyModel, const size_t frameIndex) {
+                decodedFrames.push_back(frameIndex);
+                const auto offset = static_cast<float>(frameIndex);
+                lazyModel.setFrame(frameIndex, "frame", makeTriangle(offset), EntityModel::Indices(GL_TRIANGLES, 0, 3));
+            });
+
+            ASSERT_EQ(3u, model.frameCount());
+            ASSERT_EQ(0u, model.loadedFrameCount());
+            ASSERT_EQ(0u, model.memoryUsage());
+
+            std::unique_ptr<Renderer::TexturedIndexRangeRenderer> renderer(model.buildRenderer(0, 2));
+            ASSERT_NE(nullptr, renderer);
+            ASSERT_EQ(std::vector<size_t>({ 2 }), decodedFrames);
+            ASSERT_EQ(1u, model.loadedFrameCount());
+            ASSERT_EQ(3 * sizeof(EntityModel::Vertex), model.memoryUsage());
+
+            // decoded frames are kept
+            ASSERT_EQ(vm::bbox3f(vm::vec3f(2.0f, 0.0f, 0.0f), vm::vec3f(3.0f, 1.0f, 0.0f)), model.bounds(0, 2));
+            ASSERT_EQ(std::vector<size_t>({ 2 }), decodedFrames);
+
+            ASSERT_EQ(vm::bbox3f(vm::vec3f(0.0f, 0.0f, 0.0f), vm::vec3f(1.0f, 1.0f, 0.0f)), model.bounds(0, 0));
+            ASSERT_EQ(std::vector<size_t>({ 2, 0 }), decodedFrames);
+            ASSERT_EQ(2u, model.loadedFrameCount());
+
+            ASSERT_EQ(nullptr, model.buildRenderer(0, 3));
+            ASSERT_EQ(2u, model.loadedFrameCount());
+        }
+    }
+}
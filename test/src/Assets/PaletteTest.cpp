@@ -0,0 +1,91 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ByteBuffer.h"
+#include "Color.h"
+#include "Assets/Palette.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        static Palette createRandomPalette(std::mt19937& rng) {
+            std::uniform_int_distribution<int> dist(0, 255);
+            unsigned char* data = new unsigned char[768];
+            for (size_t i = 0; i < 768; ++i)
+                data[i] = static_cast<unsigned char>(dist(rng));
+            return Palette(768, data);
+        }
+        
+        static void assertKernelMatchesScalar(const Palette& palette, const PaletteKernel kernel, const std::vector<unsigned char>& indices, const PaletteTransparency transparency) {
+            const size_t pixelCount = indices.size();
+            
+            Buffer<unsigned char> expectedImage(pixelCount * 4);
+            Color expectedColor;
+            palette.indexedToRgba(indices.data(), pixelCount, expectedImage, expectedColor, transparency, PaletteKernel::Scalar);
+            
+            Buffer<unsigned char> actualImage(pixelCount * 4);
+            Color actualColor;
+            palette.indexedToRgba(indices.data(), pixelCount, actualImage, actualColor, transparency, kernel);
+            
+            ASSERT_EQ(0, std::memcmp(expectedImage.ptr(), actualImage.ptr(), pixelCount * 4));
+            for (size_t i = 0; i < 4; ++i)
+                ASSERT_EQ(expectedColor[i], actualColor[i]);
+        }
+        
+        TEST(PaletteTest, kernelsMatchScalarConversion) {
+            std::mt19937 rng(12345);
+            const Palette palette = createRandomPalette(rng);
+            
+            std::uniform_int_distribution<int> dist(0, 255);
+            for (const size_t pixelCount : { 1u, 7u, 8u, 9u, 4096u, 65539u }) {
+                std::vector<unsigned char> indices(pixelCount);
+                for (auto& index : indices)
+                    index = static_cast<unsigned char>(dist(rng));
+                indices.front() = 255;
+                
+                for (const auto kernel : { PaletteKernel::Table, PaletteKernel::Avx2 }) {
+                    if (!Palette::supportsKernel(kernel))
+                        continue;
+                    
+                    assertKernelMatchesScalar(palette, kernel, indices, PaletteTransparency::Opaque);
+                    assertKernelMatchesScalar(palette, kernel, indices, PaletteTransparency::Index255Transparent);
+                }
+            }
+        }
+        
+        TEST(PaletteTest, shortPaletteHasBlackEntries) {
+            // a palette with only two colors
+            unsigned char* data = new unsigned char[6] { 1, 2, 3, 4, 5, 6 };
+            const Palette palette(6, data);
+            
+            const unsigned char indices[] = { 1, 0 };
+            Buffer<unsigned char> image(8);
+            Color averageColor;
+            palette.indexedToRgba(indices, 2, image, averageColor, PaletteTransparency::Opaque, PaletteKernel::Table);
+            
+            const unsigned char expected[] = { 4, 5, 6, 0xFF, 1, 2, 3, 0xFF };
+            ASSERT_EQ(0, std::memcmp(expected, image.ptr(), 8));
+        }
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/ContentHash.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(ContentHashTest, hash) {
+            const String data("some file contents that are longer than thirty-two bytes");
+
+            ASSERT_EQ(contentHash(data), contentHash(data));
+            ASSERT_EQ(contentHash(data), contentHash(data.data(), data.data() + data.size()));
+            ASSERT_NE(contentHash(data), contentHash(data, 1));
+            ASSERT_NE(contentHash(data), contentHash(data.substr(1)));
+            ASSERT_NE(contentHash(data), contentHash(data + '\0'));
+            ASSERT_NE(contentHash(""), contentHash(String(1, '\0')));
+        }
+    }
+}
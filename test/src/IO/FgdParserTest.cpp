@@ -25,6 +25,7 @@
 #include "Assets/AttributeDefinition.h"
 #include "Assets/EntityDefinitionTestUtils.h"
 #include "IO/DiskIO.h"
+#include "IO/FgdFileCache.h"
 #include "IO/FgdParser.h"
 #include "IO/Path.h"
 #include "IO/TestParserStatus.h"
@@ -736,6 +737,81 @@ decor_goddess_statue : "Goddess Statue" [])";
             VectorUtils::clearAndDelete(defs);
         }
 
+        TEST(FgdParserTest, parseIncludeWithCache) {
+            const Path path = Disk::getCurrentWorkingDir() + Path("data/IO/Fgd/parseNestedInclude/host.fgd");
+            MappedFile::Ptr file = Disk::openFile(path);
+            const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+            FgdFileCache cache;
+
+            for (size_t i = 0; i < 2; ++i) {
+                FgdParser parser(file->begin(), file->end(), defaultColor, file->path(), &cache);
+
+                TestParserStatus status;
+                auto defs = parser.parseDefinitions(status);
+                ASSERT_EQ(3u, cache.size());
+                ASSERT_EQ(3u, defs.size());
+                ASSERT_TRUE(std::any_of(std::begin(defs), std::end(defs), [](const auto* def) { return def->name() == "worldspawn"; }));
+                ASSERT_TRUE(std::any_of(std::begin(defs), std::end(defs), [](const auto* def) { return def->name() == "info_player_start"; }));
+                ASSERT_TRUE(std::any_of(std::begin(defs), std::end(defs), [](const auto* def) { return def->name() == "info_player_coop"; }));
+                ASSERT_EQ(0u, status.countStatus(Logger::LogLevel_Warn));
+                ASSERT_EQ(0u, status.countStatus(Logger::LogLevel_Error));
+
+                VectorUtils::clearAndDelete(defs);
+            }
+        }
+
+        TEST(FgdParserTest, parseChangedFileWithCache) {
+            const Path path = Disk::getCurrentWorkingDir() + Path("data/IO/Fgd/cached.fgd");
+            const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+            FgdFileCache cache;
+
+            const String file1 = "@PointClass = info_null : \"Null\" []";
+            FgdParser parser1(file1, defaultColor, path, &cache);
+
+            TestParserStatus status;
+            auto defs = parser1.parseDefinitions(status);
+            ASSERT_EQ(1u, defs.size());
+            ASSERT_EQ("info_null", defs.front()->name());
+            VectorUtils::clearAndDelete(defs);
+
+            const String file2 = "@PointClass = info_notnull : \"Not null\" []";
+            FgdParser parser2(file2, defaultColor, path, &cache);
+
+            defs = parser2.parseDefinitions(status);
+            ASSERT_EQ(1u, cache.size());
+            ASSERT_EQ(1u, defs.size());
+            ASSERT_EQ("info_notnull", defs.front()->name());
+            VectorUtils::clearAndDelete(defs);
+        }
+
+        TEST(FgdParserTest, parseCachedSpawnflagsOfBaseClasses) {
+            const String file =
+                "@baseclass = Appearflags [\n"
+                "    spawnflags(Flags) = [ 256 : \"Not on Easy\" : 0 ]\n"
+                "]\n"
+                "@PointClass base(Appearflags) = item_health [\n"
+                "    spawnflags(Flags) = [ 1 : \"Rotten\" : 0 ]\n"
+                "]\n";
+
+            const Path path = Disk::getCurrentWorkingDir() + Path("data/IO/Fgd/cached.fgd");
+            const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+            FgdFileCache cache;
+
+            for (size_t i = 0; i < 2; ++i) {
+                FgdParser parser(file, defaultColor, path, &cache);
+
+                TestParserStatus status;
+                auto defs = parser.parseDefinitions(status);
+                ASSERT_EQ(1u, defs.size());
+
+                const auto* spawnflags = defs.front()->spawnflags();
+                ASSERT_TRUE(spawnflags != nullptr);
+                ASSERT_EQ(2u, spawnflags->options().size());
+
+                VectorUtils::clearAndDelete(defs);
+            }
+        }
+
         TEST(FgdParserTest, parseStringContinuations) {
             const String file =
                 "@PointClass = cont_description :\n"
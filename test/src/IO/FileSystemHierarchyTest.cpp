@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "IO/DiskIO.h"
+#include "IO/FileSystemHierarchy.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/MappedFile.h"
+
+#include <cstring>
+#include <map>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * A flat file system whose files can be added and removed behind the back of the hierarchy.
+         */
+        class FlatFileSystem : public FileSystem {
+        private:
+            std::map<String, MappedFile::Ptr> m_files;
+        public:
+            void addFile(const Path& path, const String& contents) {
+                char* data = new char[contents.size()];
+                std::memcpy(data, contents.data(), contents.size());
+                m_files[path.asString()] = std::make_shared<MappedFileBuffer>(path, data, contents.size());
+            }
+
+            void removeFile(const Path& path) {
+                m_files.erase(path.asString());
+            }
+        private:
+            Path doMakeAbsolute(const Path& relPath) const override {
+                return Path("/") + relPath;
+            }
+
+            bool doDirectoryExists(const Path& path) const override {
+                return path.isEmpty();
+            }
+
+            bool doFileExists(const Path& path) const override {
+                return m_files.count(path.asString()) > 0;
+            }
+
+            Path::List doGetDirectoryContents(const Path& path) const override {
+                Path::List result;
+                for (const auto& entry : m_files) {
+                    result.push_back(Path(entry.first));
+                }
+                return result;
+            }
+
+            const MappedFile::Ptr doOpenFile(const Path& path) const override {
+                return m_files.at(path.asString());
+            }
+        };
+
+        TEST(FileSystemHierarchyTest, findItemsInAllFileSystems) {
+            const Path pakPath = Disk::getCurrentWorkingDir() + Path("data/IO/Pak");
+            FileSystemHierarchy fs;
+            ASSERT_FALSE(fs.directoryExists(Path("")));
+
+            fs.pushFileSystem(new IdPakFileSystem(pakPath + Path("pak1.pak"), Disk::openFile(pakPath + Path("pak1.pak"))));
+            fs.pushFileSystem(new IdPakFileSystem(pakPath + Path("pak3.pak"), Disk::openFile(pakPath + Path("pak3.pak"))));
+
+            ASSERT_TRUE(fs.directoryExists(Path("")));
+            ASSERT_TRUE(fs.directoryExists(Path("GFX")));
+            ASSERT_TRUE(fs.directoryExists(Path("textures/E1U1")));
+            ASSERT_FALSE(fs.directoryExists(Path("textures/e1u1/brlava.wal")));
+            ASSERT_FALSE(fs.directoryExists(Path("models")));
+
+            ASSERT_TRUE(fs.fileExists(Path("Textures/e1u1/BRLAVA.wal")));
+            ASSERT_TRUE(fs.fileExists(Path("gfx/palette.lmp")));
+            ASSERT_TRUE(fs.fileExists(Path("gfx/../amnet.cfg")));
+            ASSERT_FALSE(fs.fileExists(Path("gfx")));
+            ASSERT_FALSE(fs.fileExists(Path("gfx/colormap.lmp")));
+            ASSERT_FALSE(fs.fileExists(Path("models/player.mdl")));
+
+            ASSERT_EQ(Path::List({ Path("amnet.cfg"), Path("bear.cfg"), Path("gfx"), Path("pics"), Path("textures") }), fs.getDirectoryContents(Path("")));
+            ASSERT_EQ(Path::List({ Path("tag1.pcx"), Path("tag2.pcx") }), fs.getDirectoryContents(Path("PICS")));
+            ASSERT_THROW(fs.getDirectoryContents(Path("models")), FileSystemException);
+
+            ASSERT_NE(nullptr, fs.openFile(Path("pics/TAG1.pcx")));
+            ASSERT_THROW(fs.openFile(Path("pics/tag3.pcx")), FileSystemException);
+        }
+
+        TEST(FileSystemHierarchyTest, laterFileSystemsTakePrecedence) {
+            const Path pakPath = Disk::getCurrentWorkingDir() + Path("data/IO/Pak");
+            const MappedFile::Ptr pakFile = Disk::openFile(pakPath + Path("pak1.pak"));
+
+            FileSystemHierarchy fs;
+            fs.pushFileSystem(new IdPakFileSystem(Path("/base/pak0.pak"), pakFile));
+            ASSERT_EQ(Path("/base/pak0.pak/amnet.cfg"), fs.makeAbsolute(Path("amnet.cfg")));
+
+            fs.pushFileSystem(new IdPakFileSystem(Path("/mod/pak0.pak"), pakFile));
+            ASSERT_EQ(Path("/mod/pak0.pak/amnet.cfg"), fs.makeAbsolute(Path("amnet.cfg")));
+            ASSERT_EQ(Path::List({ Path("tag1.pcx"), Path("tag2.pcx") }), fs.getDirectoryContents(Path("pics")));
+
+            fs.popFileSystem();
+            ASSERT_EQ(Path("/base/pak0.pak/amnet.cfg"), fs.makeAbsolute(Path("amnet.cfg")));
+
+            fs.popFileSystem();
+            ASSERT_FALSE(fs.fileExists(Path("amnet.cfg")));
+        }
+
+        TEST(FileSystemHierarchyTest, invalidateIndexPicksUpAddedFiles) {
+            auto* top = new FlatFileSystem();
+
+            FileSystemHierarchy fs;
+            fs.pushFileSystem(top);
+            ASSERT_FALSE(fs.fileExists(Path("test.cfg")));
+
+            top->addFile(Path("test.cfg"), "top");
+            ASSERT_FALSE(fs.fileExists(Path("test.cfg")));
+
+            fs.invalidateIndex();
+            ASSERT_TRUE(fs.fileExists(Path("test.cfg")));
+        }
+
+        TEST(FileSystemHierarchyTest, openFileSkipsRemovedFiles) {
+            auto* bottom = new FlatFileSystem();
+            auto* top = new FlatFileSystem();
+            bottom->addFile(Path("test.cfg"), "bottom");
+            top->addFile(Path("test.cfg"), "top");
+
+            FileSystemHierarchy fs;
+            fs.pushFileSystem(bottom);
+            fs.pushFileSystem(top);
+            ASSERT_EQ(String("top"), String(fs.openFile(Path("test.cfg"))->begin(), 3));
+
+            // without refreshing the index, the file falls back to the lower file system
+            top->removeFile(Path("test.cfg"));
+            ASSERT_EQ(String("bottom"), String(fs.openFile(Path("test.cfg"))->begin(), 6));
+        }
+    }
+}
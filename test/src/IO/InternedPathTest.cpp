@@ -0,0 +1,86 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "IO/InternedPath.h"
+#include "IO/Path.h"
+
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(InternedPathTest, internCanonicalPaths) {
+            ASSERT_TRUE(InternedPath().isEmpty());
+            ASSERT_EQ(InternedPath(), InternedPath(Path("")));
+            ASSERT_TRUE(InternedPath(Path("/")).isEmpty());
+            ASSERT_NE(InternedPath(), InternedPath(Path("/")));
+
+            const InternedPath path(Path("textures/e1u1/brlava.wal"));
+            ASSERT_EQ(path, InternedPath(Path("textures/e1u1/brlava.wal")));
+            ASSERT_EQ(path, InternedPath(Path("textures/./e1u2/../e1u1/brlava.wal")));
+            ASSERT_EQ(path, InternedPath(Path("textures")) + Path("e1u1/brlava.wal"));
+            ASSERT_NE(path, InternedPath(Path("/textures/e1u1/brlava.wal")));
+            ASSERT_EQ(Path("textures/e1u1/brlava.wal"), path.path());
+            ASSERT_EQ(Path("/textures/e1u1"), InternedPath(Path("/textures/e1u1/brlava.wal")).deleteLastComponent().path());
+            ASSERT_EQ(InternedPath(Path("textures/e1u1")), path.deleteLastComponent());
+
+            // leading parent components are kept
+            ASSERT_EQ(Path("../maps"), InternedPath(Path("../maps")).path());
+            ASSERT_EQ(Path("../../maps"), InternedPath(Path("../../maps")).path());
+
+            ASSERT_THROW(InternedPath() + Path("/maps"), PathException);
+        }
+
+        TEST(InternedPathTest, caseFolded) {
+            const InternedPath path(Path("Textures/E1U1/BRLAVA.wal"));
+            const InternedPath folded = path.caseFolded();
+            ASSERT_NE(path, folded);
+            ASSERT_EQ(Path("textures/e1u1/brlava.wal"), folded.path());
+            ASSERT_EQ(folded, folded.caseFolded());
+            ASSERT_EQ(folded, InternedPath(Path("textures/e1u1/brlava.wal")));
+            ASSERT_EQ(folded, InternedPath(Path("TEXTURES/e1u1/Brlava.WAL")).caseFolded());
+            ASSERT_EQ(folded.hash(), InternedPath(Path("textures/e1u1/brlava.wal")).hash());
+        }
+
+        TEST(InternedPathTest, internConcurrently) {
+            std::vector<std::vector<InternedPath>> results(4);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < results.size(); ++t) {
+                threads.emplace_back([&results, t]() {
+                    for (size_t i = 0; i < 2000; ++i) {
+                        results[t].push_back(InternedPath(Path("concurrent/Dir" + std::to_string(i % 50) + "/file" + std::to_string(i) + ".mdl")));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t t = 1; t < results.size(); ++t) {
+                ASSERT_EQ(results[0], results[t]);
+            }
+            for (size_t i = 0; i < 2000; ++i) {
+                ASSERT_EQ(Path("concurrent/dir" + std::to_string(i % 50) + "/file" + std::to_string(i) + ".mdl"), results[0][i].caseFolded().path());
+            }
+        }
+    }
+}
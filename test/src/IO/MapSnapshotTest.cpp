@@ -0,0 +1,176 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Color.h"
+#include "StringUtils.h"
+#include "IO/DiskIO.h"
+#include "IO/MapSnapshot.h"
+#include "IO/NodeWriter.h"
+#include "IO/Path.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace TrenchBroom {
+    namespace IO {
+        static String readFile(const Path& path) {
+            std::ifstream stream(path.asString().c_str(), std::ios::in | std::ios::binary);
+            std::stringstream result;
+            result << stream.rdbuf();
+            return result.str();
+        }
+
+        static String writeWithNodeWriter(Model::World& map) {
+            FILE* file = std::tmpfile();
+            NodeWriter writer(&map, file);
+            writer.writeMap();
+
+            String result;
+            std::fflush(file);
+            std::rewind(file);
+
+            char buffer[4096];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, count);
+            std::fclose(file);
+            return result;
+        }
+
+        static void createMap(Model::World& map, const vm::bbox3& worldBounds) {
+            map.addOrUpdateAttribute("classname", "worldspawn");
+
+            Model::BrushBuilder builder(&map, worldBounds);
+            for (size_t i = 0; i < 100; ++i) {
+                Model::Brush* brush = builder.createCube(16.0 + static_cast<double>(i) / 3.0, "tex");
+                map.defaultLayer()->addChild(brush);
+            }
+
+            Model::Entity* entity = new Model::Entity();
+            entity->addOrUpdateAttribute("classname", "func_door");
+            entity->addChild(builder.createCube(32.0, "door"));
+            map.defaultLayer()->addChild(entity);
+        }
+
+        TEST(MapSnapshotTest, writeSnapshot) {
+            const vm::bbox3 worldBounds(8192.0);
+            const Path path = Disk::getCurrentWorkingDir() + Path("map_snapshot_test.map");
+
+            Model::World map(Model::MapFormat::Valve, nullptr, worldBounds);
+            createMap(map, worldBounds);
+
+            const String expected = "// Game: Test\n// Format: Valve\n" + writeWithNodeWriter(map);
+
+            const MapSnapshot::Ptr snapshot = MapSnapshot::take(&map, "Test");
+            snapshot->write(path, 1);
+            ASSERT_EQ(expected, readFile(path));
+
+            // writing the snapshot again replaces the file
+            snapshot->write(path, 4);
+            ASSERT_EQ(expected, readFile(path));
+            ASSERT_FALSE(Disk::fileExists(path.addExtension("tmp")));
+
+            std::remove(path.asString().c_str());
+        }
+
+        TEST(MapSnapshotTest, snapshotIsNotAffectedByChanges) {
+            const vm::bbox3 worldBounds(8192.0);
+            const Path path = Disk::getCurrentWorkingDir() + Path("map_snapshot_test.map");
+
+            Model::World map(Model::MapFormat::Standard, nullptr, worldBounds);
+            createMap(map, worldBounds);
+
+            const String expected = "// Game: Test\n// Format: Standard\n" + writeWithNodeWriter(map);
+            const MapSnapshot::Ptr snapshot = MapSnapshot::take(&map, "Test");
+
+            // change a face and delete a brush after the snapshot was taken
+            Model::Brush* first = static_cast<Model::Brush*>(map.defaultLayer()->children().front());
+            first->faces().front()->setXOffset(17.0f);
+
+            Model::Node* last = map.defaultLayer()->children()[50];
+            map.defaultLayer()->removeChild(last);
+            delete last;
+
+            snapshot->write(path, 2);
+            ASSERT_EQ(expected, readFile(path));
+
+            std::remove(path.asString().c_str());
+        }
+
+        TEST(MapSnapshotTest, snapshotContainsChangesSincePreviousSnapshot) {
+            const vm::bbox3 worldBounds(8192.0);
+            const Path path = Disk::getCurrentWorkingDir() + Path("map_snapshot_test.map");
+
+            Model::World map(Model::MapFormat::Daikatana, nullptr, worldBounds);
+            createMap(map, worldBounds);
+
+            MapSnapshot::take(&map, "Test");
+
+            // change attributes that are not rendered as well as attributes that are
+            const Model::NodeList& children = map.defaultLayer()->children();
+            static_cast<Model::Brush*>(children[0])->faces().front()->setSurfaceFlags(8);
+            static_cast<Model::Brush*>(children[1])->faces().front()->setSurfaceValue(2.0f);
+            static_cast<Model::Brush*>(children[2])->faces().front()->setColor(Color(1.0f, 0.5f, 0.25f));
+            static_cast<Model::Brush*>(children[3])->faces().front()->setXOffset(17.0f);
+
+            const String expected = "// Game: Test\n// Format: Daikatana\n" + writeWithNodeWriter(map);
+            MapSnapshot::take(&map, "Test")->write(path, 1);
+            ASSERT_EQ(expected, readFile(path));
+
+            std::remove(path.asString().c_str());
+        }
+
+        TEST(MapSnapshotTest, snapshotSharesFaceDataOfUnchangedBrushes) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World map(Model::MapFormat::Standard, nullptr, worldBounds);
+            createMap(map, worldBounds);
+
+            Model::Brush* first = static_cast<Model::Brush*>(map.defaultLayer()->children()[0]);
+            Model::Brush* second = static_cast<Model::Brush*>(map.defaultLayer()->children()[1]);
+            second->setFilePosition(1234, 5);
+
+            const MapSnapshot::Ptr snapshot = MapSnapshot::take(&map, "Test");
+            const BrushFaceDataListPtr firstData = first->faceData();
+            const BrushFaceDataListPtr secondData = second->faceData();
+
+            first->faces().front()->setSurfaceContents(1);
+            MapSnapshot::take(&map, "Test");
+
+            ASSERT_NE(firstData, first->faceData());
+            ASSERT_EQ(1, first->faceData()->front().attributes.surfaceContents());
+            ASSERT_EQ(0, firstData->front().attributes.surfaceContents());
+            ASSERT_EQ(secondData, second->faceData());
+
+            // taking a snapshot does not change the file positions
+            ASSERT_EQ(1234u, second->lineNumber());
+        }
+    }
+}
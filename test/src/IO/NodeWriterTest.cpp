@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include "Color.h"
 #include "StringUtils.h"
 #include "IO/NodeWriter.h"
 #include "Model/Brush.h"
@@ -30,6 +31,12 @@
 #include "Model/MapFormat.h"
 #include "Model/World.h"
 
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+
+#include <cstdio>
+#include <random>
+
 namespace TrenchBroom {
     namespace IO {
         TEST(NodeWriterTest, writeEmptyMap) {
@@ -479,5 +486,197 @@ namespace TrenchBroom {
                          "\"message\" \"holy damn\\nhe said\"\n"
                          "}\n", result.c_str());
         }
+
+        /**
+         * Formats a face like the map file writer did when it wrote every face with fprintf.
+         */
+        static String formatFaceWithPrintf(const Model::MapFormat::Type format, const Model::BrushFace* face) {
+            const Model::BrushFace::Points& points = face->points();
+            const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
+
+            char buffer[1024];
+            String result;
+            std::snprintf(buffer, sizeof(buffer), "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g )",
+                          points[0].x(), points[0].y(), points[0].z(),
+                          points[1].x(), points[1].y(), points[1].z(),
+                          points[2].x(), points[2].y(), points[2].z());
+            result += buffer;
+
+            if (format == Model::MapFormat::Valve) {
+                const vm::vec3 xAxis = face->textureXAxis();
+                const vm::vec3 yAxis = face->textureYAxis();
+                std::snprintf(buffer, sizeof(buffer), " %s [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g",
+                              textureName.c_str(),
+                              xAxis.x(), xAxis.y(), xAxis.z(), face->xOffset(),
+                              yAxis.x(), yAxis.y(), yAxis.z(), face->yOffset(),
+                              face->rotation(), face->xScale(), face->yScale());
+            } else {
+                std::snprintf(buffer, sizeof(buffer), " %s %.6g %.6g %.6g %.6g %.6g",
+                              textureName.c_str(), face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale());
+            }
+            result += buffer;
+
+            if ((format == Model::MapFormat::Quake2 && face->hasSurfaceAttributes()) ||
+                (format == Model::MapFormat::Daikatana && (face->hasSurfaceAttributes() || face->hasColor()))) {
+                std::snprintf(buffer, sizeof(buffer), " %d %d %.6g", face->surfaceContents(), face->surfaceFlags(), face->surfaceValue());
+                result += buffer;
+            }
+            if (format == Model::MapFormat::Daikatana && face->hasColor()) {
+                std::snprintf(buffer, sizeof(buffer), " %d %d %d",
+                              static_cast<int>(face->color().r()),
+                              static_cast<int>(face->color().g()),
+                              static_cast<int>(face->color().b()));
+                result += buffer;
+            }
+
+            // Hexen 2 appends an extra value without a separator
+            result += format == Model::MapFormat::Hexen2 ? "0 \n" : "\n";
+            return result;
+        }
+
+        static String readAndCloseFile(FILE* file) {
+            String result;
+            std::fflush(file);
+            std::rewind(file);
+
+            char buffer[4096];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, count);
+            std::fclose(file);
+            return result;
+        }
+
+        static String writeMapFile(Model::World& map, const size_t threadCount) {
+            FILE* file = std::tmpfile();
+            NodeWriter writer(&map, file, threadCount);
+            writer.writeMap();
+            return readAndCloseFile(file);
+        }
+
+        static void addRandomBrushes(Model::World& map, const vm::bbox3& worldBounds, const size_t count) {
+            std::mt19937 random(0);
+            std::uniform_real_distribution<double> angles(0.0, 3.14);
+            std::uniform_real_distribution<double> coords(-2048.0, 2048.0);
+            std::uniform_real_distribution<float> attribs(-2.0f, 2.0f);
+            std::uniform_int_distribution<int> flags(0, 8);
+            std::uniform_int_distribution<int> colors(0, 255);
+
+            Model::BrushBuilder builder(&map, worldBounds);
+            for (size_t i = 0; i < count; ++i) {
+                Model::Brush* brush = builder.createCube(64.0, i % 2 == 0 ? "tex" : "");
+                if (i % 3 != 0) {
+                    const vm::mat4x4 transform = vm::translationMatrix(vm::vec3(coords(random), coords(random), coords(random))) *
+                                                 vm::rotationMatrix(angles(random), angles(random), angles(random));
+                    brush->transform(transform, false, worldBounds);
+                }
+                for (Model::BrushFace* face : brush->faces()) {
+                    if (i % 5 != 0) {
+                        face->setXOffset(attribs(random));
+                        face->setYOffset(attribs(random) * 64.0f);
+                        face->setRotation(attribs(random) * 90.0f);
+                        face->setXScale(attribs(random));
+                        face->setSurfaceContents(flags(random));
+                        face->setSurfaceValue(attribs(random));
+                    }
+                    if (i % 7 == 0) {
+                        face->setColor(Color(static_cast<float>(colors(random)), static_cast<float>(colors(random)), static_cast<float>(colors(random))));
+                    }
+                }
+                map.defaultLayer()->addChild(brush);
+            }
+        }
+
+        static void assertWritesLikePrintf(const Model::MapFormat::Type format) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            // enough faces to fill the writer's buffer several times
+            Model::World map(format, nullptr, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            addRandomBrushes(map, worldBounds, 12000);
+
+            String expected = "// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+            size_t brushNo = 0;
+            for (const Model::Node* node : map.defaultLayer()->children()) {
+                const Model::Brush* brush = static_cast<const Model::Brush*>(node);
+                expected += "// brush " + std::to_string(brushNo++) + "\n{\n";
+                for (const Model::BrushFace* face : brush->faces())
+                    expected += formatFaceWithPrintf(format, face);
+                expected += "}\n";
+            }
+            expected += "}\n";
+
+            const String serial = writeMapFile(map, 1);
+            ASSERT_TRUE(expected == serial) << "first difference at " << StringUtils::findFirstDifference(expected, serial);
+
+            const String parallel = writeMapFile(map, 4);
+            ASSERT_TRUE(expected == parallel) << "first difference at " << StringUtils::findFirstDifference(expected, parallel);
+        }
+
+        TEST(NodeWriterTest, writeStandardMapFileLikePrintf) {
+            assertWritesLikePrintf(Model::MapFormat::Standard);
+        }
+
+        TEST(NodeWriterTest, writeValveMapFileLikePrintf) {
+            assertWritesLikePrintf(Model::MapFormat::Valve);
+        }
+
+        TEST(NodeWriterTest, writeQuake2MapFileLikePrintf) {
+            assertWritesLikePrintf(Model::MapFormat::Quake2);
+        }
+
+        TEST(NodeWriterTest, writeDaikatanaMapFileLikePrintf) {
+            assertWritesLikePrintf(Model::MapFormat::Daikatana);
+        }
+
+        TEST(NodeWriterTest, writeHexen2MapFileLikePrintf) {
+            assertWritesLikePrintf(Model::MapFormat::Hexen2);
+        }
+
+        TEST(NodeWriterTest, writeMapFileSetsFilePositions) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World map(Model::MapFormat::Standard, nullptr, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            addRandomBrushes(map, worldBounds, 12000);
+
+            writeMapFile(map, 1);
+            std::vector<size_t> serialLines;
+            for (const Model::Node* node : map.defaultLayer()->children())
+                serialLines.push_back(node->lineNumber());
+
+            writeMapFile(map, 4);
+            std::vector<size_t> parallelLines;
+            for (const Model::Node* node : map.defaultLayer()->children())
+                parallelLines.push_back(node->lineNumber());
+
+            ASSERT_EQ(serialLines, parallelLines);
+            ASSERT_EQ(5u, serialLines[0]);
+            ASSERT_EQ(14u, serialLines[1]);
+            ASSERT_EQ(5u + 9u * 11999u, serialLines.back());
+        }
+
+        TEST(NodeWriterTest, writeFacesToFile) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World map(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::Brush* brush = builder.createCube(64.0, "none");
+
+            FILE* file = std::tmpfile();
+            NodeWriter writer(&map, file);
+            writer.writeBrushFaces(brush->faces());
+
+            const String result = readAndCloseFile(file);
+            ASSERT_STREQ("( -32 -32 -32 ) ( -32 -31 -32 ) ( -32 -32 -31 ) none 0 0 0 1 1\n"
+                         "( 32 32 32 ) ( 32 32 33 ) ( 32 33 32 ) none 0 0 0 1 1\n"
+                         "( -32 -32 -32 ) ( -32 -32 -31 ) ( -31 -32 -32 ) none 0 0 0 1 1\n"
+                         "( 32 32 32 ) ( 33 32 32 ) ( 32 32 33 ) none 0 0 0 1 1\n"
+                         "( 32 32 32 ) ( 32 33 32 ) ( 33 32 32 ) none 0 0 0 1 1\n"
+                         "( -32 -32 -32 ) ( -31 -32 -32 ) ( -32 -31 -32 ) none 0 0 0 1 1\n",
+                         result.c_str());
+
+            delete brush;
+        }
     }
 }
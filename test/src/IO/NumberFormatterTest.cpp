@@ -0,0 +1,151 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/NumberFormatter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace TrenchBroom {
+    namespace IO {
+        static String format(const double value, const int precision) {
+            char buffer[MaxFormattedNumberLength];
+            return String(buffer, formatDecimal(value, precision, buffer));
+        }
+
+        static String formatWithSnprintf(const double value, const int precision) {
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            return buffer;
+        }
+
+        static void assertFormatsLikePrintf(const double value) {
+            ASSERT_EQ(formatWithSnprintf(value, 17), format(value, 17)) << "value: " << formatWithSnprintf(value, 17);
+            ASSERT_EQ(formatWithSnprintf(value, 6), format(value, 6)) << "value: " << formatWithSnprintf(value, 17);
+            ASSERT_EQ(formatWithSnprintf(-value, 17), format(-value, 17)) << "value: " << formatWithSnprintf(-value, 17);
+            ASSERT_EQ(formatWithSnprintf(-value, 6), format(-value, 6)) << "value: " << formatWithSnprintf(-value, 17);
+        }
+
+        TEST(NumberFormatterTest, formatZero) {
+            ASSERT_EQ("0", format(0.0, 17));
+            ASSERT_EQ("-0", format(-0.0, 17));
+            ASSERT_EQ("0", format(0.0, 6));
+        }
+
+        TEST(NumberFormatterTest, formatIntegers) {
+            ASSERT_EQ("1", format(1.0, 17));
+            ASSERT_EQ("-64", format(-64.0, 17));
+            ASSERT_EQ("4096", format(4096.0, 6));
+            ASSERT_EQ("123456", format(123456.0, 6));
+            ASSERT_EQ("1.23457e+06", format(1234567.0, 6));
+            ASSERT_EQ("12345678901234560", format(12345678901234560.0, 17));
+
+            for (int i = -70000; i <= 70000; ++i)
+                assertFormatsLikePrintf(static_cast<double>(i));
+            for (int i = 0; i < 64; ++i)
+                assertFormatsLikePrintf(std::ldexp(1.0, i));
+        }
+
+        TEST(NumberFormatterTest, formatBinaryFractions) {
+            ASSERT_EQ("0.5", format(0.5, 17));
+            ASSERT_EQ("-12.25", format(-12.25, 6));
+            ASSERT_EQ("0.0001220703125", format(std::ldexp(1.0, -13), 17));
+            ASSERT_EQ("0.00012207", format(std::ldexp(1.0, -13), 6));
+
+            for (int i = -4096; i <= 4096; ++i) {
+                for (int j = 1; j <= 24; ++j)
+                    assertFormatsLikePrintf(std::ldexp(static_cast<double>(i), -j));
+            }
+        }
+
+        TEST(NumberFormatterTest, formatDecimalFractions) {
+            ASSERT_EQ("0.10000000000000001", format(0.1, 17));
+            ASSERT_EQ("0.1", format(0.1, 6));
+            ASSERT_EQ("-1234.5678", format(-1234.5678, 17));
+            ASSERT_EQ("1234.57", format(1234.5678, 6));
+            ASSERT_EQ("100000", format(99999.97, 6));
+            ASSERT_EQ("1e+06", format(999999.5, 6));
+
+            // ties are rounded to even
+            ASSERT_EQ("0.2", format(0.25, 1));
+            ASSERT_EQ("0.12", format(0.125, 2));
+            ASSERT_EQ("2", format(2.5, 1));
+
+            for (int i = -4; i < 17; ++i) {
+                const double power = std::pow(10.0, i);
+                assertFormatsLikePrintf(power);
+                assertFormatsLikePrintf(std::nextafter(power, 0.0));
+                assertFormatsLikePrintf(std::nextafter(power, 2.0 * power));
+            }
+        }
+
+        TEST(NumberFormatterTest, formatSmallAndLargeNumbers) {
+            assertFormatsLikePrintf(1e-4);
+            assertFormatsLikePrintf(std::ldexp(1.0, -14));
+            assertFormatsLikePrintf(std::ldexp(3.0, -16));
+            assertFormatsLikePrintf(1e-300);
+            assertFormatsLikePrintf(1e300);
+            assertFormatsLikePrintf(1e17);
+            assertFormatsLikePrintf(123456789012345678.0);
+            assertFormatsLikePrintf(std::numeric_limits<double>::min());
+            assertFormatsLikePrintf(std::numeric_limits<double>::denorm_min());
+            assertFormatsLikePrintf(std::numeric_limits<double>::max());
+            assertFormatsLikePrintf(std::numeric_limits<double>::epsilon());
+            assertFormatsLikePrintf(std::numeric_limits<double>::infinity());
+        }
+
+        TEST(NumberFormatterTest, formatRandomNumbers) {
+            std::mt19937 random(0);
+            std::uniform_real_distribution<double> decimals(-8192.0, 8192.0);
+            std::uniform_int_distribution<uint64_t> bits;
+
+            for (size_t i = 0; i < 100000; ++i) {
+                const double value = decimals(random);
+                assertFormatsLikePrintf(value);
+                assertFormatsLikePrintf(value * std::pow(10.0, static_cast<int>(i % 24) - 10));
+                assertFormatsLikePrintf(static_cast<double>(static_cast<float>(value)));
+
+                uint64_t b = bits(random);
+                double any;
+                std::memcpy(&any, &b, sizeof(any));
+                if (!std::isnan(any))
+                    assertFormatsLikePrintf(any);
+            }
+        }
+
+        TEST(NumberFormatterTest, formatInteger) {
+            const long values[] = { 0, 1, -1, 9, 10, 255, -4096, 2147483647, -2147483647 - 1,
+                                    std::numeric_limits<long>::max(), std::numeric_limits<long>::min() };
+            for (const long value : values) {
+                char expected[64];
+                std::snprintf(expected, sizeof(expected), "%ld", value);
+
+                char buffer[MaxFormattedNumberLength];
+                ASSERT_EQ(String(expected), String(buffer, formatInteger(value, buffer)));
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/NumberParser.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace TrenchBroom {
+    namespace IO {
+        static void assertParseDecimal(const String& str) {
+            const double expected = std::atof(str.c_str());
+            const double actual = parseDecimal(str.data(), str.data() + str.size());
+            ASSERT_EQ(0, std::memcmp(&expected, &actual, sizeof(double))) << "Parsing '" << str << "'";
+        }
+
+        static void assertParseInteger(const String& str) {
+            ASSERT_EQ(std::atol(str.c_str()), parseInteger(str.data(), str.data() + str.size())) << "Parsing '" << str << "'";
+        }
+
+        TEST(NumberParserTest, parseDecimal) {
+            assertParseDecimal("");
+            assertParseDecimal("0");
+            assertParseDecimal("-0");
+            assertParseDecimal("+0");
+            assertParseDecimal("-0.0");
+            assertParseDecimal("1");
+            assertParseDecimal("-1");
+            assertParseDecimal("+1");
+            assertParseDecimal("1.");
+            assertParseDecimal(".5");
+            assertParseDecimal("-.5");
+            assertParseDecimal("0.1");
+            assertParseDecimal("0.3");
+            assertParseDecimal("123.456");
+            assertParseDecimal("-1320.000000");
+            assertParseDecimal("505.37931034482756");
+            assertParseDecimal("197.51724137931035");
+            assertParseDecimal("0.30000000000000004");
+            assertParseDecimal("9007199254740993");
+            assertParseDecimal("12345678901234567890123");
+            assertParseDecimal("1e10");
+            assertParseDecimal("1E10");
+            assertParseDecimal("1.5e-3");
+            assertParseDecimal("1.5e+3");
+            assertParseDecimal("2.5e-30");
+            assertParseDecimal("1e400");
+            assertParseDecimal("1e-400");
+            assertParseDecimal("1e");
+            assertParseDecimal("1e-");
+            assertParseDecimal("0x1p3");
+            assertParseDecimal("inf");
+            assertParseDecimal("nan");
+            assertParseDecimal("abc");
+            assertParseDecimal(" 12");
+            assertParseDecimal("12abc");
+        }
+
+        TEST(NumberParserTest, parseDecimalMatchesAtof) {
+            std::mt19937 random(42);
+            std::uniform_real_distribution<double> values(-65536.0, 65536.0);
+            std::uniform_int_distribution<int> precisions(0, 17);
+
+            char buffer[64];
+            for (size_t i = 0; i < 100000; ++i) {
+                std::snprintf(buffer, sizeof(buffer), "%.*f", precisions(random), values(random));
+                assertParseDecimal(buffer);
+                std::snprintf(buffer, sizeof(buffer), "%.17g", values(random));
+                assertParseDecimal(buffer);
+            }
+        }
+
+        TEST(NumberParserTest, parseDecimalRange) {
+            const String str("12.5)");
+            ASSERT_DOUBLE_EQ(12.5, parseDecimal(str.data(), str.data() + 4));
+            ASSERT_DOUBLE_EQ(12.0, parseDecimal(str.data(), str.data() + 2));
+        }
+
+        TEST(NumberParserTest, parseInteger) {
+            assertParseInteger("");
+            assertParseInteger("0");
+            assertParseInteger("-0");
+            assertParseInteger("1");
+            assertParseInteger("-1");
+            assertParseInteger("+1");
+            assertParseInteger("1234567");
+            assertParseInteger("-1234567");
+            assertParseInteger("12.5");
+            assertParseInteger("12abc");
+            assertParseInteger(" 12");
+            assertParseInteger("abc");
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/FileMatcher.h"
+#include "IO/FreeImageTextureReader.h"
+#include "IO/IdMipTextureReader.h"
+#include "IO/Path.h"
+#include "IO/PersistentTextureCache.h"
+#include "IO/WadFileSystem.h"
+
+#include <cstring>
+#include <memory>
+
+#include <wx/datetime.h>
+#include <wx/filename.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        class TestTextureCacheDirectory {
+        private:
+            Path m_dir;
+        public:
+            TestTextureCacheDirectory() :
+            m_dir(Disk::getCurrentWorkingDir() + Path("texturecachetest")) {
+                deleteDirectory();
+            }
+
+            ~TestTextureCacheDirectory() {
+                deleteDirectory();
+            }
+
+            const Path& dir() const {
+                return m_dir;
+            }
+        private:
+            void deleteDirectory() {
+                if (Disk::directoryExists(m_dir)) {
+                    ::wxFileName::Rmdir(m_dir.asString(), wxPATH_RMDIR_RECURSIVE);
+                }
+            }
+        };
+
+        static void assertSameImage(const Assets::Texture& expected, const Assets::Texture& actual) {
+            ASSERT_EQ(expected.name(), actual.name());
+            ASSERT_EQ(expected.width(), actual.width());
+            ASSERT_EQ(expected.height(), actual.height());
+            ASSERT_EQ(expected.format(), actual.format());
+            ASSERT_EQ(expected.type(), actual.type());
+            ASSERT_EQ(expected.averageColor(), actual.averageColor());
+            ASSERT_EQ(expected.buffers().size(), actual.buffers().size());
+            for (size_t i = 0; i < expected.buffers().size(); ++i) {
+                const auto& expectedBuffer = expected.buffers()[i];
+                const auto& actualBuffer = actual.buffers()[i];
+                ASSERT_EQ(expectedBuffer.size(), actualBuffer.size());
+                ASSERT_EQ(0, std::memcmp(expectedBuffer.ptr(), actualBuffer.ptr(), expectedBuffer.size()));
+            }
+        }
+
+        TEST(PersistentTextureCacheTest, readWrittenTexture) {
+            TestTextureCacheDirectory env;
+            const PersistentTextureCache cache(env.dir());
+
+            Assets::TextureBuffer::List buffers(2);
+            Assets::setMipBufferSize(buffers, 2, 4, 2, GL_RGBA);
+            for (auto& buffer : buffers) {
+                for (size_t i = 0; i < buffer.size(); ++i) {
+                    buffer[i] = static_cast<unsigned char>(i);
+                }
+            }
+            const Assets::Texture texture("texture", 4, 2, Color(0.25f, 0.5f, 0.75f, 1.0f), buffers, GL_RGBA, Assets::TextureType::Masked);
+
+            ASSERT_EQ(nullptr, cache.read(1, "texture"));
+            cache.write(1, texture);
+
+            std::unique_ptr<Assets::Texture> cached(cache.read(1, "texture"));
+            ASSERT_NE(nullptr, cached);
+            assertSameImage(texture, *cached);
+
+            ASSERT_EQ(nullptr, cache.read(2, "texture"));
+        }
+
+        TEST(PersistentTextureCacheTest, pruneDeletesOldestEntries) {
+            TestTextureCacheDirectory env;
+            const PersistentTextureCache cache(env.dir());
+
+            Assets::TextureBuffer::List buffers(1);
+            Assets::setMipBufferSize(buffers, 1, 4, 4, GL_RGBA);
+            const Assets::Texture texture("texture", 4, 4, Color(), buffers, GL_RGBA, Assets::TextureType::Opaque);
+
+            // the first entry was written an hour ago
+            cache.write(1, texture);
+            const auto entries = Disk::findItemsRecursively(env.dir(), FileExtensionMatcher("tex"));
+            ASSERT_EQ(1u, entries.size());
+            const auto entrySize = Disk::fileSize(entries.front());
+            const wxDateTime anHourAgo = wxDateTime::Now() - wxTimeSpan::Hour();
+            ASSERT_TRUE(wxFileName(entries.front().asString()).SetTimes(&anHourAgo, &anHourAgo, nullptr));
+
+            cache.write(2, texture);
+            cache.write(3, texture);
+
+            cache.prune(3 * entrySize);
+            ASSERT_EQ(3u, Disk::findItemsRecursively(env.dir(), FileExtensionMatcher("tex")).size());
+
+            cache.prune(2 * entrySize);
+            ASSERT_EQ(2u, Disk::findItemsRecursively(env.dir(), FileExtensionMatcher("tex")).size());
+            std::unique_ptr<Assets::Texture> first(cache.read(1, "texture"));
+            ASSERT_EQ(nullptr, first);
+            std::unique_ptr<Assets::Texture> second(cache.read(2, "texture"));
+            ASSERT_NE(nullptr, second);
+        }
+
+        TEST(PersistentTextureCacheTest, readerUsesCache) {
+            TestTextureCacheDirectory env;
+
+            const DiskFileSystem fs(Disk::getCurrentWorkingDir() + Path("data/IO/Image"));
+            const auto file = fs.openFile(Path("707x710.png"));
+
+            TextureReader::TextureNameStrategy nameStrategy;
+            FreeImageTextureReader uncachedReader(nameStrategy, 4);
+            std::unique_ptr<Assets::Texture> expected(uncachedReader.readTexture(file));
+            ASSERT_NE(nullptr, expected);
+
+            FreeImageTextureReader cachedReader(nameStrategy, 4);
+            cachedReader.setCache(std::make_shared<PersistentTextureCache>(env.dir()));
+
+            // the first read decodes the texture and stores it, the second one reads it from the cache
+            std::unique_ptr<Assets::Texture> decoded(cachedReader.readTexture(file));
+            ASSERT_NE(nullptr, decoded);
+            assertSameImage(*expected, *decoded);
+            ASSERT_EQ(1u, Disk::findItemsRecursively(env.dir(), FileExtensionMatcher("tex")).size());
+
+            std::unique_ptr<Assets::Texture> cached(cachedReader.readTexture(file));
+            ASSERT_NE(nullptr, cached);
+            assertSameImage(*expected, *cached);
+        }
+
+        TEST(PersistentTextureCacheTest, palettedTexturesAreNotCached) {
+            TestTextureCacheDirectory env;
+
+            const DiskFileSystem fs(Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            const WadFileSystem wadFS(Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad"));
+
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader reader(nameStrategy, palette);
+            reader.setCache(std::make_shared<PersistentTextureCache>(env.dir()));
+
+            std::unique_ptr<Assets::Texture> texture(reader.readTexture(wadFS.openFile(Path("cr8_czg_3.D"))));
+            ASSERT_NE(nullptr, texture);
+            ASSERT_FALSE(Disk::directoryExists(env.dir()));
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/IdMipTextureReader.h"
+#include "IO/Path.h"
+#include "IO/TextureCollectionLoader.h"
+
+#include <memory>
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(TextureCollectionLoaderTest, loadTextureCollectionsInParallel) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader textureReader(nameStrategy, palette);
+            
+            FileTextureCollectionLoader loader(Path::List(1, Disk::getCurrentWorkingDir() + Path("data/IO/Wad")));
+            const StringList extensions(1, "D");
+            const Path::List paths{ Path("cr8_czg.wad"), Path("does_not_exist.wad"), Path("cr8_czg.wad") };
+            
+            const auto serial = loader.loadTextureCollections(paths, extensions, textureReader, 1);
+            const auto parallel = loader.loadTextureCollections(paths, extensions, textureReader, 4);
+            ASSERT_EQ(3u, serial.size());
+            ASSERT_EQ(3u, parallel.size());
+            
+            ASSERT_TRUE(parallel[1].collection == nullptr);
+            ASSERT_FALSE(parallel[1].error.empty());
+            
+            for (const size_t i : { 0u, 2u }) {
+                ASSERT_TRUE(serial[i].collection != nullptr);
+                ASSERT_TRUE(parallel[i].collection != nullptr);
+                ASSERT_EQ(Path("cr8_czg.wad"), parallel[i].collection->path());
+                
+                const auto& expected = serial[i].collection->textures();
+                const auto& actual = parallel[i].collection->textures();
+                ASSERT_EQ(21u, actual.size());
+                ASSERT_EQ(expected.size(), actual.size());
+                for (size_t j = 0; j < expected.size(); ++j) {
+                    ASSERT_EQ(expected[j]->name(), actual[j]->name());
+                    ASSERT_EQ(expected[j]->averageColor(), actual[j]->averageColor());
+                }
+            }
+        }
+
+        TEST(TextureCollectionLoaderTest, loadLazyTextureCollections) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            auto textureReader = std::make_shared<IdMipTextureReader>(nameStrategy, palette);
+            
+            FileTextureCollectionLoader loader(Path::List(1, Disk::getCurrentWorkingDir() + Path("data/IO/Wad")));
+            const StringList extensions(1, "D");
+            const Path::List paths{ Path("cr8_czg.wad") };
+            
+            const auto eager = loader.loadTextureCollections(paths, extensions, *textureReader, 1);
+            const auto lazy = loader.loadLazyTextureCollections(paths, extensions, textureReader, 4);
+            ASSERT_TRUE(lazy[0].collection != nullptr);
+            
+            const auto& expected = eager[0].collection->textures();
+            const auto& actual = lazy[0].collection->textures();
+            ASSERT_EQ(expected.size(), actual.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_FALSE(expected[i]->lazy());
+                ASSERT_TRUE(actual[i]->lazy());
+                ASSERT_EQ(expected[i]->name(), actual[i]->name());
+                ASSERT_EQ(expected[i]->width(), actual[i]->width());
+                ASSERT_EQ(expected[i]->height(), actual[i]->height());
+            }
+        }
+    }
+}
@@ -19,11 +19,14 @@
 
 #include <gtest/gtest.h>
 
+#include "Exceptions.h"
+#include "IO/ParserStatus.h"
 #include "IO/TestParserStatus.h"
 #include "IO/WorldReader.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/Entity.h"
+#include "Model/Group.h"
 #include "Model/World.h"
 
 namespace TrenchBroom {
@@ -709,6 +712,203 @@ namespace TrenchBroom {
             delete world;
         }
         
+        TEST(WorldReaderTest, parseEntitiesAndBrushesWithGroupInParallel) {
+            const String data("{\n"
+                              "\"classname\" \"worldspawn\"\n"
+                              "{\n"
+                              "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) none 0 0 0 1 1\n"
+                              "}\n"
+                              "}\n"
+                              "{\n"
+                              "\"classname\" \"func_group\"\n"
+                              "\"_tb_type\" \"_tb_group\"\n"
+                              "\"_tb_name\" \"My Group\"\n"
+                              "\"_tb_id\" \"1\"\n"
+                              "{\n"
+                              "( -800 288 1024 ) ( -736 288 1024 ) ( -736 224 1024 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 288 1024 ) ( -800 224 1024 ) ( -800 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -736 224 1024 ) ( -736 288 1024 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -736 288 1024 ) ( -800 288 1024 ) ( -800 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 224 1024 ) ( -736 224 1024 ) ( -736 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 224 576 ) ( -736 224 576 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "}\n"
+                              "}\n"
+                              "{\n"
+                              "\"classname\" \"func_door\"\n"
+                              "\"_tb_group\" \"1\"\n"
+                              "{\n"
+                              "( -800 288 1024 ) ( -736 288 1024 ) ( -736 224 1024 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 288 1024 ) ( -800 224 1024 ) ( -800 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -736 224 1024 ) ( -736 288 1024 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -736 288 1024 ) ( -800 288 1024 ) ( -800 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 224 1024 ) ( -736 224 1024 ) ( -736 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "( -800 224 576 ) ( -736 224 576 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                              "}\n"
+                              "}\n");
+            vm::bbox3 worldBounds(8192);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setThreadCount(4);
+
+            Model::World* world = reader.read(Model::MapFormat::Quake2, worldBounds, status);
+
+            ASSERT_EQ(1u, world->childCount());
+
+            // the children must be in the same order as if the brushes had been built while parsing
+            Model::Node* defaultLayer = world->children().front();
+            ASSERT_EQ(2u, defaultLayer->childCount());
+            ASSERT_TRUE(dynamic_cast<Model::Brush*>(defaultLayer->children()[0]) != nullptr);
+            ASSERT_EQ(3u, defaultLayer->children()[0]->lineNumber());
+
+            Model::Node* myGroup = defaultLayer->children()[1];
+            ASSERT_TRUE(dynamic_cast<Model::Group*>(myGroup) != nullptr);
+            ASSERT_EQ(2u, myGroup->childCount());
+            ASSERT_TRUE(dynamic_cast<Model::Brush*>(myGroup->children()[0]) != nullptr);
+
+            Model::Node* door = myGroup->children()[1];
+            ASSERT_TRUE(dynamic_cast<Model::Entity*>(door) != nullptr);
+            ASSERT_EQ(1u, door->childCount());
+            ASSERT_EQ(29u, door->children().front()->lineNumber());
+
+            delete world;
+        }
+
+        TEST(WorldReaderTest, parseInvalidBrushInParallel) {
+            const String data("{\n"
+                              "\"classname\" \"worldspawn\"\n"
+                              "{\n"
+                              "( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) __TB_empty -56 -72 -0 1 1\n"
+                              "( 1320 512 152 ) ( 1280 512 192 ) ( 1320 504 152 ) grill_wall03b_h -0 -72 -0 1 1\n"
+                              "( 1344 512 160 ) ( 1280 512 224 ) ( 1320 512 152 ) grill_wall03b_h -56 -72 -0 1 1\n"
+                              "( 1320 512 152 ) ( 1320 504 152 ) ( 1344 512 160 ) grill_wall03b_h -56 -0 -0 1 1\n"
+                              "}\n"
+                              "{\n"
+                              "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) none 0 0 0 1 1\n"
+                              "}\n"
+                              "}\n");
+            vm::bbox3 worldBounds(8192);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+            reader.setThreadCount(4);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+
+            ASSERT_EQ(1u, status.countStatus(Logger::LogLevel_Error));
+
+            Model::Node* defaultLayer = world->children().front();
+            ASSERT_EQ(1u, defaultLayer->childCount());
+            ASSERT_EQ(9u, defaultLayer->children().front()->lineNumber());
+
+            delete world;
+        }
+
+        class MessageRecorder : public ParserStatus {
+        public:
+            StringList messages;
+        public:
+            MessageRecorder() :
+            ParserStatus(nullptr) {}
+        private:
+            void doProgress(const double progress) override {}
+
+            void doLog(const Logger::LogLevel level, const String& str) override {
+                messages.push_back(str);
+            }
+        };
+
+        static void describeNode(const Model::Node* node, StringStream& str) {
+            str << node->lineNumber();
+            if (const auto* entity = dynamic_cast<const Model::Entity*>(node))
+                str << " entity " << entity->classname();
+            if (const auto* brush = dynamic_cast<const Model::Brush*>(node)) {
+                str << " brush";
+                for (const Model::BrushFace* face : brush->faces())
+                    str << " " << face->textureName();
+            }
+            str << "\n";
+
+            for (const Model::Node* child : node->children())
+                describeNode(child, str);
+        }
+
+        static String readAndDescribe(const String& data, const size_t threadCount, StringList& messages) {
+            const vm::bbox3 worldBounds(8192);
+
+            MessageRecorder status;
+            WorldReader reader(data, nullptr);
+            reader.setThreadCount(threadCount);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+
+            StringStream str;
+            describeNode(world, str);
+            delete world;
+
+            messages = status.messages;
+            return str.str();
+        }
+
+        static String makeLargeMap(const size_t entityCount) {
+            StringStream str;
+            str << "{\n\"classname\" \"worldspawn\"\n}\n";
+            for (size_t i = 0; i < entityCount; ++i) {
+                // braces in strings, comments and texture names must not be taken for entity boundaries
+                str << "// entity " << i + 1 << " { \n";
+                str << "{\n";
+                str << "\"classname\" \"func_wall\"\n";
+                str << "\"message\" \"} {{ \\\" }\"\n";
+                str << "\"path\" \"maps\\\"\n";
+                if (i % 10 == 0)
+                    str << "\"message\" \"duplicate\"\n";
+                str << "{\n";
+                str << "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) {fence 0 0 0 1 1\n";
+                str << "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex} 0 0 0 1 1 // }\n";
+                str << "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) none 0 0 0 1 1\n";
+                str << "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) none 0 0 0 1 1\n";
+                str << "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) none 0 0 0 1 1\n";
+                str << "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) none 0 0 0 1 1\n";
+                if (i % 50 == 0)
+                    str << "( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) none 0 0 0 1 1\n";
+                str << "}\n";
+                str << "}";
+                if (i % 3 == 0)
+                    str << "\n";
+            }
+            return str.str();
+        }
+
+        TEST(WorldReaderTest, parseLargeMapInParallel) {
+            const String data = makeLargeMap(2000);
+
+            StringList serialMessages, parallelMessages;
+            const String serial = readAndDescribe(data, 1, serialMessages);
+            const String parallel = readAndDescribe(data, 4, parallelMessages);
+
+            ASSERT_EQ(serial, parallel);
+            ASSERT_EQ(serialMessages, parallelMessages);
+            ASSERT_FALSE(serialMessages.empty());
+        }
+
+        TEST(WorldReaderTest, parseLargeMapWithErrorInParallel) {
+            const String data = makeLargeMap(2000) + "\n{\n\"classname\" \"light\"\nfoo\n}\n" + makeLargeMap(10);
+
+            StringList messages;
+            ASSERT_THROW(readAndDescribe(data, 1, messages), ParserException);
+            ASSERT_THROW(readAndDescribe(data, 4, messages), ParserException);
+        }
+
         TEST(WorldReaderTest, parseMultipleClassnames) {
             // See https://github.com/kduske/TrenchBroom/issues/1485
             
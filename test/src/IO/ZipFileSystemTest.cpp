@@ -0,0 +1,173 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "IO/DiskFileSystem.h"
+#include "IO/MappedFile.h"
+#include "IO/ZipFileSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        static std::string contents(const MappedFile::Ptr& file) {
+            return std::string(file->begin(), file->end());
+        }
+
+        static std::string repeat(const std::string& str, const size_t count) {
+            std::string result;
+            for (size_t i = 0; i < count; ++i) {
+                result += str;
+            }
+            return result;
+        }
+
+        TEST(ZipFileSystemTest, directoryExists) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile);
+            ASSERT_THROW(fs.directoryExists(Path("/textures")), FileSystemException);
+
+            ASSERT_TRUE(fs.directoryExists(Path("textures")));
+            ASSERT_TRUE(fs.directoryExists(Path("TEXTURES/e1u1")));
+            ASSERT_TRUE(fs.directoryExists(Path("maps")));
+            ASSERT_TRUE(fs.directoryExists(Path("pics")));
+            ASSERT_FALSE(fs.directoryExists(Path("textures/e1u3")));
+            ASSERT_FALSE(fs.directoryExists(Path("amnet.cfg")));
+        }
+
+        TEST(ZipFileSystemTest, fileExists) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile);
+            ASSERT_THROW(fs.fileExists(Path("/amnet.cfg")), FileSystemException);
+
+            ASSERT_TRUE(fs.fileExists(Path("amnet.cfg")));
+            ASSERT_TRUE(fs.fileExists(Path("maps/start.map")));
+            ASSERT_TRUE(fs.fileExists(Path("Textures/E1U1/Box1_3.wal")));
+            ASSERT_FALSE(fs.fileExists(Path("pics")));
+            ASSERT_FALSE(fs.fileExists(Path("pics/tag2.pcx")));
+        }
+
+        TEST(ZipFileSystemTest, findItems) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile);
+            Path::List items = fs.findItems(Path(""));
+            ASSERT_EQ(4u, items.size());
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("amnet.cfg")) != std::end(items));
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("Maps")) != std::end(items));
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("pics")) != std::end(items));
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("textures")) != std::end(items));
+
+            items = fs.findItemsRecursively(Path("textures"));
+            ASSERT_EQ(4u, items.size());
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("textures/e1u1/box1_3.wal")) != std::end(items));
+            ASSERT_TRUE(std::find(std::begin(items), std::end(items), Path("textures/e1u2/angle1_1.wal")) != std::end(items));
+        }
+
+        TEST(ZipFileSystemTest, openFile) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile);
+            ASSERT_THROW(fs.openFile(Path("textures")), FileSystemException);
+            ASSERT_THROW(fs.openFile(Path("/amnet.cfg")), FileSystemException);
+
+            // stored
+            ASSERT_EQ(std::string("// amnet config\nbind x \"+attack\"\n"), contents(fs.openFile(Path("amnet.cfg"))));
+            ASSERT_EQ(1024u, fs.openFile(Path("pics/tag1.pcx"))->size());
+
+            // deflated
+            ASSERT_EQ(repeat("box1_3 ", 1000), contents(fs.openFile(Path("textures/e1u1/box1_3.wal"))));
+            ASSERT_EQ(repeat("angle1_1 ", 2000), contents(fs.openFile(Path("textures/e1u2/angle1_1.wal"))));
+            ASSERT_EQ(repeat("{\n\"classname\" \"worldspawn\"\n}\n", 50), contents(fs.openFile(Path("maps/start.map"))));
+        }
+
+        TEST(ZipFileSystemTest, cacheDecompressedFiles) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile, 20000);
+            ASSERT_EQ(0u, fs.cacheUsage());
+
+            // stored files are not cached
+            fs.openFile(Path("amnet.cfg"));
+            ASSERT_EQ(0u, fs.cacheUsage());
+
+            const auto box = fs.openFile(Path("textures/e1u1/box1_3.wal"));
+            ASSERT_EQ(7000u, fs.cacheUsage());
+            ASSERT_EQ(box, fs.openFile(Path("textures/e1u1/box1_3.wal")));
+
+            // evicts the box texture, which stays valid as long as it is used
+            const auto angle = fs.openFile(Path("textures/e1u2/angle1_1.wal"));
+            ASSERT_EQ(18000u, fs.cacheUsage());
+            ASSERT_EQ(angle, fs.openFile(Path("textures/e1u2/angle1_1.wal")));
+            ASSERT_EQ(repeat("box1_3 ", 1000), contents(box));
+
+            ASSERT_NE(box, fs.openFile(Path("textures/e1u1/box1_3.wal")));
+            ASSERT_EQ(7000u, fs.cacheUsage());
+        }
+
+        TEST(ZipFileSystemTest, openFilesConcurrently) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/zip1.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            const ZipFileSystem fs(zipPath, zipFile);
+            Path::List paths;
+            for (size_t i = 0; i < 100; ++i) {
+                paths.push_back(Path(i % 2 == 0 ? "textures/e1u1/box1_3.wal" : "textures/e1u2/angle1_1.wal"));
+            }
+
+            const auto files = fs.openFiles(paths, 8);
+            ASSERT_EQ(paths.size(), files.size());
+            for (size_t i = 0; i < files.size(); ++i) {
+                ASSERT_EQ(i % 2 == 0 ? 7000u : 18000u, files[i]->size());
+            }
+            ASSERT_EQ(25000u, fs.cacheUsage());
+        }
+
+        TEST(ZipFileSystemTest, skipUnsupportedEntries) {
+            const Path zipPath = Disk::getCurrentWorkingDir() + Path("data/IO/Zip/unsupported.zip");
+            const MappedFile::Ptr zipFile = Disk::openFile(zipPath);
+            assert(zipFile != nullptr);
+
+            // contains a bzip2 compressed entry, an encrypted entry and an entry with zip64 sizes
+            const ZipFileSystem fs(zipPath, zipFile);
+            ASSERT_EQ(Path::List({ Path("readme.txt") }), fs.findItems(Path("")));
+            ASSERT_FALSE(fs.fileExists(Path("bzip2.txt")));
+            ASSERT_FALSE(fs.fileExists(Path("encrypted.txt")));
+            ASSERT_FALSE(fs.fileExists(Path("zip64.txt")));
+            ASSERT_EQ(std::string("supported\n"), contents(fs.openFile(Path("readme.txt"))));
+        }
+    }
+}
@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <random>
 
 namespace TrenchBroom {
     namespace Model {
@@ -581,6 +582,57 @@ namespace TrenchBroom {
             ASSERT_TRUE(hits2.empty());
         }
 
+        TEST(BrushTest, pickMatchesFaceIntersection) {
+            const vm::bbox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            // a convex brush with faces that are not axis aligned
+            const std::vector<vm::vec3> points {
+                vm::vec3(-32.0, -16.0, -24.0), vm::vec3(+32.0, -24.0, -16.0), vm::vec3(+24.0, +32.0, -32.0), vm::vec3(-16.0, +24.0, -24.0),
+                vm::vec3(-24.0, -32.0, +16.0), vm::vec3(+16.0, -16.0, +32.0), vm::vec3(+32.0, +16.0, +24.0), vm::vec3(-32.0, +32.0, +16.0),
+                vm::vec3(  0.0,   0.0, +48.0), vm::vec3(+48.0,   0.0,   0.0)
+            };
+
+            BrushBuilder builder(&world, worldBounds);
+            std::unique_ptr<Brush> brush(builder.createBrush(points, BrushFace::NoTextureName));
+
+            std::mt19937 random(0);
+            std::uniform_real_distribution<FloatType> coords(-64.0, 64.0);
+
+            size_t hitCount = 0;
+            for (size_t i = 0; i < 1000; ++i) {
+                const auto origin = vm::vec3(coords(random), coords(random), coords(random)) * 2.0;
+                const auto target = vm::vec3(coords(random), coords(random), coords(random)) * 0.5;
+                const auto ray = vm::ray3(origin, vm::normalize(target - origin));
+
+                // the first face that the ray hits from the front
+                BrushFace* expectedFace = nullptr;
+                auto expectedDistance = vm::nan<FloatType>();
+                for (auto* face : brush->faces()) {
+                    const auto distance = face->intersectWithRay(ray);
+                    if (!vm::isnan(distance)) {
+                        expectedFace = face;
+                        expectedDistance = distance;
+                        break;
+                    }
+                }
+
+                PickResult hits;
+                brush->pick(ray, hits);
+                if (expectedFace == nullptr) {
+                    ASSERT_TRUE(hits.empty());
+                } else {
+                    ASSERT_EQ(1u, hits.size());
+                    const auto& hit = hits.all().front();
+                    ASSERT_EQ(expectedFace, hit.target<BrushFace*>());
+                    ASSERT_NEAR(expectedDistance, hit.distance(), vm::constants<FloatType>::almostZero());
+                    ++hitCount;
+                }
+            }
+
+            ASSERT_LT(0u, hitCount);
+        }
+
         TEST(BrushTest, partialSelectionAfterAdd) {
             const vm::bbox3 worldBounds(4096.0);
 
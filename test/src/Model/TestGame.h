@@ -39,6 +39,7 @@ namespace TrenchBroom {
             void doSetGamePath(const IO::Path& gamePath, Logger* logger) override;
             void doSetAdditionalSearchPaths(const IO::Path::List& searchPaths, Logger* logger) override;
             PathErrors doCheckAdditionalSearchPaths(const IO::Path::List& searchPaths) const override;
+            void doRefreshFileSystem() override;
 
             CompilationConfig& doCompilationConfig() override;
             size_t doMaxPropertyLength() const override;
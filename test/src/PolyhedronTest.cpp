@@ -29,6 +29,7 @@
 #include <vecmath/scalar.h>
 
 #include <iterator>
+#include <set>
 #include <tuple>
 
 typedef Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload> Polyhedron3d;
@@ -114,6 +115,38 @@ TEST(PolyhedronTest, copy) {
     ASSERT_EQ(original, copy);
 }
 
+TEST(PolyhedronTest, copyPreservesTopology) {
+    Polyhedron3d original(vm::bbox3d(vm::vec3d(0.0, 0.0, 0.0), vm::vec3d(64.0, 64.0, 64.0)));
+    original.clip(vm::plane3d(vm::vec3d(56.0, 56.0, 56.0), normalize(vm::vec3d(1.0, 1.0, 1.0))));
+
+    const Polyhedron3d copy(original);
+    ASSERT_EQ(original, copy);
+    ASSERT_EQ(original.vertexCount(), copy.vertexCount());
+    ASSERT_EQ(original.edgeCount(), copy.edgeCount());
+    ASSERT_EQ(original.faceCount(), copy.faceCount());
+    ASSERT_TRUE(copy.closed());
+
+    std::set<const Polyhedron3d::Face*> copiedFaces;
+    for (const auto* face : copy.faces()) {
+        ASSERT_EQ(face, face->boundary().front()->face());
+        copiedFaces.insert(face);
+    }
+
+    for (const auto* edge : copy.edges()) {
+        ASSERT_EQ(edge, edge->firstEdge()->edge());
+        ASSERT_EQ(edge, edge->secondEdge()->edge());
+        ASSERT_EQ(1u, copiedFaces.count(edge->firstFace()));
+        ASSERT_EQ(1u, copiedFaces.count(edge->secondFace()));
+        ASSERT_EQ(edge->firstVertex(), edge->firstEdge()->origin());
+        ASSERT_EQ(edge->firstVertex(), edge->secondEdge()->destination());
+    }
+
+    for (const auto* vertex : copy.vertices()) {
+        ASSERT_EQ(vertex, vertex->leaving()->origin());
+        ASSERT_TRUE(original.findVertexByPosition(vertex->position()) != vertex);
+    }
+}
+
 TEST(PolyhedronTest, swap) {
     const vm::vec3d p1( 0.0, 0.0, 8.0);
     const vm::vec3d p2( 8.0, 0.0, 0.0);
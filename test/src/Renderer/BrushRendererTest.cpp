@@ -0,0 +1,213 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "CollectionUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+#include "Renderer/BrushRenderer.h"
+#include "Renderer/PerspectiveCamera.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TEST(BrushRendererTest, chunkedBrushesAreCulled) {
+            const vm::bbox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            // a row of brushes along the X axis, one in every chunk
+            Model::BrushList brushes;
+            for (size_t i = 0; i < 8; ++i) {
+                const vm::vec3 center(128.0 + 256.0 * static_cast<FloatType>(i), 0.0, 0.0);
+                brushes.push_back(builder.createCuboid(vm::bbox3(center - vm::vec3::fill(32.0), center + vm::vec3::fill(32.0)), "texture"));
+            }
+
+            // looking along the row, but only seeing the first four brushes
+            const PerspectiveCamera camera(90.0f, 1.0f, 1000.0f, Camera::Viewport(0, 0, 800, 800),
+                                           vm::vec3f(-10, 0, 0), vm::vec3f::pos_x, vm::vec3f::pos_z);
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes(brushes);
+            renderer.validate();
+            ASSERT_EQ(1u, renderer.chunkCount());
+            ASSERT_EQ(1u, renderer.visibleChunkCount(camera));
+
+            renderer.setChunkSize(256.0);
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+            ASSERT_EQ(8u, renderer.chunkCount());
+            ASSERT_EQ(4u, renderer.visibleChunkCount(camera));
+
+            // removed brushes are kept until the next change, so their chunks are only removed then
+            renderer.setBrushes(Model::BrushList(std::begin(brushes), std::begin(brushes) + 6));
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(8u, renderer.chunkCount());
+            renderer.setBrushes(Model::BrushList(std::begin(brushes), std::begin(brushes) + 6));
+            ASSERT_EQ(6u, renderer.chunkCount());
+
+            // moving a brush out of view moves it to another chunk
+            brushes[0]->transform(vm::translationMatrix(vm::vec3(2048.0, 0.0, 0.0)), false, worldBounds);
+            renderer.invalidateBrushes(Model::BrushList{ brushes[0] });
+            renderer.validate();
+            ASSERT_EQ(6u, renderer.chunkCount());
+            ASSERT_EQ(3u, renderer.visibleChunkCount(camera));
+
+            renderer.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushRendererTest, brushCacheWritesFaceNormals) {
+            const vm::bbox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            Model::Brush* brush = builder.createCube(64.0, "texture");
+            auto& cache = brush->brushRendererBrushCache();
+            cache.validateVertexCache(brush);
+
+            const auto& cachedVertices = cache.cachedVertices();
+            ASSERT_EQ(24u, cachedVertices.size());
+            ASSERT_LT(0u, cache.memoryUsage());
+
+            std::vector<BrushRendererBrushCache::Vertex> vertices(cachedVertices.size());
+            cache.writeVertices(vertices.data());
+
+            for (const auto& cachedFace : cache.cachedFacesSortedByTexture()) {
+                const auto& boundary = cachedFace.face->boundary();
+                for (size_t i = 0; i < cachedFace.vertexCount; ++i) {
+                    const auto& vertex = vertices[cachedFace.indexOfFirstVertexRelativeToBrush + i];
+                    ASSERT_EQ(vm::vec3f(boundary.normal), vertex.v2);
+                    ASSERT_EQ(cachedVertices[cachedFace.indexOfFirstVertexRelativeToBrush + i].position, vertex.v1);
+                    ASSERT_DOUBLE_EQ(0.0, boundary.pointDistance(vm::vec3(vertex.v1)));
+                }
+            }
+
+            // both faces of every edge contain the edge's vertices
+            const auto& cachedFaces = cache.cachedFacesSortedByTexture();
+            for (const auto& cachedEdge : cache.cachedEdges()) {
+                ASSERT_NE(cachedEdge.faceIndex1, cachedEdge.faceIndex2);
+                for (const auto faceIndex : { cachedEdge.faceIndex1, cachedEdge.faceIndex2 }) {
+                    const auto& boundary = cachedFaces[faceIndex].face->boundary();
+                    ASSERT_DOUBLE_EQ(0.0, boundary.pointDistance(vm::vec3(cachedVertices[cachedEdge.vertexIndex1RelativeToBrush].position)));
+                    ASSERT_DOUBLE_EQ(0.0, boundary.pointDistance(vm::vec3(cachedVertices[cachedEdge.vertexIndex2RelativeToBrush].position)));
+                }
+            }
+
+            delete brush;
+        }
+
+        TEST(BrushRendererTest, removedBrushesAreShownAgainWithoutValidation) {
+            const vm::bbox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            Model::BrushList brushes;
+            for (size_t i = 0; i < 4; ++i) {
+                brushes.push_back(builder.createCube(64.0, "texture"));
+            }
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes(brushes);
+            renderer.validate();
+
+            // like deselecting and reselecting all brushes
+            renderer.setBrushes(Model::BrushList());
+            ASSERT_TRUE(renderer.valid());
+            renderer.setBrushes(brushes);
+            ASSERT_TRUE(renderer.valid());
+
+            // a brush that changed while it was removed must be validated again
+            renderer.setBrushes(Model::BrushList());
+            brushes[0]->transform(vm::translationMatrix(vm::vec3(128.0, 0.0, 0.0)), false, worldBounds);
+            renderer.setBrushes(brushes);
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+
+            // brushes that are removed twice in a row are not kept
+            renderer.setBrushes(Model::BrushList());
+            renderer.setBrushes(Model::BrushList());
+            renderer.setBrushes(brushes);
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+
+            // invalidating a removed brush removes it for good
+            renderer.setBrushes(Model::BrushList(std::begin(brushes) + 1, std::end(brushes)));
+            renderer.invalidateBrushes(Model::BrushList{ brushes[0] });
+            renderer.setBrushes(brushes);
+            ASSERT_FALSE(renderer.valid());
+
+            renderer.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        class ToggleFilter : public BrushRenderer::Filter {
+        private:
+            std::shared_ptr<bool> m_transparent;
+        public:
+            explicit ToggleFilter(std::shared_ptr<bool> transparent) :
+            m_transparent(std::move(transparent)) {}
+
+            RenderSettings markFaces(const Model::Brush* brush) const override {
+                for (Model::BrushFace* face : brush->faces()) {
+                    face->setMarked(true);
+                }
+                return std::make_tuple(*m_transparent ? RenderOpacity::Transparent : RenderOpacity::Opaque,
+                                       FaceRenderPolicy::RenderMarked,
+                                       EdgeRenderPolicy::RenderAll);
+            }
+        };
+
+        TEST(BrushRendererTest, removedBrushesAreValidatedAgainIfFilterResultChanged) {
+            const vm::bbox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            Model::BrushList brushes;
+            for (size_t i = 0; i < 4; ++i) {
+                brushes.push_back(builder.createCube(64.0, "texture"));
+            }
+
+            auto transparent = std::make_shared<bool>(false);
+            BrushRenderer renderer((ToggleFilter(transparent)));
+            renderer.setBrushes(brushes);
+            renderer.validate();
+
+            // like deselecting a brush whose entity became transparent while it was selected
+            renderer.setBrushes(Model::BrushList());
+            *transparent = true;
+            renderer.setBrushes(brushes);
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+
+            renderer.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+    }
+}
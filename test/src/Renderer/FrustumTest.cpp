@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Renderer/Frustum.h"
+#include "Renderer/OrthographicCamera.h"
+#include "Renderer/PerspectiveCamera.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static vm::bbox3f boxAt(const vm::vec3f& center, const float size) {
+            return vm::bbox3f(center - vm::vec3f::fill(size), center + vm::vec3f::fill(size));
+        }
+
+        TEST(FrustumTest, perspectiveCamera) {
+            // looking along the positive X axis, with a 90 degree field of view
+            const PerspectiveCamera camera(90.0f, 1.0f, 1000.0f, Camera::Viewport(0, 0, 800, 800),
+                                           vm::vec3f::zero, vm::vec3f::pos_x, vm::vec3f::pos_z);
+            const Frustum frustum(camera);
+
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(100, 0, 0), 8)));
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(100, 50, 50), 8)));
+
+            // contains the camera position
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f::zero, 8)));
+
+            // behind the camera
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(-100, 0, 0), 8)));
+
+            // beside, above and below the view volume
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(100, 200, 0), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(100, -200, 0), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(100, 0, 200), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(100, 0, -200), 8)));
+
+            // beyond the far plane
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(2000, 0, 0), 8)));
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(1000, 0, 0), 8)));
+
+            // large boxes that contain the entire frustum
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f::zero, 4096)));
+        }
+
+        TEST(FrustumTest, orthographicCamera) {
+            // looking down the negative Z axis, showing 800x600 units around the origin
+            const OrthographicCamera camera(1.0f, 1000.0f, Camera::Viewport(0, 0, 800, 600),
+                                            vm::vec3f(0, 0, 500), vm::vec3f::neg_z, vm::vec3f::pos_y);
+            const Frustum frustum(camera);
+
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f::zero, 8)));
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(390, 290, 0), 16)));
+
+            // the near and far planes are ignored
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(0, 0, 10000), 8)));
+            ASSERT_TRUE(frustum.intersects(boxAt(vm::vec3f(0, 0, -10000), 8)));
+
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(500, 0, 0), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(-500, 0, 0), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(0, 400, 0), 8)));
+            ASSERT_FALSE(frustum.intersects(boxAt(vm::vec3f(0, -400, 0), 8)));
+        }
+    }
+}
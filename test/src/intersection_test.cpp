@@ -25,12 +25,18 @@
 #include <vecmath/mat.h>
 #include <vecmath/quat.h>
 #include <vecmath/bbox.h>
+#include <vecmath/bbox_packet.h>
 #include <vecmath/ray.h>
 #include <vecmath/line.h>
 #include <vecmath/plane.h>
 #include <vecmath/util.h>
 #include <vecmath/intersection.h>
 
+#include <iterator>
+#include <random>
+#include <tuple>
+#include <vector>
+
 namespace vm {
     bool lineOnPlane(const plane3f& plane, const line3f& line);
 
@@ -168,6 +174,135 @@ namespace vm {
 
     }
 
+    TEST(IntersectionTest, intersectRayAndBBoxPacket) {
+        std::mt19937 random(0);
+        std::uniform_real_distribution<double> coords(-64.0, 64.0);
+        std::uniform_real_distribution<double> sizes(0.0, 32.0);
+        std::uniform_int_distribution<int> axes(0, 5);
+
+        const auto randomBox = [&]() {
+            const auto min = vec3d(coords(random), coords(random), coords(random));
+            return bbox3d(min, min + vec3d(sizes(random), sizes(random), sizes(random)));
+        };
+
+        const auto randomRay = [&](const size_t i) {
+            const auto origin = vec3d(coords(random), coords(random), coords(random));
+            if (i % 2 == 0) {
+                return ray3d(origin, normalize(vec3d(coords(random), coords(random), coords(random))));
+            } else {
+                // axis aligned rays are parallel to two pairs of slabs
+                static const vec3d directions[] = { vec3d::pos_x, vec3d::neg_x, vec3d::pos_y, vec3d::neg_y, vec3d::pos_z, vec3d::neg_z };
+                return ray3d(origin, directions[axes(random)]);
+            }
+        };
+
+        // the scalar test does not count boxes that contain the ray's origin in all cases
+        const auto scalarIntersects = [](const ray3d& ray, const bbox3d& box) {
+            return box.contains(ray.origin) || !isnan(intersect(ray, box));
+        };
+
+        size_t hits = 0;
+        for (size_t i = 0; i < 2000; ++i) {
+            const auto ray = randomRay(i);
+
+            bbox_packet<float,3,4> floatBoxes;
+            bbox_packet<double,3,8> doubleBoxes;
+            for (size_t j = 0; j < 8; ++j) {
+                const auto box = randomBox();
+                doubleBoxes.set(j, box);
+                if (j < 4) {
+                    floatBoxes.set(j, bbox3f(box));
+                }
+            }
+
+            const auto floatMask = intersects(ray, floatBoxes);
+            const auto doubleMask = intersects(ray, doubleBoxes);
+            for (size_t j = 0; j < 8; ++j) {
+                const auto expected = scalarIntersects(ray, doubleBoxes.get(j));
+                ASSERT_EQ(expected, (doubleMask & (1u << j)) != 0);
+                if (j < 4) {
+                    ASSERT_EQ(scalarIntersects(ray, bbox3d(floatBoxes.get(j))), (floatMask & (1u << j)) != 0);
+                }
+                hits += expected ? 1u : 0u;
+            }
+        }
+
+        // make sure that both outcomes were tested
+        ASSERT_LT(0u, hits);
+        ASSERT_GT(2000u * 8u, hits);
+    }
+
+    TEST(IntersectionTest, bboxPacketContains) {
+        bbox_packet<float,3,4> boxes;
+        boxes.set(0, bbox3f(vec3f(-1.0f, -1.0f, -1.0f), vec3f(1.0f, 1.0f, 1.0f)));
+        boxes.set(1, bbox3f(vec3f( 0.0f,  0.0f,  0.0f), vec3f(2.0f, 2.0f, 2.0f)));
+        boxes.set(2, bbox3f(vec3f( 4.0f,  4.0f,  4.0f), vec3f(5.0f, 5.0f, 5.0f)));
+
+        ASSERT_EQ(bbox3f(vec3f(0.0f, 0.0f, 0.0f), vec3f(2.0f, 2.0f, 2.0f)), boxes.get(1));
+
+        // the last lane was never set, so it only contains the origin
+        ASSERT_EQ(0xBu, boxes.contains(vec3d(0.0, 0.0, 0.0)));
+        ASSERT_EQ(0x2u, boxes.contains(vec3d(1.5, 0.5, 2.0)));
+        ASSERT_EQ(0x0u, boxes.contains(vec3d(3.0, 3.0, 3.0)));
+
+        ASSERT_EQ(0x3u, boxes.contains(bbox3d(vec3d(0.0, 0.0, 0.0), vec3d(1.0, 1.0, 1.0))));
+        ASSERT_EQ(0x4u, boxes.contains(bbox3d(vec3d(4.5, 4.5, 4.5), vec3d(5.0, 5.0, 5.0))));
+        ASSERT_EQ(0x0u, boxes.contains(bbox3d(vec3d(0.0, 0.0, 0.0), vec3d(3.0, 3.0, 3.0))));
+    }
+
+    TEST(IntersectionTest, intersectRayAndConvexVolume) {
+        const bbox3d bounds(vec3d(-12.0, -3.0, 4.0), vec3d(8.0, 9.0, 8.0));
+        const std::vector<plane3d> planes {
+            plane3d(bounds.min, vec3d::neg_x),
+            plane3d(bounds.min, vec3d::neg_y),
+            plane3d(bounds.min, vec3d::neg_z),
+            plane3d(bounds.max, vec3d::pos_x),
+            plane3d(bounds.max, vec3d::pos_y),
+            plane3d(bounds.max, vec3d::pos_z)
+        };
+
+        // misses
+        auto [distance, it] = intersectConvex(ray3d(vec3d::zero, vec3d::neg_z), std::begin(planes), std::end(planes));
+        ASSERT_TRUE(isnan(distance));
+        ASSERT_EQ(std::end(planes), it);
+
+        // parallel to a plane, outside of the volume
+        std::tie(distance, it) = intersectConvex(ray3d(vec3d(0.0, 10.0, 0.0), vec3d::pos_z), std::begin(planes), std::end(planes));
+        ASSERT_TRUE(isnan(distance));
+
+        // origin inside of the volume
+        std::tie(distance, it) = intersectConvex(ray3d(vec3d(0.0, 0.0, 6.0), vec3d::pos_z), std::begin(planes), std::end(planes));
+        ASSERT_TRUE(isnan(distance));
+
+        std::tie(distance, it) = intersectConvex(ray3d(vec3d::zero, vec3d::pos_z), std::begin(planes), std::end(planes));
+        ASSERT_DOUBLE_EQ(4.0, distance);
+        ASSERT_EQ(std::next(std::begin(planes), 2), it);
+
+        // compare with the scalar bounding box test
+        std::mt19937 random(0);
+        std::uniform_real_distribution<double> coords(-32.0, 32.0);
+        size_t hits = 0;
+        for (size_t i = 0; i < 1000; ++i) {
+            const auto origin = vec3d(coords(random), coords(random), coords(random));
+            if (bounds.contains(origin)) {
+                continue;
+            }
+
+            const auto ray = ray3d(origin, normalize(vec3d(coords(random), coords(random), coords(random))));
+            const auto expected = intersect(ray, bounds);
+            std::tie(distance, it) = intersectConvex(ray, std::begin(planes), std::end(planes));
+            if (isnan(expected)) {
+                ASSERT_TRUE(isnan(distance));
+            } else {
+                ASSERT_DOUBLE_EQ(expected, distance);
+                ASSERT_NE(std::end(planes), it);
+                ASSERT_NEAR(0.0, it->pointDistance(ray.pointAtDistance(distance)), constants<double>::almostZero() * 1000.0);
+                ++hits;
+            }
+        }
+        ASSERT_LT(0u, hits);
+    }
+
     TEST(IntersectionTest, intersectRayAndSphere) {
         const ray3f ray(vec3f::zero, vec3f::pos_z);
 
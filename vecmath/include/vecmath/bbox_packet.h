@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRENCHBROOM_BBOX_PACKET_H
+#define TRENCHBROOM_BBOX_PACKET_H
+
+#include "vec.h"
+#include "bbox.h"
+
+#include <cassert>
+#include <cstddef>
+
+namespace vm {
+    /**
+     * A fixed number of axis aligned bounding boxes that are stored component wise, i.e., the min values of all boxes
+     * for the first axis are stored next to each other, followed by the min values for the second axis and so on. This
+     * layout allows testing all boxes against a ray or a point at once with vector instructions, see the intersects
+     * functions in intersection.h.
+     *
+     * The boxes are referred to as lanes. Lanes that have not been set have size 0 and are located at the origin.
+     *
+     * @tparam T the component type
+     * @tparam S the number of components of the min and max points
+     * @tparam N the number of boxes
+     */
+    template <typename T, size_t S, size_t N>
+    class bbox_packet {
+    public:
+        static_assert(N <= 32, "lane masks must fit into an unsigned int");
+
+        T min[S][N];
+        T max[S][N];
+    public:
+        /**
+         * Creates a new packet where every lane has size 0 and is located at the origin.
+         */
+        bbox_packet() :
+        min(),
+        max() {}
+
+        /**
+         * Returns the box in the given lane.
+         *
+         * @param lane the lane, must be less than N
+         * @return the box
+         */
+        bbox<T,S> get(const size_t lane) const {
+            assert(lane < N);
+            bbox<T,S> result;
+            for (size_t i = 0; i < S; ++i) {
+                result.min[i] = min[i][lane];
+                result.max[i] = max[i][lane];
+            }
+            return result;
+        }
+
+        /**
+         * Sets the box in the given lane.
+         *
+         * @param lane the lane, must be less than N
+         * @param box the box
+         */
+        void set(const size_t lane, const bbox<T,S>& box) {
+            assert(lane < N);
+            for (size_t i = 0; i < S; ++i) {
+                min[i][lane] = box.min[i];
+                max[i][lane] = box.max[i];
+            }
+        }
+
+        /**
+         * Checks which of the boxes contain the given point. The point may have a different component type than this
+         * packet, in which case the comparisons are done in the point's component type.
+         *
+         * @tparam U the component type of the point
+         * @param point the point to check
+         * @return a bit mask where bit i is set if the box in lane i contains the given point
+         */
+        template <typename U>
+        unsigned contains(const vec<U,S>& point) const {
+            unsigned result = 0u;
+            for (size_t j = 0; j < N; ++j) {
+                bool contained = true;
+                for (size_t i = 0; i < S; ++i) {
+                    contained &= static_cast<U>(min[i][j]) <= point[i] && point[i] <= static_cast<U>(max[i][j]);
+                }
+                result |= static_cast<unsigned>(contained) << j;
+            }
+            return result;
+        }
+
+        /**
+         * Checks which of the boxes contain the given bounding box. The box may have a different component type than
+         * this packet, in which case the comparisons are done in the given box's component type.
+         *
+         * @tparam U the component type of the given box
+         * @param box the box to check
+         * @return a bit mask where bit i is set if the box in lane i contains the given box
+         */
+        template <typename U>
+        unsigned contains(const bbox<U,S>& box) const {
+            unsigned result = 0u;
+            for (size_t j = 0; j < N; ++j) {
+                bool contained = true;
+                for (size_t i = 0; i < S; ++i) {
+                    contained &= static_cast<U>(min[i][j]) <= box.min[i] && box.max[i] <= static_cast<U>(max[i][j]);
+                }
+                result |= static_cast<unsigned>(contained) << j;
+            }
+            return result;
+        }
+    };
+}
+
+#endif //TRENCHBROOM_BBOX_PACKET_H
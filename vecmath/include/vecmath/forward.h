@@ -80,6 +80,9 @@ namespace vm {
     using bbox3f = bbox<float,3>;
     using bbox3d = bbox<double,3>;
 
+    template<typename T, size_t S, size_t N>
+    class bbox_packet;
+
     template<typename T, size_t S>
     class line;
 
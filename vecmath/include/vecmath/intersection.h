@@ -23,12 +23,20 @@
 #include "vec.h"
 #include "ray.h"
 #include "bbox.h"
+#include "bbox_packet.h"
 #include "line.h"
 #include "plane.h"
 #include "scalar.h"
 #include "util.h"
 
+#include <algorithm>
 #include <array>
+#include <limits>
+#include <tuple>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
 
 namespace vm {
     /**
@@ -397,6 +405,180 @@ namespace vm {
         return distances[bestPlane];
     }
 
+    /**
+     * Checks which of the given boxes are intersected by the given ray using the slab test. The boxes are tested all
+     * at once, and the loops over the boxes are written such that the compiler can turn them into vector instructions.
+     * A box counts as intersected if the ray's origin is contained in it.
+     *
+     * The boxes may have a different component type than the ray, in which case the computations are done in the
+     * ray's component type. This allows storing the boxes in single precision without losing the precision of the
+     * intersection test, provided that the boxes have been rounded outwards.
+     *
+     * @tparam T the component type of the ray
+     * @tparam U the component type of the boxes
+     * @tparam S the number of components
+     * @tparam N the number of boxes
+     * @param r the ray
+     * @param inverseDirection the component wise inverse of the ray's direction, can be computed once for many tests
+     * @param b the boxes
+     * @return a bit mask where bit i is set if the box in lane i is intersected by the given ray
+     */
+    template <typename T, typename U, size_t S, size_t N>
+    unsigned intersects(const ray<T,S>& r, const vec<T,S>& inverseDirection, const bbox_packet<U,S,N>& b) {
+        T minDistances[N];
+        T maxDistances[N];
+        bool hits[N];
+        for (size_t j = 0; j < N; ++j) {
+            minDistances[j] = static_cast<T>(0.0);
+            maxDistances[j] = std::numeric_limits<T>::max();
+            hits[j] = true;
+        }
+
+        for (size_t i = 0; i < S; ++i) {
+            const auto origin = r.origin[i];
+            if (r.direction[i] == static_cast<T>(0.0)) {
+                // the ray is parallel to the slabs
+                for (size_t j = 0; j < N; ++j) {
+                    hits[j] &= static_cast<T>(b.min[i][j]) <= origin && origin <= static_cast<T>(b.max[i][j]);
+                }
+            } else {
+                const auto inverse = inverseDirection[i];
+                for (size_t j = 0; j < N; ++j) {
+                    const auto t1 = (static_cast<T>(b.min[i][j]) - origin) * inverse;
+                    const auto t2 = (static_cast<T>(b.max[i][j]) - origin) * inverse;
+                    minDistances[j] = std::max(minDistances[j], std::min(t1, t2));
+                    maxDistances[j] = std::min(maxDistances[j], std::max(t1, t2));
+                }
+            }
+        }
+
+        unsigned result = 0u;
+        for (size_t j = 0; j < N; ++j) {
+            result |= static_cast<unsigned>(hits[j] && minDistances[j] <= maxDistances[j]) << j;
+        }
+        return result;
+    }
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    /**
+     * Checks which of the given four boxes are intersected by the given ray, see above. This is the case that is used
+     * to traverse bounding volume hierarchies, so it is implemented with SSE2 instructions directly. The boxes are
+     * converted to double precision, and each half of the packet is tested in one register.
+     *
+     * @param r the ray
+     * @param inverseDirection the component wise inverse of the ray's direction
+     * @param b the boxes
+     * @return a bit mask where bit i is set if the box in lane i is intersected by the given ray
+     */
+    inline unsigned intersects(const ray<double,3>& r, const vec<double,3>& inverseDirection, const bbox_packet<float,3,4>& b) {
+        const auto allSet = _mm_castsi128_pd(_mm_set1_epi32(-1));
+        __m128d minDistances[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+        __m128d maxDistances[2] = { _mm_set1_pd(std::numeric_limits<double>::max()), _mm_set1_pd(std::numeric_limits<double>::max()) };
+        __m128d hits[2] = { allSet, allSet };
+
+        for (size_t i = 0; i < 3; ++i) {
+            const auto mins = _mm_loadu_ps(b.min[i]);
+            const auto maxs = _mm_loadu_ps(b.max[i]);
+            const __m128d boxMin[2] = { _mm_cvtps_pd(mins), _mm_cvtps_pd(_mm_movehl_ps(mins, mins)) };
+            const __m128d boxMax[2] = { _mm_cvtps_pd(maxs), _mm_cvtps_pd(_mm_movehl_ps(maxs, maxs)) };
+            const auto origin = _mm_set1_pd(r.origin[i]);
+
+            if (r.direction[i] == 0.0) {
+                // the ray is parallel to the slabs
+                for (size_t k = 0; k < 2; ++k) {
+                    const auto inside = _mm_and_pd(_mm_cmple_pd(boxMin[k], origin), _mm_cmple_pd(origin, boxMax[k]));
+                    hits[k] = _mm_and_pd(hits[k], inside);
+                }
+            } else {
+                const auto inverse = _mm_set1_pd(inverseDirection[i]);
+                for (size_t k = 0; k < 2; ++k) {
+                    const auto t1 = _mm_mul_pd(_mm_sub_pd(boxMin[k], origin), inverse);
+                    const auto t2 = _mm_mul_pd(_mm_sub_pd(boxMax[k], origin), inverse);
+                    minDistances[k] = _mm_max_pd(minDistances[k], _mm_min_pd(t1, t2));
+                    maxDistances[k] = _mm_min_pd(maxDistances[k], _mm_max_pd(t1, t2));
+                }
+            }
+        }
+
+        const auto lo = _mm_and_pd(hits[0], _mm_cmple_pd(minDistances[0], maxDistances[0]));
+        const auto hi = _mm_and_pd(hits[1], _mm_cmple_pd(minDistances[1], maxDistances[1]));
+        return static_cast<unsigned>(_mm_movemask_pd(lo) | (_mm_movemask_pd(hi) << 2));
+    }
+#endif
+
+    /**
+     * Checks which of the given boxes are intersected by the given ray, see above.
+     *
+     * @tparam T the component type of the ray
+     * @tparam U the component type of the boxes
+     * @tparam S the number of components
+     * @tparam N the number of boxes
+     * @param r the ray
+     * @param b the boxes
+     * @return a bit mask where bit i is set if the box in lane i is intersected by the given ray
+     */
+    template <typename T, typename U, size_t S, size_t N>
+    unsigned intersects(const ray<T,S>& r, const bbox_packet<U,S,N>& b) {
+        vec<T,S> inverseDirection;
+        for (size_t i = 0; i < S; ++i) {
+            inverseDirection[i] = static_cast<T>(1.0) / r.direction[i];
+        }
+        return intersects(r, inverseDirection, b);
+    }
+
+    /**
+     * Computes the point at which the given ray enters the convex volume that is bounded by the given planes. The
+     * normals of the planes must point out of the volume.
+     *
+     * Instead of intersecting the ray with each boundary polygon of the volume, this function makes one pass over the
+     * planes: the ray enters the volume at the farthest plane that it crosses from the front, and it leaves the volume at
+     * the nearest plane that it crosses from the back. If it leaves before it enters, it misses the volume.
+     *
+     * @tparam T the component type
+     * @tparam I the plane range iterator
+     * @tparam G a transformation function that transforms a range element to a plane<T,3>
+     * @param r the ray
+     * @param cur the plane range start iterator
+     * @param end the plane range end iterator
+     * @param get the transformation function
+     * @return the distance from the origin of the ray to the entry point and an iterator to the plane through which the
+     * ray enters the volume, or NaN and the end iterator if the ray misses the volume or if its origin is inside of it
+     */
+    template <typename T, typename I, typename G = Identity>
+    std::tuple<T, I> intersectConvex(const ray<T,3>& r, I cur, const I end, const G& get = G()) {
+        const auto miss = std::make_tuple(nan<T>(), end);
+
+        auto entry = end;
+        auto entryDistance = -std::numeric_limits<T>::max();
+        auto exitDistance = std::numeric_limits<T>::max();
+        for (; cur != end; ++cur) {
+            const plane<T,3>& p = get(*cur);
+            const auto cos = dot(p.normal, r.direction);
+            const auto distance = p.pointDistance(r.origin);
+            if (isZero(cos, constants<T>::almostZero())) {
+                // the ray is parallel to the plane, and it misses the volume if it is in front of the plane
+                if (distance > constants<T>::almostZero()) {
+                    return miss;
+                }
+            } else {
+                const auto t = -distance / cos;
+                if (cos < static_cast<T>(0.0)) {
+                    if (t > entryDistance) {
+                        entryDistance = t;
+                        entry = cur;
+                    }
+                } else {
+                    exitDistance = std::min(exitDistance, t);
+                }
+            }
+        }
+
+        if (entry == end || entryDistance < -constants<T>::almostZero() || entryDistance - exitDistance > constants<T>::almostZero()) {
+            return miss;
+        }
+        return std::make_tuple(entryDistance, entry);
+    }
+
     /**
      * Computes the point of intersection between the given ray and a sphere centered at the given position and with the
      * given radius.